@@ -0,0 +1,303 @@
+#pragma once
+
+/*
+ * breadth_first_search.hpp
+ * Direction-optimizing parallel breadth first search over the adjacency in offsets/targets form (CSR).
+ * The edges of vertex v are targets[offsets[v], offsets[v + 1]), see more in "compressed_graph.hpp".
+ *
+ * The search switch between two directions in every level :
+ * top-down : visit the edges of frontier and claim the unvisited targets with CAS, the frontier is a queue.
+ * bottom-up : every unvisited vertex looks for a parent in frontier by its in-edges, and stops at the first one.
+ * The frontier is a bitmap and every part owns a range of words, so the words are written without atomic RMW.
+ * We go bottom-up when the edges of frontier are more than (edges of unvisited vertices / alpha),
+ * and go back when the frontier is less than (vertex count / beta) and it is shrinking.
+ *
+ * The vertices (or words) of a level are cut into parts, in top-down every part appends the vertices it found to its own queue,
+ * and the queues are merged into next frontier by the exclusive prefix sum of their sizes.
+ *
+ * bfs_options::pool : the thread pool of parallel search, nullptr means the sequential search.
+ * Every step of a level is a parallel_for of pool over the parts, so the end of parallel_for is the barrier of levels.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "../dependent/thread_pool.hpp"
+
+namespace alg_dat {
+
+	template<typename Vertex>
+	struct adjacency_view {
+		size_t vertex_count = 0;
+
+		const size_t* offsets = nullptr;
+		const Vertex* targets = nullptr;
+
+		size_t degree(Vertex vertex) const { return offsets[vertex + 1] - offsets[vertex]; }
+	};
+
+	struct bfs_options {
+		thread_pool* pool = nullptr;
+		size_t alpha = 14;
+		size_t beta = 24;
+	};
+
+	template<typename Vertex>
+	constexpr auto bfs_invalid_vertex() -> Vertex { return static_cast<Vertex>(~static_cast<Vertex>(0)); }
+
+	namespace detail {
+
+		inline auto bfs_lowest_bit(uint64_t bits) -> size_t {
+#ifdef _MSC_VER
+			unsigned long index = 0;
+
+			_BitScanForward64(&index, bits);
+
+			return index;
+#else
+			return static_cast<size_t>(__builtin_ctzll(bits));
+#endif
+		}
+	}
+
+	/**
+	 * \brief direction-optimizing breadth first search
+	 * \tparam Vertex the type of vertex, unsigned integer
+	 * \param out_edges the out-edges of graph (CSR)
+	 * \param in_edges the in-edges of graph (CSC), it is same as out_edges if the graph is undirected
+	 * \param source the source vertex
+	 * \param parents the parent of every vertex in bfs tree, bfs_invalid_vertex if it is not reached, parents[source] = source
+	 * \param depths the depth of every vertex, it can be nullptr. It is not written if the vertex is not reached
+	 * \param options the options
+	 * \return the number of vertices we reached
+	 */
+	template<typename Vertex>
+	auto breadth_first_search(
+		const adjacency_view<Vertex>& out_edges,
+		const adjacency_view<Vertex>& in_edges,
+		Vertex source, Vertex* parents, Vertex* depths = nullptr,
+		const bfs_options& options = bfs_options()) -> size_t
+	{
+		static_assert(std::is_integral<Vertex>::value && std::is_unsigned<Vertex>::value, "the vertex should be unsigned.");
+
+		constexpr auto invalid = bfs_invalid_vertex<Vertex>();
+		constexpr size_t word_bits = 64;
+
+		const auto vertex_count = out_edges.vertex_count;
+		const auto word_count = (vertex_count + word_bits - 1) / word_bits;
+		const auto edge_count = out_edges.offsets[vertex_count];
+
+		assert(in_edges.vertex_count == vertex_count && source < vertex_count);
+
+		//4 parts per thread, so the threads are balanced when some parts are heavy
+		const auto part_count = options.pool == nullptr ? static_cast<size_t>(1) :
+			std::max(std::min(options.pool->thread_count() * 4, word_count), static_cast<size_t>(1));
+
+		//the parents are claimed by CAS in top-down, so we use atomic and copy them out at last
+		std::unique_ptr<std::atomic<Vertex>[]> claimed(new std::atomic<Vertex>[vertex_count]);
+		std::unique_ptr<std::atomic<uint64_t>[]> current_bitmap(new std::atomic<uint64_t>[word_count]);
+		std::unique_ptr<std::atomic<uint64_t>[]> next_bitmap(new std::atomic<uint64_t>[word_count]);
+
+		std::vector<Vertex> frontier(vertex_count);
+		std::vector<Vertex> next_frontier(vertex_count);
+		std::vector<std::vector<Vertex>> queues(part_count);
+
+		//the counters of every part, [vertices, edges] we found in this level
+		std::vector<size_t> found_vertices(part_count);
+		std::vector<size_t> found_edges(part_count);
+		std::vector<size_t> queue_offsets(part_count + 1);
+
+		auto frontier_size = static_cast<size_t>(1);
+		auto frontier_edges = out_edges.degree(source);
+		auto unvisited_edges = edge_count - frontier_edges;
+		auto reached = static_cast<size_t>(1);
+		auto bottom_up = false;
+		auto frontier_is_bitmap = false;
+		auto level = static_cast<Vertex>(0);
+
+		frontier[0] = source;
+
+		//function(part, first, last) is called for every part of [0, count)
+		const auto for_parts = [&](size_t count, const auto& function) {
+			const auto range = [&](size_t first_part, size_t last_part) {
+				for (auto part = first_part; part < last_part; part++)
+					function(part, count * part / part_count, count * (part + 1) / part_count);
+			};
+
+			if (part_count > 1) options.pool->parallel_for(0, part_count, range, 1);
+			else range(0, part_count);
+		};
+
+		//merge the queues of parts into next frontier, the offsets are the exclusive prefix sum of sizes
+		const auto merge_queues = [&]() {
+			queue_offsets[0] = 0;
+
+			for (size_t index = 0; index < part_count; index++)
+				queue_offsets[index + 1] = queue_offsets[index] + queues[index].size();
+
+			for_parts(part_count, [&](size_t, size_t first, size_t last) {
+				for (auto part = first; part < last; part++) {
+					std::copy(queues[part].begin(), queues[part].end(), next_frontier.begin() + queue_offsets[part]);
+
+					queues[part].clear();
+				}
+			});
+		};
+
+		//initialize the arrays, every part owns a range of words
+		for_parts(word_count, [&](size_t, size_t first, size_t last) {
+			for (auto word = first; word < last; word++) {
+				current_bitmap[word].store(0, std::memory_order_relaxed);
+				next_bitmap[word].store(0, std::memory_order_relaxed);
+
+				for (auto vertex = word * word_bits; vertex < std::min((word + 1) * word_bits, vertex_count); vertex++)
+					claimed[vertex].store(invalid, std::memory_order_relaxed);
+			}
+		});
+
+		claimed[source].store(source, std::memory_order_relaxed);
+
+		if (depths != nullptr) depths[source] = 0;
+
+		while (frontier_size != 0) {
+			const auto depth = static_cast<Vertex>(level + 1);
+
+			if (!bottom_up) {
+				//the frontier is a queue, convert it if it is a bitmap
+				if (frontier_is_bitmap) {
+					for_parts(word_count, [&](size_t part, size_t first, size_t last) {
+						for (auto word = first; word < last; word++) {
+							auto bits = current_bitmap[word].load(std::memory_order_relaxed);
+
+							for (; bits != 0; bits = bits & (bits - 1))
+								queues[part].push_back(static_cast<Vertex>(word * word_bits + detail::bfs_lowest_bit(bits)));
+
+							current_bitmap[word].store(0, std::memory_order_relaxed);
+						}
+					});
+
+					merge_queues();
+
+					std::swap(frontier, next_frontier);
+
+					frontier_is_bitmap = false;
+				}
+
+				for_parts(frontier_size, [&](size_t part, size_t first, size_t last) {
+					size_t edges = 0;
+
+					for (auto index = first; index < last; index++) {
+						const auto from = frontier[index];
+
+						for (auto edge = out_edges.offsets[from]; edge < out_edges.offsets[from + 1]; edge++) {
+							const auto to = out_edges.targets[edge];
+
+							auto expected = invalid;
+
+							if (claimed[to].load(std::memory_order_relaxed) != invalid) continue;
+							if (!claimed[to].compare_exchange_strong(expected, from, std::memory_order_relaxed)) continue;
+
+							if (depths != nullptr) depths[to] = depth;
+
+							queues[part].push_back(to);
+
+							edges = edges + out_edges.degree(to);
+						}
+					}
+
+					found_vertices[part] = queues[part].size();
+					found_edges[part] = edges;
+				});
+
+				merge_queues();
+			}
+			else {
+				//the frontier is a bitmap, convert it if it is a queue
+				if (!frontier_is_bitmap) {
+					for_parts(frontier_size, [&](size_t, size_t first, size_t last) {
+						for (auto index = first; index < last; index++) {
+							const auto vertex = frontier[index];
+
+							current_bitmap[vertex / word_bits].fetch_or(
+								static_cast<uint64_t>(1) << (vertex % word_bits), std::memory_order_relaxed);
+						}
+					});
+				}
+
+				for_parts(word_count, [&](size_t part, size_t first, size_t last) {
+					size_t vertices = 0;
+					size_t edges = 0;
+
+					for (auto word = first; word < last; word++) {
+						uint64_t bits = 0;
+
+						for (auto vertex = word * word_bits; vertex < std::min((word + 1) * word_bits, vertex_count); vertex++) {
+							if (claimed[vertex].load(std::memory_order_relaxed) != invalid) continue;
+
+							for (auto edge = in_edges.offsets[vertex]; edge < in_edges.offsets[vertex + 1]; edge++) {
+								const auto from = in_edges.targets[edge];
+
+								if (!((current_bitmap[from / word_bits].load(std::memory_order_relaxed) >> (from % word_bits)) & 1)) continue;
+
+								claimed[vertex].store(from, std::memory_order_relaxed);
+
+								if (depths != nullptr) depths[vertex] = depth;
+
+								bits = bits | (static_cast<uint64_t>(1) << (vertex % word_bits));
+
+								vertices++;
+								edges = edges + out_edges.degree(static_cast<Vertex>(vertex));
+
+								break;
+							}
+						}
+
+						next_bitmap[word].store(bits, std::memory_order_relaxed);
+					}
+
+					found_vertices[part] = vertices;
+					found_edges[part] = edges;
+				});
+			}
+
+			//decide the direction of next level
+			size_t next_size = 0;
+			size_t next_edges = 0;
+
+			for (size_t index = 0; index < part_count; index++) {
+				next_size = next_size + found_vertices[index];
+				next_edges = next_edges + found_edges[index];
+			}
+
+			if (bottom_up) {
+				std::swap(current_bitmap, next_bitmap);
+
+				frontier_is_bitmap = true;
+			}
+			else std::swap(frontier, next_frontier);
+
+			const auto growing = next_size > frontier_size;
+
+			unvisited_edges = unvisited_edges - std::min(unvisited_edges, next_edges);
+			reached = reached + next_size;
+			frontier_size = next_size;
+			frontier_edges = next_edges;
+			level = depth;
+
+			if (!bottom_up && frontier_edges > unvisited_edges / options.alpha) bottom_up = true;
+			else if (bottom_up && !growing && frontier_size < vertex_count / options.beta) bottom_up = false;
+		}
+
+		for (size_t vertex = 0; vertex < vertex_count; vertex++) parents[vertex] = claimed[vertex].load(std::memory_order_relaxed);
+
+		return reached;
+	}
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+/*
+ * convex_hull.hpp
+ * Convex hull of 2D points by monotone chain (Andrew 1979) :
+ * 1. sort the points by (x, y) with radix_sort, the components are mapped to unsigned keys with same order.
+ * 2. the lower hull is built from left to right, the upper hull is built from right to left,
+ *    a point is popped from the chain if it does not make a counterclockwise turn (see "predicates.hpp").
+ *
+ * The parallel mode cuts the sorted points into slabs, every thread builds the lower and upper chains of its slab.
+ * Every vertex of the lower (upper) hull is a vertex of the lower (upper) chain of its slab,
+ * and the concatenation of chains is still sorted, so the hull is the monotone chain of the concatenation,
+ * which is much smaller than the points.
+ *
+ * convex_hull_options::pool : the thread pool of parallel hull, nullptr means the sequential hull.
+ * The points are sorted by the parallel radix_sort, and the slabs are built by the parallel_for of pool.
+ */
+
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "../../dependent/thread_pool.hpp"
+#include "../radix_sort.hpp"
+#include "predicates.hpp"
+
+namespace alg_dat {
+
+	struct convex_hull_options {
+		thread_pool* pool = nullptr;
+	};
+
+	namespace detail {
+
+		//the minimum number of points per slab
+		constexpr size_t convex_hull_min_work = static_cast<size_t>(1) << 16;
+
+		//map the value to unsigned key, the order of keys is the order of values
+		template<typename T>
+		auto convex_hull_key(T value) {
+			static_assert(sizeof(T) == 4 || sizeof(T) == 8, "the component of point should be 32 or 64 bits.");
+
+			using key_type = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+
+			constexpr auto sign = static_cast<key_type>(1) << (sizeof(T) * 8 - 1);
+
+			//-0.0 and 0.0 are same value, they should have same key
+			if (value == T(0)) value = T(0);
+
+			key_type bits = 0;
+
+			std::memcpy(&bits, &value, sizeof(T));
+
+			if (!std::is_signed<T>::value) return bits;
+
+			//the negative float is in reversed order, all bits are flipped, the sign bit of others is flipped
+			if (std::is_floating_point<T>::value && (bits & sign) != 0) return static_cast<key_type>(~bits);
+
+			return static_cast<key_type>(bits ^ sign);
+		}
+
+		template<typename T>
+		void convex_hull_sort(vec2_t<T>* begin, vec2_t<T>* end, thread_pool* pool) {
+			const radix_sort_options options = { pool };
+
+			if (sizeof(T) == 4) {
+				radix_sort<uint64_t, vec2_t<T>>(begin, end, [](const vec2_t<T>& point) {
+					return (static_cast<uint64_t>(convex_hull_key(point.x)) << 32) | static_cast<uint64_t>(convex_hull_key(point.y));
+				}, options);
+			}
+			else {
+				//radix_sort is stable, sort by y then by x
+				radix_sort<uint64_t, vec2_t<T>>(begin, end, [](const vec2_t<T>& point) { return static_cast<uint64_t>(convex_hull_key(point.y)); }, options);
+				radix_sort<uint64_t, vec2_t<T>>(begin, end, [](const vec2_t<T>& point) { return static_cast<uint64_t>(convex_hull_key(point.x)); }, options);
+			}
+		}
+
+		/**
+		 * \brief the lower and upper chains of sorted points
+		 * \param points the sorted points
+		 * \param size the number of points
+		 * \param lower the lower chain from left to right
+		 * \param upper the upper chain from left to right
+		 */
+		template<typename T>
+		void convex_hull_chains(const vec2_t<T>* points, size_t size, std::vector<vec2_t<T>>& lower, std::vector<vec2_t<T>>& upper) {
+			lower.clear();
+			upper.clear();
+
+			for (size_t index = 0; index < size; index++) {
+				const auto& point = points[index];
+
+				//the duplicated points are adjacent after sorting
+				if (index != 0 && point == points[index - 1]) continue;
+
+				while (lower.size() >= 2 && orientation(lower[lower.size() - 2], lower.back(), point) <= 0) lower.pop_back();
+				while (upper.size() >= 2 && orientation(upper[upper.size() - 2], upper.back(), point) >= 0) upper.pop_back();
+
+				lower.push_back(point);
+				upper.push_back(point);
+			}
+		}
+	}
+
+	/**
+	 * \brief compute the convex hull of points
+	 * \param begin the first point
+	 * \param end the end of points
+	 * \param output the vertices of hull in counterclockwise order, it starts at the point with min (x, y).
+	 * The collinear points on the edges are not included. It should have enough space (at most end - begin)
+	 * \param options the options
+	 * \return the number of vertices
+	 */
+	template<typename T>
+	auto convex_hull(const vec2_t<T>* begin, const vec2_t<T>* end, vec2_t<T>* output,
+		const convex_hull_options& options = convex_hull_options()) -> size_t
+	{
+		const auto size = static_cast<size_t>(end - begin);
+
+		std::vector<vec2_t<T>> points(begin, end);
+
+		detail::convex_hull_sort(points.data(), points.data() + size, options.pool);
+
+		const auto slab_count = options.pool == nullptr ? static_cast<size_t>(1) :
+			std::max(std::min(options.pool->thread_count(), size / detail::convex_hull_min_work), static_cast<size_t>(1));
+
+		std::vector<vec2_t<T>> lower;
+		std::vector<vec2_t<T>> upper;
+
+		if (slab_count == 1) detail::convex_hull_chains(points.data(), size, lower, upper);
+		else {
+			std::vector<std::vector<vec2_t<T>>> lowers(slab_count);
+			std::vector<std::vector<vec2_t<T>>> uppers(slab_count);
+
+			options.pool->parallel_for(0, slab_count, [&](size_t first_slab, size_t last_slab) {
+				for (auto slab = first_slab; slab < last_slab; slab++) {
+					const auto first = size * slab / slab_count;
+					const auto last = size * (slab + 1) / slab_count;
+
+					detail::convex_hull_chains(points.data() + first, last - first, lowers[slab], uppers[slab]);
+				}
+			}, 1);
+
+			//the slabs are in order, so the concatenation of lower (upper) chains is sorted
+			std::vector<vec2_t<T>> lower_points;
+			std::vector<vec2_t<T>> upper_points;
+			std::vector<vec2_t<T>> unused;
+
+			for (size_t slab = 0; slab < slab_count; slab++) {
+				lower_points.insert(lower_points.end(), lowers[slab].begin(), lowers[slab].end());
+				upper_points.insert(upper_points.end(), uppers[slab].begin(), uppers[slab].end());
+			}
+
+			detail::convex_hull_chains(lower_points.data(), lower_points.size(), lower, unused);
+			detail::convex_hull_chains(upper_points.data(), upper_points.size(), unused, upper);
+		}
+
+		//all points are same, the hull is one point
+		if (lower.size() <= 1) {
+			if (!lower.empty()) output[0] = lower.front();
+
+			return lower.size();
+		}
+
+		//the lower chain, then the upper chain from right to left without its endpoints
+		size_t count = 0;
+
+		for (const auto& point : lower) output[count++] = point;
+
+		for (auto index = upper.size() - 1; index-- > 1;) output[count++] = upper[index];
+
+		return count;
+	}
+}
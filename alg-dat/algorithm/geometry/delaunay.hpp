@@ -0,0 +1,787 @@
+#pragma once
+
+/*
+ * delaunay.hpp
+ * Delaunay triangulation of 2D points by incremental insertion and edge flipping (Lawson 1977).
+ *
+ * 1. the insertion order is BRIO (biased randomized insertion order, Amenta et al. 2003) :
+ *    every point is in round k with probability 2^-(k+1), the rounds are inserted from the smallest to the largest,
+ *    and the points of a round are sorted by the Hilbert curve. The keys (round, Hilbert index) are sorted by radix_sort.
+ * 2. a point is located by walking from the last triangle, so the walk is short in Hilbert order.
+ * 3. the triangle containing the point is split into three triangles (a point on an edge makes a flat triangle,
+ *    it is flipped at once), then the edges opposite to the point are flipped until they are locally Delaunay.
+ *
+ * The mesh is closed by the ghost triangles, they connect the hull edges to the infinite vertex (detail::delaunay_none),
+ * so the points out of the hull are inserted as the other points (the circle of ghost triangle is the half plane).
+ * The predicates are exact (see "predicates.hpp"), and the cocircular points are perturbed symbolically
+ * (the lexicographically larger point is lifted more), so the triangulation is unique even for the grid points.
+ * The duplicated points are inserted once (the first one in insertion order), if all points are collinear there is no triangle.
+ *
+ * The result is a half-edge mesh in two arrays, edge e is the edge of triangle e / 3 :
+ * vertices()[e] : the index of the start vertex of e, the triangles are counterclockwise.
+ * twins()[e] : the opposite edge of e, or delaunay2::none if e is on the hull.
+ * The next edge of e in its triangle is next(e), the previous edge is previous(e).
+ *
+ * The parallel mode cuts the points into vertical slabs and the slabs are triangulated in parallel,
+ * a triangle whose circumcircle is in the x range of its slab is Delaunay for all points (certain),
+ * because the points of the other slabs are out of the range.
+ * The vertices of the other triangles and the hull vertices of slabs are triangulated again (the seam),
+ * the triangles of seam outside the certain triangles are the missing triangles. The certain triangles
+ * are bounded by their edges to the other triangles (frontier), so the seam triangles inside them are found by a flood fill.
+ *
+ * delaunay_options::pool : the thread pool of parallel mode, nullptr means the sequential triangulation.
+ * The slabs are triangulated by the parallel_for of pool.
+ */
+
+#include <type_traits>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <cmath>
+
+#include "../../dependent/memory/aligned_buffer.hpp"
+#include "../../dependent/thread_pool.hpp"
+#include "../../dependent/bounds2.hpp"
+#include "../radix_sort.hpp"
+#include "predicates.hpp"
+
+namespace alg_dat {
+
+	struct delaunay_options {
+		thread_pool* pool = nullptr;
+	};
+
+	namespace detail {
+
+		//the minimum number of points per slab
+		constexpr size_t delaunay_min_work = static_cast<size_t>(1) << 16;
+
+		//the infinite vertex of ghost triangles and the twin of hull edges
+		constexpr uint32_t delaunay_none = ~static_cast<uint32_t>(0);
+
+		inline uint32_t delaunay_next(uint32_t edge) { return edge % 3 == 2 ? edge - 2 : edge + 1; }
+
+		inline uint32_t delaunay_previous(uint32_t edge) { return edge % 3 == 0 ? edge + 2 : edge - 1; }
+
+		//the index of cell (x, y) on the Hilbert curve of 2^bits x 2^bits cells
+		inline uint32_t delaunay_hilbert(uint32_t x, uint32_t y, uint32_t bits) {
+			uint32_t index = 0;
+
+			for (auto half = static_cast<uint32_t>(1) << (bits - 1); half > 0; half >>= 1) {
+				const auto rx = (x & half) != 0 ? 1u : 0u;
+				const auto ry = (y & half) != 0 ? 1u : 0u;
+
+				index = index + half * half * ((3 * rx) ^ ry);
+
+				//rotate the quadrant, so the curve is continuous
+				if (ry == 0) {
+					if (rx == 1) {
+						x = half - 1 - (x & (half - 1));
+						y = half - 1 - (y & (half - 1));
+					}
+
+					std::swap(x, y);
+				}
+			}
+
+			return index;
+		}
+
+		template<typename T>
+		bool delaunay_less(const vec2_t<T>& a, const vec2_t<T>& b) {
+			return a.x < b.x || (a.x == b.x && a.y < b.y);
+		}
+
+		/**
+		 * \brief incircle with symbolic perturbation, the point is lifted by epsilon^rank,
+		 * the lexicographically largest point has the largest lift. It is never zero for four different points
+		 * \return positive if d is in the circle of counterclockwise a, b, c
+		 */
+		template<typename T>
+		int delaunay_incircle(const vec2_t<T>& a, const vec2_t<T>& b, const vec2_t<T>& c, const vec2_t<T>& d) {
+			const auto result = incircle(a, b, c, d);
+
+			if (result != 0) return result;
+
+			//lifting a point changes the determinant by the cofactor of its lifted component
+			struct lift {
+				const vec2_t<T>* point;
+				int sign;
+			};
+
+			lift lifts[4] = {
+				{ &a, orientation(b, c, d) },
+				{ &b, orientation(c, a, d) },
+				{ &c, orientation(a, b, d) },
+				{ &d, -orientation(a, b, c) }
+			};
+
+			std::sort(lifts, lifts + 4, [](const lift& l0, const lift& l1) { return delaunay_less(*l1.point, *l0.point); });
+
+			for (const auto& current : lifts) {
+				if (current.sign != 0) return current.sign;
+			}
+
+			return 0;
+		}
+
+		/**
+		 * \brief the insertion order of points, BRIO rounds of Hilbert order
+		 * \param points all points
+		 * \param subset the indices of points to insert
+		 * \param count the number of indices
+		 * \return the indices in insertion order
+		 */
+		template<typename T>
+		auto delaunay_order(const vec2_t<T>* points, const uint32_t* subset, size_t count) -> std::vector<uint32_t> {
+			struct order_entry {
+				uint32_t key;
+				uint32_t index;
+			};
+
+			constexpr uint32_t hilbert_bits = 14;
+			constexpr uint32_t last_round = 15;
+
+			bounds2_t<double> bounds;
+
+			for (size_t index = 0; index < count; index++) {
+				const auto& point = points[subset[index]];
+
+				bounds.expand(vec2_t<double>(static_cast<double>(point.x), static_cast<double>(point.y)));
+			}
+
+			const auto extent = bounds.size();
+			const auto cells = static_cast<double>((1u << hilbert_bits) - 1);
+			const auto scale_x = extent.x > 0 ? cells / extent.x : 0.0;
+			const auto scale_y = extent.y > 0 ? cells / extent.y : 0.0;
+
+			std::vector<order_entry> entries(count);
+
+			for (size_t index = 0; index < count; index++) {
+				const auto vertex = subset[index];
+				const auto& point = points[vertex];
+
+				const auto x = static_cast<uint32_t>((static_cast<double>(point.x) - bounds.min.x) * scale_x);
+				const auto y = static_cast<uint32_t>((static_cast<double>(point.y) - bounds.min.y) * scale_y);
+
+				//the hash of vertex decides the round, the number of trailing zeros is geometric
+				auto hash = vertex * 0x9E3779B9u;
+
+				hash = (hash ^ (hash >> 16)) * 0x85EBCA6Bu;
+				hash = hash ^ (hash >> 13);
+
+				uint32_t zeros = 0;
+
+				while (zeros < last_round && (hash & (1u << zeros)) == 0) zeros++;
+
+				entries[index] = { ((last_round - zeros) << (hilbert_bits * 2)) | delaunay_hilbert(x, y, hilbert_bits), vertex };
+			}
+
+			radix_sort<uint32_t, order_entry>(entries.data(), entries.data() + count,
+				[](const order_entry& element) { return element.key; });
+
+			std::vector<uint32_t> order(count);
+
+			for (size_t index = 0; index < count; index++) order[index] = entries[index].index;
+
+			return order;
+		}
+
+		//the mesh with ghost triangles during the insertion
+		template<typename T>
+		class delaunay_builder {
+		public:
+			explicit delaunay_builder(const vec2_t<T>* points) : mPoints(points) {}
+
+			/**
+			 * \brief triangulate the points
+			 * \param order the indices of points in insertion order
+			 * \param count the number of indices
+			 * \return false if all points are collinear, there is no triangle
+			 */
+			bool triangulate(const uint32_t* order, size_t count) {
+				if (count < 3) return false;
+
+				const auto a = order[0];
+
+				size_t second = 1;
+
+				while (second < count && mPoints[order[second]] == mPoints[a]) second++;
+
+				if (second == count) return false;
+
+				const auto b = order[second];
+
+				size_t third = second + 1;
+
+				while (third < count && orientation(mPoints[a], mPoints[b], mPoints[order[third]]) == 0) third++;
+
+				if (third == count) return false;
+
+				const auto c = order[third];
+
+				mVertices.reserve(count * 6 + 12);
+				mTwins.reserve(count * 6 + 12);
+
+				if (orientation(mPoints[a], mPoints[b], mPoints[c]) > 0) initialize(a, b, c);
+				else initialize(a, c, b);
+
+				for (size_t index = 1; index < count; index++) {
+					if (index != second && index != third) insert(order[index]);
+				}
+
+				return true;
+			}
+
+			size_t triangle_count() const { return mVertices.size() / 3; }
+
+			bool ghost(uint32_t triangle) const {
+				const auto edge = triangle * 3;
+
+				return mVertices[edge] == delaunay_none || mVertices[edge + 1] == delaunay_none || mVertices[edge + 2] == delaunay_none;
+			}
+
+			const std::vector<uint32_t>& vertices() const { return mVertices; }
+
+			const std::vector<uint32_t>& twins() const { return mTwins; }
+		private:
+			void link(uint32_t edge0, uint32_t edge1) {
+				mTwins[edge0] = edge1;
+				mTwins[edge1] = edge0;
+			}
+
+			//the triangle (a, b, c) and three ghost triangles
+			void initialize(uint32_t a, uint32_t b, uint32_t c) {
+				mVertices = { a, b, c, b, a, delaunay_none, c, b, delaunay_none, a, c, delaunay_none };
+				mTwins.assign(12, delaunay_none);
+
+				link(0, 3);
+				link(1, 6);
+				link(2, 9);
+				link(4, 11);
+				link(5, 7);
+				link(8, 10);
+
+				mLast = 0;
+			}
+
+			//whether p is strictly between u and v, they are collinear
+			bool between(uint32_t u, uint32_t v, const vec2_t<T>& p) const {
+				const auto& pu = mPoints[u];
+				const auto& pv = mPoints[v];
+
+				return delaunay_less(pu, pv) ? delaunay_less(pu, p) && delaunay_less(p, pv) : delaunay_less(pv, p) && delaunay_less(p, pu);
+			}
+
+			//the circle of ghost triangle (u, v, infinite) is the open half plane left of u -> v and the open edge
+			bool ghost_inside(uint32_t u, uint32_t v, const vec2_t<T>& p) const {
+				const auto side = orientation(mPoints[u], mPoints[v], p);
+
+				return side > 0 || (side == 0 && between(u, v, p));
+			}
+
+			//whether p is in the circle of counterclockwise triangle (a, b, c)
+			bool inside(uint32_t a, uint32_t b, uint32_t c, uint32_t p) const {
+				if (c == delaunay_none) return ghost_inside(a, b, mPoints[p]);
+				if (a == delaunay_none) return ghost_inside(b, c, mPoints[p]);
+				if (b == delaunay_none) return ghost_inside(c, a, mPoints[p]);
+
+				return delaunay_incircle(mPoints[a], mPoints[b], mPoints[c], mPoints[p]) > 0;
+			}
+
+			/**
+			 * \brief find the triangle containing the point by walking from the last triangle
+			 * \return the triangle (a ghost triangle if the point is out of hull), none if the point is a vertex
+			 */
+			uint32_t locate(const vec2_t<T>& point) {
+				auto triangle = mLast;
+
+				for (;;) {
+					const auto first = triangle * 3;
+
+					uint32_t infinite = 0;
+
+					while (infinite < 3 && mVertices[first + infinite] != delaunay_none) infinite++;
+
+					if (infinite != 3) {
+						//the ghost triangle (u, v, infinite)
+						const auto edge = first + (infinite + 1) % 3;
+						const auto u = mVertices[edge];
+						const auto v = mVertices[delaunay_next(edge)];
+
+						const auto side = orientation(mPoints[u], mPoints[v], point);
+
+						if (side > 0) return triangle;
+						if (side < 0) {
+							triangle = mTwins[edge] / 3;
+
+							continue;
+						}
+
+						if (mPoints[u] == point || mPoints[v] == point) return delaunay_none;
+						if (between(u, v, point)) return triangle;
+
+						//walk along the hull to the side of point
+						const auto beyond = delaunay_less(mPoints[u], mPoints[v]) == delaunay_less(mPoints[v], point);
+
+						triangle = mTwins[beyond ? first + (infinite + 2) % 3 : first + infinite] / 3;
+
+						continue;
+					}
+
+					//visit the edges from a random edge, so the walk never cycles
+					mRandom = mRandom * 1103515245u + 12345u;
+
+					const auto start = (mRandom >> 16) % 3;
+
+					uint32_t zeros = 0;
+					uint32_t next = delaunay_none;
+
+					for (uint32_t offset = 0; offset < 3; offset++) {
+						const auto edge = first + (start + offset) % 3;
+
+						const auto side = orientation(mPoints[mVertices[edge]], mPoints[mVertices[delaunay_next(edge)]], point);
+
+						if (side < 0) {
+							next = mTwins[edge] / 3;
+
+							break;
+						}
+
+						if (side == 0) zeros++;
+					}
+
+					if (next == delaunay_none) return zeros >= 2 ? delaunay_none : triangle;
+
+					triangle = next;
+				}
+			}
+
+			void insert(uint32_t vertex) {
+				const auto triangle = locate(mPoints[vertex]);
+
+				if (triangle == delaunay_none) return;
+
+				//split (v0, v1, v2) into (v0, v1, p), (v1, v2, p) and (v2, v0, p)
+				const auto first = triangle * 3;
+				const auto second = static_cast<uint32_t>(mVertices.size());
+				const auto third = second + 3;
+
+				const auto v0 = mVertices[first];
+				const auto v1 = mVertices[first + 1];
+				const auto v2 = mVertices[first + 2];
+
+				const auto twin1 = mTwins[first + 1];
+				const auto twin2 = mTwins[first + 2];
+
+				mVertices[first + 2] = vertex;
+
+				mVertices.insert(mVertices.end(), { v1, v2, vertex, v2, v0, vertex });
+				mTwins.insert(mTwins.end(), 6, delaunay_none);
+
+				link(second, twin1);
+				link(third, twin2);
+				link(first + 1, second + 2);
+				link(second + 1, third + 2);
+				link(third + 1, first + 2);
+
+				mLast = triangle;
+
+				legalize(first);
+				legalize(second);
+				legalize(third);
+			}
+
+			//flip the edges opposite to the new point until they are locally Delaunay
+			void legalize(uint32_t edge) {
+				mStack.push_back(edge);
+
+				while (!mStack.empty()) {
+					const auto a = mStack.back();
+
+					mStack.pop_back();
+
+					const auto b = mTwins[a];
+
+					const auto a1 = delaunay_next(a), a2 = delaunay_previous(a);
+					const auto b1 = delaunay_next(b), b2 = delaunay_previous(b);
+
+					const auto p = mVertices[a2];
+					const auto q = mVertices[b2];
+
+					if (!inside(mVertices[a1], mVertices[a], q, p)) continue;
+
+					//(x, y, p) and (y, x, q) to (q, y, p) and (p, x, q)
+					const auto twin_a2 = mTwins[a2];
+					const auto twin_b2 = mTwins[b2];
+
+					mVertices[a] = q;
+					mVertices[b] = p;
+
+					link(a, twin_b2);
+					link(b, twin_a2);
+					link(a2, b2);
+
+					mStack.push_back(a);
+					mStack.push_back(b1);
+				}
+			}
+		private:
+			const vec2_t<T>* mPoints;
+
+			std::vector<uint32_t> mVertices;
+			std::vector<uint32_t> mTwins;
+			std::vector<uint32_t> mStack;
+
+			uint32_t mLast = 0;
+			uint32_t mRandom = 1;
+		};
+
+		inline uint64_t delaunay_edge_key(uint32_t from, uint32_t to) {
+			return (static_cast<uint64_t>(from) << 32) | to;
+		}
+
+		//the sorted (key, edge) of edges, to find the edge by its vertices
+		struct delaunay_edge_entry {
+			uint64_t key;
+			uint32_t edge;
+		};
+
+		inline uint32_t delaunay_find_edge(const std::vector<delaunay_edge_entry>& entries, uint64_t key) {
+			const auto iterator = std::lower_bound(entries.begin(), entries.end(), key,
+				[](const delaunay_edge_entry& entry, uint64_t value) { return entry.key < value; });
+
+			return iterator != entries.end() && iterator->key == key ? iterator->edge : delaunay_none;
+		}
+
+		inline void delaunay_sort_edges(std::vector<delaunay_edge_entry>& entries) {
+			radix_sort<uint64_t, delaunay_edge_entry>(entries.data(), entries.data() + entries.size(),
+				[](const delaunay_edge_entry& entry) { return entry.key; });
+		}
+	}
+
+	template<typename T = real>
+	class delaunay2 {
+	public:
+		using size_type = size_t;
+		using vec_type = vec2_t<T>;
+
+		static constexpr uint32_t none = detail::delaunay_none;
+	public:
+		delaunay2() = default;
+
+		/**
+		 * \brief triangulate the points
+		 * \param begin the first point
+		 * \param end the end of points, the index of point is the offset from begin
+		 * \param options the options
+		 */
+		delaunay2(const vec_type* begin, const vec_type* end, const delaunay_options& options = delaunay_options()) {
+			assert(end - begin < static_cast<ptrdiff_t>(std::numeric_limits<uint32_t>::max()));
+
+			const auto count = static_cast<size_type>(end - begin);
+
+			const auto slab_count = options.pool == nullptr ? static_cast<size_type>(1) :
+				std::max(std::min(options.pool->thread_count(), count / detail::delaunay_min_work), static_cast<size_type>(1));
+
+			std::vector<uint32_t> indices(count);
+
+			for (size_type index = 0; index < count; index++) indices[index] = static_cast<uint32_t>(index);
+
+			if (slab_count == 1) triangulate(begin, indices);
+			else triangulate(begin, indices, *options.pool, slab_count);
+		}
+
+		size_type triangle_count() const { return mVertices.size() / 3; }
+
+		//the start vertex of every edge, 3 * triangle_count() elements
+		const uint32_t* vertices() const { return mVertices.data(); }
+
+		//the opposite edge of every edge, none for the hull edges
+		const uint32_t* twins() const { return mTwins.data(); }
+
+		static uint32_t next(uint32_t edge) { return detail::delaunay_next(edge); }
+
+		static uint32_t previous(uint32_t edge) { return detail::delaunay_previous(edge); }
+	private:
+		using builder = detail::delaunay_builder<T>;
+
+		void triangulate(const vec_type* points, const std::vector<uint32_t>& indices) {
+			const auto order = detail::delaunay_order(points, indices.data(), indices.size());
+
+			builder mesh(points);
+
+			if (!mesh.triangulate(order.data(), order.size())) return;
+
+			//remove the ghost triangles
+			std::vector<uint32_t> renumber(mesh.triangle_count(), none);
+
+			uint32_t real_count = 0;
+
+			for (uint32_t triangle = 0; triangle < mesh.triangle_count(); triangle++) {
+				if (!mesh.ghost(triangle)) renumber[triangle] = real_count++;
+			}
+
+			mVertices.resize(static_cast<size_type>(real_count) * 3);
+			mTwins.resize(static_cast<size_type>(real_count) * 3);
+
+			for (uint32_t triangle = 0; triangle < mesh.triangle_count(); triangle++) {
+				if (renumber[triangle] == none) continue;
+
+				for (uint32_t corner = 0; corner < 3; corner++) {
+					const auto edge = renumber[triangle] * 3 + corner;
+					const auto twin = mesh.twins()[triangle * 3 + corner];
+
+					mVertices[edge] = mesh.vertices()[triangle * 3 + corner];
+					mTwins[edge] = renumber[twin / 3] == none ? none : renumber[twin / 3] * 3 + twin % 3;
+				}
+			}
+		}
+
+		void triangulate(const vec_type* points, std::vector<uint32_t>& indices, thread_pool& pool, size_type slab_count) {
+			//the slab s is indices [count * s / slab_count, count * (s + 1) / slab_count) in (x, y) order
+			const auto count = indices.size();
+			const auto less = [&](uint32_t i0, uint32_t i1) { return detail::delaunay_less(points[i0], points[i1]); };
+
+			std::vector<size_type> firsts(slab_count + 1);
+
+			for (size_type index = 0; index <= slab_count; index++) firsts[index] = count * index / slab_count;
+
+			for (size_type index = 1; index < slab_count; index++) {
+				std::nth_element(indices.begin() + static_cast<std::ptrdiff_t>(firsts[index - 1]),
+					indices.begin() + static_cast<std::ptrdiff_t>(firsts[index]), indices.end(), less);
+			}
+
+			struct slab {
+				std::vector<uint32_t> certain;
+				std::vector<uint32_t> seam;
+			};
+
+			std::vector<slab> slabs(slab_count);
+			std::vector<builder> meshes(slab_count, builder(points));
+
+			const auto triangulate_slab = [&](size_type number) {
+				const auto first = firsts[number];
+				const auto last = firsts[number + 1];
+
+				const auto order = detail::delaunay_order(points, indices.data() + first, last - first);
+
+				auto& mesh = meshes[number];
+				auto& current = slabs[number];
+
+				if (!mesh.triangulate(order.data(), order.size())) {
+					current.seam = order;
+
+					return;
+				}
+
+				//the points of other slabs are out of (low, high), the previous slabs are left of the leftmost point
+				const auto leftmost = [&](size_type slab_first, size_type slab_last) {
+					return static_cast<double>(points[*std::min_element(indices.begin() + static_cast<std::ptrdiff_t>(slab_first),
+						indices.begin() + static_cast<std::ptrdiff_t>(slab_last), less)].x);
+				};
+
+				const auto low = number == 0 ? -std::numeric_limits<double>::infinity() : leftmost(first, last);
+				const auto high = number + 1 == slab_count ? std::numeric_limits<double>::infinity() : leftmost(last, firsts[number + 2]);
+
+				std::vector<bool> seam(count, false);
+
+				for (uint32_t triangle = 0; triangle < mesh.triangle_count(); triangle++) {
+					const auto* vertices = mesh.vertices().data() + triangle * 3;
+
+					if (mesh.ghost(triangle)) {
+						for (uint32_t corner = 0; corner < 3; corner++) {
+							if (vertices[corner] != none) seam[vertices[corner]] = true;
+						}
+
+						continue;
+					}
+
+					if (certain(points[vertices[0]], points[vertices[1]], points[vertices[2]], low, high)) current.certain.push_back(triangle);
+					else {
+						for (uint32_t corner = 0; corner < 3; corner++) seam[vertices[corner]] = true;
+					}
+				}
+
+				for (size_type index = first; index < last; index++) {
+					if (seam[indices[index]]) current.seam.push_back(indices[index]);
+				}
+			};
+
+			pool.parallel_for(0, slab_count, [&](size_type first_slab, size_type last_slab) {
+				for (auto number = first_slab; number < last_slab; number++) triangulate_slab(number);
+			}, 1);
+
+			stitch(points, slabs, meshes);
+		}
+
+		//whether the circumcircle of triangle is in (low, high), the margin covers the rounding error
+		static bool certain(const vec_type& a, const vec_type& b, const vec_type& c, double low, double high) {
+			const auto bx = static_cast<double>(b.x) - static_cast<double>(a.x), by = static_cast<double>(b.y) - static_cast<double>(a.y);
+			const auto cx = static_cast<double>(c.x) - static_cast<double>(a.x), cy = static_cast<double>(c.y) - static_cast<double>(a.y);
+
+			const auto d = 2 * (bx * cy - by * cx);
+
+			if (d == 0) return false;
+
+			const auto bl = bx * bx + by * by;
+			const auto cl = cx * cx + cy * cy;
+
+			const auto ux = (cy * bl - by * cl) / d;
+			const auto uy = (bx * cl - cx * bl) / d;
+
+			const auto center = static_cast<double>(a.x) + ux;
+			const auto radius = std::sqrt(ux * ux + uy * uy);
+			const auto margin = radius * 1e-6 + (std::abs(center) + radius) * 1e-12;
+
+			return center - radius - margin > low && center + radius + margin < high;
+		}
+
+		template<typename Slab>
+		void stitch(const vec_type* points, const std::vector<Slab>& slabs, const std::vector<builder>& meshes) {
+			//the seam is the triangulation of the vertices of uncertain triangles and hulls
+			std::vector<uint32_t> seam_indices;
+
+			for (const auto& current : slabs) seam_indices.insert(seam_indices.end(), current.seam.begin(), current.seam.end());
+
+			const auto order = detail::delaunay_order(points, seam_indices.data(), seam_indices.size());
+
+			builder seam(points);
+
+			const auto has_seam = seam.triangulate(order.data(), order.size());
+
+			//the certain triangles are numbered slab by slab, the seam triangles are after them
+			std::vector<uint32_t> offsets(slabs.size() + 1, 0);
+
+			for (size_type thread = 0; thread < slabs.size(); thread++)
+				offsets[thread + 1] = offsets[thread] + static_cast<uint32_t>(slabs[thread].certain.size());
+
+			//the frontier edges, they are the edges of certain triangles to the other triangles
+			std::vector<detail::delaunay_edge_entry> frontier;
+			std::vector<std::vector<uint32_t>> renumbers(slabs.size());
+
+			for (size_type thread = 0; thread < slabs.size(); thread++) {
+				auto& renumber = renumbers[thread];
+
+				renumber.assign(meshes[thread].triangle_count(), none);
+
+				for (size_type index = 0; index < slabs[thread].certain.size(); index++)
+					renumber[slabs[thread].certain[index]] = offsets[thread] + static_cast<uint32_t>(index);
+			}
+
+			mVertices.resize(static_cast<size_type>(offsets.back()) * 3);
+			mTwins.resize(static_cast<size_type>(offsets.back()) * 3);
+
+			for (size_type thread = 0; thread < slabs.size(); thread++) {
+				const auto& mesh = meshes[thread];
+				const auto& renumber = renumbers[thread];
+
+				for (const auto triangle : slabs[thread].certain) {
+					for (uint32_t corner = 0; corner < 3; corner++) {
+						const auto edge = renumber[triangle] * 3 + corner;
+						const auto twin = mesh.twins()[triangle * 3 + corner];
+
+						mVertices[edge] = mesh.vertices()[triangle * 3 + corner];
+						mTwins[edge] = renumber[twin / 3] == none ? none : renumber[twin / 3] * 3 + twin % 3;
+
+						if (mTwins[edge] == none)
+							frontier.push_back({ detail::delaunay_edge_key(mVertices[edge], mesh.vertices()[detail::delaunay_next(triangle * 3 + corner)]), edge });
+					}
+				}
+			}
+
+			if (!has_seam) return;
+
+			detail::delaunay_sort_edges(frontier);
+
+			//the edges of seam by their vertices
+			const auto& seam_vertices = seam.vertices();
+			const auto& seam_twins = seam.twins();
+
+			std::vector<detail::delaunay_edge_entry> seam_edges;
+
+			for (uint32_t edge = 0; edge < seam_vertices.size(); edge++) {
+				const auto from = seam_vertices[edge];
+				const auto to = seam_vertices[detail::delaunay_next(edge)];
+
+				if (from != none && to != none) seam_edges.push_back({ detail::delaunay_edge_key(from, to), edge });
+			}
+
+			detail::delaunay_sort_edges(seam_edges);
+
+			//flood fill the seam triangles in certain triangles, from the left of frontier edges to the frontier edges
+			std::vector<bool> covered(seam.triangle_count(), false);
+			std::vector<uint32_t> stack;
+
+			for (const auto& entry : frontier) {
+				const auto edge = detail::delaunay_find_edge(seam_edges, entry.key);
+
+				if (edge == none || covered[edge / 3]) continue;
+
+				covered[edge / 3] = true;
+				stack.push_back(edge / 3);
+
+				while (!stack.empty()) {
+					const auto triangle = stack.back();
+
+					stack.pop_back();
+
+					for (uint32_t corner = 0; corner < 3; corner++) {
+						const auto current = triangle * 3 + corner;
+						const auto from = seam_vertices[current];
+						const auto to = seam_vertices[detail::delaunay_next(current)];
+						const auto neighbor = seam_twins[current] / 3;
+
+						if (covered[neighbor] || seam.ghost(neighbor) || from == none || to == none) continue;
+						if (detail::delaunay_find_edge(frontier, detail::delaunay_edge_key(from, to)) != none) continue;
+
+						covered[neighbor] = true;
+						stack.push_back(neighbor);
+					}
+				}
+			}
+
+			//the seam triangles not covered are appended
+			std::vector<uint32_t> renumber(seam.triangle_count(), none);
+
+			auto triangle_count = offsets.back();
+
+			for (uint32_t triangle = 0; triangle < seam.triangle_count(); triangle++) {
+				if (!covered[triangle] && !seam.ghost(triangle)) renumber[triangle] = triangle_count++;
+			}
+
+			mVertices.resize(static_cast<size_type>(triangle_count) * 3);
+			mTwins.resize(static_cast<size_type>(triangle_count) * 3);
+
+			for (uint32_t triangle = 0; triangle < seam.triangle_count(); triangle++) {
+				if (renumber[triangle] == none) continue;
+
+				for (uint32_t corner = 0; corner < 3; corner++) {
+					const auto edge = renumber[triangle] * 3 + corner;
+					const auto twin = seam_twins[triangle * 3 + corner];
+
+					mVertices[edge] = seam_vertices[triangle * 3 + corner];
+
+					if (renumber[twin / 3] != none) {
+						mTwins[edge] = renumber[twin / 3] * 3 + twin % 3;
+
+						continue;
+					}
+
+					//the twin is a certain triangle (the reversed frontier edge) or out of hull
+					const auto certain_edge = detail::delaunay_find_edge(frontier,
+						detail::delaunay_edge_key(seam_vertices[detail::delaunay_next(triangle * 3 + corner)], mVertices[edge]));
+
+					mTwins[edge] = certain_edge;
+
+					if (certain_edge != none) mTwins[certain_edge] = edge;
+				}
+			}
+		}
+	private:
+		aligned_buffer<uint32_t> mVertices;
+		aligned_buffer<uint32_t> mTwins;
+	};
+}
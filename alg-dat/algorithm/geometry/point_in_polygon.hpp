@@ -0,0 +1,272 @@
+#pragma once
+
+/*
+ * point_in_polygon.hpp
+ * Test whether points are in a simple (or self-intersecting) polygon by the crossing number (even-odd rule) :
+ * the point is inside if the ray from the point to +x crosses the edges odd times.
+ * The edge (p0, p1) is crossed if (p0.y > y) != (p1.y > y) and x < p0.x + (y - p0.y) * (p1.x - p0.x) / (p1.y - p0.y).
+ * The points on the boundary may be inside or outside.
+ *
+ * The batch test precomputes the edges (y0, y1, x0, slope) once and tests many points in structure of arrays,
+ * every edge is tested against a batch of points in SIMD :
+ * AVX-512 : 16 floats per instruction.
+ * AVX2 : 8 floats per instruction.
+ * SSE2 : 4 floats per instruction.
+ * others : the scalar loop.
+ * The fma of all kernels is fused if the batch is AVX-512 or ALG_DAT_FMA, otherwise it is a multiplication and an addition,
+ * so the rest points (less than a batch) and the batches have same results.
+ * The result is a bitmask, bit i of mask[i / 64] is the result of point i, see more in "bounds2_soa.hpp".
+ */
+
+#include <type_traits>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "../../dependent/vec2_soa.hpp"
+
+namespace alg_dat {
+
+	namespace detail {
+
+		template<typename T>
+		struct point_in_polygon_scalar {
+			using type = T;
+			using mask = bool;
+
+			static constexpr size_t width = 1;
+
+			static type load(const T* value) { return *value; }
+
+			static type set(T value) { return value; }
+
+			//the fma has one rounding as the fused SIMD kernels, so the rest points are same as the batches
+			static type fma(type b0, type b1, type b2) {
+#if defined(ALG_DAT_FMA) || defined(ALG_DAT_AVX512)
+				return static_cast<type>(std::fma(b0, b1, b2));
+#else
+				return b0 * b1 + b2;
+#endif
+			}
+
+			static type sub(type b0, type b1) { return b0 - b1; }
+
+			static mask less(type b0, type b1) { return b0 < b1; }
+
+			static mask zero() { return false; }
+
+			static mask both(mask m0, mask m1) { return m0 && m1; }
+
+			static mask different(mask m0, mask m1) { return m0 != m1; }
+
+			static uint32_t bits(mask value) { return value ? 1 : 0; }
+		};
+
+#if defined(ALG_DAT_AVX512)
+		struct point_in_polygon_avx512 {
+			using type = __m512;
+			using mask = __mmask16;
+
+			static constexpr size_t width = 16;
+
+			static type load(const float* value) { return _mm512_load_ps(value); }
+
+			static type set(float value) { return _mm512_set1_ps(value); }
+
+			static type fma(type b0, type b1, type b2) { return _mm512_fmadd_ps(b0, b1, b2); }
+
+			static type sub(type b0, type b1) { return _mm512_sub_ps(b0, b1); }
+
+			static mask less(type b0, type b1) { return _mm512_cmp_ps_mask(b0, b1, _CMP_LT_OQ); }
+
+			static mask zero() { return 0; }
+
+			static mask both(mask m0, mask m1) { return static_cast<mask>(m0 & m1); }
+
+			static mask different(mask m0, mask m1) { return static_cast<mask>(m0 ^ m1); }
+
+			static uint32_t bits(mask value) { return static_cast<uint32_t>(value); }
+		};
+#endif
+
+#if defined(ALG_DAT_AVX2)
+		struct point_in_polygon_avx2 {
+			using type = __m256;
+			using mask = __m256;
+
+			static constexpr size_t width = 8;
+
+			static type load(const float* value) { return _mm256_load_ps(value); }
+
+			static type set(float value) { return _mm256_set1_ps(value); }
+
+#if defined(ALG_DAT_FMA)
+			static type fma(type b0, type b1, type b2) { return _mm256_fmadd_ps(b0, b1, b2); }
+#else
+			static type fma(type b0, type b1, type b2) { return _mm256_add_ps(_mm256_mul_ps(b0, b1), b2); }
+#endif
+
+			static type sub(type b0, type b1) { return _mm256_sub_ps(b0, b1); }
+
+			static mask less(type b0, type b1) { return _mm256_cmp_ps(b0, b1, _CMP_LT_OQ); }
+
+			static mask zero() { return _mm256_setzero_ps(); }
+
+			static mask both(mask m0, mask m1) { return _mm256_and_ps(m0, m1); }
+
+			static mask different(mask m0, mask m1) { return _mm256_xor_ps(m0, m1); }
+
+			static uint32_t bits(mask value) { return static_cast<uint32_t>(_mm256_movemask_ps(value)); }
+		};
+#endif
+
+#if defined(ALG_DAT_SSE2)
+		struct point_in_polygon_sse2 {
+			using type = __m128;
+			using mask = __m128;
+
+			static constexpr size_t width = 4;
+
+			static type load(const float* value) { return _mm_load_ps(value); }
+
+			static type set(float value) { return _mm_set1_ps(value); }
+
+			static type fma(type b0, type b1, type b2) { return _mm_add_ps(_mm_mul_ps(b0, b1), b2); }
+
+			static type sub(type b0, type b1) { return _mm_sub_ps(b0, b1); }
+
+			static mask less(type b0, type b1) { return _mm_cmplt_ps(b0, b1); }
+
+			static mask zero() { return _mm_setzero_ps(); }
+
+			static mask both(mask m0, mask m1) { return _mm_and_ps(m0, m1); }
+
+			static mask different(mask m0, mask m1) { return _mm_xor_ps(m0, m1); }
+
+			static uint32_t bits(mask value) { return static_cast<uint32_t>(_mm_movemask_ps(value)); }
+		};
+#endif
+
+		//the widest batch operations of T
+		template<typename T>
+		struct point_in_polygon_batch {
+			using type = point_in_polygon_scalar<T>;
+		};
+
+#if defined(ALG_DAT_AVX512)
+		template<>
+		struct point_in_polygon_batch<float> {
+			using type = point_in_polygon_avx512;
+		};
+#elif defined(ALG_DAT_AVX2)
+		template<>
+		struct point_in_polygon_batch<float> {
+			using type = point_in_polygon_avx2;
+		};
+#elif defined(ALG_DAT_SSE2)
+		template<>
+		struct point_in_polygon_batch<float> {
+			using type = point_in_polygon_sse2;
+		};
+#endif
+	}
+
+	/**
+	 * \brief test whether the point is in the polygon
+	 * \param polygon the vertices of polygon, the last vertex is connected to the first vertex
+	 * \param vertex_count the number of vertices
+	 * \param point the point
+	 * \return true if the point is inside
+	 */
+	template<typename T>
+	bool point_in_polygon(const vec2_t<T>* polygon, size_t vertex_count, const vec2_t<T>& point) {
+		bool inside = false;
+
+		for (size_t index = 0, previous = vertex_count - 1; index < vertex_count; previous = index++) {
+			const auto& p0 = polygon[previous];
+			const auto& p1 = polygon[index];
+
+			if ((p0.y > point.y) != (p1.y > point.y) &&
+				point.x < p0.x + (point.y - p0.y) * ((p1.x - p0.x) / (p1.y - p0.y)))
+				inside = !inside;
+		}
+
+		return inside;
+	}
+
+	/**
+	 * \brief test whether every point is in the polygon
+	 * \param polygon the vertices of polygon, the last vertex is connected to the first vertex
+	 * \param vertex_count the number of vertices
+	 * \param points the points
+	 * \param mask the result, bit i of mask[i / 64] is 1 if point i is inside. It should have (points.size() + 63) / 64 words
+	 */
+	template<typename T>
+	void point_in_polygon(const vec2_t<T>* polygon, size_t vertex_count, const vec2_soa<T>& points, uint64_t* mask) {
+		static_assert(std::is_floating_point<T>::value, "the component of point should be floating point.");
+
+		using batch = typename detail::point_in_polygon_batch<T>::type;
+
+		constexpr size_t mask_bits = 64;
+
+		static_assert(mask_bits % batch::width == 0, "the batch should not cross the word of mask.");
+
+		//the horizontal edges are never crossed, so their slope is not used
+		struct edge {
+			T y0, y1, x0, slope;
+		};
+
+		std::vector<edge> edges;
+
+		for (size_t index = 0, previous = vertex_count - 1; index < vertex_count; previous = index++) {
+			const auto& p0 = polygon[previous];
+			const auto& p1 = polygon[index];
+
+			if (p0.y == p1.y) continue;
+
+			edges.push_back({ p0.y, p1.y, p0.x, (p1.x - p0.x) / (p1.y - p0.y) });
+		}
+
+		const auto kernel = [&](auto ops, size_t index) {
+			using operations = decltype(ops);
+
+			const auto x = operations::load(points.x() + index);
+			const auto y = operations::load(points.y() + index);
+
+			auto inside = operations::zero();
+
+			for (const auto& current : edges) {
+				const auto cross = operations::different(
+					operations::less(y, operations::set(current.y0)),
+					operations::less(y, operations::set(current.y1)));
+
+				const auto intersection = operations::fma(
+					operations::sub(y, operations::set(current.y0)), operations::set(current.slope), operations::set(current.x0));
+
+				inside = operations::different(inside, operations::both(cross, operations::less(x, intersection)));
+			}
+
+			return operations::bits(inside);
+		};
+
+		const auto size = points.size();
+
+		for (size_t word = 0; word * mask_bits < size; word++) {
+			const auto first = word * mask_bits;
+			const auto last = std::min(first + mask_bits, size);
+
+			uint64_t bits = 0;
+
+			auto index = first;
+
+			for (; index + batch::width <= last; index += batch::width)
+				bits = bits | (static_cast<uint64_t>(kernel(batch(), index)) << (index - first));
+
+			for (; index < last; index++)
+				bits = bits | (static_cast<uint64_t>(kernel(detail::point_in_polygon_scalar<T>(), index)) << (index - first));
+
+			mask[word] = bits;
+		}
+	}
+}
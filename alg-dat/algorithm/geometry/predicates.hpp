@@ -0,0 +1,266 @@
+#pragma once
+
+/*
+ * predicates.hpp
+ * Robust geometric predicates of 2D points, the sign of result is always exact.
+ *
+ * orientation(a, b, c) is the sign of the determinant
+ * | a.x - c.x  a.y - c.y |
+ * | b.x - c.x  b.y - c.y |
+ * it is computed adaptively (Shewchuk 1997) :
+ * 1. the fast path computes the determinant in double and its error bound,
+ *    if the determinant is larger than the bound, the sign is correct. Almost all inputs stop here.
+ * 2. otherwise, the determinant is expanded into 6 products, every product is a exact sum of two doubles
+ *    (two_product), and they are summed exactly as a nonoverlapping expansion (grow_expansion).
+ *    The sign of expansion is the sign of its largest component.
+ *
+ * incircle(a, b, c, d) is the sign of the determinant
+ * | a.x - d.x  a.y - d.y  (a.x - d.x)^2 + (a.y - d.y)^2 |
+ * | b.x - d.x  b.y - d.y  (b.x - d.x)^2 + (b.y - d.y)^2 |
+ * | c.x - d.x  c.y - d.y  (c.x - d.x)^2 + (c.y - d.y)^2 |
+ * the fast path is same as orientation, the exact path computes the differences as expansions (two_diff)
+ * and multiplies the expansions exactly, it is slow but it is only used for (nearly) cocircular points.
+ *
+ * The components are converted to double, so float and int32 points are exact in fast path input
+ * (the float fast path is the double filter, it almost never fails for float points).
+ */
+
+#include <type_traits>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <cmath>
+
+#include "../../dependent/vec.hpp"
+
+namespace alg_dat {
+
+	namespace detail {
+
+		//a + b = sum + error exactly
+		inline void predicates_two_sum(double a, double b, double& sum, double& error) {
+			sum = a + b;
+
+			const auto virtual_b = sum - a;
+			const auto virtual_a = sum - virtual_b;
+
+			error = (a - virtual_a) + (b - virtual_b);
+		}
+
+		//a - b = difference + error exactly
+		inline void predicates_two_diff(double a, double b, double& difference, double& error) {
+			difference = a - b;
+
+			const auto virtual_b = a - difference;
+			const auto virtual_a = difference + virtual_b;
+
+			error = (a - virtual_a) + (virtual_b - b);
+		}
+
+		//a * b = product + error exactly, the error of fma is exact
+		inline void predicates_two_product(double a, double b, double& product, double& error) {
+			product = a * b;
+			error = std::fma(a, b, -product);
+		}
+
+		/**
+		 * \brief add b to the nonoverlapping expansion, the zero components are removed
+		 * \param expansion the components in increasing magnitude, it has size + 1 space
+		 * \param size the number of components
+		 * \param b the value
+		 * \return the new number of components
+		 */
+		inline auto predicates_grow_expansion(double* expansion, size_t size, double b) -> size_t {
+			size_t count = 0;
+
+			auto q = b;
+
+			for (size_t index = 0; index < size; index++) {
+				double error = 0;
+
+				predicates_two_sum(q, expansion[index], q, error);
+
+				if (error != 0) expansion[count++] = error;
+			}
+
+			if (q != 0 || count == 0) expansion[count++] = q;
+
+			return count;
+		}
+
+		//the exact sum of two expansions
+		inline auto predicates_add(const std::vector<double>& e, const std::vector<double>& f) -> std::vector<double> {
+			std::vector<double> sum(e.size() + f.size() + 1);
+
+			std::copy(e.begin(), e.end(), sum.begin());
+
+			auto size = e.size();
+
+			for (const auto component : f) size = predicates_grow_expansion(sum.data(), size, component);
+
+			sum.resize(size);
+
+			return sum;
+		}
+
+		//the exact product of two expansions, every product of components is added as two_product
+		inline auto predicates_multiply(const std::vector<double>& e, const std::vector<double>& f) -> std::vector<double> {
+			std::vector<double> product(e.size() * f.size() * 2 + 1);
+
+			size_t size = 0;
+
+			for (const auto c0 : e) {
+				for (const auto c1 : f) {
+					double value = 0, error = 0;
+
+					predicates_two_product(c0, c1, value, error);
+
+					size = predicates_grow_expansion(product.data(), size, error);
+					size = predicates_grow_expansion(product.data(), size, value);
+				}
+			}
+
+			product.resize(size);
+
+			return product;
+		}
+
+		inline int predicates_sign(double value) {
+			return value > 0 ? 1 : (value < 0 ? -1 : 0);
+		}
+
+		//the exact sign of a.x * b.y - a.y * b.x + b.x * c.y - b.y * c.x + c.x * a.y - c.y * a.x
+		inline int predicates_orientation_exact(double ax, double ay, double bx, double by, double cx, double cy) {
+			const double factors[6][2] = {
+				{ ax, by }, { -ay, bx },
+				{ bx, cy }, { -by, cx },
+				{ cx, ay }, { -cy, ax }
+			};
+
+			double expansion[13] = {};
+			size_t size = 0;
+
+			for (const auto& factor : factors) {
+				double product = 0, error = 0;
+
+				predicates_two_product(factor[0], factor[1], product, error);
+
+				size = predicates_grow_expansion(expansion, size, error);
+				size = predicates_grow_expansion(expansion, size, product);
+			}
+
+			return predicates_sign(expansion[size - 1]);
+		}
+
+		//the exact sign of incircle determinant
+		inline int predicates_incircle_exact(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy) {
+			const auto difference = [](double a, double b) {
+				double value = 0, error = 0;
+
+				predicates_two_diff(a, b, value, error);
+
+				//the integer and float inputs usually have exact differences
+				return error == 0 ? std::vector<double>{ value } : std::vector<double>{ error, value };
+			};
+
+			const auto negate = [](std::vector<double> value) {
+				for (auto& component : value) component = -component;
+
+				return value;
+			};
+
+			const auto adx = difference(ax, dx), ady = difference(ay, dy);
+			const auto bdx = difference(bx, dx), bdy = difference(by, dy);
+			const auto cdx = difference(cx, dx), cdy = difference(cy, dy);
+
+			const auto lift = [&](const std::vector<double>& x, const std::vector<double>& y) {
+				return predicates_add(predicates_multiply(x, x), predicates_multiply(y, y));
+			};
+
+			const auto cross = [&](const std::vector<double>& x0, const std::vector<double>& y0, const std::vector<double>& x1, const std::vector<double>& y1) {
+				return predicates_add(predicates_multiply(x0, y1), negate(predicates_multiply(y0, x1)));
+			};
+
+			const auto determinant = predicates_add(
+				predicates_add(
+					predicates_multiply(lift(adx, ady), cross(bdx, bdy, cdx, cdy)),
+					predicates_multiply(lift(bdx, bdy), cross(cdx, cdy, adx, ady))),
+				predicates_multiply(lift(cdx, cdy), cross(adx, ady, bdx, bdy)));
+
+			return predicates_sign(determinant.back());
+		}
+	}
+
+	/**
+	 * \brief the orientation of three points
+	 * \param a the first point
+	 * \param b the second point
+	 * \param c the third point
+	 * \return 1 if a, b, c are counterclockwise, -1 if they are clockwise and 0 if they are collinear
+	 */
+	template<typename T>
+	int orientation(const vec2_t<T>& a, const vec2_t<T>& b, const vec2_t<T>& c) {
+		static_assert(std::is_arithmetic<T>::value, "the component of point should be arithmetic.");
+
+		//(3 + 16 epsilon) * epsilon, epsilon is the half of machine epsilon of double
+		constexpr auto epsilon = std::numeric_limits<double>::epsilon() * 0.5;
+		constexpr auto error_bound = (3.0 + 16.0 * epsilon) * epsilon;
+
+		const auto ax = static_cast<double>(a.x), ay = static_cast<double>(a.y);
+		const auto bx = static_cast<double>(b.x), by = static_cast<double>(b.y);
+		const auto cx = static_cast<double>(c.x), cy = static_cast<double>(c.y);
+
+		//both products have a zero factor (e.g. c is a or b), the determinant is exactly zero
+		if ((ax == cx || by == cy) && (ay == cy || bx == cx)) return 0;
+
+		const auto left = (ax - cx) * (by - cy);
+		const auto right = (ay - cy) * (bx - cx);
+		const auto determinant = left - right;
+
+		if (std::abs(determinant) >= error_bound * (std::abs(left) + std::abs(right)) && determinant != 0)
+			return detail::predicates_sign(determinant);
+
+		return detail::predicates_orientation_exact(ax, ay, bx, by, cx, cy);
+	}
+
+	/**
+	 * \brief whether the point is in the circle through three points
+	 * \param a the first point
+	 * \param b the second point
+	 * \param c the third point, a, b, c should be counterclockwise
+	 * \param d the point
+	 * \return 1 if d is inside the circle, -1 if d is outside and 0 if they are cocircular
+	 */
+	template<typename T>
+	int incircle(const vec2_t<T>& a, const vec2_t<T>& b, const vec2_t<T>& c, const vec2_t<T>& d) {
+		static_assert(std::is_arithmetic<T>::value, "the component of point should be arithmetic.");
+
+		//(10 + 96 epsilon) * epsilon
+		constexpr auto epsilon = std::numeric_limits<double>::epsilon() * 0.5;
+		constexpr auto error_bound = (10.0 + 96.0 * epsilon) * epsilon;
+
+		const auto adx = static_cast<double>(a.x) - static_cast<double>(d.x), ady = static_cast<double>(a.y) - static_cast<double>(d.y);
+		const auto bdx = static_cast<double>(b.x) - static_cast<double>(d.x), bdy = static_cast<double>(b.y) - static_cast<double>(d.y);
+		const auto cdx = static_cast<double>(c.x) - static_cast<double>(d.x), cdy = static_cast<double>(c.y) - static_cast<double>(d.y);
+
+		const auto bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+		const auto cdxady = cdx * ady, adxcdy = adx * cdy;
+		const auto adxbdy = adx * bdy, bdxady = bdx * ady;
+
+		const auto alift = adx * adx + ady * ady;
+		const auto blift = bdx * bdx + bdy * bdy;
+		const auto clift = cdx * cdx + cdy * cdy;
+
+		const auto determinant = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+		const auto permanent =
+			(std::abs(bdxcdy) + std::abs(cdxbdy)) * alift +
+			(std::abs(cdxady) + std::abs(adxcdy)) * blift +
+			(std::abs(adxbdy) + std::abs(bdxady)) * clift;
+
+		if (std::abs(determinant) > error_bound * permanent) return detail::predicates_sign(determinant);
+
+		return detail::predicates_incircle_exact(
+			static_cast<double>(a.x), static_cast<double>(a.y), static_cast<double>(b.x), static_cast<double>(b.y),
+			static_cast<double>(c.x), static_cast<double>(c.y), static_cast<double>(d.x), static_cast<double>(d.y));
+	}
+}
@@ -0,0 +1,581 @@
+#pragma once
+
+/*
+ * segment_intersection.hpp
+ * Report all intersecting pairs of 2D segments by the sweep line (Bentley and Ottmann 1979).
+ * The sweep line moves from left to right (the points are ordered by (x, y), so the vertical segments work),
+ * the status is the segments crossing the sweep line from bottom to top,
+ * two segments can intersect for the first time only if they are adjacent in the status.
+ *
+ * 1. the endpoint events are sorted once by radix_sort, the components are mapped to unsigned keys with same order.
+ *    The crossing events are found during the sweep, they are in a binary heap and merged with the endpoint events.
+ * 2. at an endpoint p, the segments containing p are removed, reported with each other and the segments start at p,
+ *    then the segments do not end at p are inserted in their order after p.
+ * 3. at a crossing, the two segments are swapped and reported.
+ * 4. the pairs are sorted by radix_sort and the duplicated pairs are removed.
+ *
+ * The order in the status and whether two adjacent segments cross are decided by orientation (see "predicates.hpp"),
+ * so they are exact. The crossing points are computed in double only to order the crossing events.
+ * Touching segments (shared endpoints, T-junctions) and overlapping collinear segments are intersecting too.
+ *
+ * The status is a list of blocks (at most 64 segments per block, 256 bytes) with an array of blocks in order.
+ * The segment is found by binary search of blocks and a scan in block, inserting or erasing moves at most one block,
+ * and the neighbors are usually in the same block.
+ *
+ * The parallel mode cuts the plane into vertical strips with same number of endpoints,
+ * every strip sweeps the segments overlapping it until the sweep line leaves the strip.
+ * An intersection is in some strip and both segments overlap that strip, so it is found by the sweep of that strip.
+ *
+ * segment_intersection_options::pool : the thread pool of parallel mode, nullptr means the sequential sweep.
+ * The sorts are the parallel radix_sort, and the strips are swept by the parallel_for of pool.
+ */
+
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <queue>
+
+#include "../../dependent/thread_pool.hpp"
+#include "../radix_sort.hpp"
+#include "convex_hull.hpp"
+#include "predicates.hpp"
+
+namespace alg_dat {
+
+	struct segment_intersection_options {
+		thread_pool* pool = nullptr;
+	};
+
+	namespace detail {
+
+		//the minimum number of segments per strip
+		constexpr size_t segment_intersection_min_work = static_cast<size_t>(1) << 14;
+
+		constexpr uint32_t segment_intersection_none = ~static_cast<uint32_t>(0);
+
+		//the segments crossing the sweep line from bottom to top, it is a list of blocks
+		class segment_intersection_status {
+		public:
+			explicit segment_intersection_status(size_t segment_count) : mBlockOf(segment_count, segment_intersection_none) {}
+
+			bool contains(uint32_t segment) const { return mBlockOf[segment] != segment_intersection_none; }
+
+			uint32_t front() const { return mOrder.empty() ? segment_intersection_none : mBlocks[mOrder.front()].items[0]; }
+
+			uint32_t above(uint32_t segment) const {
+				const auto& current = mBlocks[mBlockOf[segment]];
+				const auto slot = locate(current, segment);
+
+				if (slot + 1 < current.count) return current.items[slot + 1];
+				if (current.rank + 1 < mOrder.size()) return mBlocks[mOrder[current.rank + 1]].items[0];
+
+				return segment_intersection_none;
+			}
+
+			uint32_t below(uint32_t segment) const {
+				const auto& current = mBlocks[mBlockOf[segment]];
+				const auto slot = locate(current, segment);
+
+				if (slot != 0) return current.items[slot - 1];
+				if (current.rank != 0) {
+					const auto& previous = mBlocks[mOrder[current.rank - 1]];
+
+					return previous.items[previous.count - 1];
+				}
+
+				return segment_intersection_none;
+			}
+
+			/**
+			 * \brief find the last segment satisfying the predicate
+			 * \param predicate it is true for the bottom segments and false for the top segments
+			 * \return the last segment, or none if the predicate of all segments are false
+			 */
+			template<typename Predicate>
+			uint32_t find(Predicate&& predicate) const {
+				//the first block whose first segment does not satisfy the predicate
+				size_t low = 0, high = mOrder.size();
+
+				while (low < high) {
+					const auto middle = (low + high) >> 1;
+
+					if (predicate(mBlocks[mOrder[middle]].items[0])) low = middle + 1;
+					else high = middle;
+				}
+
+				if (low == 0) return segment_intersection_none;
+
+				const auto& current = mBlocks[mOrder[low - 1]];
+
+				uint32_t first = 1, last = current.count;
+
+				while (first < last) {
+					const auto middle = (first + last) >> 1;
+
+					if (predicate(current.items[middle])) first = middle + 1;
+					else last = middle;
+				}
+
+				return current.items[first - 1];
+			}
+
+			//insert the segment above the previous segment, or at the bottom if previous is none
+			void insert(uint32_t previous, uint32_t segment) {
+				if (mOrder.empty()) insert_block(0);
+
+				auto block = previous == segment_intersection_none ? mOrder.front() : mBlockOf[previous];
+				auto slot = previous == segment_intersection_none ? 0 : locate(mBlocks[block], previous) + 1;
+
+				if (mBlocks[block].count == capacity) {
+					const auto next = split(block);
+
+					if (slot > mBlocks[block].count) {
+						slot = slot - mBlocks[block].count;
+						block = next;
+					}
+				}
+
+				auto& current = mBlocks[block];
+
+				std::copy_backward(current.items + slot, current.items + current.count, current.items + current.count + 1);
+
+				current.items[slot] = segment;
+				current.count++;
+
+				mBlockOf[segment] = block;
+			}
+
+			void erase(uint32_t segment) {
+				const auto block = mBlockOf[segment];
+
+				auto& current = mBlocks[block];
+
+				const auto slot = locate(current, segment);
+
+				std::copy(current.items + slot + 1, current.items + current.count, current.items + slot);
+
+				current.count--;
+
+				mBlockOf[segment] = segment_intersection_none;
+
+				if (current.count == 0) {
+					erase_block(block);
+
+					return;
+				}
+
+				//merge the small blocks, so the number of blocks is O(size / capacity)
+				if (current.rank + 1 < mOrder.size()) {
+					const auto next = mOrder[current.rank + 1];
+
+					if (current.count + mBlocks[next].count <= capacity / 2) {
+						for (uint32_t index = 0; index < mBlocks[next].count; index++) {
+							current.items[current.count++] = mBlocks[next].items[index];
+
+							mBlockOf[mBlocks[next].items[index]] = block;
+						}
+
+						erase_block(next);
+					}
+				}
+			}
+
+			//swap two segments, they can be in different blocks
+			void swap(uint32_t segment0, uint32_t segment1) {
+				auto& block0 = mBlocks[mBlockOf[segment0]];
+				auto& block1 = mBlocks[mBlockOf[segment1]];
+
+				//locate both before writing, the blocks may be same
+				const auto slot0 = locate(block0, segment0);
+				const auto slot1 = locate(block1, segment1);
+
+				block0.items[slot0] = segment1;
+				block1.items[slot1] = segment0;
+
+				std::swap(mBlockOf[segment0], mBlockOf[segment1]);
+			}
+		private:
+			static constexpr uint32_t capacity = 64;
+
+			struct block {
+				uint32_t items[capacity];
+				uint32_t count;
+				uint32_t rank;
+			};
+
+			static uint32_t locate(const block& current, uint32_t segment) {
+				uint32_t slot = 0;
+
+				while (current.items[slot] != segment) slot++;
+
+				return slot;
+			}
+
+			void update_rank(size_t first) {
+				for (auto rank = first; rank < mOrder.size(); rank++) mBlocks[mOrder[rank]].rank = static_cast<uint32_t>(rank);
+			}
+
+			uint32_t insert_block(size_t rank) {
+				uint32_t block = 0;
+
+				if (mFree.empty()) {
+					block = static_cast<uint32_t>(mBlocks.size());
+
+					mBlocks.emplace_back();
+				}
+				else {
+					block = mFree.back();
+
+					mFree.pop_back();
+				}
+
+				mBlocks[block].count = 0;
+
+				mOrder.insert(mOrder.begin() + static_cast<std::ptrdiff_t>(rank), block);
+
+				update_rank(rank);
+
+				return block;
+			}
+
+			void erase_block(uint32_t block) {
+				const auto rank = mBlocks[block].rank;
+
+				mOrder.erase(mOrder.begin() + rank);
+				mFree.push_back(block);
+
+				update_rank(rank);
+			}
+
+			//move the upper half of full block to a new block after it
+			uint32_t split(uint32_t block) {
+				const auto next = insert_block(mBlocks[block].rank + 1);
+
+				auto& current = mBlocks[block];
+				auto& upper = mBlocks[next];
+
+				for (auto index = capacity / 2; index < capacity; index++) {
+					upper.items[upper.count++] = current.items[index];
+
+					mBlockOf[current.items[index]] = next;
+				}
+
+				current.count = capacity / 2;
+
+				return next;
+			}
+		private:
+			std::vector<block> mBlocks;
+			std::vector<uint32_t> mFree;
+			std::vector<uint32_t> mOrder;
+			std::vector<uint32_t> mBlockOf;
+		};
+
+		//the segment from left to right, left < right in (x, y) order
+		template<typename T>
+		struct segment_intersection_segment {
+			vec2_t<T> left;
+			vec2_t<T> right;
+		};
+
+		template<typename T>
+		struct segment_intersection_event {
+			vec2_t<T> point;
+			uint32_t segment;
+			uint32_t start;
+		};
+
+		struct segment_intersection_crossing {
+			double x, y;
+			uint32_t lower;
+			uint32_t upper;
+		};
+
+		template<typename T>
+		bool segment_intersection_less(const vec2_t<T>& a, const vec2_t<T>& b) {
+			return a.x < b.x || (a.x == b.x && a.y < b.y);
+		}
+
+		inline uint64_t segment_intersection_pair(uint32_t a, uint32_t b) {
+			return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+		}
+
+		template<typename T>
+		void segment_intersection_sort(segment_intersection_event<T>* begin, segment_intersection_event<T>* end, thread_pool* pool) {
+			using event = segment_intersection_event<T>;
+
+			const radix_sort_options options = { pool };
+
+			if (sizeof(T) == 4) {
+				radix_sort<uint64_t, event>(begin, end, [](const event& value) {
+					return (static_cast<uint64_t>(convex_hull_key(value.point.x)) << 32) | static_cast<uint64_t>(convex_hull_key(value.point.y));
+				}, options);
+			}
+			else {
+				//radix_sort is stable, sort by y then by x
+				radix_sort<uint64_t, event>(begin, end, [](const event& value) { return static_cast<uint64_t>(convex_hull_key(value.point.y)); }, options);
+				radix_sort<uint64_t, event>(begin, end, [](const event& value) { return static_cast<uint64_t>(convex_hull_key(value.point.x)); }, options);
+			}
+		}
+
+		/**
+		 * \brief sweep the segments and report the intersecting pairs
+		 * \param segments all segments
+		 * \param events the sorted endpoint events of the swept segments
+		 * \param stop the sweep stops at the first endpoint whose x is larger than stop
+		 * \param pairs the intersecting pairs (min << 32 | max) are appended, they may be duplicated
+		 */
+		template<typename T>
+		void segment_intersection_sweep(const std::vector<segment_intersection_segment<T>>& segments,
+			const std::vector<segment_intersection_event<T>>& events, T stop, std::vector<uint64_t>& pairs)
+		{
+			using crossing = segment_intersection_crossing;
+
+			const auto later = [](const crossing& c0, const crossing& c1) { return c0.x > c1.x || (c0.x == c1.x && c0.y > c1.y); };
+
+			std::priority_queue<crossing, std::vector<crossing>, decltype(later)> crossings(later);
+
+			segment_intersection_status status(segments.size());
+
+			//the current event point, the crossings computed before it are moved to it
+			auto sweep_x = -std::numeric_limits<double>::infinity();
+			auto sweep_y = -std::numeric_limits<double>::infinity();
+
+			//schedule the crossing of adjacent segments (lower is below upper after the sweep line)
+			const auto schedule = [&](uint32_t lower, uint32_t upper) {
+				if (lower == segment_intersection_none || upper == segment_intersection_none) return;
+
+				const auto& s0 = segments[lower];
+				const auto& s1 = segments[upper];
+
+				//they cross before the nearer right endpoint iff lower is above upper at that endpoint
+				const auto cross = segment_intersection_less(s0.right, s1.right) ?
+					orientation(s1.left, s1.right, s0.right) > 0 :
+					orientation(s0.left, s0.right, s1.right) < 0;
+
+				if (!cross) return;
+
+				const auto d0x = static_cast<double>(s0.right.x) - static_cast<double>(s0.left.x);
+				const auto d0y = static_cast<double>(s0.right.y) - static_cast<double>(s0.left.y);
+				const auto d1x = static_cast<double>(s1.right.x) - static_cast<double>(s1.left.x);
+				const auto d1y = static_cast<double>(s1.right.y) - static_cast<double>(s1.left.y);
+				const auto ex = static_cast<double>(s1.left.x) - static_cast<double>(s0.left.x);
+				const auto ey = static_cast<double>(s1.left.y) - static_cast<double>(s0.left.y);
+
+				const auto t = (ex * d1y - ey * d1x) / (d0x * d1y - d0y * d1x);
+
+				crossing value = { static_cast<double>(s0.left.x) + t * d0x, static_cast<double>(s0.left.y) + t * d0y, lower, upper };
+
+				if (value.x < sweep_x || (value.x == sweep_x && value.y < sweep_y)) {
+					value.x = sweep_x;
+					value.y = sweep_y;
+				}
+
+				crossings.push(value);
+			};
+
+			std::vector<uint32_t> group;
+			std::vector<uint32_t> inserted;
+
+			size_t next = 0;
+
+			while (next < events.size() || !crossings.empty()) {
+				const auto endpoint = next < events.size() && (crossings.empty() ||
+					!later(crossing{ static_cast<double>(events[next].point.x), static_cast<double>(events[next].point.y), 0, 0 }, crossings.top()));
+
+				if (!endpoint) {
+					const auto current = crossings.top();
+
+					crossings.pop();
+
+					//the crossing is stale if the segments are not adjacent in this order now
+					if (!status.contains(current.lower) || status.above(current.lower) != current.upper) continue;
+
+					sweep_x = current.x;
+					sweep_y = current.y;
+
+					status.swap(current.lower, current.upper);
+
+					pairs.push_back(segment_intersection_pair(current.lower, current.upper));
+
+					schedule(status.below(current.upper), current.upper);
+					schedule(current.lower, status.above(current.lower));
+
+					continue;
+				}
+
+				const auto point = events[next].point;
+
+				if (point.x > stop) break;
+
+				sweep_x = static_cast<double>(point.x);
+				sweep_y = static_cast<double>(point.y);
+
+				group.clear();
+				inserted.clear();
+
+				//the segments containing the point are adjacent, they are after the segments below the point
+				const auto below = status.find([&](uint32_t segment) {
+					return orientation(segments[segment].left, segments[segment].right, point) > 0;
+				});
+
+				for (auto segment = below == segment_intersection_none ? status.front() : status.above(below);
+					segment != segment_intersection_none && orientation(segments[segment].left, segments[segment].right, point) == 0;
+					segment = status.above(segment))
+				{
+					group.push_back(segment);
+
+					if (!(segments[segment].right == point)) inserted.push_back(segment);
+				}
+
+				for (; next < events.size() && events[next].point == point; next++) {
+					const auto segment = events[next].segment;
+
+					if (events[next].start == 0) continue;
+
+					group.push_back(segment);
+
+					if (!(segments[segment].right == point)) inserted.push_back(segment);
+				}
+
+				for (size_t i = 0; i < group.size(); i++) {
+					for (auto j = i + 1; j < group.size(); j++) pairs.push_back(segment_intersection_pair(group[i], group[j]));
+				}
+
+				for (const auto segment : group) {
+					if (status.contains(segment)) status.erase(segment);
+				}
+
+				//the order after the point is the order of directions to the right endpoints
+				std::sort(inserted.begin(), inserted.end(), [&](uint32_t s0, uint32_t s1) {
+					const auto side = orientation(point, segments[s1].right, segments[s0].right);
+
+					return side != 0 ? side < 0 : s0 < s1;
+				});
+
+				auto previous = below;
+
+				for (const auto segment : inserted) {
+					status.insert(previous, segment);
+
+					previous = segment;
+				}
+
+				if (inserted.empty()) schedule(below, below == segment_intersection_none ? status.front() : status.above(below));
+				else {
+					schedule(below, inserted.front());
+					schedule(inserted.back(), status.above(inserted.back()));
+				}
+			}
+		}
+
+		inline void segment_intersection_unique(std::vector<uint64_t>& pairs, thread_pool* pool) {
+			if (pool == nullptr) radix_sort(pairs.data(), pairs.data() + pairs.size());
+			else radix_sort<uint64_t, uint64_t>(pairs.data(), pairs.data() + pairs.size(), default_radix_sort_function<uint64_t, uint64_t>, radix_sort_options{ pool });
+
+			pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+		}
+	}
+
+	/**
+	 * \brief find all intersecting pairs of segments
+	 * \param endpoints the endpoints of segments, segment i is (endpoints[2 * i], endpoints[2 * i + 1])
+	 * \param segment_count the number of segments
+	 * \param options the options
+	 * \return the pairs (i, j) with i < j of intersecting segments, they are sorted
+	 */
+	template<typename T>
+	auto segment_intersections(const vec2_t<T>* endpoints, size_t segment_count,
+		const segment_intersection_options& options = segment_intersection_options()) -> std::vector<std::pair<uint32_t, uint32_t>>
+	{
+		using segment = detail::segment_intersection_segment<T>;
+		using event = detail::segment_intersection_event<T>;
+
+		std::vector<segment> segments(segment_count);
+		std::vector<event> events;
+
+		events.reserve(segment_count * 2);
+
+		for (size_t index = 0; index < segment_count; index++) {
+			const auto& p0 = endpoints[index * 2];
+			const auto& p1 = endpoints[index * 2 + 1];
+
+			segments[index] = detail::segment_intersection_less(p1, p0) ? segment{ p1, p0 } : segment{ p0, p1 };
+
+			events.push_back({ segments[index].left, static_cast<uint32_t>(index), 1 });
+			events.push_back({ segments[index].right, static_cast<uint32_t>(index), 0 });
+		}
+
+		detail::segment_intersection_sort(events.data(), events.data() + events.size(), options.pool);
+
+		//renumber the segments by their left endpoints, so the segments in the status are near in memory
+		std::vector<uint32_t> original(segment_count);
+		std::vector<uint32_t> renumber(segment_count);
+		std::vector<segment> swept(segment_count);
+
+		uint32_t number = 0;
+
+		for (const auto& value : events) {
+			if (value.start == 0) continue;
+
+			original[number] = value.segment;
+			renumber[value.segment] = number;
+			swept[number++] = segments[value.segment];
+		}
+
+		for (auto& value : events) value.segment = renumber[value.segment];
+
+		segments.swap(swept);
+
+		const auto strip_count = options.pool == nullptr ? static_cast<size_t>(1) :
+			std::max(std::min(options.pool->thread_count(), segment_count / detail::segment_intersection_min_work), static_cast<size_t>(1));
+
+		std::vector<uint64_t> pairs;
+
+		if (strip_count == 1) detail::segment_intersection_sweep(segments, events, std::numeric_limits<T>::max(), pairs);
+		else {
+			//the strip s is [boundaries[s], boundaries[s + 1]]
+			std::vector<T> boundaries(strip_count + 1);
+
+			boundaries.front() = std::numeric_limits<T>::lowest();
+			boundaries.back() = std::numeric_limits<T>::max();
+
+			for (size_t strip = 1; strip < strip_count; strip++) boundaries[strip] = events[events.size() * strip / strip_count].point.x;
+
+			std::vector<std::vector<uint64_t>> strip_pairs(strip_count);
+
+			options.pool->parallel_for(0, strip_count, [&](size_t first_strip, size_t last_strip) {
+				for (auto strip = first_strip; strip < last_strip; strip++) {
+					const auto first = boundaries[strip];
+					const auto last = boundaries[strip + 1];
+
+					//the events of segments overlapping the strip, they are still sorted
+					std::vector<event> strip_events;
+
+					for (const auto& value : events) {
+						const auto& current = segments[value.segment];
+
+						if (current.left.x <= last && current.right.x >= first) strip_events.push_back(value);
+					}
+
+					detail::segment_intersection_sweep(segments, strip_events, last, strip_pairs[strip]);
+				}
+			}, 1);
+
+			for (const auto& current : strip_pairs) pairs.insert(pairs.end(), current.begin(), current.end());
+		}
+
+		for (auto& pair : pairs) pair = detail::segment_intersection_pair(original[pair >> 32], original[pair & 0xFFFFFFFF]);
+
+		detail::segment_intersection_unique(pairs, options.pool);
+
+		std::vector<std::pair<uint32_t, uint32_t>> result(pairs.size());
+
+		for (size_t index = 0; index < pairs.size(); index++)
+			result[index] = { static_cast<uint32_t>(pairs[index] >> 32), static_cast<uint32_t>(pairs[index]) };
+
+		return result;
+	}
+}
@@ -0,0 +1,444 @@
+#pragma once
+
+/*
+ * partition.hpp
+ * Stream compaction and partition of array by predicate, the elements should be trivially copyable.
+ *
+ * copy_if : copy the elements satisfying predicate to output in order.
+ * partition_copy : copy the elements satisfying predicate to output_true and the others to output_false in order.
+ * stable_partition : move the elements satisfying predicate before the others, the order is kept.
+ * partition : move the elements satisfying predicate before the others in place, the order is not kept.
+ * All functions return the number of elements satisfying predicate.
+ *
+ * The predicate is evaluated for a block of 64 elements to a bit mask, then the block is compacted without branch :
+ * AVX-512 compresses 16 (or 8) elements by mask, AVX2 permutes 8 (or 4) elements by the indices in a table of 256 (or 16) entries,
+ * for the elements of 4 or 8 bytes. The other elements are written and the output position is advanced by the bit.
+ * The unpredictable predicate costs no branch miss, so it is several times faster than std::copy_if.
+ * partition swaps the misplaced elements of blocks from both ends (Edelkamp and Weiss 2016), it needs no memory.
+ *
+ * partition_options::pool : the thread pool of parallel partition, nullptr means the sequential partition.
+ * The parallel partition is the count-scan-scatter as the parallel radix_sort :
+ * the chunks evaluate their masks and count in parallel, the counts are prefix summed by exclusive_scan,
+ * and the chunks compact to their offsets in parallel. The stable_partition and partition scatter to a buffer and copy back.
+ */
+
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "../dependent/memory/aligned_buffer.hpp"
+#include "../dependent/thread_pool.hpp"
+#include "../dependent/simd.hpp"
+#include "scan.hpp"
+
+namespace alg_dat {
+
+	struct partition_options {
+		thread_pool* pool = nullptr;
+	};
+
+	namespace detail {
+
+		//the minimum number of elements per chunk of parallel partition, the elements of a block
+		constexpr size_t partition_min_work = static_cast<size_t>(1) << 15;
+		constexpr size_t partition_block = 64;
+
+		inline auto partition_popcount(uint64_t value) -> size_t {
+#ifdef _MSC_VER
+			return static_cast<size_t>(__popcnt64(value));
+#else
+			return static_cast<size_t>(__builtin_popcountll(value));
+#endif
+		}
+
+		//the indices of set bits of every 8-bit (or 4-bit for the pairs of 32-bit lanes) mask, one byte per index
+		struct partition_table {
+			uint64_t indices[256];
+			uint64_t pairs[16];
+		};
+
+		constexpr partition_table partition_build_table() {
+			partition_table table = {};
+
+			for (uint32_t mask = 0; mask < 256; mask++) {
+				uint64_t indices = 0;
+				uint32_t count = 0;
+
+				for (uint32_t bit = 0; bit < 8; bit++) {
+					if ((mask & (1u << bit)) != 0) indices = indices | (static_cast<uint64_t>(bit) << (8 * count++));
+				}
+
+				table.indices[mask] = indices;
+			}
+
+			for (uint32_t mask = 0; mask < 16; mask++) {
+				uint64_t pairs = 0;
+				uint32_t count = 0;
+
+				for (uint32_t bit = 0; bit < 4; bit++) {
+					if ((mask & (1u << bit)) != 0) {
+						pairs = pairs | (static_cast<uint64_t>(bit * 2) << (8 * count++));
+						pairs = pairs | (static_cast<uint64_t>(bit * 2 + 1) << (8 * count++));
+					}
+				}
+
+				table.pairs[mask] = pairs;
+			}
+
+			return table;
+		}
+
+		constexpr partition_table partition_compact_table = partition_build_table();
+
+		template<typename T, typename Predicate>
+		uint64_t partition_mask(const T* input, size_t count, Predicate& predicate) {
+			uint64_t mask = 0;
+
+			for (size_t index = 0; index < count; index++) mask = mask | (static_cast<uint64_t>(predicate(input[index]) ? 1 : 0) << index);
+
+			return mask;
+		}
+
+		/**
+		 * \brief copy the elements of block whose bit is set, the output can be the input
+		 * \param input the block
+		 * \param count the number of elements, at most 64
+		 * \param mask the bits of elements
+		 * \param output the output, the elements after the result may be overwritten until the position of input + count
+		 * \return the number of elements copied
+		 */
+		template<typename T>
+		size_t partition_compact(const T* input, size_t count, uint64_t mask, T* output) {
+			size_t index = 0;
+			size_t position = 0;
+
+#if defined(ALG_DAT_AVX512)
+			if (sizeof(T) == 4) {
+				for (; index + 16 <= count; index += 16) {
+					const auto bits = static_cast<__mmask16>(mask >> index);
+					const auto value = _mm512_loadu_si512(input + index);
+
+					_mm512_storeu_si512(output + position, _mm512_maskz_compress_epi32(bits, value));
+
+					position = position + partition_popcount(bits);
+				}
+			}
+			else if (sizeof(T) == 8) {
+				for (; index + 8 <= count; index += 8) {
+					const auto bits = static_cast<__mmask8>(mask >> index);
+					const auto value = _mm512_loadu_si512(input + index);
+
+					_mm512_storeu_si512(output + position, _mm512_maskz_compress_epi64(bits, value));
+
+					position = position + partition_popcount(bits);
+				}
+			}
+#elif defined(ALG_DAT_AVX2)
+			if (sizeof(T) == 4) {
+				for (; index + 8 <= count; index += 8) {
+					const auto bits = static_cast<uint32_t>(mask >> index) & 0xFF;
+					const auto indices = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<long long>(partition_compact_table.indices[bits])));
+					const auto value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + index));
+
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + position), _mm256_permutevar8x32_epi32(value, indices));
+
+					position = position + partition_popcount(bits);
+				}
+			}
+			else if (sizeof(T) == 8) {
+				for (; index + 4 <= count; index += 4) {
+					const auto bits = static_cast<uint32_t>(mask >> index) & 0xF;
+					const auto indices = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<long long>(partition_compact_table.pairs[bits])));
+					const auto value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + index));
+
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + position), _mm256_permutevar8x32_epi32(value, indices));
+
+					position = position + partition_popcount(bits);
+				}
+			}
+#endif
+
+			//write every element and advance by its bit, so there is no branch
+			for (; index < count; index++) {
+				const auto value = input[index];
+
+				output[position] = value;
+
+				position = position + static_cast<size_t>((mask >> index) & 1);
+			}
+
+			return position;
+		}
+
+		//the mask of the first count elements
+		inline uint64_t partition_valid(size_t count) {
+			return count == partition_block ? ~static_cast<uint64_t>(0) : (static_cast<uint64_t>(1) << count) - 1;
+		}
+
+		/**
+		 * \brief compact the elements to trues and falses sequentially
+		 * \param input the input
+		 * \param size the number of elements
+		 * \param trues the output of elements satisfying predicate, it can be the input
+		 * \param falses the output of the other elements, nullptr if they are dropped
+		 * \param predicate the predicate
+		 * \return the number of elements satisfying predicate
+		 */
+		template<typename T, typename Predicate>
+		size_t partition_sequential(const T* input, size_t size, T* trues, T* falses, Predicate& predicate) {
+			size_t true_count = 0;
+			size_t false_count = 0;
+
+			for (size_t first = 0; first < size; first += partition_block) {
+				const auto count = std::min(size - first, partition_block);
+				const auto mask = partition_mask(input + first, count, predicate);
+
+				if (falses != nullptr) false_count = false_count + partition_compact(input + first, count, ~mask & partition_valid(count), falses + false_count);
+
+				true_count = true_count + partition_compact(input + first, count, mask, trues + true_count);
+			}
+
+			return true_count;
+		}
+
+		/**
+		 * \brief compact the elements to trues and falses by count-scan-scatter in the thread pool
+		 * \param input the input
+		 * \param size the number of elements
+		 * \param trues the output of elements satisfying predicate, it should not overlap the input
+		 * \param falses the output of the other elements, nullptr if they are dropped or they are after the trues
+		 * \param predicate the predicate
+		 * \param pool the thread pool
+		 * \param falses_after_trues the other elements are copied after the elements satisfying predicate in trues
+		 * \return the number of elements satisfying predicate
+		 */
+		template<typename T, typename Predicate>
+		size_t partition_parallel(const T* input, size_t size, T* trues, T* falses, Predicate& predicate, thread_pool& pool, bool falses_after_trues = false) {
+			const auto block_count = (size + partition_block - 1) / partition_block;
+			const auto chunk_count = std::min(pool.thread_count() * 4, size / partition_min_work);
+
+			//the chunks are made of whole blocks, so every block mask is in one chunk
+			const auto chunk_first = [&](size_t chunk) { return block_count * chunk / chunk_count; };
+
+			std::vector<uint64_t> masks(block_count);
+			std::vector<size_t> counts(chunk_count);
+			std::vector<size_t> offsets(chunk_count);
+
+			pool.parallel_for(0, chunk_count, [&](size_t first_chunk, size_t last_chunk) {
+				for (auto chunk = first_chunk; chunk < last_chunk; chunk++) {
+					size_t count = 0;
+
+					for (auto block = chunk_first(chunk); block < chunk_first(chunk + 1); block++) {
+						const auto first = block * partition_block;
+
+						masks[block] = partition_mask(input + first, std::min(size - first, partition_block), predicate);
+
+						count = count + partition_popcount(masks[block]);
+					}
+
+					counts[chunk] = count;
+				}
+			}, 1);
+
+			exclusive_scan(counts.data(), offsets.data(), chunk_count, static_cast<size_t>(0));
+
+			const auto true_count = offsets.back() + counts.back();
+
+			if (falses_after_trues) falses = trues + true_count;
+
+			//the block writes [position, position + count), it is compacted in a local buffer at the end of chunk,
+			//so it never writes the output of next chunk
+			const auto compact = [](const T* block_input, size_t count, uint64_t mask, T* output, size_t position, size_t end) {
+				if (position + count <= end) return partition_compact(block_input, count, mask, output + position);
+
+				alignas(T) unsigned char storage[sizeof(T) * partition_block];
+
+				const auto local = reinterpret_cast<T*>(storage);
+				const auto result = partition_compact(block_input, count, mask, local);
+
+				std::memcpy(output + position, local, sizeof(T) * result);
+
+				return result;
+			};
+
+			pool.parallel_for(0, chunk_count, [&](size_t first_chunk, size_t last_chunk) {
+				for (auto chunk = first_chunk; chunk < last_chunk; chunk++) {
+					const auto element_first = chunk_first(chunk) * partition_block;
+					const auto element_last = std::min(chunk_first(chunk + 1) * partition_block, size);
+
+					auto true_position = offsets[chunk];
+					auto false_position = element_first - offsets[chunk];
+
+					const auto true_end = true_position + counts[chunk];
+					const auto false_end = false_position + (element_last - element_first - counts[chunk]);
+
+					for (auto block = chunk_first(chunk); block < chunk_first(chunk + 1); block++) {
+						const auto first = block * partition_block;
+						const auto count = std::min(size - first, partition_block);
+
+						if (falses != nullptr)
+							false_position = false_position + compact(input + first, count, ~masks[block] & partition_valid(count), falses, false_position, false_end);
+
+						true_position = true_position + compact(input + first, count, masks[block], trues, true_position, true_end);
+					}
+				}
+			}, 1);
+
+			return true_count;
+		}
+
+		/**
+		 * \brief partition in place by swapping the misplaced elements of the blocks at both ends
+		 * \param data the elements
+		 * \param size the number of elements
+		 * \param predicate the predicate
+		 * \return the number of elements satisfying predicate
+		 */
+		template<typename T, typename Predicate>
+		size_t partition_blocked(T* data, size_t size, Predicate& predicate) {
+			uint8_t left_offsets[partition_block];
+			uint8_t right_offsets[partition_block];
+
+			//the elements before left satisfy predicate, the elements from right do not
+			auto left = data;
+			auto right = data + size;
+
+			size_t left_count = 0, left_start = 0;
+			size_t right_count = 0, right_start = 0;
+
+			while (static_cast<size_t>(right - left) >= partition_block * 2) {
+				if (left_count == 0) {
+					left_start = 0;
+
+					for (size_t index = 0; index < partition_block; index++) {
+						left_offsets[left_count] = static_cast<uint8_t>(index);
+						left_count = left_count + (predicate(left[index]) ? 0 : 1);
+					}
+				}
+
+				if (right_count == 0) {
+					right_start = 0;
+
+					for (size_t index = 0; index < partition_block; index++) {
+						right_offsets[right_count] = static_cast<uint8_t>(index);
+						right_count = right_count + (predicate(*(right - 1 - index)) ? 1 : 0);
+					}
+				}
+
+				const auto count = std::min(left_count, right_count);
+
+				for (size_t index = 0; index < count; index++)
+					std::swap(left[left_offsets[left_start + index]], *(right - 1 - right_offsets[right_start + index]));
+
+				left_count = left_count - count;
+				right_count = right_count - count;
+				left_start = left_start + count;
+				right_start = right_start + count;
+
+				if (left_count == 0) left = left + partition_block;
+				if (right_count == 0) right = right - partition_block;
+			}
+
+			//the pending offsets are in [left, right), so the rest is partitioned at last
+			return static_cast<size_t>(std::partition(left, right, [&](const T& element) { return static_cast<bool>(predicate(element)); }) - data);
+		}
+
+		inline bool partition_parallel_enable(const partition_options& options, size_t size) {
+			return options.pool != nullptr && options.pool->thread_count() > 1 && size >= partition_min_work * 2;
+		}
+	}
+
+	/**
+	 * \brief copy the elements satisfying predicate in order
+	 * \param input the input
+	 * \param size the number of elements
+	 * \param output the output, it has space for size elements (the elements after the result may be overwritten),
+	 * it can be the input only in the sequential copy
+	 * \param predicate predicate(element) -> bool
+	 * \param options the options
+	 * \return the number of elements copied
+	 */
+	template<typename T, typename Predicate>
+	size_t copy_if(const T* input, size_t size, T* output, Predicate predicate, const partition_options& options = partition_options()) {
+		static_assert(std::is_trivially_copyable<T>::value, "the element of copy_if should be trivially copyable.");
+
+		if (detail::partition_parallel_enable(options, size))
+			return detail::partition_parallel(input, size, output, static_cast<T*>(nullptr), predicate, *options.pool);
+
+		return detail::partition_sequential(input, size, output, static_cast<T*>(nullptr), predicate);
+	}
+
+	/**
+	 * \brief copy the elements satisfying predicate to output_true and the others to output_false in order
+	 * \param input the input
+	 * \param size the number of elements
+	 * \param output_true the output of elements satisfying predicate, it has space for size elements
+	 * \param output_false the output of the other elements, it has space for size elements
+	 * \param predicate predicate(element) -> bool
+	 * \param options the options
+	 * \return the number of elements satisfying predicate
+	 */
+	template<typename T, typename Predicate>
+	size_t partition_copy(const T* input, size_t size, T* output_true, T* output_false, Predicate predicate, const partition_options& options = partition_options()) {
+		static_assert(std::is_trivially_copyable<T>::value, "the element of partition_copy should be trivially copyable.");
+
+		if (detail::partition_parallel_enable(options, size))
+			return detail::partition_parallel(input, size, output_true, output_false, predicate, *options.pool);
+
+		return detail::partition_sequential(input, size, output_true, output_false, predicate);
+	}
+
+	/**
+	 * \brief move the elements satisfying predicate before the others, the order of elements is kept
+	 * \param data the elements
+	 * \param size the number of elements
+	 * \param predicate predicate(element) -> bool
+	 * \param options the options
+	 * \return the number of elements satisfying predicate
+	 */
+	template<typename T, typename Predicate>
+	size_t stable_partition(T* data, size_t size, Predicate predicate, const partition_options& options = partition_options()) {
+		static_assert(std::is_trivially_copyable<T>::value, "the element of stable_partition should be trivially copyable.");
+
+		if (size == 0) return 0;
+
+		aligned_buffer<T> buffer(size);
+
+		if (detail::partition_parallel_enable(options, size)) {
+			const auto count = detail::partition_parallel(data, size, buffer.data(), static_cast<T*>(nullptr), predicate, *options.pool, true);
+
+			options.pool->parallel_for(0, size, [&](size_t first, size_t last) {
+				std::memcpy(data + first, buffer.data() + first, sizeof(T) * (last - first));
+			}, detail::partition_min_work);
+
+			return count;
+		}
+
+		//the trues are compacted in place, the falses are copied after them at last
+		const auto count = detail::partition_sequential(data, size, data, buffer.data(), predicate);
+
+		std::memcpy(data + count, buffer.data(), sizeof(T) * (size - count));
+
+		return count;
+	}
+
+	/**
+	 * \brief move the elements satisfying predicate before the others, the order of elements is not kept
+	 * \param data the elements
+	 * \param size the number of elements
+	 * \param predicate predicate(element) -> bool
+	 * \param options the options
+	 * \return the number of elements satisfying predicate
+	 */
+	template<typename T, typename Predicate>
+	size_t partition(T* data, size_t size, Predicate predicate, const partition_options& options = partition_options()) {
+		static_assert(std::is_trivially_copyable<T>::value, "the element of partition should be trivially copyable.");
+
+		if (detail::partition_parallel_enable(options, size)) return stable_partition(data, size, predicate, options);
+
+		return detail::partition_blocked(data, size, predicate);
+	}
+}
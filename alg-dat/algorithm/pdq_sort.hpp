@@ -0,0 +1,473 @@
+#pragma once
+
+/*
+ * pdq_sort.hpp
+ * Pattern-defeating quicksort (O. Peters 2021), the comparison sort for the keys radix_sort can not sort
+ * (strings, structures with custom order, floating point numbers with NaN).
+ *
+ * 1. the small arrays (less than 24 elements) are sorted by insertion sort.
+ * 2. the pivot is the median of 3, or the pseudomedian of 9 for the arrays larger than 128 elements.
+ * 3. the partition puts the elements equal to pivot to the right. If the pivot equals the element before the array
+ *    (the pivot of parent partition), the elements equal to pivot are put to the left and they are done,
+ *    so the arrays with many equal elements are sorted in O(n).
+ * 4. an already partitioned array is finished by insertion sort with a limit of moves, so the sorted or almost sorted arrays are O(n).
+ * 5. the unbalanced partition shuffles some elements to break the patterns, and too many unbalanced partitions switch to heap sort,
+ *    so the worst case is O(n log n).
+ * The arithmetic keys with std::less/std::greater (and nan_last_less) use the branchless block partition (BlockQuicksort) :
+ * the comparisons of a block write the offsets of misplaced elements without branch, then the misplaced elements are swapped.
+ *
+ * pdq_sort_options::pool : the thread pool of parallel sort, nullptr means the sequential sort.
+ * The parallel sort is sample_sort (with equality buckets and recursion into large buckets), its leaves are pdq_sort.
+ */
+
+#include <type_traits>
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
+#include <utility>
+
+#include "../dependent/thread_pool.hpp"
+
+namespace alg_dat {
+
+	struct pdq_sort_options {
+		thread_pool* pool = nullptr;
+	};
+
+	//the order of floating point numbers, NaN is after all numbers
+	template<typename T = void>
+	struct nan_last_less {
+		bool operator()(const T& a, const T& b) const { return a < b || (b != b && a == a); }
+	};
+
+	template<>
+	struct nan_last_less<void> {
+		template<typename T>
+		bool operator()(const T& a, const T& b) const { return a < b || (b != b && a == a); }
+	};
+
+	namespace detail {
+
+		constexpr size_t pdq_sort_insertion_threshold = 24;
+		constexpr size_t pdq_sort_ninther_threshold = 128;
+		constexpr size_t pdq_sort_partial_insertion_limit = 8;
+		constexpr size_t pdq_sort_block = 64;
+
+		//the minimum number of elements of parallel sort
+		constexpr size_t pdq_sort_min_work = static_cast<size_t>(1) << 16;
+
+		template<typename Compare, typename T>
+		struct pdq_sort_default_compare : std::integral_constant<bool,
+			std::is_same<Compare, std::less<T>>::value || std::is_same<Compare, std::less<>>::value ||
+			std::is_same<Compare, std::greater<T>>::value || std::is_same<Compare, std::greater<>>::value ||
+			std::is_same<Compare, nan_last_less<T>>::value || std::is_same<Compare, nan_last_less<>>::value> {};
+
+		//the comparison is cheap and has no side effect, so we can compare the elements without branch
+		template<typename T, typename Compare>
+		struct pdq_sort_branchless : std::integral_constant<bool, std::is_arithmetic<T>::value && pdq_sort_default_compare<Compare, T>::value> {};
+
+		template<typename T, typename Compare>
+		void pdq_sort_insertion(T* begin, T* end, Compare& compare) {
+			if (begin == end) return;
+
+			for (auto current = begin + 1; current != end; ++current) {
+				auto sift = current;
+				auto sift_1 = current - 1;
+
+				if (compare(*sift, *sift_1)) {
+					auto value = std::move(*sift);
+
+					do {
+						*sift-- = std::move(*sift_1);
+					} while (sift != begin && compare(value, *--sift_1));
+
+					*sift = std::move(value);
+				}
+			}
+		}
+
+		//the element before begin is not greater than the elements, so it stops the sift
+		template<typename T, typename Compare>
+		void pdq_sort_unguarded_insertion(T* begin, T* end, Compare& compare) {
+			if (begin == end) return;
+
+			for (auto current = begin + 1; current != end; ++current) {
+				auto sift = current;
+				auto sift_1 = current - 1;
+
+				if (compare(*sift, *sift_1)) {
+					auto value = std::move(*sift);
+
+					do {
+						*sift-- = std::move(*sift_1);
+					} while (compare(value, *--sift_1));
+
+					*sift = std::move(value);
+				}
+			}
+		}
+
+		//insertion sort until the moves are more than the limit, return whether the array is sorted
+		template<typename T, typename Compare>
+		bool pdq_sort_partial_insertion(T* begin, T* end, Compare& compare) {
+			if (begin == end) return true;
+
+			size_t moves = 0;
+
+			for (auto current = begin + 1; current != end; ++current) {
+				auto sift = current;
+				auto sift_1 = current - 1;
+
+				if (compare(*sift, *sift_1)) {
+					auto value = std::move(*sift);
+
+					do {
+						*sift-- = std::move(*sift_1);
+					} while (sift != begin && compare(value, *--sift_1));
+
+					*sift = std::move(value);
+
+					moves = moves + static_cast<size_t>(current - sift);
+				}
+
+				if (moves > pdq_sort_partial_insertion_limit) return false;
+			}
+
+			return true;
+		}
+
+		template<typename T, typename Compare>
+		void pdq_sort2(T* a, T* b, Compare& compare) {
+			if (compare(*b, *a)) std::iter_swap(a, b);
+		}
+
+		template<typename T, typename Compare>
+		void pdq_sort3(T* a, T* b, T* c, Compare& compare) {
+			pdq_sort2(a, b, compare);
+			pdq_sort2(b, c, compare);
+			pdq_sort2(a, b, compare);
+		}
+
+		/**
+		 * \brief partition [begin, end) by the pivot *begin, the elements equal to pivot are put to the right
+		 * \return the position of pivot, and whether the array was already partitioned
+		 */
+		template<typename T, typename Compare>
+		auto pdq_sort_partition_right(T* begin, T* end, Compare& compare) -> std::pair<T*, bool> {
+			auto pivot = std::move(*begin);
+
+			auto first = begin;
+			auto last = end;
+
+			//the median of 3 guarantees an element not less than pivot, so the first loop has no bound check
+			while (compare(*++first, pivot));
+
+			if (first - 1 == begin) {
+				while (first < last && !compare(*--last, pivot));
+			}
+			else {
+				while (!compare(*--last, pivot));
+			}
+
+			const auto already_partitioned = first >= last;
+
+			while (first < last) {
+				std::iter_swap(first, last);
+
+				while (compare(*++first, pivot));
+				while (!compare(*--last, pivot));
+			}
+
+			const auto pivot_position = first - 1;
+
+			*begin = std::move(*pivot_position);
+			*pivot_position = std::move(pivot);
+
+			return { pivot_position, already_partitioned };
+		}
+
+		//swap the misplaced elements of left block and right block, rotate them by moves if the numbers differ
+		template<typename T>
+		void pdq_sort_swap_offsets(T* first, T* last, const uint8_t* left_offsets, const uint8_t* right_offsets, size_t count, bool use_swaps) {
+			if (use_swaps) {
+				//the descending array needs the swaps to keep O(n)
+				for (size_t index = 0; index < count; index++) std::iter_swap(first + left_offsets[index], last - right_offsets[index]);
+			}
+			else if (count > 0) {
+				auto left = first + left_offsets[0];
+				auto right = last - right_offsets[0];
+				auto value = std::move(*left);
+
+				*left = std::move(*right);
+
+				for (size_t index = 1; index < count; index++) {
+					left = first + left_offsets[index];
+					*right = std::move(*left);
+
+					right = last - right_offsets[index];
+					*left = std::move(*right);
+				}
+
+				*right = std::move(value);
+			}
+		}
+
+		//pdq_sort_partition_right without branch in the comparisons
+		template<typename T, typename Compare>
+		auto pdq_sort_partition_right_branchless(T* begin, T* end, Compare& compare) -> std::pair<T*, bool> {
+			auto pivot = std::move(*begin);
+
+			auto first = begin;
+			auto last = end;
+
+			while (compare(*++first, pivot));
+
+			if (first - 1 == begin) {
+				while (first < last && !compare(*--last, pivot));
+			}
+			else {
+				while (!compare(*--last, pivot));
+			}
+
+			const auto already_partitioned = first >= last;
+
+			if (!already_partitioned) {
+				std::iter_swap(first, last);
+
+				++first;
+
+				alignas(64) uint8_t left_offsets[pdq_sort_block];
+				alignas(64) uint8_t right_offsets[pdq_sort_block];
+
+				auto left_base = first;
+				auto right_base = last;
+
+				size_t left_count = 0, left_start = 0;
+				size_t right_count = 0, right_start = 0;
+
+				while (first < last) {
+					//the unknown elements are shared by the empty offset blocks
+					const auto unknown = static_cast<size_t>(last - first);
+					const auto left_split = left_count == 0 ? (right_count == 0 ? unknown / 2 : unknown) : 0;
+					const auto right_split = right_count == 0 ? unknown - left_split : 0;
+
+					const auto left_size = std::min(left_split, pdq_sort_block);
+					const auto right_size = std::min(right_split, pdq_sort_block);
+
+					for (size_t index = 0; index < left_size; index++) {
+						left_offsets[left_count] = static_cast<uint8_t>(index);
+						left_count = left_count + (compare(*first, pivot) ? 0 : 1);
+
+						++first;
+					}
+
+					for (size_t index = 0; index < right_size;) {
+						right_offsets[right_count] = static_cast<uint8_t>(++index);
+						right_count = right_count + (compare(*--last, pivot) ? 1 : 0);
+					}
+
+					const auto count = std::min(left_count, right_count);
+
+					pdq_sort_swap_offsets(left_base, right_base, left_offsets + left_start, right_offsets + right_start, count, left_count == right_count);
+
+					left_count = left_count - count;
+					right_count = right_count - count;
+					left_start = left_start + count;
+					right_start = right_start + count;
+
+					if (left_count == 0) {
+						left_start = 0;
+						left_base = first;
+					}
+
+					if (right_count == 0) {
+						right_start = 0;
+						right_base = last;
+					}
+				}
+
+				//one side has misplaced elements left, move them to the boundary
+				if (left_count != 0) {
+					const auto offsets = left_offsets + left_start;
+
+					while (left_count-- != 0) std::iter_swap(left_base + offsets[left_count], --last);
+
+					first = last;
+				}
+
+				if (right_count != 0) {
+					const auto offsets = right_offsets + right_start;
+
+					while (right_count-- != 0) {
+						std::iter_swap(right_base - offsets[right_count], first);
+
+						++first;
+					}
+
+					last = first;
+				}
+			}
+
+			const auto pivot_position = first - 1;
+
+			*begin = std::move(*pivot_position);
+			*pivot_position = std::move(pivot);
+
+			return { pivot_position, already_partitioned };
+		}
+
+		//partition [begin, end) by the pivot *begin, the elements equal to pivot are put to the left
+		template<typename T, typename Compare>
+		T* pdq_sort_partition_left(T* begin, T* end, Compare& compare) {
+			auto pivot = std::move(*begin);
+
+			auto first = begin;
+			auto last = end;
+
+			while (compare(pivot, *--last));
+
+			if (last + 1 == end) {
+				while (first < last && !compare(pivot, *++first));
+			}
+			else {
+				while (!compare(pivot, *++first));
+			}
+
+			while (first < last) {
+				std::iter_swap(first, last);
+
+				while (compare(pivot, *--last));
+				while (!compare(pivot, *++first));
+			}
+
+			const auto pivot_position = last;
+
+			*begin = std::move(*pivot_position);
+			*pivot_position = std::move(pivot);
+
+			return pivot_position;
+		}
+
+		template<bool Branchless, typename T, typename Compare>
+		void pdq_sort_loop(T* begin, T* end, Compare& compare, size_t bad_allowed, bool leftmost) {
+			//the right partition is the loop, so the recursion depth is O(log n)
+			for (;;) {
+				const auto size = static_cast<size_t>(end - begin);
+
+				if (size < pdq_sort_insertion_threshold) {
+					if (leftmost) pdq_sort_insertion(begin, end, compare);
+					else pdq_sort_unguarded_insertion(begin, end, compare);
+
+					return;
+				}
+
+				const auto half = size / 2;
+
+				if (size > pdq_sort_ninther_threshold) {
+					pdq_sort3(begin, begin + half, end - 1, compare);
+					pdq_sort3(begin + 1, begin + (half - 1), end - 2, compare);
+					pdq_sort3(begin + 2, begin + (half + 1), end - 3, compare);
+					pdq_sort3(begin + (half - 1), begin + half, begin + (half + 1), compare);
+
+					std::iter_swap(begin, begin + half);
+				}
+				else pdq_sort3(begin + half, begin, end - 1, compare);
+
+				//the element before begin is the pivot of parent, no element is less than it,
+				//so if the pivot equals it, the elements equal to pivot are put to the left and they are sorted
+				if (!leftmost && !compare(*(begin - 1), *begin)) {
+					begin = pdq_sort_partition_left(begin, end, compare) + 1;
+
+					continue;
+				}
+
+				const auto result = Branchless ? pdq_sort_partition_right_branchless(begin, end, compare) : pdq_sort_partition_right(begin, end, compare);
+
+				const auto pivot_position = result.first;
+				const auto left_size = static_cast<size_t>(pivot_position - begin);
+				const auto right_size = static_cast<size_t>(end - (pivot_position + 1));
+
+				if (left_size < size / 8 || right_size < size / 8) {
+					//too many unbalanced partitions, heap sort guarantees O(n log n)
+					if (--bad_allowed == 0) {
+						std::make_heap(begin, end, compare);
+						std::sort_heap(begin, end, compare);
+
+						return;
+					}
+
+					//shuffle some elements to break the pattern
+					if (left_size >= pdq_sort_insertion_threshold) {
+						std::iter_swap(begin, begin + left_size / 4);
+						std::iter_swap(pivot_position - 1, pivot_position - left_size / 4);
+
+						if (left_size > pdq_sort_ninther_threshold) {
+							std::iter_swap(begin + 1, begin + (left_size / 4 + 1));
+							std::iter_swap(begin + 2, begin + (left_size / 4 + 2));
+							std::iter_swap(pivot_position - 2, pivot_position - (left_size / 4 + 1));
+							std::iter_swap(pivot_position - 3, pivot_position - (left_size / 4 + 2));
+						}
+					}
+
+					if (right_size >= pdq_sort_insertion_threshold) {
+						std::iter_swap(pivot_position + 1, pivot_position + (1 + right_size / 4));
+						std::iter_swap(end - 1, end - right_size / 4);
+
+						if (right_size > pdq_sort_ninther_threshold) {
+							std::iter_swap(pivot_position + 2, pivot_position + (2 + right_size / 4));
+							std::iter_swap(pivot_position + 3, pivot_position + (3 + right_size / 4));
+							std::iter_swap(end - 2, end - (1 + right_size / 4));
+							std::iter_swap(end - 3, end - (2 + right_size / 4));
+						}
+					}
+				}
+				else if (result.second && pdq_sort_partial_insertion(begin, pivot_position, compare) &&
+					pdq_sort_partial_insertion(pivot_position + 1, end, compare)) {
+					//the balanced partition of an already partitioned array, the insertion sort finishes it
+					return;
+				}
+
+				pdq_sort_loop<Branchless>(begin, pivot_position, compare, bad_allowed, leftmost);
+
+				begin = pivot_position + 1;
+				leftmost = false;
+			}
+		}
+
+		template<typename T, typename Compare>
+		void pdq_sort_sequential(T* begin, T* end, Compare& compare) {
+			if (end - begin < 2) return;
+
+			//log2(size) unbalanced partitions are allowed
+			size_t bad_allowed = 0;
+
+			for (auto size = static_cast<size_t>(end - begin); size > 1; size >>= 1) bad_allowed++;
+
+			pdq_sort_loop<pdq_sort_branchless<T, Compare>::value>(begin, end, compare, bad_allowed, true);
+		}
+
+		//the parallel sort is sample_sort, it is defined in sample_sort.hpp (included at the end) which uses pdq_sort_sequential
+		template<typename T, typename Compare>
+		void sample_sort_run(T* begin, T* end, Compare& compare, thread_pool* pool);
+	}
+
+	/**
+	 * \brief sort the elements by pattern-defeating quicksort, it is not stable
+	 * \param begin the first element
+	 * \param end the end of elements
+	 * \param compare the strict weak order
+	 * \param options the options
+	 */
+	template<typename T, typename Compare = std::less<T>>
+	void pdq_sort(T* begin, T* end, Compare compare = Compare(), const pdq_sort_options& options = pdq_sort_options()) {
+		const auto size = static_cast<size_t>(end - begin);
+
+		if (options.pool != nullptr && options.pool->thread_count() > 1 && size >= detail::pdq_sort_min_work)
+			detail::sample_sort_run(begin, end, compare, options.pool);
+		else
+			detail::pdq_sort_sequential(begin, end, compare);
+	}
+}
+
+#include "sample_sort.hpp"
@@ -10,13 +10,66 @@
  * The time complexity is O(n * 4) and memory complexity is O(n + 2 ^ 8).
  * 
  * radix_sort_function(): a function to get the key by element. See more in "default_radix_sort_function".
+ *
+ * Every pass is a counting sort : count the elements of every bucket, prefix sum the counters and scatter.
+ * The count and scatter steps are detail::radix_sort_count and detail::radix_sort_scatter,
+ * they work on a chunk of elements, so the other sorts (e.g. the counting sort by cell of uniform_grid2)
+ * can count and scatter the chunks in parallel.
+ *
+ * radix_sort_options::pool : the thread pool of parallel sort, nullptr means the sequential sort.
+ * The parallel sort cuts the elements into chunks, every pass counts the chunks in parallel,
+ * prefix sums the counters by (bucket, chunk), so the chunks scatter in parallel and the sort is still stable.
+ *
+ * The small arrays of 32-bit and 64-bit keys (at most small_sort_max_size) are sorted by the sorting networks of small_sort,
+ * the passes cost more than the sort when there are only some keys.
  */
 
 #include <type_traits>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
 #include <memory>
+#include <vector>
+
+#include "../dependent/thread_pool.hpp"
+#include "small_sort.hpp"
+#include "scan.hpp"
 
 namespace alg_dat {
 
+	struct radix_sort_options {
+		thread_pool* pool = nullptr;
+	};
+
+	namespace detail {
+
+		//the minimum number of elements per chunk of parallel sort
+		constexpr size_t radix_sort_min_work = static_cast<size_t>(1) << 15;
+
+		/**
+		 * \brief count the elements of every bucket
+		 * \param buckets the bucket of every element
+		 * \param size the number of elements
+		 * \param counter the counter of buckets, it is not cleared
+		 */
+		template<typename Bucket, typename Counter>
+		void radix_sort_count(const Bucket* buckets, size_t size, Counter* counter) {
+			for (size_t element = 0; element < size; element++) ++counter[buckets[element]];
+		}
+
+		/**
+		 * \brief scatter the elements to their buckets, the order of elements in same bucket is kept
+		 * \param buckets the bucket of every element
+		 * \param size the number of elements
+		 * \param offsets the position of next element of every bucket, it is advanced
+		 * \param move move(element, position), move the element to the position
+		 */
+		template<typename Bucket, typename Counter, typename Move>
+		void radix_sort_scatter(const Bucket* buckets, size_t size, Counter* offsets, Move&& move) {
+			for (size_t element = 0; element < size; element++) move(element, static_cast<size_t>(offsets[buckets[element]]++));
+		}
+	}
+
 	template<typename T>
 	using allow_unsigned_type = std::enable_if_t<std::is_integral<T>::value && std::is_unsigned<T>::value>;
 
@@ -60,17 +113,17 @@ namespace alg_dat {
 
 			for (size_t element = 0; element < size; element++) {
 				auto key = function(in[element]);
-				auto index = static_cast<KeyType>((key & mask) >> low_bit);
 
-				indices[element] = index;
-				++element_counter[index];
+				indices[element] = static_cast<KeyType>((key & mask) >> low_bit);
 			}
 
-			for (size_t index = 1; index < counter_size; index++)
-				element_sum[index] = element_sum[index - 1] + element_counter[index - 1];
+			detail::radix_sort_count(indices, size, element_counter);
+
+			exclusive_scan(element_counter, element_sum, counter_size, static_cast<size_t>(0));
 
-			for (size_t element = 0; element < size; element++) 
-				out[element_sum[indices[element]]++] = in[element];
+			detail::radix_sort_scatter(indices, size, element_sum, [&](size_t element, size_t position) {
+				out[position] = in[element];
+			});
 
 			std::swap(in, out);
 
@@ -78,7 +131,91 @@ namespace alg_dat {
 			mask = mask << group_length;
 		}
 
-		if (out == pool) std::memcpy(begin, pool, sizeof(T) * size);
+		//the result of last pass is in "in", copy it back if it is the pool
+		if (in == pool) std::memcpy(begin, pool, sizeof(T) * size);
+
+		std::free(indices);
+		std::free(pool);
+	}
+
+	/**
+	 * \brief radix sort in the thread pool of options
+	 * \param begin the first element
+	 * \param end the end of elements
+	 * \param function the function to get the key by element
+	 * \param options the options, the sort is sequential if there is no pool
+	 */
+	template<typename KeyType, typename T, typename = allow_unsigned_type<KeyType>>
+	void radix_sort(T* begin, T* end, radix_sort_function<KeyType, T> function, const radix_sort_options& options) {
+		constexpr auto bits_length = sizeof(KeyType) << 3;
+		constexpr auto group_length = static_cast<size_t>(1) << 3;
+		constexpr auto group_pass = bits_length / group_length;
+		constexpr auto counter_size = static_cast<size_t>(1 << group_length);
+
+		const auto size = static_cast<size_t>(end - begin);
+
+		if (options.pool == nullptr || options.pool->thread_count() == 1 || size < detail::radix_sort_min_work * 2) {
+			radix_sort<KeyType, T>(begin, end, function);
+
+			return;
+		}
+
+		//4 chunks per thread, so the threads are balanced when some threads are slow
+		const auto chunk_count = std::min(options.pool->thread_count() * 4, size / detail::radix_sort_min_work);
+
+		auto indices = static_cast<KeyType*>(std::malloc(sizeof(KeyType) * size));
+		auto pool = static_cast<T*>(std::malloc(sizeof(T) * size));
+
+		std::vector<size_t> counters(chunk_count * counter_size);
+
+		auto in = begin;
+		auto out = pool;
+
+		for (size_t i = 0; i < group_pass; i++) {
+			const auto low_bit = i * group_length;
+
+			std::fill(counters.begin(), counters.end(), static_cast<size_t>(0));
+
+			options.pool->parallel_for(0, chunk_count, [&](size_t first_chunk, size_t last_chunk) {
+				for (auto chunk = first_chunk; chunk < last_chunk; chunk++) {
+					const auto first = size * chunk / chunk_count;
+					const auto last = size * (chunk + 1) / chunk_count;
+
+					for (auto element = first; element < last; element++)
+						indices[element] = static_cast<KeyType>((function(in[element]) >> low_bit) & (counter_size - 1));
+
+					detail::radix_sort_count(indices + first, last - first, counters.data() + chunk * counter_size);
+				}
+			}, 1);
+
+			//the offset of (chunk, bucket) is after all elements of smaller buckets and the elements of bucket in previous chunks
+			size_t sum = 0;
+
+			for (size_t bucket = 0; bucket < counter_size; bucket++) {
+				for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+					const auto count = counters[chunk * counter_size + bucket];
+
+					counters[chunk * counter_size + bucket] = sum;
+
+					sum = sum + count;
+				}
+			}
+
+			options.pool->parallel_for(0, chunk_count, [&](size_t first_chunk, size_t last_chunk) {
+				for (auto chunk = first_chunk; chunk < last_chunk; chunk++) {
+					const auto first = size * chunk / chunk_count;
+					const auto last = size * (chunk + 1) / chunk_count;
+
+					detail::radix_sort_scatter(indices + first, last - first, counters.data() + chunk * counter_size, [&](size_t element, size_t position) {
+						out[position] = in[first + element];
+					});
+				}
+			}, 1);
+
+			std::swap(in, out);
+		}
+
+		if (in == pool) std::memcpy(begin, pool, sizeof(T) * size);
 
 		std::free(indices);
 		std::free(pool);
@@ -86,6 +223,14 @@ namespace alg_dat {
 
 	template<typename T, typename = allow_unsigned_type<T>>
 	void radix_sort(T* begin, T* end) {
+		const auto size = static_cast<size_t>(end - begin);
+
+		if (detail::small_sort_vectorized<T>::value && size <= small_sort_max_size) {
+			small_sort(begin, size);
+
+			return;
+		}
+
 		radix_sort<T, T>(begin, end, default_radix_sort_function<T, T>);
 	}
 }
@@ -0,0 +1,306 @@
+#pragma once
+
+/*
+ * sample_sort.hpp
+ * Super scalar sample sort (P. Sanders, S. Winkel 2004), the parallel comparison sort for the huge arrays.
+ * A step distributes the elements to at most 256 buckets, and the buckets are sorted recursively (in parallel),
+ * the small buckets are sorted by pdq_sort.
+ *
+ * 1. the splitters are chosen from the sorted random sample, they are stored in an implicit binary search tree.
+ * 2. the element finds its bucket by descending the tree without branch : index = 2 * index + compare(tree[index], element).
+ *    The descents of 8 elements are interleaved, so the comparisons are independent and the CPU runs them together.
+ * 3. if the sample has equal splitters, the elements equal to a splitter are put to its equality bucket (IPS4o),
+ *    the equality buckets are not sorted, so the arrays with many equal elements are fine.
+ * 4. the chunks count their buckets by detail::radix_sort_count, the counters are prefix summed by (bucket, chunk)
+ *    and the elements are moved to a scratch buffer by detail::radix_sort_scatter as radix_sort, then moved back.
+ *
+ * sample_sort_options::pool : the thread pool of parallel sort, nullptr means the sequential sort.
+ * The large steps classify and scatter the chunks in parallel, the buckets are sorted by the parallel_for of pool,
+ * so a large bucket is sorted in parallel again.
+ */
+
+#include <type_traits>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <memory>
+#include <vector>
+#include <new>
+
+#include "../dependent/thread_pool.hpp"
+#include "radix_sort.hpp"
+#include "pdq_sort.hpp"
+
+namespace alg_dat {
+
+	struct sample_sort_options {
+		thread_pool* pool = nullptr;
+	};
+
+	namespace detail {
+
+		//the arrays smaller than it are sorted by pdq_sort
+		constexpr size_t sample_sort_base = static_cast<size_t>(1) << 12;
+
+		constexpr size_t sample_sort_max_log_buckets = 8;
+		constexpr size_t sample_sort_oversampling = 16;
+		constexpr size_t sample_sort_unroll = 8;
+
+		//the maximum levels of recursion, the buckets of a bad sample are sorted by pdq_sort
+		constexpr size_t sample_sort_max_depth = 8;
+
+		//the minimum number of elements per chunk of parallel step
+		constexpr size_t sample_sort_min_work = static_cast<size_t>(1) << 15;
+
+		template<typename T, typename Compare>
+		class sample_sort_classifier {
+		public:
+			using size_type = size_t;
+		private:
+			//the implicit binary search tree of splitters, the children of node i are 2i and 2i + 1
+			std::vector<T> mTree;
+			std::vector<T> mSplitters;
+
+			Compare& mCompare;
+
+			size_type mLogBuckets;
+			bool mEqualBuckets;
+
+			void build(size_type node, size_type first, size_type last) {
+				if (first >= last) return;
+
+				const auto middle = first + (last - first) / 2;
+
+				mTree[node] = mSplitters[middle];
+
+				build(node * 2, first, middle);
+				build(node * 2 + 1, middle + 1, last);
+			}
+
+			//the leaf is the number of splitters less than element, the element is not greater than the splitter of leaf
+			uint16_t finish(size_type leaf, const T& element) const {
+				if (!mEqualBuckets) return static_cast<uint16_t>(leaf);
+
+				const auto equal = leaf < mSplitters.size() && !mCompare(element, mSplitters[leaf]);
+
+				return static_cast<uint16_t>(leaf * 2 + (equal ? 1 : 0));
+			}
+		public:
+			sample_sort_classifier(const T* data, size_type size, Compare& compare) : mCompare(compare) {
+				mLogBuckets = 1;
+
+				while (mLogBuckets < sample_sort_max_log_buckets && (size >> mLogBuckets) > sample_sort_base) mLogBuckets++;
+
+				const auto buckets = static_cast<size_type>(1) << mLogBuckets;
+
+				//the regular sample of a random permutation, the positions are from a fixed generator so the sort is deterministic
+				const auto sample_size = std::min(buckets * sample_sort_oversampling, size / 2);
+
+				std::vector<T> sample;
+
+				sample.reserve(sample_size);
+
+				uint64_t random = 0x9E3779B97F4A7C15ull ^ size;
+
+				for (size_type index = 0; index < sample_size; index++) {
+					random = random * 6364136223846793005ull + 1442695040888963407ull;
+
+					sample.push_back(data[(random >> 33) % size]);
+				}
+
+				pdq_sort_sequential(sample.data(), sample.data() + sample.size(), mCompare);
+
+				mSplitters.reserve(buckets - 1);
+
+				for (size_type bucket = 1; bucket < buckets; bucket++) mSplitters.push_back(sample[bucket * sample_size / buckets]);
+
+				mEqualBuckets = false;
+
+				for (size_type index = 1; index < mSplitters.size(); index++) if (!mCompare(mSplitters[index - 1], mSplitters[index])) mEqualBuckets = true;
+
+				mTree.assign(buckets, mSplitters.front());
+
+				build(1, 0, mSplitters.size());
+			}
+
+			auto bucket_count() const noexcept -> size_type { return mEqualBuckets ? (static_cast<size_type>(2) << mLogBuckets) - 1 : static_cast<size_type>(1) << mLogBuckets; }
+
+			//the odd buckets are the equality buckets
+			bool equality_bucket(size_type bucket) const noexcept { return mEqualBuckets && (bucket & 1) != 0; }
+
+			/**
+			 * \brief find the buckets of elements
+			 * \param input the elements
+			 * \param size the number of elements
+			 * \param output the buckets
+			 */
+			void classify(const T* input, size_type size, uint16_t* output) const {
+				const auto buckets = static_cast<size_type>(1) << mLogBuckets;
+
+				size_type element = 0;
+
+				for (; element + sample_sort_unroll <= size; element += sample_sort_unroll) {
+					size_type index[sample_sort_unroll];
+
+					for (size_type lane = 0; lane < sample_sort_unroll; lane++) index[lane] = 1;
+
+					for (size_type level = 0; level < mLogBuckets; level++) {
+						for (size_type lane = 0; lane < sample_sort_unroll; lane++)
+							index[lane] = index[lane] * 2 + (mCompare(mTree[index[lane]], input[element + lane]) ? 1 : 0);
+					}
+
+					for (size_type lane = 0; lane < sample_sort_unroll; lane++) output[element + lane] = finish(index[lane] - buckets, input[element + lane]);
+				}
+
+				for (; element < size; element++) {
+					size_type index = 1;
+
+					for (size_type level = 0; level < mLogBuckets; level++) index = index * 2 + (mCompare(mTree[index], input[element]) ? 1 : 0);
+
+					output[element] = finish(index - buckets, input[element]);
+				}
+			}
+		};
+
+		/**
+		 * \brief sort the elements
+		 * \param data the elements
+		 * \param size the number of elements
+		 * \param scratch the raw memory of size elements
+		 * \param buckets the memory of size buckets
+		 * \param compare the strict weak order
+		 * \param pool the thread pool, nullptr means sequential
+		 * \param depth the remaining levels of recursion
+		 */
+		template<typename T, typename Compare>
+		void sample_sort_step(T* data, size_t size, T* scratch, uint16_t* buckets, Compare& compare, thread_pool* pool, size_t depth) {
+			if (size < sample_sort_base || depth == 0) {
+				pdq_sort_sequential(data, data + size, compare);
+
+				return;
+			}
+
+			const sample_sort_classifier<T, Compare> classifier(data, size, compare);
+
+			const auto bucket_count = classifier.bucket_count();
+
+			const auto parallel = pool != nullptr && pool->thread_count() > 1 && size >= sample_sort_min_work * 2;
+			const auto chunk_count = parallel ? std::min(pool->thread_count() * 4, size / sample_sort_min_work) : 1;
+
+			std::vector<size_t> counters(chunk_count * bucket_count, 0);
+
+			const auto for_chunks = [&](const auto& function) {
+				const auto chunk = [&](size_t first_chunk, size_t last_chunk) {
+					for (auto index = first_chunk; index < last_chunk; index++) {
+						const auto first = size * index / chunk_count;
+
+						function(index, first, size * (index + 1) / chunk_count - first);
+					}
+				};
+
+				if (parallel) pool->parallel_for(0, chunk_count, chunk, 1);
+				else chunk(0, chunk_count);
+			};
+
+			for_chunks([&](size_t chunk, size_t first, size_t count) {
+				classifier.classify(data + first, count, buckets + first);
+
+				radix_sort_count(buckets + first, count, counters.data() + chunk * bucket_count);
+			});
+
+			std::vector<size_t> bucket_first(bucket_count + 1, 0);
+
+			size_t sum = 0;
+
+			for (size_t bucket = 0; bucket < bucket_count; bucket++) {
+				bucket_first[bucket] = sum;
+
+				for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+					const auto count = counters[chunk * bucket_count + bucket];
+
+					counters[chunk * bucket_count + bucket] = sum;
+
+					sum = sum + count;
+				}
+			}
+
+			bucket_first[bucket_count] = size;
+
+			for_chunks([&](size_t chunk, size_t first, size_t count) {
+				radix_sort_scatter(buckets + first, count, counters.data() + chunk * bucket_count, [&](size_t element, size_t position) {
+					::new (static_cast<void*>(scratch + position)) T(std::move(data[first + element]));
+				});
+			});
+
+			for_chunks([&](size_t, size_t first, size_t count) {
+				for (auto element = first; element < first + count; element++) {
+					data[element] = std::move(scratch[element]);
+					scratch[element].~T();
+				}
+			});
+
+			//the bucket i is sorted with the scratch and buckets memory of its elements
+			const auto sort_buckets = [&](size_t first_bucket, size_t last_bucket) {
+				for (auto bucket = first_bucket; bucket < last_bucket; bucket++) {
+					if (classifier.equality_bucket(bucket)) continue;
+
+					const auto first = bucket_first[bucket];
+
+					sample_sort_step(data + first, bucket_first[bucket + 1] - first, scratch + first, buckets + first, compare, pool, depth - 1);
+				}
+			};
+
+			if (pool != nullptr && pool->thread_count() > 1) pool->parallel_for(0, bucket_count, sort_buckets, 1);
+			else sort_buckets(0, bucket_count);
+		}
+
+		/**
+		 * \brief sort the elements by sample sort, it is also the parallel mode of pdq_sort
+		 * \param begin the first element
+		 * \param end the end of elements
+		 * \param compare the strict weak order
+		 * \param pool the thread pool, nullptr means sequential
+		 */
+		template<typename T, typename Compare>
+		void sample_sort_run(T* begin, T* end, Compare& compare, thread_pool* pool) {
+			const auto size = static_cast<size_t>(end - begin);
+
+			if (size < sample_sort_base) {
+				pdq_sort_sequential(begin, end, compare);
+
+				return;
+			}
+
+			//the sorted and reversed arrays are found by the first inversion, it is cheap for the others
+			if (std::is_sorted(begin, end, compare)) return;
+
+			if (std::adjacent_find(begin, end, [&](const T& a, const T& b) { return compare(a, b); }) == end) {
+				std::reverse(begin, end);
+
+				return;
+			}
+
+			std::allocator<T> allocator;
+			std::vector<uint16_t> buckets(size);
+
+			const auto scratch = allocator.allocate(size);
+
+			sample_sort_step(begin, size, scratch, buckets.data(), compare, pool, sample_sort_max_depth);
+
+			allocator.deallocate(scratch, size);
+		}
+	}
+
+	/**
+	 * \brief sort the elements by super scalar sample sort, it is not stable
+	 * \param begin the first element
+	 * \param end the end of elements
+	 * \param compare the strict weak order
+	 * \param options the options
+	 */
+	template<typename T, typename Compare = std::less<T>>
+	void sample_sort(T* begin, T* end, Compare compare = Compare(), const sample_sort_options& options = sample_sort_options()) {
+		detail::sample_sort_run(begin, end, compare, options.pool);
+	}
+}
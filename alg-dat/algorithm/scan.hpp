@@ -0,0 +1,648 @@
+#pragma once
+
+/*
+ * scan.hpp
+ * Prefix sum (scan) of array with any associative operation.
+ *
+ * inclusive_scan : output[i] = input[0] + ... + input[i].
+ * exclusive_scan : output[i] = initial + input[0] + ... + input[i - 1].
+ * segmented_inclusive_scan, segmented_exclusive_scan : heads[i] != 0 starts a new segment at i, every segment is scanned independently,
+ * the exclusive scan starts every segment with initial.
+ * The output can be the input, the scan is in place.
+ *
+ * The sequential scan of std::plus (int32, uint32, int64, uint64, float, double) uses AVX2 :
+ * the 8 (or 4) elements are scanned in register by shifts and additions, and the last element is the carry of next vector.
+ * The floating point sums are added in another order, so the results may be different from the scalar scan in the last bits.
+ *
+ * scan_options::pool : the thread pool of parallel scan, nullptr means the sequential scan.
+ * The parallel scan is the single pass scan with decoupled look-back (Merrill and Garland 2016) :
+ * the workers take the tiles in order, a tile publishes its aggregate, then looks back the previous tiles
+ * to sum their aggregates until a tile with inclusive prefix, publishes its inclusive prefix and scans with its exclusive prefix.
+ * The tile is read twice but the second read is in cache, so the scan reads and writes the array once (memory bandwidth bound).
+ * The segmented scan uses the same look-back with the (head, value) pairs.
+ */
+
+#include <type_traits>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <atomic>
+#include <thread>
+
+#include "../dependent/thread_pool.hpp"
+#include "../dependent/simd.hpp"
+
+namespace alg_dat {
+
+	struct scan_options {
+		thread_pool* pool = nullptr;
+	};
+
+	namespace detail {
+
+		//the minimum number of elements of parallel scan and the elements of a tile
+		constexpr size_t scan_min_work = static_cast<size_t>(1) << 16;
+		constexpr size_t scan_tile_size = static_cast<size_t>(1) << 14;
+
+#if defined(ALG_DAT_AVX2)
+		template<typename T, typename = void>
+		struct scan_avx2 {
+			static constexpr bool enable = false;
+		};
+
+		//the in-register scan of 8 32-bit integers, the unsigned integers are added as the signed integers
+		template<typename T>
+		struct scan_avx2<T, std::enable_if_t<std::is_integral<T>::value && sizeof(T) == 4>> {
+			using vector = __m256i;
+
+			static constexpr bool enable = true;
+			static constexpr size_t width = 8;
+
+			static vector load(const T* input) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input)); }
+
+			static void store(T* output, vector value) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), value); }
+
+			static vector set1(T value) { return _mm256_set1_epi32(static_cast<int32_t>(value)); }
+
+			static vector add(vector a, vector b) { return _mm256_add_epi32(a, b); }
+
+			static vector scan(vector x) {
+				x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+				x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+
+				//add the last element of low lane to the high lane
+				const auto low = _mm256_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+
+				return _mm256_add_epi32(x, _mm256_permute2x128_si256(low, low, 0x08));
+			}
+
+			static vector last(vector x) { return _mm256_permutevar8x32_epi32(x, _mm256_set1_epi32(7)); }
+
+			//[carry, x0, ..., x6]
+			static vector shift(vector x, vector carry) {
+				return _mm256_blend_epi32(_mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6)), carry, 0x01);
+			}
+		};
+
+		template<typename T>
+		struct scan_avx2<T, std::enable_if_t<std::is_integral<T>::value && sizeof(T) == 8>> {
+			using vector = __m256i;
+
+			static constexpr bool enable = true;
+			static constexpr size_t width = 4;
+
+			static vector load(const T* input) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input)); }
+
+			static void store(T* output, vector value) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), value); }
+
+			static vector set1(T value) { return _mm256_set1_epi64x(static_cast<int64_t>(value)); }
+
+			static vector add(vector a, vector b) { return _mm256_add_epi64(a, b); }
+
+			static vector scan(vector x) {
+				x = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));
+
+				const auto low = _mm256_shuffle_epi32(x, _MM_SHUFFLE(3, 2, 3, 2));
+
+				return _mm256_add_epi64(x, _mm256_permute2x128_si256(low, low, 0x08));
+			}
+
+			static vector last(vector x) { return _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3)); }
+
+			static vector shift(vector x, vector carry) {
+				return _mm256_blend_epi32(_mm256_permute4x64_epi64(x, _MM_SHUFFLE(2, 1, 0, 3)), carry, 0x03);
+			}
+		};
+
+		template<>
+		struct scan_avx2<float> {
+			using vector = __m256;
+
+			static constexpr bool enable = true;
+			static constexpr size_t width = 8;
+
+			static vector load(const float* input) { return _mm256_loadu_ps(input); }
+
+			static void store(float* output, vector value) { _mm256_storeu_ps(output, value); }
+
+			static vector set1(float value) { return _mm256_set1_ps(value); }
+
+			static vector add(vector a, vector b) { return _mm256_add_ps(a, b); }
+
+			static vector scan(vector x) {
+				x = _mm256_add_ps(x, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(x), 4)));
+				x = _mm256_add_ps(x, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(x), 8)));
+
+				const auto low = _mm256_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+
+				return _mm256_add_ps(x, _mm256_permute2f128_ps(low, low, 0x08));
+			}
+
+			static vector last(vector x) { return _mm256_permutevar8x32_ps(x, _mm256_set1_epi32(7)); }
+
+			static vector shift(vector x, vector carry) {
+				return _mm256_blend_ps(_mm256_permutevar8x32_ps(x, _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6)), carry, 0x01);
+			}
+		};
+
+		template<>
+		struct scan_avx2<double> {
+			using vector = __m256d;
+
+			static constexpr bool enable = true;
+			static constexpr size_t width = 4;
+
+			static vector load(const double* input) { return _mm256_loadu_pd(input); }
+
+			static void store(double* output, vector value) { _mm256_storeu_pd(output, value); }
+
+			static vector set1(double value) { return _mm256_set1_pd(value); }
+
+			static vector add(vector a, vector b) { return _mm256_add_pd(a, b); }
+
+			static vector scan(vector x) {
+				x = _mm256_add_pd(x, _mm256_castsi256_pd(_mm256_slli_si256(_mm256_castpd_si256(x), 8)));
+
+				const auto low = _mm256_permute_pd(x, 0x0F);
+
+				return _mm256_add_pd(x, _mm256_permute2f128_pd(low, low, 0x08));
+			}
+
+			static vector last(vector x) { return _mm256_permute4x64_pd(x, _MM_SHUFFLE(3, 3, 3, 3)); }
+
+			static vector shift(vector x, vector carry) {
+				return _mm256_blend_pd(_mm256_permute4x64_pd(x, _MM_SHUFFLE(2, 1, 0, 3)), carry, 0x01);
+			}
+		};
+
+		//whether the scan of T by Operation is vectorized, the operation must be the addition
+		template<typename T, typename Operation>
+		struct scan_vectorized : std::integral_constant<bool, scan_avx2<T>::enable &&
+			(std::is_same<Operation, std::plus<T>>::value || std::is_same<Operation, std::plus<>>::value)> {};
+#else
+		template<typename T, typename Operation>
+		struct scan_vectorized : std::false_type {};
+#endif
+
+		/**
+		 * \brief inclusive scan of block
+		 * \param input the input
+		 * \param output the output
+		 * \param size the number of elements, at least one
+		 * \param carry the prefix of block, nullptr if there is no prefix
+		 * \param operation the operation
+		 * \return the inclusive prefix of last element
+		 */
+		template<typename T, typename Operation>
+		T scan_inclusive_block(const T* input, T* output, size_t size, const T* carry, Operation& operation, std::false_type) {
+			size_t index = 0;
+
+			auto sum = carry != nullptr ? *carry : input[index++];
+
+			if (carry == nullptr) output[0] = sum;
+
+			for (; index < size; index++) {
+				sum = operation(sum, input[index]);
+
+				output[index] = sum;
+			}
+
+			return sum;
+		}
+
+		template<typename T, typename Operation>
+		T scan_exclusive_block(const T* input, T* output, size_t size, T carry, Operation& operation, std::false_type) {
+			for (size_t index = 0; index < size; index++) {
+				const auto value = input[index];
+
+				output[index] = carry;
+
+				carry = operation(carry, value);
+			}
+
+			return carry;
+		}
+
+		//the sum of block, at least one element
+		template<typename T, typename Operation>
+		T scan_reduce_block(const T* input, size_t size, Operation& operation, std::false_type) {
+			auto sum = input[0];
+
+			for (size_t index = 1; index < size; index++) sum = operation(sum, input[index]);
+
+			return sum;
+		}
+
+#if defined(ALG_DAT_AVX2)
+		template<typename T, typename Vector>
+		T scan_first(Vector value) {
+			T values[scan_avx2<T>::width];
+
+			scan_avx2<T>::store(values, value);
+
+			return values[0];
+		}
+
+		template<typename T, typename Operation>
+		T scan_inclusive_block(const T* input, T* output, size_t size, const T* carry, Operation&, std::true_type) {
+			using kernel = scan_avx2<T>;
+
+			auto sum = kernel::set1(carry != nullptr ? *carry : T(0));
+
+			size_t index = 0;
+
+			for (; index + kernel::width <= size; index += kernel::width) {
+				const auto value = kernel::add(kernel::scan(kernel::load(input + index)), sum);
+
+				kernel::store(output + index, value);
+
+				sum = kernel::last(value);
+			}
+
+			auto result = scan_first<T>(sum);
+
+			//the tail is less than a vector, it is counted from the end of vectors so the compiler can bound the loop
+			const auto tail_input = input + index;
+			const auto tail_output = output + index;
+
+			for (size_t offset = 0; offset < size - index; offset++) tail_output[offset] = result = result + tail_input[offset];
+
+			return result;
+		}
+
+		template<typename T, typename Operation>
+		T scan_exclusive_block(const T* input, T* output, size_t size, T carry, Operation&, std::true_type) {
+			using kernel = scan_avx2<T>;
+
+			auto sum = kernel::set1(carry);
+
+			size_t index = 0;
+
+			for (; index + kernel::width <= size; index += kernel::width) {
+				const auto value = kernel::add(kernel::scan(kernel::load(input + index)), sum);
+
+				kernel::store(output + index, kernel::shift(value, sum));
+
+				sum = kernel::last(value);
+			}
+
+			auto result = scan_first<T>(sum);
+
+			const auto tail_input = input + index;
+			const auto tail_output = output + index;
+
+			for (size_t offset = 0; offset < size - index; offset++) {
+				const auto value = tail_input[offset];
+
+				tail_output[offset] = result;
+
+				result = result + value;
+			}
+
+			return result;
+		}
+
+		template<typename T, typename Operation>
+		T scan_reduce_block(const T* input, size_t size, Operation&, std::true_type) {
+			using kernel = scan_avx2<T>;
+
+			auto sum = kernel::set1(T(0));
+
+			size_t index = 0;
+
+			for (; index + kernel::width <= size; index += kernel::width) sum = kernel::add(sum, kernel::load(input + index));
+
+			T values[kernel::width];
+
+			kernel::store(values, sum);
+
+			T result = T(0);
+
+			for (const auto value : values) result = result + value;
+			const auto tail_input = input + index;
+
+			for (size_t offset = 0; offset < size - index; offset++) result = result + tail_input[offset];
+
+			return result;
+		}
+#endif
+
+		//the look-back state of a tile, the values are written before the release store of flag
+		template<typename State>
+		struct scan_tile {
+			static constexpr uint32_t empty = 0;
+			static constexpr uint32_t aggregate_ready = 1;
+			static constexpr uint32_t prefix_ready = 2;
+
+			std::atomic<uint32_t> flag = { empty };
+
+			State aggregate;
+			State prefix;
+		};
+
+		/**
+		 * \brief the single pass scan with decoupled look-back
+		 * \param pool the thread pool
+		 * \param tile_count the number of tiles
+		 * \param initial the prefix of first tile, nullptr if there is no prefix
+		 * \param reduce reduce(tile) -> State, the aggregate of tile
+		 * \param combine combine(State, State) -> State, the operation
+		 * \param scan scan(tile, const State* prefix), scan the tile with its exclusive prefix
+		 */
+		template<typename State, typename Reduce, typename Combine, typename Scan>
+		void scan_look_back(thread_pool& pool, size_t tile_count, const State* initial, Reduce&& reduce, Combine&& combine, Scan&& scan) {
+			using tile_type = scan_tile<State>;
+
+			std::unique_ptr<tile_type[]> tiles(new tile_type[tile_count]);
+			std::atomic<size_t> next = { 0 };
+
+			pool.parallel_for(0, pool.thread_count(), [&](size_t, size_t) {
+				//the tiles are taken in order, so the previous tiles are in progress and the look-back never waits forever
+				for (auto tile = next.fetch_add(1); tile < tile_count; tile = next.fetch_add(1)) {
+					auto& current = tiles[tile];
+
+					const auto aggregate = reduce(tile);
+
+					if (tile == 0) {
+						current.prefix = initial != nullptr ? combine(*initial, aggregate) : aggregate;
+						current.flag.store(tile_type::prefix_ready, std::memory_order_release);
+
+						scan(tile, initial);
+
+						continue;
+					}
+
+					current.aggregate = aggregate;
+					current.flag.store(tile_type::aggregate_ready, std::memory_order_release);
+
+					auto previous = tile - 1;
+					auto flag = tile_type::empty;
+
+					while ((flag = tiles[previous].flag.load(std::memory_order_acquire)) == tile_type::empty) std::this_thread::yield();
+
+					auto exclusive = flag == tile_type::prefix_ready ? tiles[previous].prefix : tiles[previous].aggregate;
+
+					while (flag != tile_type::prefix_ready) {
+						previous--;
+
+						while ((flag = tiles[previous].flag.load(std::memory_order_acquire)) == tile_type::empty) std::this_thread::yield();
+
+						exclusive = combine(flag == tile_type::prefix_ready ? tiles[previous].prefix : tiles[previous].aggregate, exclusive);
+					}
+
+					current.prefix = combine(exclusive, aggregate);
+					current.flag.store(tile_type::prefix_ready, std::memory_order_release);
+
+					scan(tile, &exclusive);
+				}
+			}, 1);
+		}
+
+		//the value of segmented scan, head means there is a segment head in the elements
+		template<typename T>
+		struct scan_segment {
+			T value;
+			bool head;
+		};
+
+		template<typename T, typename Operation>
+		scan_segment<T> scan_segment_combine(const scan_segment<T>& a, const scan_segment<T>& b, Operation& operation) {
+			return { b.head ? b.value : operation(a.value, b.value), a.head || b.head };
+		}
+
+		template<typename T, typename Operation>
+		scan_segment<T> scan_segment_reduce(const T* input, const uint8_t* heads, size_t size, Operation& operation) {
+			scan_segment<T> sum = { input[0], heads[0] != 0 };
+
+			for (size_t index = 1; index < size; index++) {
+				if (heads[index] != 0) sum = { input[index], true };
+				else sum.value = operation(sum.value, input[index]);
+			}
+
+			return sum;
+		}
+
+		//the elements before the first head are added to the carry
+		template<typename T, typename Operation>
+		void scan_segment_inclusive_block(const T* input, const uint8_t* heads, T* output, size_t size, const T* carry, Operation& operation) {
+			auto sum = carry != nullptr && heads[0] == 0 ? operation(*carry, input[0]) : input[0];
+
+			output[0] = sum;
+
+			for (size_t index = 1; index < size; index++) {
+				sum = heads[index] != 0 ? input[index] : operation(sum, input[index]);
+
+				output[index] = sum;
+			}
+		}
+
+		template<typename T, typename Operation>
+		void scan_segment_exclusive_block(const T* input, const uint8_t* heads, T* output, size_t size, T carry, const T& initial, Operation& operation) {
+			for (size_t index = 0; index < size; index++) {
+				const auto value = input[index];
+
+				if (heads[index] != 0) carry = initial;
+
+				output[index] = carry;
+
+				carry = operation(carry, value);
+			}
+		}
+
+		inline bool scan_parallel(const scan_options& options, size_t size) {
+			return options.pool != nullptr && options.pool->thread_count() > 1 && size >= scan_min_work;
+		}
+
+		inline size_t scan_tile_count(size_t size) { return (size + scan_tile_size - 1) / scan_tile_size; }
+	}
+
+	/**
+	 * \brief inclusive scan, output[i] = input[0] + ... + input[i]
+	 * \param input the input
+	 * \param output the output, it can be the input
+	 * \param size the number of elements
+	 * \param operation the associative operation
+	 * \param options the options
+	 */
+	template<typename T, typename Operation = std::plus<T>>
+	void inclusive_scan(const T* input, T* output, size_t size, Operation operation = Operation(), const scan_options& options = scan_options()) {
+		using vectorized = detail::scan_vectorized<T, Operation>;
+
+		if (size == 0) return;
+
+		if (!detail::scan_parallel(options, size)) {
+			detail::scan_inclusive_block(input, output, size, static_cast<const T*>(nullptr), operation, vectorized());
+
+			return;
+		}
+
+		const auto range = [size](size_t tile, size_t& first) {
+			first = tile * detail::scan_tile_size;
+
+			return std::min(size - first, detail::scan_tile_size);
+		};
+
+		detail::scan_look_back<T>(*options.pool, detail::scan_tile_count(size), nullptr,
+			[&](size_t tile) {
+				size_t first = 0;
+
+				const auto count = range(tile, first);
+
+				return detail::scan_reduce_block(input + first, count, operation, vectorized());
+			},
+			[&](const T& a, const T& b) { return operation(a, b); },
+			[&](size_t tile, const T* prefix) {
+				size_t first = 0;
+
+				const auto count = range(tile, first);
+
+				detail::scan_inclusive_block(input + first, output + first, count, prefix, operation, vectorized());
+			});
+	}
+
+	/**
+	 * \brief exclusive scan, output[i] = initial + input[0] + ... + input[i - 1]
+	 * \param input the input
+	 * \param output the output, it can be the input
+	 * \param size the number of elements
+	 * \param initial the initial value
+	 * \param operation the associative operation
+	 * \param options the options
+	 */
+	template<typename T, typename Operation = std::plus<T>>
+	void exclusive_scan(const T* input, T* output, size_t size, T initial, Operation operation = Operation(), const scan_options& options = scan_options()) {
+		using vectorized = detail::scan_vectorized<T, Operation>;
+
+		if (size == 0) return;
+
+		if (!detail::scan_parallel(options, size)) {
+			detail::scan_exclusive_block(input, output, size, initial, operation, vectorized());
+
+			return;
+		}
+
+		const auto range = [size](size_t tile, size_t& first) {
+			first = tile * detail::scan_tile_size;
+
+			return std::min(size - first, detail::scan_tile_size);
+		};
+
+		detail::scan_look_back<T>(*options.pool, detail::scan_tile_count(size), &initial,
+			[&](size_t tile) {
+				size_t first = 0;
+
+				const auto count = range(tile, first);
+
+				return detail::scan_reduce_block(input + first, count, operation, vectorized());
+			},
+			[&](const T& a, const T& b) { return operation(a, b); },
+			[&](size_t tile, const T* prefix) {
+				size_t first = 0;
+
+				const auto count = range(tile, first);
+
+				detail::scan_exclusive_block(input + first, output + first, count, *prefix, operation, vectorized());
+			});
+	}
+
+	/**
+	 * \brief segmented inclusive scan, every segment is scanned independently
+	 * \param input the input
+	 * \param heads heads[i] != 0 means a segment starts at i
+	 * \param output the output, it can be the input
+	 * \param size the number of elements
+	 * \param operation the associative operation
+	 * \param options the options
+	 */
+	template<typename T, typename Operation = std::plus<T>>
+	void segmented_inclusive_scan(const T* input, const uint8_t* heads, T* output, size_t size, Operation operation = Operation(), const scan_options& options = scan_options()) {
+		using segment = detail::scan_segment<T>;
+
+		if (size == 0) return;
+
+		if (!detail::scan_parallel(options, size)) {
+			detail::scan_segment_inclusive_block(input, heads, output, size, static_cast<const T*>(nullptr), operation);
+
+			return;
+		}
+
+		const auto range = [size](size_t tile, size_t& first) {
+			first = tile * detail::scan_tile_size;
+
+			return std::min(size - first, detail::scan_tile_size);
+		};
+
+		detail::scan_look_back<segment>(*options.pool, detail::scan_tile_count(size), nullptr,
+			[&](size_t tile) {
+				size_t first = 0;
+
+				const auto count = range(tile, first);
+
+				return detail::scan_segment_reduce(input + first, heads + first, count, operation);
+			},
+			[&](const segment& a, const segment& b) { return detail::scan_segment_combine(a, b, operation); },
+			[&](size_t tile, const segment* prefix) {
+				size_t first = 0;
+
+				const auto count = range(tile, first);
+
+				detail::scan_segment_inclusive_block(input + first, heads + first, output + first, count,
+					prefix != nullptr ? &prefix->value : nullptr, operation);
+			});
+	}
+
+	/**
+	 * \brief segmented exclusive scan, every segment is scanned independently from initial
+	 * \param input the input
+	 * \param heads heads[i] != 0 means a segment starts at i
+	 * \param output the output, it can be the input
+	 * \param size the number of elements
+	 * \param initial the initial value of every segment
+	 * \param operation the associative operation
+	 * \param options the options
+	 */
+	template<typename T, typename Operation = std::plus<T>>
+	void segmented_exclusive_scan(const T* input, const uint8_t* heads, T* output, size_t size, T initial, Operation operation = Operation(), const scan_options& options = scan_options()) {
+		using segment = detail::scan_segment<T>;
+
+		if (size == 0) return;
+
+		if (!detail::scan_parallel(options, size)) {
+			detail::scan_segment_exclusive_block(input, heads, output, size, initial, initial, operation);
+
+			return;
+		}
+
+		const auto range = [size](size_t tile, size_t& first) {
+			first = tile * detail::scan_tile_size;
+
+			return std::min(size - first, detail::scan_tile_size);
+		};
+
+		//the first element starts a segment, so initial is the prefix of first tile
+		const segment first_prefix = { initial, true };
+
+		detail::scan_look_back<segment>(*options.pool, detail::scan_tile_count(size), &first_prefix,
+			[&](size_t tile) {
+				size_t first = 0;
+
+				const auto count = range(tile, first);
+
+				auto aggregate = detail::scan_segment_reduce(input + first, heads + first, count, operation);
+
+				//the exclusive scan restarts from initial at the last head
+				if (aggregate.head) aggregate.value = operation(initial, aggregate.value);
+
+				return aggregate;
+			},
+			[&](const segment& a, const segment& b) { return detail::scan_segment_combine(a, b, operation); },
+			[&](size_t tile, const segment* prefix) {
+				size_t first = 0;
+
+				const auto count = range(tile, first);
+
+				detail::scan_segment_exclusive_block(input + first, heads + first, output + first, count, prefix->value, initial, operation);
+			});
+	}
+}
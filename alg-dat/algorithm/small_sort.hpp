@@ -0,0 +1,608 @@
+#pragma once
+
+/*
+ * small_sort.hpp
+ * Sort the small arrays (at most 256 keys) by bitonic sorting networks in SIMD registers,
+ * for the leaf sorts of larger algorithms and the many short lists (e.g. the results of k nearest neighbors).
+ *
+ * The keys are 32-bit or 64-bit (int32_t, uint32_t, float, int64_t, uint64_t, double), the array is padded with the maximum key
+ * to a power of two registers. Every block of 2, 4, ... keys is sorted by the bitonic network :
+ * the first stage compares the mirrored keys of block (so both halves sorted ascending become a bitonic sequence),
+ * then the half cleaners compare the keys at distance block / 4, ..., 1.
+ * The stages at distance less than the lanes of register are in-register (permute, min, max and blend),
+ * the others are the bitonic merges of registers (min and max of two registers).
+ *
+ * The pairs sort the values with their keys, the value should have the same size as key (e.g. float distance and uint32_t index),
+ * the comparison mask of keys blends the keys and values.
+ *
+ * AVX-512 uses 16 x 32-bit or 8 x 64-bit lanes, AVX2 uses 8 x 32-bit or 4 x 64-bit lanes,
+ * the other keys or platforms use std::sort (the scalar fallback).
+ * The floating point keys should not be NaN.
+ *
+ * small_sort_batch sorts many independent arrays given by offsets, small_sort_options::pool sorts them in parallel.
+ * The arrays larger than small_sort_max_size are not the use of small_sort, they are sorted by std::sort.
+ */
+
+#include <type_traits>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+#include <utility>
+#include <limits>
+#include <vector>
+
+#include "../dependent/thread_pool.hpp"
+#include "../dependent/simd.hpp"
+
+namespace alg_dat {
+
+	//the maximum number of keys of small_sort
+	constexpr size_t small_sort_max_size = 256;
+
+	struct small_sort_options {
+		thread_pool* pool = nullptr;
+	};
+
+	namespace detail {
+
+		//the minimum number of keys of parallel batch
+		constexpr size_t small_sort_min_work = static_cast<size_t>(1) << 15;
+
+		//the register operations of Bytes-bit lanes, all keys and values are in integer vectors
+		template<size_t Bytes>
+		struct small_sort_register {
+			static constexpr size_t width = 0;
+		};
+
+		//the comparisons of keys, min(a, b) and max(a, b) return b if a equals b
+		template<typename Key>
+		struct small_sort_compare {
+			static constexpr bool value = false;
+		};
+
+#if defined(ALG_DAT_AVX512)
+
+		template<>
+		struct small_sort_register<4> {
+			using vector = __m512i;
+			using mask = __mmask16;
+
+			static constexpr size_t width = 16;
+
+			static vector load(const void* data) { return _mm512_loadu_si512(data); }
+			static void store(void* data, vector value) { _mm512_storeu_si512(data, value); }
+
+			//the permutation of lane ^ pattern
+			static vector index(size_t pattern) {
+				return _mm512_xor_si512(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(static_cast<int>(pattern)));
+			}
+
+			static vector permute(vector value, vector index) { return _mm512_permutexvar_epi32(index, value); }
+			static vector blend(mask select, vector a, vector b) { return _mm512_mask_blend_epi32(select, a, b); }
+
+			//the lanes with the bit of distance
+			static mask upper(size_t distance) {
+				unsigned bits = 0;
+
+				for (size_t lane = 0; lane < width; lane++) if ((lane & distance) != 0) bits = bits | (1u << lane);
+
+				return static_cast<mask>(bits);
+			}
+
+			static mask select(mask upper, mask greater, mask less) { return static_cast<mask>((upper & greater) | (~upper & less)); }
+		};
+
+		template<>
+		struct small_sort_register<8> {
+			using vector = __m512i;
+			using mask = __mmask8;
+
+			static constexpr size_t width = 8;
+
+			static vector load(const void* data) { return _mm512_loadu_si512(data); }
+			static void store(void* data, vector value) { _mm512_storeu_si512(data, value); }
+
+			static vector index(size_t pattern) {
+				return _mm512_xor_si512(_mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0), _mm512_set1_epi64(static_cast<long long>(pattern)));
+			}
+
+			static vector permute(vector value, vector index) { return _mm512_permutexvar_epi64(index, value); }
+			static vector blend(mask select, vector a, vector b) { return _mm512_mask_blend_epi64(select, a, b); }
+
+			static mask upper(size_t distance) {
+				unsigned bits = 0;
+
+				for (size_t lane = 0; lane < width; lane++) if ((lane & distance) != 0) bits = bits | (1u << lane);
+
+				return static_cast<mask>(bits);
+			}
+
+			static mask select(mask upper, mask greater, mask less) { return static_cast<mask>((upper & greater) | (~upper & less)); }
+		};
+
+		template<>
+		struct small_sort_compare<int32_t> {
+			static constexpr bool value = true;
+
+			static __mmask16 less(__m512i a, __m512i b) { return _mm512_cmplt_epi32_mask(a, b); }
+			static __m512i min(__m512i a, __m512i b) { return _mm512_min_epi32(a, b); }
+			static __m512i max(__m512i a, __m512i b) { return _mm512_max_epi32(a, b); }
+		};
+
+		template<>
+		struct small_sort_compare<uint32_t> {
+			static constexpr bool value = true;
+
+			static __mmask16 less(__m512i a, __m512i b) { return _mm512_cmplt_epu32_mask(a, b); }
+			static __m512i min(__m512i a, __m512i b) { return _mm512_min_epu32(a, b); }
+			static __m512i max(__m512i a, __m512i b) { return _mm512_max_epu32(a, b); }
+		};
+
+		template<>
+		struct small_sort_compare<float> {
+			static constexpr bool value = true;
+
+			static __mmask16 less(__m512i a, __m512i b) { return _mm512_cmp_ps_mask(_mm512_castsi512_ps(a), _mm512_castsi512_ps(b), _CMP_LT_OQ); }
+			static __m512i min(__m512i a, __m512i b) { return _mm512_castps_si512(_mm512_min_ps(_mm512_castsi512_ps(a), _mm512_castsi512_ps(b))); }
+			static __m512i max(__m512i a, __m512i b) { return _mm512_castps_si512(_mm512_max_ps(_mm512_castsi512_ps(a), _mm512_castsi512_ps(b))); }
+		};
+
+		template<>
+		struct small_sort_compare<int64_t> {
+			static constexpr bool value = true;
+
+			static __mmask8 less(__m512i a, __m512i b) { return _mm512_cmplt_epi64_mask(a, b); }
+			static __m512i min(__m512i a, __m512i b) { return _mm512_min_epi64(a, b); }
+			static __m512i max(__m512i a, __m512i b) { return _mm512_max_epi64(a, b); }
+		};
+
+		template<>
+		struct small_sort_compare<uint64_t> {
+			static constexpr bool value = true;
+
+			static __mmask8 less(__m512i a, __m512i b) { return _mm512_cmplt_epu64_mask(a, b); }
+			static __m512i min(__m512i a, __m512i b) { return _mm512_min_epu64(a, b); }
+			static __m512i max(__m512i a, __m512i b) { return _mm512_max_epu64(a, b); }
+		};
+
+		template<>
+		struct small_sort_compare<double> {
+			static constexpr bool value = true;
+
+			static __mmask8 less(__m512i a, __m512i b) { return _mm512_cmp_pd_mask(_mm512_castsi512_pd(a), _mm512_castsi512_pd(b), _CMP_LT_OQ); }
+			static __m512i min(__m512i a, __m512i b) { return _mm512_castpd_si512(_mm512_min_pd(_mm512_castsi512_pd(a), _mm512_castsi512_pd(b))); }
+			static __m512i max(__m512i a, __m512i b) { return _mm512_castpd_si512(_mm512_max_pd(_mm512_castsi512_pd(a), _mm512_castsi512_pd(b))); }
+		};
+
+#elif defined(ALG_DAT_AVX2)
+
+		template<>
+		struct small_sort_register<4> {
+			using vector = __m256i;
+			using mask = __m256i;
+
+			static constexpr size_t width = 8;
+
+			static vector load(const void* data) { return _mm256_loadu_si256(static_cast<const __m256i*>(data)); }
+			static void store(void* data, vector value) { _mm256_storeu_si256(static_cast<__m256i*>(data), value); }
+
+			static vector index(size_t pattern) {
+				return _mm256_xor_si256(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(pattern)));
+			}
+
+			static vector permute(vector value, vector index) { return _mm256_permutevar8x32_epi32(value, index); }
+			static vector blend(mask select, vector a, vector b) { return _mm256_blendv_epi8(a, b, select); }
+
+			static mask upper(size_t distance) {
+				const auto bit = _mm256_set1_epi32(static_cast<int>(distance));
+
+				return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), bit), bit);
+			}
+
+			static mask select(mask upper, mask greater, mask less) { return _mm256_blendv_epi8(less, greater, upper); }
+		};
+
+		template<>
+		struct small_sort_register<8> {
+			using vector = __m256i;
+			using mask = __m256i;
+
+			static constexpr size_t width = 4;
+
+			static vector load(const void* data) { return _mm256_loadu_si256(static_cast<const __m256i*>(data)); }
+			static void store(void* data, vector value) { _mm256_storeu_si256(static_cast<__m256i*>(data), value); }
+
+			//AVX2 has no variable permutation of 64-bit lanes, the 32-bit halves of lane ^ pattern are (lane ^ pattern) * 2 + half
+			static vector index(size_t pattern) {
+				return _mm256_xor_si256(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(pattern * 2)));
+			}
+
+			static vector permute(vector value, vector index) { return _mm256_permutevar8x32_epi32(value, index); }
+			static vector blend(mask select, vector a, vector b) { return _mm256_blendv_epi8(a, b, select); }
+
+			static mask upper(size_t distance) {
+				const auto bit = _mm256_set1_epi64x(static_cast<long long>(distance));
+
+				return _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_setr_epi64x(0, 1, 2, 3), bit), bit);
+			}
+
+			static mask select(mask upper, mask greater, mask less) { return _mm256_blendv_epi8(less, greater, upper); }
+		};
+
+		template<>
+		struct small_sort_compare<int32_t> {
+			static constexpr bool value = true;
+
+			static __m256i less(__m256i a, __m256i b) { return _mm256_cmpgt_epi32(b, a); }
+			static __m256i min(__m256i a, __m256i b) { return _mm256_min_epi32(a, b); }
+			static __m256i max(__m256i a, __m256i b) { return _mm256_max_epi32(a, b); }
+		};
+
+		template<>
+		struct small_sort_compare<uint32_t> {
+			static constexpr bool value = true;
+
+			//AVX2 has no unsigned comparison, flip the sign bits and compare the signed integers
+			static __m256i less(__m256i a, __m256i b) {
+				const auto sign = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+
+				return _mm256_cmpgt_epi32(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+			}
+
+			static __m256i min(__m256i a, __m256i b) { return _mm256_min_epu32(a, b); }
+			static __m256i max(__m256i a, __m256i b) { return _mm256_max_epu32(a, b); }
+		};
+
+		template<>
+		struct small_sort_compare<float> {
+			static constexpr bool value = true;
+
+			static __m256i less(__m256i a, __m256i b) { return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_LT_OQ)); }
+			static __m256i min(__m256i a, __m256i b) { return _mm256_castps_si256(_mm256_min_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b))); }
+			static __m256i max(__m256i a, __m256i b) { return _mm256_castps_si256(_mm256_max_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b))); }
+		};
+
+		//AVX2 has no min and max of 64-bit integers, they are the blends of comparisons
+		template<>
+		struct small_sort_compare<int64_t> {
+			static constexpr bool value = true;
+
+			static __m256i less(__m256i a, __m256i b) { return _mm256_cmpgt_epi64(b, a); }
+			static __m256i min(__m256i a, __m256i b) { return _mm256_blendv_epi8(b, a, less(a, b)); }
+			static __m256i max(__m256i a, __m256i b) { return _mm256_blendv_epi8(b, a, less(b, a)); }
+		};
+
+		template<>
+		struct small_sort_compare<uint64_t> {
+			static constexpr bool value = true;
+
+			static __m256i less(__m256i a, __m256i b) {
+				const auto sign = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+
+				return _mm256_cmpgt_epi64(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+			}
+
+			static __m256i min(__m256i a, __m256i b) { return _mm256_blendv_epi8(b, a, less(a, b)); }
+			static __m256i max(__m256i a, __m256i b) { return _mm256_blendv_epi8(b, a, less(b, a)); }
+		};
+
+		template<>
+		struct small_sort_compare<double> {
+			static constexpr bool value = true;
+
+			static __m256i less(__m256i a, __m256i b) { return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_LT_OQ)); }
+			static __m256i min(__m256i a, __m256i b) { return _mm256_castpd_si256(_mm256_min_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b))); }
+			static __m256i max(__m256i a, __m256i b) { return _mm256_castpd_si256(_mm256_max_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b))); }
+		};
+
+#endif
+
+		//whether the keys (and the values of same size) are sorted by the sorting networks
+		template<typename Key, typename Value = Key>
+		struct small_sort_vectorized : std::integral_constant<bool,
+			small_sort_compare<Key>::value && small_sort_register<sizeof(Key)>::width != 0 && sizeof(Value) == sizeof(Key)> {};
+
+		//the padding key, it is after all keys
+		template<typename Key>
+		Key small_sort_maximum() {
+			return std::numeric_limits<Key>::has_infinity ? std::numeric_limits<Key>::infinity() : std::numeric_limits<Key>::max();
+		}
+
+		/**
+		 * \brief sort the keys in registers by the bitonic network
+		 * \param keys the registers of keys
+		 * \param values the registers of values, it is used if Pairs
+		 * \param registers the number of registers, it is a power of two
+		 */
+		template<typename Key, bool Pairs, typename Register = small_sort_register<sizeof(Key)>>
+		void small_sort_network(typename Register::vector* keys, typename Register::vector* values, size_t registers) {
+			using compare = small_sort_compare<Key>;
+
+			constexpr auto width = Register::width;
+
+			//the compare-exchange of lanes (lane, lane ^ pattern), the lane with the bit of distance takes the greater key
+			const auto exchange_lanes = [&](size_t pattern, size_t distance) {
+				const auto index = Register::index(pattern);
+				const auto upper = Register::upper(distance);
+
+				for (size_t i = 0; i < registers; i++) {
+					const auto partner = Register::permute(keys[i], index);
+
+					if (Pairs) {
+						const auto select = Register::select(upper, compare::less(keys[i], partner), compare::less(partner, keys[i]));
+
+						keys[i] = Register::blend(select, keys[i], partner);
+						values[i] = Register::blend(select, values[i], Register::permute(values[i], index));
+					}
+					else keys[i] = Register::blend(upper, compare::min(partner, keys[i]), compare::max(partner, keys[i]));
+				}
+			};
+
+			//the compare-exchange of registers, the lower register takes the smaller keys
+			const auto exchange_registers = [&](size_t lower, size_t higher) {
+				if (Pairs) {
+					const auto select = compare::less(keys[higher], keys[lower]);
+
+					const auto key = Register::blend(select, keys[lower], keys[higher]);
+					const auto value = Register::blend(select, values[lower], values[higher]);
+
+					keys[higher] = Register::blend(select, keys[higher], keys[lower]);
+					values[higher] = Register::blend(select, values[higher], values[lower]);
+
+					keys[lower] = key;
+					values[lower] = value;
+				}
+				else {
+					const auto key = compare::min(keys[higher], keys[lower]);
+
+					keys[higher] = compare::max(keys[lower], keys[higher]);
+					keys[lower] = key;
+				}
+			};
+
+			const auto reverse = Register::index(width - 1);
+
+			for (size_t block = 2; block <= registers * width; block <<= 1) {
+				//the mirrored keys of block, the higher register is reversed
+				if (block <= width) exchange_lanes(block - 1, block / 2);
+				else {
+					const auto block_registers = block / width;
+
+					for (size_t i = 0; i < registers; i++) {
+						if ((i & (block_registers / 2)) != 0) continue;
+
+						const auto higher = i ^ (block_registers - 1);
+
+						keys[higher] = Register::permute(keys[higher], reverse);
+
+						if (Pairs) values[higher] = Register::permute(values[higher], reverse);
+
+						exchange_registers(i, higher);
+
+						keys[higher] = Register::permute(keys[higher], reverse);
+
+						if (Pairs) values[higher] = Register::permute(values[higher], reverse);
+					}
+				}
+
+				//the bitonic merge of both halves
+				for (auto distance = block / 4; distance > 0; distance >>= 1) {
+					if (distance >= width) {
+						const auto distance_registers = distance / width;
+
+						for (size_t i = 0; i < registers; i++) if ((i & distance_registers) == 0) exchange_registers(i, i | distance_registers);
+					}
+					else exchange_lanes(distance, distance);
+				}
+			}
+		}
+
+		template<typename Key, typename Value, bool Pairs, typename Register = small_sort_register<sizeof(Key)>>
+		void small_sort_vector(Key* keys, Value* values, size_t size) {
+			constexpr auto width = Register::width;
+
+			assert(size <= small_sort_max_size);
+
+			size_t count = width;
+
+			while (count < size) count <<= 1;
+
+			alignas(64) Key key_buffer[small_sort_max_size];
+			alignas(64) Value value_buffer[Pairs ? small_sort_max_size : 1];
+
+			typename Register::vector key_registers[small_sort_max_size / width];
+			typename Register::vector value_registers[Pairs ? small_sort_max_size / width : 1];
+
+			std::memcpy(key_buffer, keys, sizeof(Key) * size);
+			std::fill(key_buffer + size, key_buffer + count, small_sort_maximum<Key>());
+
+			if (Pairs) {
+				std::memcpy(value_buffer, values, sizeof(Value) * size);
+				std::memset(static_cast<void*>(value_buffer + size), 0, sizeof(Value) * (count - size));
+			}
+
+			for (size_t i = 0; i < count / width; i++) {
+				key_registers[i] = Register::load(key_buffer + i * width);
+
+				if (Pairs) value_registers[i] = Register::load(value_buffer + i * width);
+			}
+
+			small_sort_network<Key, Pairs>(key_registers, value_registers, count / width);
+
+			for (size_t i = 0; i < count / width; i++) {
+				Register::store(key_buffer + i * width, key_registers[i]);
+
+				if (Pairs) Register::store(value_buffer + i * width, value_registers[i]);
+			}
+
+			//the keys equal to padding key may be swapped with paddings, the pairs with non-zero value are moved back
+			//(a pair of padding key and zero value is same as a padding)
+			if (Pairs && count != size && !(key_buffer[size - 1] < small_sort_maximum<Key>())) {
+				const auto zero = [](const Value& value) {
+					alignas(Value) unsigned char bytes[sizeof(Value)] = {};
+
+					return std::memcmp(&value, bytes, sizeof(Value)) == 0;
+				};
+
+				auto hole = size;
+
+				for (auto position = size; position < count; position++) {
+					if (zero(value_buffer[position])) continue;
+
+					while (--hole, key_buffer[hole] < small_sort_maximum<Key>() || !zero(value_buffer[hole]));
+
+					std::swap(value_buffer[hole], value_buffer[position]);
+				}
+			}
+
+			std::memcpy(keys, key_buffer, sizeof(Key) * size);
+
+			if (Pairs) std::memcpy(values, value_buffer, sizeof(Value) * size);
+		}
+
+		template<typename Key, typename Value>
+		void small_sort_scalar(Key* keys, Value* values, size_t size) {
+			assert(size <= small_sort_max_size);
+
+			uint16_t order[small_sort_max_size];
+
+			for (size_t i = 0; i < size; i++) order[i] = static_cast<uint16_t>(i);
+
+			std::sort(order, order + size, [keys](uint16_t a, uint16_t b) { return keys[a] < keys[b]; });
+
+			Key key_buffer[small_sort_max_size];
+			Value value_buffer[small_sort_max_size];
+
+			for (size_t i = 0; i < size; i++) {
+				key_buffer[i] = keys[order[i]];
+				value_buffer[i] = values[order[i]];
+			}
+
+			std::memcpy(keys, key_buffer, sizeof(Key) * size);
+			std::memcpy(values, value_buffer, sizeof(Value) * size);
+		}
+
+		//the pairs of large array, the keys and values are sorted together in a temporary array
+		template<typename Key, typename Value>
+		void small_sort_large(Key* keys, Value* values, size_t size) {
+			std::vector<std::pair<Key, Value>> pairs(size);
+
+			for (size_t i = 0; i < size; i++) pairs[i] = { keys[i], values[i] };
+
+			std::sort(pairs.begin(), pairs.end(), [](const std::pair<Key, Value>& a, const std::pair<Key, Value>& b) { return a.first < b.first; });
+
+			for (size_t i = 0; i < size; i++) {
+				keys[i] = pairs[i].first;
+				values[i] = pairs[i].second;
+			}
+		}
+
+		template<typename Key>
+		void small_sort_keys(Key* keys, size_t size, std::true_type) {
+			small_sort_vector<Key, Key, false>(keys, static_cast<Key*>(nullptr), size);
+		}
+
+		template<typename Key>
+		void small_sort_keys(Key* keys, size_t size, std::false_type) {
+			std::sort(keys, keys + size);
+		}
+
+		template<typename Key, typename Value>
+		void small_sort_pairs(Key* keys, Value* values, size_t size, std::true_type) {
+			small_sort_vector<Key, Value, true>(keys, values, size);
+		}
+
+		template<typename Key, typename Value>
+		void small_sort_pairs(Key* keys, Value* values, size_t size, std::false_type) {
+			small_sort_scalar(keys, values, size);
+		}
+
+		template<typename Sort>
+		void small_sort_batch(const size_t* offsets, size_t count, const small_sort_options& options, const Sort& sort) {
+			if (count == 0) return;
+
+			if (options.pool != nullptr && options.pool->thread_count() > 1 && offsets[count] - offsets[0] >= small_sort_min_work) {
+				options.pool->parallel_for(0, count, [&](size_t first, size_t last) {
+					for (auto array = first; array < last; array++) sort(offsets[array], offsets[array + 1] - offsets[array]);
+				});
+			}
+			else {
+				for (size_t array = 0; array < count; array++) sort(offsets[array], offsets[array + 1] - offsets[array]);
+			}
+		}
+	}
+
+	/**
+	 * \brief sort the keys ascending, it is not stable
+	 * \param keys the keys
+	 * \param size the number of keys, the arrays larger than small_sort_max_size are sorted by std::sort
+	 */
+	template<typename Key>
+	void small_sort(Key* keys, size_t size) {
+		static_assert(std::is_trivially_copyable<Key>::value, "the key of small_sort should be trivially copyable.");
+
+		if (size < 2) return;
+
+		if (size > small_sort_max_size) {
+			std::sort(keys, keys + size);
+
+			return;
+		}
+
+		detail::small_sort_keys(keys, size, std::integral_constant<bool, detail::small_sort_vectorized<Key>::value>());
+	}
+
+	/**
+	 * \brief sort the pairs of keys and values by keys ascending, it is not stable
+	 * \param keys the keys
+	 * \param values the values, the value of keys[i] is values[i]
+	 * \param size the number of pairs, the arrays larger than small_sort_max_size are sorted by std::sort
+	 */
+	template<typename Key, typename Value>
+	void small_sort(Key* keys, Value* values, size_t size) {
+		static_assert(std::is_trivially_copyable<Key>::value, "the key of small_sort should be trivially copyable.");
+		static_assert(std::is_trivially_copyable<Value>::value, "the value of small_sort should be trivially copyable.");
+
+		if (size < 2) return;
+
+		if (size > small_sort_max_size) {
+			detail::small_sort_large(keys, values, size);
+
+			return;
+		}
+
+		detail::small_sort_pairs(keys, values, size, std::integral_constant<bool, detail::small_sort_vectorized<Key, Value>::value>());
+	}
+
+	/**
+	 * \brief sort the independent arrays of keys
+	 * \param keys the keys
+	 * \param offsets the array i is [offsets[i], offsets[i + 1]), there are count + 1 offsets.
+	 * The arrays should not be larger than small_sort_max_size, the larger arrays are sorted by std::sort
+	 * \param count the number of arrays
+	 * \param options the options
+	 */
+	template<typename Key>
+	void small_sort_batch(Key* keys, const size_t* offsets, size_t count, const small_sort_options& options = small_sort_options()) {
+		detail::small_sort_batch(offsets, count, options, [keys](size_t first, size_t size) {
+			small_sort(keys + first, size);
+		});
+	}
+
+	/**
+	 * \brief sort the independent arrays of pairs
+	 * \param keys the keys
+	 * \param values the values
+	 * \param offsets the array i is [offsets[i], offsets[i + 1]), there are count + 1 offsets.
+	 * The arrays should not be larger than small_sort_max_size, the larger arrays are sorted by std::sort
+	 * \param count the number of arrays
+	 * \param options the options
+	 */
+	template<typename Key, typename Value>
+	void small_sort_batch(Key* keys, Value* values, const size_t* offsets, size_t count, const small_sort_options& options = small_sort_options()) {
+		detail::small_sort_batch(offsets, count, options, [keys, values](size_t first, size_t size) {
+			small_sort(keys + first, values + first, size);
+		});
+	}
+}
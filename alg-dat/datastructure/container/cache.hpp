@@ -0,0 +1,581 @@
+#pragma once
+
+/*
+ * cache.hpp
+ * Bounded cache containers, all operations are O(1).
+ * Every entry has a charge (for example, the size in bytes of value) and the sum of charges is limited by budget.
+ * When we insert an entry and the budget or the number of entries is not enough, we evict some entries.
+ *
+ * lru_cache : evict the least recently used entry. The entries are linked by an intrusive list of indices,
+ * and a hit moves the entry to the front of list.
+ * clock_cache : evict with CLOCK (second chance). A hit only set the reference bit if it is not set,
+ * so the hot entries are read without any write and the lookup can run under shared lock.
+ * sharded_cache : split the keys into shards by hash, every shard has a cache and a lock.
+ * The budget and entries are divided into shards exactly, if they are less than Shards, less shards are used,
+ * so the sharded cache never holds more than its budget.
+ *
+ * The entries are stored in a fixed array, and we use an open-addressing (linear probing) table to index them.
+ * The table is at least two times of max entries, and we use backward shift to erase, so there are no tombstones.
+ */
+
+#include <shared_mutex>
+#include <functional>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <mutex>
+
+#include "../../dependent/simd.hpp"
+
+namespace alg_dat {
+
+	namespace detail {
+
+		constexpr uint32_t cache_invalid_slot = UINT32_MAX;
+
+		class cache_index {
+		public:
+			using size_type = size_t;
+		public:
+			cache_index() = default;
+
+			explicit cache_index(size_type entries) {
+				size_type size = 2;
+
+				while (size < (entries << 1)) size = size << 1;
+
+				mTable.assign(size, cache_invalid_slot);
+				mMask = size - 1;
+			}
+
+			template<typename Match>
+			auto find(size_t hash, Match&& match) const -> uint32_t {
+				for (auto position = hash & mMask; ; position = (position + 1) & mMask) {
+					const auto slot = mTable[position];
+
+					if (slot == cache_invalid_slot || match(slot)) return slot;
+				}
+			}
+
+			void insert(size_t hash, uint32_t slot) {
+				auto position = hash & mMask;
+
+				while (mTable[position] != cache_invalid_slot) position = (position + 1) & mMask;
+
+				mTable[position] = slot;
+			}
+
+			template<typename HashOf>
+			void erase(size_t hash, uint32_t slot, HashOf&& hash_of) {
+				auto position = hash & mMask;
+
+				while (mTable[position] != slot) position = (position + 1) & mMask;
+
+				//backward shift, move the slots that can not be found after we erase the position
+				for (auto next = (position + 1) & mMask; mTable[next] != cache_invalid_slot; next = (next + 1) & mMask) {
+					const auto home = hash_of(mTable[next]) & mMask;
+
+					const auto keep = position <= next ?
+						(position < home && home <= next) :
+						(position < home || home <= next);
+
+					if (keep) continue;
+
+					mTable[position] = mTable[next];
+					position = next;
+				}
+
+				mTable[position] = cache_invalid_slot;
+			}
+		private:
+			std::vector<uint32_t> mTable;
+			size_type mMask = 0;
+		};
+	}
+
+	template<typename Key, typename Value, typename Hash = std::hash<Key>, typename Equal = std::equal_to<Key>>
+	class lru_cache {
+	public:
+		using size_type = size_t;
+		using key_type = Key;
+		using value_type = Value;
+		using hasher = Hash;
+	public:
+		/**
+		 * \brief create lru cache
+		 * \param budget the max sum of charges
+		 * \param entries the max number of entries
+		 */
+		lru_cache(size_type budget, size_type entries) :
+			mEntries(entries), mIndex(entries), mBudget(budget)
+		{
+			assert(entries != 0 && entries < detail::cache_invalid_slot);
+
+			//all entries are in free list at first, we reuse the next of entry
+			for (size_type index = 0; index < entries; index++)
+				mEntries[index].next = index + 1 == entries ? detail::cache_invalid_slot : static_cast<uint32_t>(index + 1);
+
+			mFree = 0;
+		}
+
+		/**
+		 * \brief find the value and mark it as the most recently used
+		 * \param key the key
+		 * \return the pointer to value, nullptr if not found. It is invalid after next insert or erase.
+		 */
+		auto find(const Key& key) -> Value* {
+			const auto slot = find_slot(key, mHash(key));
+
+			if (slot == detail::cache_invalid_slot) return nullptr;
+
+			unlink(slot);
+			link_front(slot);
+
+			return &mEntries[slot].value;
+		}
+
+		/**
+		 * \brief insert or replace the value of key, evict least recently used entries if need
+		 * \param key the key
+		 * \param value the value
+		 * \param charge the charge of entry
+		 * \return false if the charge is larger than budget
+		 */
+		bool insert(const Key& key, Value value, size_type charge = 1) {
+			if (charge > mBudget) return false;
+
+			const auto hash = mHash(key);
+
+			auto slot = find_slot(key, hash);
+
+			if (slot != detail::cache_invalid_slot) {
+				mCharge = mCharge - mEntries[slot].charge;
+
+				unlink(slot);
+			}
+			else {
+				if (mFree == detail::cache_invalid_slot) evict();
+
+				slot = mFree;
+				mFree = mEntries[slot].next;
+				mSize++;
+
+				mEntries[slot].key = key;
+				mEntries[slot].hash = hash;
+
+				mIndex.insert(hash, slot);
+			}
+
+			mEntries[slot].value = std::move(value);
+			mEntries[slot].charge = charge;
+			mCharge = mCharge + charge;
+
+			link_front(slot);
+
+			//the new entry is at front, so it will be evicted at last
+			while (mCharge > mBudget) evict();
+
+			return true;
+		}
+
+		bool erase(const Key& key) {
+			const auto slot = find_slot(key, mHash(key));
+
+			if (slot == detail::cache_invalid_slot) return false;
+
+			unlink(slot);
+			release(slot);
+
+			return true;
+		}
+
+		void clear() {
+			while (mHead != detail::cache_invalid_slot) evict();
+		}
+
+		size_type size() const { return mSize; }
+
+		size_type charge() const { return mCharge; }
+
+		size_type budget() const { return mBudget; }
+
+		bool empty() const { return mSize == 0; }
+	private:
+		struct entry {
+			Key key = Key();
+			Value value = Value();
+
+			size_t hash = 0;
+			size_type charge = 0;
+
+			uint32_t prev = detail::cache_invalid_slot;
+			uint32_t next = detail::cache_invalid_slot;
+		};
+
+		auto find_slot(const Key& key, size_t hash) const -> uint32_t {
+			return mIndex.find(hash, [&](uint32_t slot)
+				{
+					return mEntries[slot].hash == hash && mEqual(mEntries[slot].key, key);
+				});
+		}
+
+		void unlink(uint32_t slot) {
+			auto& current = mEntries[slot];
+
+			if (current.prev != detail::cache_invalid_slot) mEntries[current.prev].next = current.next; else mHead = current.next;
+			if (current.next != detail::cache_invalid_slot) mEntries[current.next].prev = current.prev; else mTail = current.prev;
+		}
+
+		void link_front(uint32_t slot) {
+			mEntries[slot].prev = detail::cache_invalid_slot;
+			mEntries[slot].next = mHead;
+
+			if (mHead != detail::cache_invalid_slot) mEntries[mHead].prev = slot; else mTail = slot;
+
+			mHead = slot;
+		}
+
+		//remove the entry from index and put it into free list, the entry should be unlinked
+		void release(uint32_t slot) {
+			mIndex.erase(mEntries[slot].hash, slot, [&](uint32_t other) { return mEntries[other].hash; });
+
+			mCharge = mCharge - mEntries[slot].charge;
+			mSize--;
+
+			mEntries[slot].key = Key();
+			mEntries[slot].value = Value();
+			mEntries[slot].next = mFree;
+
+			mFree = slot;
+		}
+
+		void evict() {
+			assert(mTail != detail::cache_invalid_slot);
+
+			const auto slot = mTail;
+
+			unlink(slot);
+			release(slot);
+		}
+	private:
+		std::vector<entry> mEntries;
+		detail::cache_index mIndex;
+
+		Hash mHash;
+		Equal mEqual;
+
+		uint32_t mHead = detail::cache_invalid_slot;
+		uint32_t mTail = detail::cache_invalid_slot;
+		uint32_t mFree = detail::cache_invalid_slot;
+
+		size_type mBudget = 0;
+		size_type mCharge = 0;
+		size_type mSize = 0;
+	};
+
+	template<typename Key, typename Value, typename Hash = std::hash<Key>, typename Equal = std::equal_to<Key>>
+	class clock_cache {
+	public:
+		using size_type = size_t;
+		using key_type = Key;
+		using value_type = Value;
+		using hasher = Hash;
+	public:
+		/**
+		 * \brief create clock cache
+		 * \param budget the max sum of charges
+		 * \param entries the max number of entries
+		 */
+		clock_cache(size_type budget, size_type entries) :
+			mEntries(new entry[entries]), mIndex(entries), mCapacity(entries), mBudget(budget)
+		{
+			assert(entries != 0 && entries < detail::cache_invalid_slot);
+		}
+
+		/**
+		 * \brief find the value, it is safe to call find at the same time from many threads
+		 * \param key the key
+		 * \return the pointer to value, nullptr if not found. It is invalid after next insert or erase.
+		 */
+		auto find(const Key& key) const -> const Value* {
+			const auto slot = find_slot(key, mHash(key));
+
+			if (slot == detail::cache_invalid_slot) return nullptr;
+
+			auto& current = mEntries[slot];
+
+			//only write the bit when it is not set, so the hot entries do not make the cache line dirty
+			if (current.referenced.load(std::memory_order_relaxed) == 0)
+				current.referenced.store(1, std::memory_order_relaxed);
+
+			return &current.value;
+		}
+
+		/**
+		 * \brief insert or replace the value of key, evict entries by clock if need
+		 * \param key the key
+		 * \param value the value
+		 * \param charge the charge of entry
+		 * \return false if the charge is larger than budget
+		 */
+		bool insert(const Key& key, Value value, size_type charge = 1) {
+			if (charge > mBudget) return false;
+
+			const auto hash = mHash(key);
+
+			auto slot = find_slot(key, hash);
+
+			if (slot != detail::cache_invalid_slot) {
+				mCharge = mCharge - mEntries[slot].charge;
+			}
+			else {
+				if (mSize == mCapacity) evict();
+
+				//there is at least one free slot, we search it from the hand
+				slot = mHand;
+
+				while (mEntries[slot].used) slot = (slot + 1) % static_cast<uint32_t>(mCapacity);
+
+				mEntries[slot].key = key;
+				mEntries[slot].hash = hash;
+				mEntries[slot].used = true;
+				mSize++;
+
+				mIndex.insert(hash, slot);
+			}
+
+			mEntries[slot].value = std::move(value);
+			mEntries[slot].charge = charge;
+			mEntries[slot].referenced.store(0, std::memory_order_relaxed);
+			mCharge = mCharge + charge;
+
+			//the new entry should not be evicted by itself
+			mEntries[slot].pinned = true;
+
+			while (mCharge > mBudget) evict();
+
+			mEntries[slot].pinned = false;
+
+			return true;
+		}
+
+		bool erase(const Key& key) {
+			const auto slot = find_slot(key, mHash(key));
+
+			if (slot == detail::cache_invalid_slot) return false;
+
+			release(slot);
+
+			return true;
+		}
+
+		void clear() {
+			for (uint32_t slot = 0; slot < mCapacity; slot++) if (mEntries[slot].used) release(slot);
+		}
+
+		size_type size() const { return mSize; }
+
+		size_type charge() const { return mCharge; }
+
+		size_type budget() const { return mBudget; }
+
+		bool empty() const { return mSize == 0; }
+	private:
+		struct entry {
+			Key key = Key();
+			Value value = Value();
+
+			size_t hash = 0;
+			size_type charge = 0;
+
+			mutable std::atomic<uint8_t> referenced = { 0 };
+
+			bool used = false;
+			bool pinned = false;
+		};
+
+		auto find_slot(const Key& key, size_t hash) const -> uint32_t {
+			return mIndex.find(hash, [&](uint32_t slot)
+				{
+					return mEntries[slot].hash == hash && mEqual(mEntries[slot].key, key);
+				});
+		}
+
+		void release(uint32_t slot) {
+			mIndex.erase(mEntries[slot].hash, slot, [&](uint32_t other) { return mEntries[other].hash; });
+
+			mCharge = mCharge - mEntries[slot].charge;
+			mSize--;
+
+			mEntries[slot].key = Key();
+			mEntries[slot].value = Value();
+			mEntries[slot].used = false;
+		}
+
+		//move the hand until we find an entry is not referenced, the referenced entries get second chance
+		void evict() {
+			assert(mSize != 0);
+
+			while (true) {
+				auto& current = mEntries[mHand];
+				const auto slot = mHand;
+
+				mHand = (mHand + 1) % static_cast<uint32_t>(mCapacity);
+
+				if (!current.used || current.pinned) continue;
+
+				if (current.referenced.load(std::memory_order_relaxed) != 0) {
+					current.referenced.store(0, std::memory_order_relaxed);
+
+					continue;
+				}
+
+				release(slot);
+
+				return;
+			}
+		}
+	private:
+		std::unique_ptr<entry[]> mEntries;
+		detail::cache_index mIndex;
+
+		Hash mHash;
+		Equal mEqual;
+
+		uint32_t mHand = 0;
+
+		size_type mCapacity = 0;
+		size_type mBudget = 0;
+		size_type mCharge = 0;
+		size_type mSize = 0;
+	};
+
+	namespace detail {
+
+		//the lru cache update the list when hit, so it need exclusive lock
+		template<typename Cache>
+		struct cache_find_lock {
+			using type = std::unique_lock<std::shared_mutex>;
+		};
+
+		template<typename Key, typename Value, typename Hash, typename Equal>
+		struct cache_find_lock<clock_cache<Key, Value, Hash, Equal>> {
+			using type = std::shared_lock<std::shared_mutex>;
+		};
+	}
+
+	template<typename Cache, size_t Shards = 16>
+	class sharded_cache {
+		static_assert(Shards != 0 && (Shards & (Shards - 1)) == 0, "the number of shards must be power of 2.");
+	public:
+		using size_type = size_t;
+		using key_type = typename Cache::key_type;
+		using value_type = typename Cache::value_type;
+	public:
+		/**
+		 * \brief create sharded cache, the budget and entries are divided into shards and the remainders are spread to the first shards.
+		 * The shards in use are the largest power of 2 not more than Shards, budget and entries, so every shard has at least 1 budget
+		 * (if budget is not 0) and 1 entry, and the sum of shards is exactly the budget and entries
+		 * \param budget the max sum of charges
+		 * \param entries the max number of entries, it should not be 0
+		 */
+		sharded_cache(size_type budget, size_type entries) {
+			assert(entries != 0);
+
+			const auto limit = std::min(std::max(std::min(budget, entries), static_cast<size_type>(1)), Shards);
+
+			mActive = 1;
+
+			while (mActive * 2 <= limit) mActive = mActive * 2;
+
+			const auto share = [&](size_type total, size_type index) {
+				return total / mActive + (index < total % mActive ? 1 : 0);
+			};
+
+			for (size_type index = 0; index < mActive; index++)
+				mShards[index].cache = std::make_unique<Cache>(share(budget, index), share(entries, index));
+		}
+
+		/**
+		 * \brief find the value and copy it
+		 * \param key the key
+		 * \param value the value we found
+		 * \return true if found
+		 */
+		bool find(const key_type& key, value_type& value) const {
+			auto& current = shard_of(key);
+
+			typename detail::cache_find_lock<Cache>::type lock(current.mutex);
+
+			const auto result = current.cache->find(key);
+
+			if (result == nullptr) return false;
+
+			value = *result;
+
+			return true;
+		}
+
+		bool insert(const key_type& key, value_type value, size_type charge = 1) {
+			auto& current = shard_of(key);
+
+			std::unique_lock<std::shared_mutex> lock(current.mutex);
+
+			return current.cache->insert(key, std::move(value), charge);
+		}
+
+		bool erase(const key_type& key) {
+			auto& current = shard_of(key);
+
+			std::unique_lock<std::shared_mutex> lock(current.mutex);
+
+			return current.cache->erase(key);
+		}
+
+		size_type size() const {
+			size_type size = 0;
+
+			for (size_type index = 0; index < mActive; index++) {
+				std::shared_lock<std::shared_mutex> lock(mShards[index].mutex);
+
+				size = size + mShards[index].cache->size();
+			}
+
+			return size;
+		}
+
+		size_type charge() const {
+			size_type charge = 0;
+
+			for (size_type index = 0; index < mActive; index++) {
+				std::shared_lock<std::shared_mutex> lock(mShards[index].mutex);
+
+				charge = charge + mShards[index].cache->charge();
+			}
+
+			return charge;
+		}
+	private:
+		//every shard is in its own cache line to avoid false sharing of locks
+		struct alignas(cache_line_size) shard {
+			mutable std::shared_mutex mutex;
+			std::unique_ptr<Cache> cache;
+		};
+
+		shard& shard_of(const key_type& key) const {
+			//use the high bits of hash, the low bits are used by the index of shard cache
+			const auto hash = typename Cache::hasher()(key);
+			const auto mixed = static_cast<size_t>(static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull >> 32);
+
+			return mShards[mixed & (mActive - 1)];
+		}
+	private:
+		mutable shard mShards[Shards];
+
+		//the number of shards in use, it is power of 2
+		size_type mActive = Shards;
+	};
+}
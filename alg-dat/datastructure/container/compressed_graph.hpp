@@ -0,0 +1,321 @@
+#pragma once
+
+/*
+ * compressed_graph.hpp
+ * Compressed sparse row (CSR) / column (CSC) graph, it is static and built from an unsorted edge list.
+ * The edges of vertex v are [offsets[v], offsets[v + 1]) of targets, and the weights are in another array (SoA).
+ * In CSC layout, the edges are grouped by target and we store the sources, so it is the CSR of transposed graph.
+ *
+ * compressed_graph_builder collects the edges and builds the graph :
+ * 1. (optional) compact the vertex ids, the ids are sorted by radix_sort and map to [0, vertex count).
+ * 2. sort the edges by the other endpoint with radix_sort, so the neighbors of a vertex are sorted.
+ * 3. count the degrees and compute the offsets with one exclusive prefix-sum pass.
+ * 4. scatter the edges to their rows, it is the last (stable) pass of radix sort with key = row.
+ * All steps are O(E + V).
+ *
+ * compressed_graph_options::pool : the thread pool of parallel build, nullptr means the sequential build.
+ * The sorts are the parallel radix_sort, the degrees are counted and the edges are scattered by chunks
+ * with detail::radix_sort_count and detail::radix_sort_scatter, the offsets are the parallel exclusive_scan.
+ * Every chunk has a counter per vertex, so the number of chunks is limited to keep the counters in O(E).
+ * The rvalue build() moves the edges of builder, so the huge edge lists are not copied.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "../../dependent/thread_pool.hpp"
+#include "../../algorithm/radix_sort.hpp"
+#include "../../algorithm/scan.hpp"
+#include "../../dependent/memory/aligned_buffer.hpp"
+#include "../../utility.hpp"
+
+namespace alg_dat {
+
+	enum class compressed_layout : unsigned {
+		row = 0,
+		column = 1
+	};
+
+	struct compressed_graph_options {
+		thread_pool* pool = nullptr;
+	};
+
+	namespace detail {
+
+		//the minimum number of edges per chunk of parallel build
+		constexpr size_t compressed_graph_min_work = static_cast<size_t>(1) << 15;
+	}
+
+	template<typename Vertex = uint32_t, typename Weight = real>
+	class compressed_graph {
+		static_assert(std::is_integral<Vertex>::value && std::is_unsigned<Vertex>::value, "the vertex of graph should be unsigned.");
+	public:
+		using size_type = size_t;
+		using vertex_type = Vertex;
+		using weight_type = Weight;
+	public:
+		compressed_graph() = default;
+
+		compressed_graph(
+			aligned_buffer<size_type>&& offsets,
+			aligned_buffer<Vertex>&& targets,
+			aligned_buffer<Weight>&& weights,
+			compressed_layout layout) :
+			mOffsets(std::move(offsets)), mTargets(std::move(targets)), mWeights(std::move(weights)), mLayout(layout)
+		{
+			assert(!mOffsets.empty() && mOffsets[mOffsets.size() - 1] == mTargets.size());
+			assert(mWeights.empty() || mWeights.size() == mTargets.size());
+		}
+
+		size_type vertex_count() const { return mOffsets.empty() ? 0 : mOffsets.size() - 1; }
+
+		size_type edge_count() const { return mTargets.size(); }
+
+		size_type degree(Vertex vertex) const {
+			assert(vertex < vertex_count());
+
+			return mOffsets[vertex + 1] - mOffsets[vertex];
+		}
+
+		//the neighbors of vertex are [neighbors_begin(vertex), neighbors_end(vertex))
+		auto neighbors_begin(Vertex vertex) const -> const Vertex* { return mTargets.data() + mOffsets[vertex]; }
+
+		auto neighbors_end(Vertex vertex) const -> const Vertex* { return mTargets.data() + mOffsets[vertex + 1]; }
+
+		//the weights of edges of vertex, it is nullptr if the graph has no weights
+		auto weights_begin(Vertex vertex) const -> const Weight* {
+			return has_weights() ? mWeights.data() + mOffsets[vertex] : nullptr;
+		}
+
+		auto offsets() const -> const size_type* { return mOffsets.data(); }
+
+		auto targets() const -> const Vertex* { return mTargets.data(); }
+
+		auto weights() const -> const Weight* { return has_weights() ? mWeights.data() : nullptr; }
+
+		bool has_weights() const { return !mWeights.empty(); }
+
+		auto layout() const -> compressed_layout { return mLayout; }
+	private:
+		aligned_buffer<size_type> mOffsets;
+		aligned_buffer<Vertex> mTargets;
+		aligned_buffer<Weight> mWeights;
+
+		compressed_layout mLayout = compressed_layout::row;
+	};
+
+	template<typename Vertex = uint32_t, typename Weight = real>
+	class compressed_graph_builder {
+	public:
+		using size_type = size_t;
+		using vertex_type = Vertex;
+		using weight_type = Weight;
+		using graph_type = compressed_graph<Vertex, Weight>;
+
+		struct edge {
+			Vertex source;
+			Vertex target;
+			Weight weight;
+		};
+	public:
+		/**
+		 * \brief create builder
+		 * \param weighted whether the graph has weights
+		 * \param sorted whether sort the neighbors of every vertex, it costs a radix sort of edges
+		 * \param options the options
+		 */
+		explicit compressed_graph_builder(bool weighted = false, bool sorted = true, const compressed_graph_options& options = compressed_graph_options()) :
+			mOptions(options), mWeighted(weighted), mSorted(sorted) {}
+
+		void reserve(size_type edges) { mEdges.reserve(edges); }
+
+		void add_edge(Vertex source, Vertex target, Weight weight = Weight(1)) {
+			mEdges.push_back({ source, target, weight });
+		}
+
+		size_type edge_count() const { return mEdges.size(); }
+
+		/**
+		 * \brief build the graph, the ids of vertex should be in [0, vertex_count)
+		 * \param vertex_count the number of vertices
+		 * \param layout row(CSR) or column(CSC)
+		 * \return the graph, the edges of builder are not changed
+		 */
+		auto build(size_type vertex_count, compressed_layout layout = compressed_layout::row) const & -> graph_type {
+			auto edges = mEdges;
+
+			return build(edges, vertex_count, layout);
+		}
+
+		/**
+		 * \brief build the graph with the edges of builder, they are moved so the builder is empty
+		 * \param vertex_count the number of vertices
+		 * \param layout row(CSR) or column(CSC)
+		 * \return the graph
+		 */
+		auto build(size_type vertex_count, compressed_layout layout = compressed_layout::row) && -> graph_type {
+			auto edges = std::move(mEdges);
+
+			mEdges.clear();
+
+			return build(edges, vertex_count, layout);
+		}
+
+		/**
+		 * \brief compact the ids of vertex to [0, vertex count) and build the graph
+		 * \param ids the original ids of vertices, ids[new id] = original id
+		 * \param layout row(CSR) or column(CSC)
+		 * \return the graph, the edges of builder are not changed
+		 */
+		auto build_compact(std::vector<Vertex>& ids, compressed_layout layout = compressed_layout::row) const & -> graph_type {
+			auto edges = mEdges;
+
+			compact(edges, ids);
+
+			return build(edges, ids.size(), layout);
+		}
+
+		/**
+		 * \brief compact the ids of vertex and build the graph with the edges of builder, they are moved so the builder is empty
+		 * \param ids the original ids of vertices, ids[new id] = original id
+		 * \param layout row(CSR) or column(CSC)
+		 * \return the graph
+		 */
+		auto build_compact(std::vector<Vertex>& ids, compressed_layout layout = compressed_layout::row) && -> graph_type {
+			auto edges = std::move(mEdges);
+
+			mEdges.clear();
+
+			compact(edges, ids);
+
+			return build(edges, ids.size(), layout);
+		}
+	private:
+		struct endpoint {
+			Vertex id;
+			size_type slot;
+		};
+
+		//map the sparse ids to dense ids, the order of dense ids is the order of original ids
+		void compact(std::vector<edge>& edges, std::vector<Vertex>& ids) const {
+			std::vector<endpoint> endpoints(edges.size() << 1);
+
+			for (size_type index = 0; index < edges.size(); index++) {
+				endpoints[(index << 1) + 0] = { edges[index].source, (index << 1) + 0 };
+				endpoints[(index << 1) + 1] = { edges[index].target, (index << 1) + 1 };
+			}
+
+			radix_sort<Vertex, endpoint>(endpoints.data(), endpoints.data() + endpoints.size(),
+				[](const endpoint& element) { return element.id; }, radix_sort_options{ mOptions.pool });
+
+			ids.clear();
+
+			for (size_type index = 0; index < endpoints.size(); index++) {
+				if (index == 0 || endpoints[index].id != endpoints[index - 1].id) ids.push_back(endpoints[index].id);
+
+				const auto slot = endpoints[index].slot;
+				const auto dense = static_cast<Vertex>(ids.size() - 1);
+
+				if (slot & 1) edges[slot >> 1].target = dense; else edges[slot >> 1].source = dense;
+			}
+		}
+
+		auto build(std::vector<edge>& edges, size_type vertex_count, compressed_layout layout) const -> graph_type {
+			const auto column = layout == compressed_layout::column;
+			const auto size = edges.size();
+			const auto pool = mOptions.pool;
+			const auto parallel = pool != nullptr && pool->thread_count() > 1 && size >= detail::compressed_graph_min_work * 2;
+
+			//the neighbors are sorted by the other endpoint, the scatter pass is stable so the order is kept
+			if (mSorted && column) {
+				radix_sort<Vertex, edge>(edges.data(), edges.data() + size,
+					[](const edge& element) { return element.source; }, radix_sort_options{ pool });
+			}
+
+			if (mSorted && !column) {
+				radix_sort<Vertex, edge>(edges.data(), edges.data() + size,
+					[](const edge& element) { return element.target; }, radix_sort_options{ pool });
+			}
+
+			//4 chunks per thread, and the counters of chunks are not more than the edges
+			const auto chunk_count = parallel ?
+				std::max(std::min({ pool->thread_count() * 4, size / detail::compressed_graph_min_work, size / (vertex_count + 1) }), static_cast<size_t>(1)) : 1;
+
+			const auto for_ranges = [&](size_t count, size_t range_count, const auto& function) {
+				const auto range = [&](size_t first_range, size_t last_range) {
+					for (auto index = first_range; index < last_range; index++) {
+						const auto first = count * index / range_count;
+
+						function(index, first, count * (index + 1) / range_count);
+					}
+				};
+
+				if (range_count > 1) pool->parallel_for(0, range_count, range, 1);
+				else range(0, range_count);
+			};
+
+			aligned_buffer<Vertex> rows(size);
+			aligned_buffer<size_type> offsets(vertex_count + 1);
+			aligned_buffer<Vertex> targets(size);
+			aligned_buffer<Weight> weights(mWeighted ? size : 0);
+
+			//counters[chunk * vertex_count + row], the degree of row in chunk, then the position of next edge
+			aligned_buffer<size_type> counters(chunk_count * vertex_count);
+
+			for_ranges(size, chunk_count, [&](size_t chunk, size_t first, size_t last) {
+				for (auto index = first; index < last; index++) {
+					rows[index] = column ? edges[index].target : edges[index].source;
+
+					assert(rows[index] < vertex_count);
+				}
+
+				detail::radix_sort_count(rows.data() + first, last - first, counters.data() + chunk * vertex_count);
+			});
+
+			//the degrees of vertices, the counters are the positions of chunks in their rows
+			for_ranges(vertex_count, chunk_count, [&](size_t, size_t first, size_t last) {
+				for (auto vertex = first; vertex < last; vertex++) {
+					size_type degree = 0;
+
+					for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+						auto& counter = counters[chunk * vertex_count + vertex];
+
+						degree = degree + counter;
+						counter = degree - counter;
+					}
+
+					offsets[vertex] = degree;
+				}
+			});
+
+			//the offsets[v] is the sum of degrees of [0, v), the offsets[vertex_count] is 0 so it is the number of edges
+			exclusive_scan(offsets.data(), offsets.data(), vertex_count + 1, static_cast<size_type>(0), std::plus<size_type>(), scan_options{ pool });
+
+			for_ranges(vertex_count, chunk_count, [&](size_t, size_t first, size_t last) {
+				for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+					for (auto vertex = first; vertex < last; vertex++) counters[chunk * vertex_count + vertex] += offsets[vertex];
+				}
+			});
+
+			for_ranges(size, chunk_count, [&](size_t chunk, size_t first, size_t last) {
+				detail::radix_sort_scatter(rows.data() + first, last - first, counters.data() + chunk * vertex_count, [&](size_t element, size_t position) {
+					const auto& current = edges[first + element];
+
+					targets[position] = column ? current.source : current.target;
+
+					if (mWeighted) weights[position] = current.weight;
+				});
+			});
+
+			return graph_type(std::move(offsets), std::move(targets), std::move(weights), layout);
+		}
+	private:
+		std::vector<edge> mEdges;
+
+		compressed_graph_options mOptions;
+
+		bool mWeighted = false;
+		bool mSorted = true;
+	};
+}
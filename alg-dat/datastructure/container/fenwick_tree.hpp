@@ -0,0 +1,117 @@
+#pragma once
+
+/*
+ * fenwick_tree.hpp
+ * Fenwick tree (binary indexed tree) for prefix sum of mutable array.
+ * The add and prefix sum are O(log n), build is O(n) and the memory is O(n).
+ *
+ * The index of interface is from 0, but the tree is stored from 1 in memory.
+ * So the tree[i] is the sum of [i - lowbit(i), i) of the array.
+ */
+
+#include "../../dependent/memory/aligned_buffer.hpp"
+
+namespace alg_dat {
+
+	template<typename T>
+	class fenwick_tree {
+	public:
+		using size_type = size_t;
+		using type = T;
+	public:
+		fenwick_tree() = default;
+
+		explicit fenwick_tree(size_type size) : mTree(size + 1) {}
+
+		/**
+		 * \brief build the tree from array in O(n)
+		 * \param begin the begin of array
+		 * \param end the end of array
+		 */
+		fenwick_tree(const T* begin, const T* end) : mTree(static_cast<size_type>(end - begin) + 1) {
+			const auto size = this->size();
+
+			for (size_type index = 1; index <= size; index++) mTree[index] = begin[index - 1];
+
+			//push the value to its parent, every node only be visited once
+			for (size_type index = 1; index <= size; index++) {
+				const auto parent = index + lowbit(index);
+
+				if (parent <= size) mTree[parent] = mTree[parent] + mTree[index];
+			}
+		}
+
+		/**
+		 * \brief add value to array[index]
+		 * \param index the index of element
+		 * \param value the value we add
+		 */
+		void add(size_type index, const T& value) {
+			assert(index < size());
+
+			for (index = index + 1; index < mTree.size(); index = index + lowbit(index))
+				mTree[index] = mTree[index] + value;
+		}
+
+		/**
+		 * \brief the sum of [0, last)
+		 * \param last the end of range
+		 * \return the sum of range
+		 */
+		auto prefix_sum(size_type last) const -> T {
+			assert(last <= size());
+
+			T sum = T(0);
+
+			for (; last != 0; last = last - lowbit(last)) sum = sum + mTree[last];
+
+			return sum;
+		}
+
+		/**
+		 * \brief the sum of [first, last)
+		 * \param first the begin of range
+		 * \param last the end of range
+		 * \return the sum of range
+		 */
+		auto range_sum(size_type first, size_type last) const -> T {
+			assert(first <= last);
+
+			return prefix_sum(last) - prefix_sum(first);
+		}
+
+		auto at(size_type index) const -> T {
+			return range_sum(index, index + 1);
+		}
+
+		/**
+		 * \brief find the first last that prefix_sum(last) >= value, all elements should be non-negative
+		 * \param value the value we want to find
+		 * \return the last, size() + 1 if not found
+		 */
+		auto lower_bound(T value) const -> size_type {
+			if (!(T(0) < value)) return 0;
+
+			size_type position = 0;
+			size_type step = 1;
+
+			while ((step << 1) <= size()) step = step << 1;
+
+			//descend the implicit tree from the highest power of 2
+			for (; step != 0; step = step >> 1) {
+				if (position + step <= size() && mTree[position + step] < value) {
+					position = position + step;
+					value = value - mTree[position];
+				}
+			}
+
+			return position + 1;
+		}
+
+		size_type size() const { return mTree.empty() ? 0 : mTree.size() - 1; }
+	private:
+		static size_type lowbit(size_type index) { return index & (~index + 1); }
+	private:
+		aligned_buffer<T> mTree;
+	};
+}
@@ -0,0 +1,617 @@
+#pragma once
+
+/*
+ * persistent_map.hpp
+ * Persistent (immutable and structure sharing) hash map, it is a hash array mapped trie (HAMT).
+ * Every node use 5 bits of hash to index 32 slots, and only the used slots are stored.
+ * The "datamap" marks the slots store a key-value and the "nodemap" marks the slots store a child node (CHAMP layout),
+ * so a node is [header | children | values] in one block and the index of slot is the popcount of lower bits.
+ * When all bits of hash are used, the keys with same hash are stored in a collision node.
+ *
+ * insert and erase return a new map and copy the path from root, they are O(log32 n). Copy a map is O(1).
+ * transient_map is the batch edit mode, it edits the nodes it owned in place, see more in "persistent_vector.hpp".
+ *
+ * The nodes are variable size, so they are allocated by size_class_pool of the context.
+ */
+
+#include <functional>
+#include <utility>
+
+#include "persistent_vector.hpp"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace alg_dat {
+
+	template<typename Key, typename Value, typename Hash, typename Equal>
+	class transient_map;
+
+	namespace detail {
+
+		inline auto persistent_popcount(uint32_t value) -> uint32_t {
+#ifdef _MSC_VER
+			return __popcnt(value);
+#else
+			return static_cast<uint32_t>(__builtin_popcount(value));
+#endif
+		}
+
+		constexpr auto persistent_align_up(size_t size, size_t alignment) -> size_t {
+			return (size + alignment - 1) / alignment * alignment;
+		}
+
+		template<typename Key, typename Value, typename Hash, typename Equal>
+		class persistent_map_data {
+		public:
+			using size_type = size_t;
+			using value_type = std::pair<Key, Value>;
+
+			static constexpr size_type bits = 5;
+			static constexpr size_type mask = (static_cast<size_type>(1) << bits) - 1;
+			static constexpr size_type hash_bits = sizeof(size_t) << 3;
+
+			struct node : persistent_node {
+				uint32_t datamap = 0;
+				uint32_t nodemap = 0;
+
+				//the number of values if it is collision node, otherwise 0
+				uint32_t collisions = 0;
+
+				explicit node(uint64_t owner) : persistent_node(owner) {}
+			};
+
+			static constexpr size_type header_size = persistent_align_up(sizeof(node), alignof(node*));
+			static constexpr size_type max_node_size = persistent_align_up(header_size + (mask + 1) *
+				(sizeof(value_type) > sizeof(node*) ? sizeof(value_type) : sizeof(node*)), alignof(value_type)) + alignof(value_type);
+
+			struct context {
+				std::mutex mutex;
+
+				size_class_pool<> pool = size_class_pool<>(64, max_node_size);
+			};
+		public:
+			persistent_map_data() = default;
+
+			persistent_map_data(const persistent_map_data& data) :
+				mContext(data.mContext), mRoot(data.mRoot), mSize(data.mSize)
+			{
+				if (mRoot != nullptr) mRoot->retain();
+			}
+
+			persistent_map_data(persistent_map_data&& data) noexcept { swap(data); }
+
+			persistent_map_data& operator=(persistent_map_data data) noexcept {
+				swap(data);
+
+				return *this;
+			}
+
+			~persistent_map_data() { reset(); }
+
+			void swap(persistent_map_data& data) noexcept {
+				std::swap(mContext, data.mContext);
+				std::swap(mRoot, data.mRoot);
+				std::swap(mSize, data.mSize);
+			}
+
+			void reset() {
+				if (mRoot != nullptr) release(mRoot);
+
+				mRoot = nullptr;
+				mSize = 0;
+			}
+
+			auto find(const Key& key) const -> const Value* {
+				const auto hash = Hash()(key);
+
+				auto current = mRoot;
+
+				for (size_type shift = 0; current != nullptr; shift += bits) {
+					if (current->collisions != 0) {
+						const auto index = find_collision(current, key);
+
+						return index == current->collisions ? nullptr : &values(current)[index].second;
+					}
+
+					const auto bit = bit_of(hash, shift);
+
+					if (current->datamap & bit) {
+						const auto& entry = values(current)[index_of(current->datamap, bit)];
+
+						return Equal()(entry.first, key) ? &entry.second : nullptr;
+					}
+
+					if (!(current->nodemap & bit)) return nullptr;
+
+					current = children(current)[index_of(current->nodemap, bit)];
+				}
+
+				return nullptr;
+			}
+
+			void insert(const Key& key, const Value& value, uint64_t owner) {
+				if (mContext == nullptr) mContext = std::make_shared<context>();
+
+				auto added = false;
+
+				mRoot = insert(mRoot, key, value, Hash()(key), 0, owner, added);
+
+				if (added) mSize++;
+			}
+
+			bool erase(const Key& key, uint64_t owner) {
+				//we do not copy the path if the key is not in map
+				if (find(key) == nullptr) return false;
+
+				mRoot = erase(mRoot, key, Hash()(key), 0, owner);
+				mSize--;
+
+				return true;
+			}
+
+			template<typename Function>
+			void for_each(Function&& function) const {
+				if (mRoot != nullptr) for_each(mRoot, function);
+			}
+
+			size_type size() const { return mSize; }
+		private:
+			static uint32_t bit_of(size_t hash, size_type shift) {
+				return static_cast<uint32_t>(1) << ((hash >> shift) & mask);
+			}
+
+			static size_type index_of(uint32_t map, uint32_t bit) {
+				return persistent_popcount(map & (bit - 1));
+			}
+
+			static size_type data_count(const node* current) {
+				return current->collisions != 0 ? current->collisions : persistent_popcount(current->datamap);
+			}
+
+			static size_type node_count(const node* current) {
+				return persistent_popcount(current->nodemap);
+			}
+
+			static size_type values_offset(size_type nodes) {
+				return persistent_align_up(header_size + nodes * sizeof(node*), alignof(value_type));
+			}
+
+			static size_type bytes_of(size_type datas, size_type nodes) {
+				return values_offset(nodes) + datas * sizeof(value_type);
+			}
+
+			static node** children(const node* current) {
+				return reinterpret_cast<node**>(reinterpret_cast<char*>(const_cast<node*>(current)) + header_size);
+			}
+
+			static value_type* values(const node* current) {
+				return reinterpret_cast<value_type*>(
+					reinterpret_cast<char*>(const_cast<node*>(current)) + values_offset(node_count(current)));
+			}
+
+			static size_type find_collision(const node* current, const Key& key) {
+				const auto entries = values(current);
+
+				size_type index = 0;
+
+				while (index < current->collisions && !Equal()(entries[index].first, key)) index++;
+
+				return index;
+			}
+
+			//create a node without values, the caller should construct the values and set the children
+			node* create(uint64_t owner, uint32_t datamap, uint32_t nodemap, uint32_t collisions) {
+				const auto bytes = bytes_of(collisions != 0 ? collisions : persistent_popcount(datamap), persistent_popcount(nodemap));
+
+				void* memory = nullptr;
+
+				if (bytes > max_node_size) memory = std::malloc(bytes);
+				else {
+					std::lock_guard<std::mutex> lock(mContext->mutex);
+
+					memory = mContext->pool.allocate(bytes);
+				}
+
+				const auto current = new (memory)node(owner);
+
+				current->datamap = datamap;
+				current->nodemap = nodemap;
+				current->collisions = collisions;
+
+				return current;
+			}
+
+			//destroy the values and free the node, the children are not released
+			void destroy(node* current) {
+				const auto bytes = bytes_of(data_count(current), node_count(current));
+				const auto entries = values(current);
+
+				for (size_type index = 0; index < data_count(current); index++) entries[index].~value_type();
+
+				current->~node();
+
+				if (bytes > max_node_size) std::free(current);
+				else {
+					std::lock_guard<std::mutex> lock(mContext->mutex);
+
+					mContext->pool.deallocate(current, bytes);
+				}
+			}
+
+			void release(node* current) {
+				if (!current->release()) return;
+
+				for (size_type index = 0; index < node_count(current); index++) release(children(current)[index]);
+
+				destroy(current);
+			}
+
+			/**
+			 * \brief rebuild the node with new layout, the reference of old node is moved to new node
+			 * \param current the old node
+			 * \param datamap the datamap of new node
+			 * \param nodemap the nodemap of new node
+			 * \param collisions the collisions of new node
+			 * \param skip_value the value of old node we do not keep, -1 if we keep all
+			 * \param skip_child the child of old node we do not keep, -1 if we keep all
+			 * \param new_value the index of value in new node we do not fill, -1 if there is not
+			 * \param new_child the index of child in new node we do not fill, -1 if there is not
+			 */
+			node* rebuild(node* current, uint64_t owner, uint32_t datamap, uint32_t nodemap, uint32_t collisions,
+				size_type skip_value, size_type skip_child, size_type new_value, size_type new_child)
+			{
+				const auto result = create(owner, datamap, nodemap, collisions);
+
+				//if we own the old node, no one can see it, so we move the values and children
+				const auto unique = current->owner == owner;
+
+				const auto old_values = values(current);
+				const auto old_children = children(current);
+				const auto result_values = values(result);
+				const auto result_children = children(result);
+
+				for (size_type from = 0, to = 0; from < data_count(current); from++) {
+					if (from == skip_value) continue;
+					if (to == new_value) to++;
+
+					if (unique) new (result_values + to++)value_type(std::move(old_values[from]));
+					else new (result_values + to++)value_type(old_values[from]);
+				}
+
+				for (size_type from = 0, to = 0; from < node_count(current); from++) {
+					if (from == skip_child) {
+						if (unique) release(old_children[from]);
+
+						continue;
+					}
+
+					if (to == new_child) to++;
+
+					result_children[to++] = old_children[from];
+
+					if (!unique) old_children[from]->retain();
+				}
+
+				if (unique) destroy(current); else release(current);
+
+				return result;
+			}
+
+			node* edit(node* current, uint64_t owner) {
+				if (current->owner == owner) return current;
+
+				const auto none = static_cast<size_type>(-1);
+
+				return rebuild(current, owner, current->datamap, current->nodemap, current->collisions, none, none, none, none);
+			}
+
+			//create the node contains two values, they have same bits before shift
+			node* merge(value_type first, size_t first_hash, value_type second, size_t second_hash, size_type shift, uint64_t owner) {
+				if (shift >= hash_bits) {
+					const auto result = create(owner, 0, 0, 2);
+
+					new (values(result) + 0)value_type(std::move(first));
+					new (values(result) + 1)value_type(std::move(second));
+
+					return result;
+				}
+
+				const auto first_bit = bit_of(first_hash, shift);
+				const auto second_bit = bit_of(second_hash, shift);
+
+				if (first_bit == second_bit) {
+					const auto result = create(owner, 0, first_bit, 0);
+
+					children(result)[0] = merge(std::move(first), first_hash, std::move(second), second_hash, shift + bits, owner);
+
+					return result;
+				}
+
+				const auto result = create(owner, first_bit | second_bit, 0, 0);
+
+				if (second_bit < first_bit) std::swap(first, second);
+
+				new (values(result) + 0)value_type(std::move(first));
+				new (values(result) + 1)value_type(std::move(second));
+
+				return result;
+			}
+
+			node* insert(node* current, const Key& key, const Value& value, size_t hash, size_type shift, uint64_t owner, bool& added) {
+				const auto none = static_cast<size_type>(-1);
+
+				if (current == nullptr) {
+					const auto result = create(owner, bit_of(hash, shift), 0, 0);
+
+					new (values(result))value_type(key, value);
+
+					added = true;
+
+					return result;
+				}
+
+				if (current->collisions != 0) {
+					const auto index = find_collision(current, key);
+
+					if (index != current->collisions) {
+						current = edit(current, owner);
+
+						values(current)[index].second = value;
+
+						return current;
+					}
+
+					const auto result = rebuild(current, owner, 0, 0, current->collisions + 1, none, none, current->collisions, none);
+
+					new (values(result) + result->collisions - 1)value_type(key, value);
+
+					added = true;
+
+					return result;
+				}
+
+				const auto bit = bit_of(hash, shift);
+
+				if (current->datamap & bit) {
+					const auto index = index_of(current->datamap, bit);
+					const auto& entry = values(current)[index];
+
+					if (Equal()(entry.first, key)) {
+						current = edit(current, owner);
+
+						values(current)[index].second = value;
+
+						return current;
+					}
+
+					//the slot has a value, so we move it and new value to a child
+					const auto child = merge(entry, Hash()(entry.first), value_type(key, value), hash, shift + bits, owner);
+
+					const auto result = rebuild(current, owner, current->datamap ^ bit, current->nodemap | bit, 0,
+						index, none, none, index_of(current->nodemap | bit, bit));
+
+					children(result)[index_of(result->nodemap, bit)] = child;
+
+					added = true;
+
+					return result;
+				}
+
+				if (current->nodemap & bit) {
+					current = edit(current, owner);
+
+					auto& child = children(current)[index_of(current->nodemap, bit)];
+
+					child = insert(child, key, value, hash, shift + bits, owner, added);
+
+					return current;
+				}
+
+				const auto index = index_of(current->datamap | bit, bit);
+				const auto result = rebuild(current, owner, current->datamap | bit, current->nodemap, 0, none, none, index, none);
+
+				new (values(result) + index)value_type(key, value);
+
+				added = true;
+
+				return result;
+			}
+
+			//erase the key, the key must be in the node
+			node* erase(node* current, const Key& key, size_t hash, size_type shift, uint64_t owner) {
+				const auto none = static_cast<size_type>(-1);
+
+				if (current->collisions != 0) {
+					const auto index = find_collision(current, key);
+
+					return rebuild(current, owner, 0, 0, current->collisions - 1, index, none, none, none);
+				}
+
+				const auto bit = bit_of(hash, shift);
+
+				if (current->datamap & bit) {
+					if (data_count(current) == 1 && node_count(current) == 0) {
+						release(current);
+
+						return nullptr;
+					}
+
+					return rebuild(current, owner, current->datamap ^ bit, current->nodemap, 0,
+						index_of(current->datamap, bit), none, none, none);
+				}
+
+				assert(current->nodemap & bit);
+
+				current = edit(current, owner);
+
+				const auto child_index = index_of(current->nodemap, bit);
+				const auto child = erase(children(current)[child_index], key, hash, shift + bits, owner);
+
+				assert(child != nullptr);
+
+				children(current)[child_index] = child;
+
+				//the child only has one value, so we move the value to this node
+				if (data_count(child) == 1 && node_count(child) == 0) {
+					auto entry = values(child)[0];
+
+					const auto index = index_of(current->datamap | bit, bit);
+					const auto result = rebuild(current, owner, current->datamap | bit, current->nodemap ^ bit, 0,
+						none, child_index, index, none);
+
+					new (values(result) + index)value_type(std::move(entry));
+
+					return result;
+				}
+
+				return current;
+			}
+
+			template<typename Function>
+			static void for_each(const node* current, Function& function) {
+				const auto entries = values(current);
+
+				for (size_type index = 0; index < data_count(current); index++)
+					function(static_cast<const value_type&>(entries[index]));
+
+				for (size_type index = 0; index < node_count(current); index++)
+					for_each(children(current)[index], function);
+			}
+
+			std::shared_ptr<context> mContext;
+
+			node* mRoot = nullptr;
+
+			size_type mSize = 0;
+		};
+	}
+
+	template<typename Key, typename Value, typename Hash = std::hash<Key>, typename Equal = std::equal_to<Key>>
+	class persistent_map {
+	public:
+		using size_type = size_t;
+		using key_type = Key;
+		using mapped_type = Value;
+		using value_type = std::pair<Key, Value>;
+		using transient_type = transient_map<Key, Value, Hash, Equal>;
+	public:
+		persistent_map() = default;
+
+		/**
+		 * \brief insert or replace the value of key
+		 * \return the new map
+		 */
+		auto insert(const Key& key, const Value& value) const -> persistent_map {
+			auto map = *this;
+
+			map.mData.insert(key, value, detail::persistent_new_owner());
+
+			return map;
+		}
+
+		/**
+		 * \brief erase the key
+		 * \return the new map, it shares all nodes if the key is not in map
+		 */
+		auto erase(const Key& key) const -> persistent_map {
+			auto map = *this;
+
+			map.mData.erase(key, detail::persistent_new_owner());
+
+			return map;
+		}
+
+		/**
+		 * \brief start a batch edit, the map is not changed
+		 * \return the transient map
+		 */
+		auto transient() const -> transient_type;
+
+		/**
+		 * \brief find the value of key
+		 * \return the pointer to value, nullptr if not found. It is valid while the map is alive.
+		 */
+		auto find(const Key& key) const -> const Value* { return mData.find(key); }
+
+		bool contains(const Key& key) const { return mData.find(key) != nullptr; }
+
+		template<typename Function>
+		void for_each(Function&& function) const { mData.for_each(function); }
+
+		size_type size() const { return mData.size(); }
+
+		bool empty() const { return mData.size() == 0; }
+	private:
+		friend class transient_map<Key, Value, Hash, Equal>;
+
+		detail::persistent_map_data<Key, Value, Hash, Equal> mData;
+	};
+
+	template<typename Key, typename Value, typename Hash = std::hash<Key>, typename Equal = std::equal_to<Key>>
+	class transient_map {
+	public:
+		using size_type = size_t;
+		using key_type = Key;
+		using mapped_type = Value;
+	public:
+		transient_map(const transient_map&) = delete;
+
+		transient_map(transient_map&& map) noexcept {
+			mData.swap(map.mData);
+
+			std::swap(mOwner, map.mOwner);
+		}
+
+		transient_map& insert(const Key& key, const Value& value) {
+			assert(mOwner != 0);
+
+			mData.insert(key, value, mOwner);
+
+			return *this;
+		}
+
+		bool erase(const Key& key) {
+			assert(mOwner != 0);
+
+			return mData.erase(key, mOwner);
+		}
+
+		/**
+		 * \brief finish the batch edit, the transient can not be used after it
+		 * \return the persistent map
+		 */
+		auto persistent() -> persistent_map<Key, Value, Hash, Equal> {
+			persistent_map<Key, Value, Hash, Equal> map;
+
+			map.mData.swap(mData);
+
+			mOwner = 0;
+
+			return map;
+		}
+
+		auto find(const Key& key) const -> const Value* { return mData.find(key); }
+
+		bool contains(const Key& key) const { return mData.find(key) != nullptr; }
+
+		size_type size() const { return mData.size(); }
+
+		bool empty() const { return mData.size() == 0; }
+	private:
+		friend class persistent_map<Key, Value, Hash, Equal>;
+
+		explicit transient_map(const detail::persistent_map_data<Key, Value, Hash, Equal>& data) :
+			mData(data), mOwner(detail::persistent_new_owner()) {}
+
+		detail::persistent_map_data<Key, Value, Hash, Equal> mData;
+
+		uint64_t mOwner = 0;
+	};
+
+	template<typename Key, typename Value, typename Hash, typename Equal>
+	auto persistent_map<Key, Value, Hash, Equal>::transient() const -> transient_type {
+		return transient_type(mData);
+	}
+}
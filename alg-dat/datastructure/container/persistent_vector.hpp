@@ -0,0 +1,496 @@
+#pragma once
+
+/*
+ * persistent_vector.hpp
+ * Persistent (immutable and structure sharing) vector, it is a 32-way trie with a tail.
+ * Every "modify" operation returns a new vector and the old one is not changed,
+ * the new vector only copy the path from root to the leaf, so push_back, pop_back and set are O(log32 n).
+ * Copy a vector is O(1), so a snapshot is only a copy. The readers of a snapshot never need locks.
+ *
+ * transient_vector is the batch edit mode. The nodes it created are owned by it and it edits them in place,
+ * so a batch of edits only copy the shared nodes once. Call "persistent()" to finish the batch edit.
+ *
+ * The nodes are reference counted (atomic) and allocated by pool_allocator of the context.
+ * The vectors created from same vector share the context, the pools are protected by the lock of context.
+ */
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "../../dependent/memory/pool_allocator.hpp"
+
+namespace alg_dat {
+
+	namespace detail {
+
+		//the owner of persistent node, a transient can edit the node if it is the owner.
+		//the owner id is never reused, so the nodes of a finished transient are never edited again.
+		inline auto persistent_new_owner() -> uint64_t {
+			static std::atomic<uint64_t> next_owner = { 1 };
+
+			return next_owner.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		struct persistent_node {
+			std::atomic<uint32_t> references = { 1 };
+			uint64_t owner = 0;
+
+			explicit persistent_node(uint64_t owner) : owner(owner) {}
+
+			void retain() { references.fetch_add(1, std::memory_order_relaxed); }
+
+			//return true if the node has no reference
+			bool release() { return references.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+		};
+	}
+
+	template<typename T>
+	class transient_vector;
+
+	namespace detail {
+
+		template<typename T>
+		class persistent_vector_data {
+		public:
+			using size_type = size_t;
+
+			static constexpr size_type bits = 5;
+			static constexpr size_type width = static_cast<size_type>(1) << bits;
+			static constexpr size_type mask = width - 1;
+
+			struct branch : persistent_node {
+				persistent_node* children[width] = {};
+
+				explicit branch(uint64_t owner) : persistent_node(owner) {}
+			};
+
+			struct leaf : persistent_node {
+				T values[width];
+
+				explicit leaf(uint64_t owner) : persistent_node(owner) {}
+			};
+
+			struct context {
+				std::mutex mutex;
+
+				pool_allocator<branch> branches;
+				pool_allocator<leaf> leaves;
+			};
+		public:
+			persistent_vector_data() = default;
+
+			persistent_vector_data(const persistent_vector_data& data) :
+				mContext(data.mContext), mRoot(data.mRoot), mTail(data.mTail), mSize(data.mSize), mShift(data.mShift)
+			{
+				if (mRoot != nullptr) mRoot->retain();
+				if (mTail != nullptr) mTail->retain();
+			}
+
+			persistent_vector_data(persistent_vector_data&& data) noexcept { swap(data); }
+
+			persistent_vector_data& operator=(persistent_vector_data data) noexcept {
+				swap(data);
+
+				return *this;
+			}
+
+			~persistent_vector_data() { reset(); }
+
+			void swap(persistent_vector_data& data) noexcept {
+				std::swap(mContext, data.mContext);
+				std::swap(mRoot, data.mRoot);
+				std::swap(mTail, data.mTail);
+				std::swap(mSize, data.mSize);
+				std::swap(mShift, data.mShift);
+			}
+
+			void reset() {
+				if (mRoot != nullptr) release(mRoot, mShift);
+				if (mTail != nullptr) release(mTail, 0);
+
+				mRoot = nullptr;
+				mTail = nullptr;
+				mSize = 0;
+				mShift = bits;
+			}
+
+			auto at(size_type index) const -> const T& {
+				assert(index < mSize);
+
+				if (index >= tail_offset()) return mTail->values[index & mask];
+
+				const persistent_node* node = mRoot;
+
+				for (auto level = mShift; level > 0; level -= bits)
+					node = static_cast<const branch*>(node)->children[(index >> level) & mask];
+
+				return static_cast<const leaf*>(node)->values[index & mask];
+			}
+
+			void push_back(const T& value, uint64_t owner) {
+				if (mContext == nullptr) mContext = std::make_shared<context>();
+
+				//there is space in tail
+				if (mSize - tail_offset() < width && mTail != nullptr) {
+					mTail = edit(mTail, owner);
+					mTail->values[mSize & mask] = value;
+					mSize++;
+
+					return;
+				}
+
+				if (mTail != nullptr) {
+					//the tree is full, so we need a new root
+					if ((mSize >> bits) > (static_cast<size_type>(1) << mShift)) {
+						const auto root = create_branch(owner);
+
+						root->children[0] = mRoot;
+						root->children[1] = new_path(mShift, mTail, owner);
+
+						mRoot = root;
+						mShift = mShift + bits;
+					}
+					else mRoot = push_tail(mShift, static_cast<branch*>(mRoot), mTail, owner);
+				}
+
+				mTail = create_leaf(owner);
+				mTail->values[0] = value;
+				mSize++;
+			}
+
+			void set(size_type index, const T& value, uint64_t owner) {
+				assert(index < mSize);
+
+				if (index >= tail_offset()) {
+					mTail = edit(mTail, owner);
+					mTail->values[index & mask] = value;
+
+					return;
+				}
+
+				auto node = edit(static_cast<branch*>(mRoot), mShift, owner);
+
+				mRoot = node;
+
+				for (auto level = mShift; level > bits; level -= bits) {
+					auto& child = node->children[(index >> level) & mask];
+
+					child = edit(static_cast<branch*>(child), level - bits, owner);
+					node = static_cast<branch*>(child);
+				}
+
+				auto& child = node->children[(index >> bits) & mask];
+
+				child = edit(static_cast<leaf*>(child), owner);
+
+				static_cast<leaf*>(child)->values[index & mask] = value;
+			}
+
+			void pop_back(uint64_t owner) {
+				assert(mSize != 0);
+
+				if (mSize == 1) {
+					reset();
+
+					return;
+				}
+
+				//the tail has more than one element
+				if (mSize - tail_offset() > 1) {
+					mTail = edit(mTail, owner);
+					mTail->values[(mSize - 1) & mask] = T();
+					mSize--;
+
+					return;
+				}
+
+				//the last leaf in tree become the new tail
+				const auto tail = leaf_for(mSize - 2);
+
+				tail->retain();
+
+				mRoot = pop_tail(mShift, static_cast<branch*>(mRoot), owner);
+
+				if (mRoot == nullptr) mShift = bits;
+
+				//the root only has one child, so we remove a level
+				if (mShift > bits && static_cast<branch*>(mRoot)->children[1] == nullptr) {
+					const auto root = static_cast<branch*>(mRoot)->children[0];
+
+					root->retain();
+
+					release(mRoot, mShift);
+
+					mRoot = root;
+					mShift = mShift - bits;
+				}
+
+				release(mTail, 0);
+
+				mTail = tail;
+				mSize--;
+			}
+
+			size_type size() const { return mSize; }
+		private:
+			size_type tail_offset() const { return mSize < width ? 0 : ((mSize - 1) >> bits) << bits; }
+
+			leaf* leaf_for(size_type index) const {
+				if (index >= tail_offset()) return mTail;
+
+				auto node = mRoot;
+
+				for (auto level = mShift; level > 0; level -= bits)
+					node = static_cast<branch*>(node)->children[(index >> level) & mask];
+
+				return static_cast<leaf*>(node);
+			}
+
+			branch* create_branch(uint64_t owner) {
+				std::lock_guard<std::mutex> lock(mContext->mutex);
+
+				return mContext->branches.construct(owner);
+			}
+
+			leaf* create_leaf(uint64_t owner) {
+				std::lock_guard<std::mutex> lock(mContext->mutex);
+
+				return mContext->leaves.construct(owner);
+			}
+
+			//return a node we can edit in place, the reference of old node is moved to the new node
+			branch* edit(branch* node, size_type level, uint64_t owner) {
+				if (node->owner == owner) return node;
+
+				const auto copy = create_branch(owner);
+
+				for (size_type index = 0; index < width; index++) {
+					copy->children[index] = node->children[index];
+
+					if (copy->children[index] != nullptr) copy->children[index]->retain();
+				}
+
+				release(node, level);
+
+				return copy;
+			}
+
+			leaf* edit(leaf* node, uint64_t owner) {
+				if (node->owner == owner) return node;
+
+				const auto copy = create_leaf(owner);
+
+				std::copy(node->values, node->values + width, copy->values);
+
+				release(node, 0);
+
+				return copy;
+			}
+
+			persistent_node* new_path(size_type level, persistent_node* node, uint64_t owner) {
+				if (level == 0) return node;
+
+				const auto path = create_branch(owner);
+
+				path->children[0] = new_path(level - bits, node, owner);
+
+				return path;
+			}
+
+			branch* push_tail(size_type level, branch* parent, leaf* tail, uint64_t owner) {
+				parent = parent == nullptr ? create_branch(owner) : edit(parent, level, owner);
+
+				auto& child = parent->children[((mSize - 1) >> level) & mask];
+
+				if (level == bits) child = tail;
+				else if (child == nullptr) child = new_path(level - bits, tail, owner);
+				else child = push_tail(level - bits, static_cast<branch*>(child), tail, owner);
+
+				return parent;
+			}
+
+			branch* pop_tail(size_type level, branch* node, uint64_t owner) {
+				node = edit(node, level, owner);
+
+				const auto index = ((mSize - 2) >> level) & mask;
+
+				auto& child = node->children[index];
+
+				if (level > bits) child = pop_tail(level - bits, static_cast<branch*>(child), owner);
+				else {
+					release(child, 0);
+
+					child = nullptr;
+				}
+
+				if (child == nullptr && index == 0) {
+					release(node, level);
+
+					return nullptr;
+				}
+
+				return node;
+			}
+
+			//release the reference of node, the level of leaf is 0
+			void release(persistent_node* node, size_type level) {
+				if (!node->release()) return;
+
+				if (level == 0) {
+					std::lock_guard<std::mutex> lock(mContext->mutex);
+
+					mContext->leaves.destroy(static_cast<leaf*>(node));
+
+					return;
+				}
+
+				const auto current = static_cast<branch*>(node);
+
+				for (auto child : current->children) if (child != nullptr) release(child, level - bits);
+
+				std::lock_guard<std::mutex> lock(mContext->mutex);
+
+				mContext->branches.destroy(current);
+			}
+
+			//the context is released at last, so the nodes can be destroyed in destructor
+			std::shared_ptr<context> mContext;
+
+			persistent_node* mRoot = nullptr;
+			leaf* mTail = nullptr;
+
+			size_type mSize = 0;
+			size_type mShift = bits;
+		};
+	}
+
+	template<typename T>
+	class persistent_vector {
+	public:
+		using size_type = size_t;
+		using type = T;
+		using transient_type = transient_vector<T>;
+	public:
+		persistent_vector() = default;
+
+		auto push_back(const T& value) const -> persistent_vector {
+			auto vector = *this;
+
+			vector.mData.push_back(value, detail::persistent_new_owner());
+
+			return vector;
+		}
+
+		auto pop_back() const -> persistent_vector {
+			auto vector = *this;
+
+			vector.mData.pop_back(detail::persistent_new_owner());
+
+			return vector;
+		}
+
+		auto set(size_type index, const T& value) const -> persistent_vector {
+			auto vector = *this;
+
+			vector.mData.set(index, value, detail::persistent_new_owner());
+
+			return vector;
+		}
+
+		/**
+		 * \brief start a batch edit, the vector is not changed
+		 * \return the transient vector
+		 */
+		auto transient() const -> transient_vector<T>;
+
+		auto operator[](size_type index) const -> const T& { return mData.at(index); }
+
+		auto at(size_type index) const -> const T& { return mData.at(index); }
+
+		auto front() const -> const T& { return mData.at(0); }
+
+		auto back() const -> const T& { return mData.at(mData.size() - 1); }
+
+		size_type size() const { return mData.size(); }
+
+		bool empty() const { return mData.size() == 0; }
+	private:
+		friend class transient_vector<T>;
+
+		detail::persistent_vector_data<T> mData;
+	};
+
+	template<typename T>
+	class transient_vector {
+	public:
+		using size_type = size_t;
+		using type = T;
+	public:
+		transient_vector(const transient_vector&) = delete;
+
+		transient_vector(transient_vector&& vector) noexcept {
+			mData.swap(vector.mData);
+
+			std::swap(mOwner, vector.mOwner);
+		}
+
+		transient_vector& push_back(const T& value) {
+			assert(mOwner != 0);
+
+			mData.push_back(value, mOwner);
+
+			return *this;
+		}
+
+		transient_vector& pop_back() {
+			assert(mOwner != 0);
+
+			mData.pop_back(mOwner);
+
+			return *this;
+		}
+
+		transient_vector& set(size_type index, const T& value) {
+			assert(mOwner != 0);
+
+			mData.set(index, value, mOwner);
+
+			return *this;
+		}
+
+		/**
+		 * \brief finish the batch edit, the transient can not be used after it
+		 * \return the persistent vector
+		 */
+		auto persistent() -> persistent_vector<T> {
+			persistent_vector<T> vector;
+
+			vector.mData.swap(mData);
+
+			mOwner = 0;
+
+			return vector;
+		}
+
+		auto operator[](size_type index) const -> const T& { return mData.at(index); }
+
+		size_type size() const { return mData.size(); }
+
+		bool empty() const { return mData.size() == 0; }
+	private:
+		friend class persistent_vector<T>;
+
+		explicit transient_vector(const detail::persistent_vector_data<T>& data) :
+			mData(data), mOwner(detail::persistent_new_owner()) {}
+
+		detail::persistent_vector_data<T> mData;
+
+		uint64_t mOwner = 0;
+	};
+
+	template <typename T>
+	auto persistent_vector<T>::transient() const -> transient_vector<T> {
+		return transient_vector<T>(mData);
+	}
+}
@@ -0,0 +1,306 @@
+#pragma once
+
+/*
+ * segment_tree.hpp
+ * Iterative (bottom-up) segment tree for range query of mutable array.
+ * The number of leaves is power of 2, the root is tree[1] and the leaves are [capacity, 2 * capacity).
+ * So the parent of node is node / 2 and there is no recursion for update and query.
+ *
+ * segment_tree : point update and range query, both O(log n).
+ * lazy_segment_tree : range add and range query with lazy propagation, both O(log n).
+ *
+ * Operation : a struct with "identity()" and "operator()(a, b)" to combine two values.
+ * The lazy_segment_tree also need "apply(value, add, length)" to add "add" to a node covering "length" leaves.
+ * See more in "segment_tree_sum", "segment_tree_min" and "segment_tree_max".
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "../../dependent/memory/aligned_buffer.hpp"
+
+namespace alg_dat {
+
+	template<typename T>
+	struct segment_tree_sum {
+		static T identity() { return T(0); }
+
+		static T apply(const T& value, const T& add, size_t length) { return value + add * static_cast<T>(length); }
+
+		T operator()(const T& left, const T& right) const { return left + right; }
+	};
+
+	template<typename T>
+	struct segment_tree_min {
+		static T identity() { return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max(); }
+
+		static T apply(const T& value, const T& add, size_t) { return value + add; }
+
+		T operator()(const T& left, const T& right) const { return right < left ? right : left; }
+	};
+
+	template<typename T>
+	struct segment_tree_max {
+		static T identity() { return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest(); }
+
+		static T apply(const T& value, const T& add, size_t) { return value + add; }
+
+		T operator()(const T& left, const T& right) const { return left < right ? right : left; }
+	};
+
+	template<typename T, typename Operation = segment_tree_sum<T>>
+	class segment_tree {
+	public:
+		using size_type = size_t;
+		using type = T;
+		using operation = Operation;
+	public:
+		segment_tree() = default;
+
+		explicit segment_tree(size_type size, Operation op = Operation()) :
+			mOperation(op), mSize(size), mCapacity(capacity_of(size))
+		{
+			mTree = aligned_buffer<T>(mCapacity << 1, Operation::identity());
+		}
+
+		segment_tree(const T* begin, const T* end, Operation op = Operation()) :
+			segment_tree(static_cast<size_type>(end - begin), op)
+		{
+			std::copy(begin, end, mTree.data() + mCapacity);
+
+			for (auto node = mCapacity - 1; node > 0; node--)
+				mTree[node] = mOperation(mTree[node << 1], mTree[node << 1 | 1]);
+		}
+
+		/**
+		 * \brief set array[index] to value
+		 * \param index the index of element
+		 * \param value the new value
+		 */
+		void set(size_type index, const T& value) {
+			assert(index < mSize);
+
+			auto node = index + mCapacity;
+
+			mTree[node] = value;
+
+			for (node = node >> 1; node > 0; node = node >> 1)
+				mTree[node] = mOperation(mTree[node << 1], mTree[node << 1 | 1]);
+		}
+
+		/**
+		 * \brief combine the elements in [first, last)
+		 * \param first the begin of range
+		 * \param last the end of range
+		 * \return the result, identity if the range is empty
+		 */
+		auto query(size_type first, size_type last) const -> T {
+			assert(first <= last && last <= mSize);
+
+			//we keep the left and right result to support the operation that is not commutative
+			T left = Operation::identity();
+			T right = Operation::identity();
+
+			for (first = first + mCapacity, last = last + mCapacity; first < last; first = first >> 1, last = last >> 1) {
+				if (first & 1) left = mOperation(left, mTree[first++]);
+				if (last & 1) right = mOperation(mTree[--last], right);
+			}
+
+			return mOperation(left, right);
+		}
+
+		auto at(size_type index) const -> const T& {
+			assert(index < mSize);
+
+			return mTree[index + mCapacity];
+		}
+
+		auto all() const -> const T& { return mTree[1]; }
+
+		size_type size() const { return mSize; }
+
+		size_type capacity() const { return mCapacity; }
+	private:
+		static size_type capacity_of(size_type size) {
+			size_type capacity = 1;
+
+			while (capacity < size) capacity = capacity << 1;
+
+			return capacity;
+		}
+	private:
+		aligned_buffer<T> mTree;
+		Operation mOperation;
+
+		size_type mSize = 0;
+		size_type mCapacity = 0;
+	};
+
+	template<typename T, typename Operation = segment_tree_sum<T>>
+	class lazy_segment_tree {
+	public:
+		using size_type = size_t;
+		using type = T;
+		using operation = Operation;
+	public:
+		lazy_segment_tree() = default;
+
+		explicit lazy_segment_tree(size_type size, Operation op = Operation()) :
+			mOperation(op), mSize(size)
+		{
+			allocate();
+
+			std::fill(mTree.data() + mCapacity, mTree.data() + mCapacity + mSize, T(0));
+
+			build();
+		}
+
+		lazy_segment_tree(const T* begin, const T* end, Operation op = Operation()) :
+			mOperation(op), mSize(static_cast<size_type>(end - begin))
+		{
+			allocate();
+
+			std::copy(begin, end, mTree.data() + mCapacity);
+
+			build();
+		}
+
+		/**
+		 * \brief add value to every element in [first, last)
+		 * \param first the begin of range
+		 * \param last the end of range
+		 * \param value the value we add
+		 */
+		void add(size_type first, size_type last, const T& value) {
+			assert(first <= last && last <= mSize);
+
+			if (first == last) return;
+
+			const auto left_leaf = first + mCapacity;
+			const auto right_leaf = last - 1 + mCapacity;
+
+			push(left_leaf);
+			push(right_leaf);
+
+			size_type length = 1;
+
+			for (first = left_leaf, last = right_leaf + 1; first < last; first = first >> 1, last = last >> 1, length = length << 1) {
+				if (first & 1) apply(first++, value, length);
+				if (last & 1) apply(--last, value, length);
+			}
+
+			pull(left_leaf);
+			pull(right_leaf);
+		}
+
+		/**
+		 * \brief set array[index] to value
+		 * \param index the index of element
+		 * \param value the new value
+		 */
+		void set(size_type index, const T& value) {
+			assert(index < mSize);
+
+			const auto leaf = index + mCapacity;
+
+			push(leaf);
+
+			mTree[leaf] = value;
+
+			pull(leaf);
+		}
+
+		/**
+		 * \brief combine the elements in [first, last)
+		 * \param first the begin of range
+		 * \param last the end of range
+		 * \return the result, identity if the range is empty
+		 */
+		auto query(size_type first, size_type last) -> T {
+			assert(first <= last && last <= mSize);
+
+			if (first == last) return Operation::identity();
+
+			push(first + mCapacity);
+			push(last - 1 + mCapacity);
+
+			T left = Operation::identity();
+			T right = Operation::identity();
+
+			for (first = first + mCapacity, last = last + mCapacity; first < last; first = first >> 1, last = last >> 1) {
+				if (first & 1) left = mOperation(left, mTree[first++]);
+				if (last & 1) right = mOperation(mTree[--last], right);
+			}
+
+			return mOperation(left, right);
+		}
+
+		auto at(size_type index) -> T { return query(index, index + 1); }
+
+		auto all() const -> const T& { return mTree[1]; }
+
+		size_type size() const { return mSize; }
+
+		size_type capacity() const { return mCapacity; }
+	private:
+		//allocate the buffers for mSize elements, the leaves in range are left to the caller
+		void allocate() {
+			mCapacity = 1;
+			mHeight = 0;
+
+			while (mCapacity < mSize) mCapacity = mCapacity << 1, mHeight++;
+
+			mTree = aligned_buffer<T>(mCapacity << 1);
+			mLazy = aligned_buffer<T>(mCapacity, T(0));
+
+			//the leaves out of range are identity, so they never change the result of query
+			std::fill(mTree.data() + mCapacity + mSize, mTree.data() + (mCapacity << 1), Operation::identity());
+		}
+
+		//compute the internal nodes from the leaves
+		void build() {
+			for (auto node = mCapacity - 1; node > 0; node--)
+				mTree[node] = mOperation(mTree[node << 1], mTree[node << 1 | 1]);
+		}
+
+		void apply(size_type node, const T& value, size_type length) {
+			mTree[node] = Operation::apply(mTree[node], value, length);
+
+			if (node < mCapacity) mLazy[node] = mLazy[node] + value;
+		}
+
+		//push the lazy value from root to the parent of leaf
+		void push(size_type leaf) {
+			for (auto shift = mHeight; shift > 0; shift--) {
+				const auto node = leaf >> shift;
+
+				if (mLazy[node] == T(0)) continue;
+
+				const auto length = static_cast<size_type>(1) << (shift - 1);
+
+				apply(node << 1, mLazy[node], length);
+				apply(node << 1 | 1, mLazy[node], length);
+
+				mLazy[node] = T(0);
+			}
+		}
+
+		//recompute the nodes from the parent of leaf to root
+		void pull(size_type leaf) {
+			size_type length = 2;
+
+			for (auto node = leaf >> 1; node > 0; node = node >> 1, length = length << 1) {
+				mTree[node] = Operation::apply(
+					mOperation(mTree[node << 1], mTree[node << 1 | 1]), mLazy[node], length);
+			}
+		}
+	private:
+		aligned_buffer<T> mTree;
+		aligned_buffer<T> mLazy;
+		Operation mOperation;
+
+		size_type mSize = 0;
+		size_type mCapacity = 0;
+		size_type mHeight = 0;
+	};
+}
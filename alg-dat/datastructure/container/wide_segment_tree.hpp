@@ -0,0 +1,293 @@
+#pragma once
+
+/*
+ * wide_segment_tree.hpp
+ * Wide-node (B-ary) segment tree for range query of mutable array.
+ * Every node has "Width" children and they are stored in one cache line, by default Width is the largest power of 2
+ * not more than 64 / sizeof(T), and at least 4 (the node of large T is larger than a cache line).
+ * So the height of tree is log_Width(n) and a query only touch about 2 * log_Width(n) cache lines.
+ *
+ * The levels are stored from leaves to root, and every level is padded to multiple of Width with identity.
+ * The children of node[i] in level k + 1 are [i * Width, (i + 1) * Width) in level k.
+ *
+ * The part of a node in query is reduced with SIMD instructions (see "wide_node_reduce"),
+ * there are SSE versions for float/int32_t with segment_tree_sum/min/max, others use the scalar loop.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "segment_tree.hpp"
+
+namespace alg_dat {
+
+	namespace detail {
+
+		//the default width of node, the largest power of 2 not more than cache_line_size / size, and at least 4
+		constexpr size_t wide_segment_tree_width(size_t size) {
+			size_t width = 4;
+
+			while (width * 2 * size <= cache_line_size) width = width * 2;
+
+			return width;
+		}
+	}
+
+	/**
+	 * \brief reduce the elements [first, last) of a node, the scalar version
+	 */
+	template<typename T, typename Operation, size_t Width>
+	struct wide_node_reduce {
+		static T reduce(const T* node, size_t first, size_t last, const Operation& op) {
+			T result = Operation::identity();
+
+			for (auto index = first; index < last; index++) result = op(result, node[index]);
+
+			return result;
+		}
+	};
+
+#ifdef ALG_DAT_SSE2
+	namespace detail {
+
+		//the lanes in [first, last) are kept and others are set to identity
+		inline __m128i wide_node_mask(size_t index, size_t first, size_t last) {
+			const auto lane = _mm_add_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(static_cast<int>(index)));
+
+			return _mm_and_si128(
+				_mm_cmpgt_epi32(lane, _mm_set1_epi32(static_cast<int>(first) - 1)),
+				_mm_cmplt_epi32(lane, _mm_set1_epi32(static_cast<int>(last))));
+		}
+
+		template<typename Combine>
+		float wide_node_reduce_ps(const float* node, size_t first, size_t last, float identity, Combine combine) {
+			const auto fill = _mm_set1_ps(identity);
+
+			auto result = fill;
+
+			//only the vectors contain [first, last) are loaded
+			for (auto index = first & ~static_cast<size_t>(3); index < last; index += 4) {
+				const auto mask = _mm_castsi128_ps(wide_node_mask(index, first, last));
+				const auto value = _mm_load_ps(node + index);
+
+				result = combine(result, _mm_or_ps(_mm_and_ps(mask, value), _mm_andnot_ps(mask, fill)));
+			}
+
+			result = combine(result, _mm_shuffle_ps(result, result, _MM_SHUFFLE(1, 0, 3, 2)));
+			result = combine(result, _mm_shuffle_ps(result, result, _MM_SHUFFLE(2, 3, 0, 1)));
+
+			return _mm_cvtss_f32(result);
+		}
+
+		template<typename Combine>
+		int32_t wide_node_reduce_epi32(const int32_t* node, size_t first, size_t last, int32_t identity, Combine combine) {
+			const auto fill = _mm_set1_epi32(identity);
+
+			auto result = fill;
+
+			for (auto index = first & ~static_cast<size_t>(3); index < last; index += 4) {
+				const auto mask = wide_node_mask(index, first, last);
+				const auto value = _mm_load_si128(reinterpret_cast<const __m128i*>(node + index));
+
+				result = combine(result, _mm_or_si128(_mm_and_si128(mask, value), _mm_andnot_si128(mask, fill)));
+			}
+
+			result = combine(result, _mm_shuffle_epi32(result, _MM_SHUFFLE(1, 0, 3, 2)));
+			result = combine(result, _mm_shuffle_epi32(result, _MM_SHUFFLE(2, 3, 0, 1)));
+
+			return _mm_cvtsi128_si32(result);
+		}
+	}
+
+	template<size_t Width>
+	struct wide_node_reduce<float, segment_tree_sum<float>, Width> {
+		static float reduce(const float* node, size_t first, size_t last, const segment_tree_sum<float>&) {
+			return detail::wide_node_reduce_ps(node, first, last, 0.0f,
+				[](__m128 a, __m128 b) { return _mm_add_ps(a, b); });
+		}
+	};
+
+	template<size_t Width>
+	struct wide_node_reduce<float, segment_tree_min<float>, Width> {
+		static float reduce(const float* node, size_t first, size_t last, const segment_tree_min<float>&) {
+			return detail::wide_node_reduce_ps(node, first, last, segment_tree_min<float>::identity(),
+				[](__m128 a, __m128 b) { return _mm_min_ps(a, b); });
+		}
+	};
+
+	template<size_t Width>
+	struct wide_node_reduce<float, segment_tree_max<float>, Width> {
+		static float reduce(const float* node, size_t first, size_t last, const segment_tree_max<float>&) {
+			return detail::wide_node_reduce_ps(node, first, last, segment_tree_max<float>::identity(),
+				[](__m128 a, __m128 b) { return _mm_max_ps(a, b); });
+		}
+	};
+
+	template<size_t Width>
+	struct wide_node_reduce<int32_t, segment_tree_sum<int32_t>, Width> {
+		static int32_t reduce(const int32_t* node, size_t first, size_t last, const segment_tree_sum<int32_t>&) {
+			return detail::wide_node_reduce_epi32(node, first, last, 0,
+				[](__m128i a, __m128i b) { return _mm_add_epi32(a, b); });
+		}
+	};
+
+#ifdef ALG_DAT_SSE41
+	template<size_t Width>
+	struct wide_node_reduce<int32_t, segment_tree_min<int32_t>, Width> {
+		static int32_t reduce(const int32_t* node, size_t first, size_t last, const segment_tree_min<int32_t>&) {
+			return detail::wide_node_reduce_epi32(node, first, last, segment_tree_min<int32_t>::identity(),
+				[](__m128i a, __m128i b) { return _mm_min_epi32(a, b); });
+		}
+	};
+
+	template<size_t Width>
+	struct wide_node_reduce<int32_t, segment_tree_max<int32_t>, Width> {
+		static int32_t reduce(const int32_t* node, size_t first, size_t last, const segment_tree_max<int32_t>&) {
+			return detail::wide_node_reduce_epi32(node, first, last, segment_tree_max<int32_t>::identity(),
+				[](__m128i a, __m128i b) { return _mm_max_epi32(a, b); });
+		}
+	};
+#endif
+#endif
+
+	template<typename T, typename Operation = segment_tree_sum<T>,
+		size_t Width = detail::wide_segment_tree_width(sizeof(T))>
+	class wide_segment_tree {
+		static_assert(Width >= 4 && (Width & (Width - 1)) == 0, "the width of node must be power of 2 and at least 4.");
+	public:
+		using size_type = size_t;
+		using type = T;
+		using operation = Operation;
+		using reducer = wide_node_reduce<T, Operation, Width>;
+
+		static constexpr size_type width = Width;
+	public:
+		wide_segment_tree() = default;
+
+		explicit wide_segment_tree(size_type size, Operation op = Operation()) :
+			mOperation(op), mSize(size)
+		{
+			allocate();
+
+			std::fill(mTree.data(), mTree.data() + mSize, T(0));
+
+			build();
+		}
+
+		wide_segment_tree(const T* begin, const T* end, Operation op = Operation()) :
+			mOperation(op), mSize(static_cast<size_type>(end - begin))
+		{
+			allocate();
+
+			std::copy(begin, end, mTree.data());
+
+			build();
+		}
+
+		/**
+		 * \brief set array[index] to value
+		 * \param index the index of element
+		 * \param value the new value
+		 */
+		void set(size_type index, const T& value) {
+			assert(index < mSize);
+
+			mTree[index] = value;
+
+			for (size_type level = 1; level < mLevels.size(); level++) {
+				const auto node = index / Width;
+
+				mTree[mLevels[level] + node] = reducer::reduce(
+					mTree.data() + mLevels[level - 1] + node * Width, 0, Width, mOperation);
+
+				index = node;
+			}
+		}
+
+		/**
+		 * \brief combine the elements in [first, last)
+		 * \param first the begin of range
+		 * \param last the end of range
+		 * \return the result, identity if the range is empty
+		 */
+		auto query(size_type first, size_type last) const -> T {
+			assert(first <= last && last <= mSize);
+
+			T left = Operation::identity();
+			T right = Operation::identity();
+
+			for (size_type level = 0; first < last; level++) {
+				const auto values = mTree.data() + mLevels[level];
+				const auto left_node = first / Width;
+				const auto right_node = (last - 1) / Width;
+
+				//the range is in one node, so we reduce it and finish
+				if (left_node == right_node) {
+					const auto middle = reducer::reduce(values + left_node * Width,
+						first - left_node * Width, last - left_node * Width, mOperation);
+
+					return mOperation(mOperation(left, middle), right);
+				}
+
+				left = mOperation(left, reducer::reduce(values + left_node * Width,
+					first - left_node * Width, Width, mOperation));
+				right = mOperation(reducer::reduce(values + right_node * Width,
+					0, last - right_node * Width, mOperation), right);
+
+				//the nodes between them are reduced in next level
+				first = left_node + 1;
+				last = right_node;
+			}
+
+			return mOperation(left, right);
+		}
+
+		auto at(size_type index) const -> const T& {
+			assert(index < mSize);
+
+			return mTree[index];
+		}
+
+		auto all() const -> T { return query(0, mSize); }
+
+		size_type size() const { return mSize; }
+
+		size_type height() const { return mLevels.size(); }
+	private:
+		//allocate the levels for mSize elements, the paddings are identity and the leaves in range are left to the caller
+		void allocate() {
+			//compute the offset of every level, the last level is the root node
+			size_type offset = 0;
+			size_type count = mSize;
+
+			do {
+				const auto padded = ((count + Width - 1) / Width) * Width;
+
+				mLevels.push_back(offset);
+
+				offset = offset + std::max(padded, Width);
+				count = (count + Width - 1) / Width;
+			} while (count > 1);
+
+			mTree = aligned_buffer<T>(offset, Operation::identity());
+		}
+
+		void build() {
+			for (size_type level = 1; level < mLevels.size(); level++) {
+				const auto count = mLevels[level] - mLevels[level - 1];
+
+				for (size_type node = 0; node * Width < count; node++) {
+					mTree[mLevels[level] + node] = reducer::reduce(
+						mTree.data() + mLevels[level - 1] + node * Width, 0, Width, mOperation);
+				}
+			}
+		}
+	private:
+		aligned_buffer<T> mTree;
+		std::vector<size_type> mLevels;
+		Operation mOperation;
+
+		size_type mSize = 0;
+	};
+}
@@ -0,0 +1,394 @@
+#pragma once
+
+/*
+ * bvh.hpp
+ * Bounding volume hierarchy of 2D boxes, it is built as LBVH (linear BVH) :
+ * 1. compute the Morton code of the center of every box, 16 bits per axis, in parallel.
+ * 2. sort the boxes by Morton code with radix_sort.
+ * 3. build the binary radix tree of codes (Karras 2012), every internal node is computed independently in parallel.
+ * 4. flatten the tree in depth-first order, the subtree with at most leaf_size boxes becomes a leaf.
+ * 5. compute the bounds of nodes from leaves to root (refit).
+ *
+ * The nodes are stored in depth-first order, so the left child of node i is node i + 1.
+ * Every node stores "escape", the index of the node after its subtree,
+ * so the traversal is stackless : go to i + 1 if the node is hit, otherwise go to escape.
+ * The right child of internal node i is node[i + 1].escape, the refit visits nodes in reverse order.
+ *
+ * bvh_options::pool : the thread pool of parallel build and refit, nullptr means sequential.
+ * The codes are sorted by the parallel radix_sort, and the parallel steps are the parallel_for of pool.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "../../dependent/thread_pool.hpp"
+#include "../../algorithm/radix_sort.hpp"
+#include "../../dependent/memory/aligned_buffer.hpp"
+#include "../../dependent/bounds2.hpp"
+#include "../../dependent/morton.hpp"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace alg_dat {
+
+	struct bvh_options {
+		thread_pool* pool = nullptr;
+		size_t leaf_size = 4;
+	};
+
+	namespace detail {
+
+		//the minimum number of elements per range of parallel steps
+		constexpr size_t bvh_min_work = static_cast<size_t>(1) << 14;
+
+		inline auto bvh_leading_zeros(uint32_t bits) -> int {
+			assert(bits != 0);
+#ifdef _MSC_VER
+			unsigned long index = 0;
+
+			_BitScanReverse(&index, bits);
+
+			return 31 - static_cast<int>(index);
+#else
+			return __builtin_clz(bits);
+#endif
+		}
+
+		//call function(first, last) for the ranges of [0, count) in the pool, a range has at least bvh_min_work elements
+		template<typename Function>
+		void bvh_parallel_for(thread_pool* pool, size_t count, Function&& function) {
+			if (pool == nullptr || pool->thread_count() == 1 || count < bvh_min_work * 2) { function(static_cast<size_t>(0), count); return; }
+
+			pool->parallel_for(0, count, function, bvh_min_work);
+		}
+	}
+
+	template<typename T = real>
+	class bvh2 {
+	public:
+		using size_type = size_t;
+		using bounds_type = bounds2_t<T>;
+		using vec_type = vec2_t<T>;
+
+		struct alignas(sizeof(T) * 8) node {
+			bounds_type bounds;
+
+			//the index of node after the subtree
+			uint32_t escape;
+
+			//the leaf has [first, first + count) boxes of the sorted boxes, the internal node has count = 0
+			uint32_t first;
+			uint32_t count;
+
+			bool leaf() const { return count != 0; }
+		};
+	public:
+		bvh2() = default;
+
+		/**
+		 * \brief build the bvh
+		 * \param begin the first box
+		 * \param end the end of boxes, the index of box is the offset from begin
+		 * \param options the options
+		 */
+		bvh2(const bounds_type* begin, const bounds_type* end, const bvh_options& options = bvh_options()) :
+			mOptions(options)
+		{
+			assert(end - begin < static_cast<ptrdiff_t>(std::numeric_limits<uint32_t>::max()));
+			assert(options.leaf_size != 0);
+
+			build(begin, static_cast<size_type>(end - begin));
+		}
+
+		/**
+		 * \brief update the bounds of boxes and nodes, the topology is not changed
+		 * \param bounds the new bounds of boxes, bounds[index] is the box with index. It has size() boxes
+		 */
+		void refit(const bounds_type* bounds) {
+			detail::bvh_parallel_for(mOptions.pool, size(), [&](size_t first, size_t last) {
+				for (auto index = first; index < last; index++) mBounds[index] = bounds[mIndices[index]];
+			});
+
+			refit();
+		}
+
+		/**
+		 * \brief visit the boxes overlap with bounds
+		 * \param bounds the query box
+		 * \param visitor visitor(index), the index of box
+		 */
+		template<typename Visitor>
+		void query(const bounds_type& bounds, Visitor&& visitor) const {
+			traverse(
+				[&](const bounds_type& box) { return box.overlap(bounds); },
+				[&](size_type index) { visitor(static_cast<size_type>(mIndices[index])); });
+		}
+
+		/**
+		 * \brief visit the boxes contain the point
+		 * \param point the query point
+		 * \param visitor visitor(index), the index of box
+		 */
+		template<typename Visitor>
+		void query(const vec_type& point, Visitor&& visitor) const {
+			traverse(
+				[&](const bounds_type& box) { return box.contains(point); },
+				[&](size_type index) { visitor(static_cast<size_type>(mIndices[index])); });
+		}
+
+		/**
+		 * \brief visit the boxes hit by ray origin + direction * t, t in [0, distance]
+		 * The boxes are not visited in order of distance, the visitor shrinks the distance to skip the far boxes.
+		 * \param origin the origin of ray
+		 * \param direction the direction of ray, it need not be normalized
+		 * \param distance the max t
+		 * \param visitor visitor(index, t) -> T, t is the entry of box and it returns the new max t (e.g. the t of hit)
+		 */
+		template<typename Visitor>
+		void raycast(const vec_type& origin, const vec_type& direction, T distance, Visitor&& visitor) const {
+			//the axis of zero direction has no inverse, the ray is in its slab or misses the box
+			const auto inverse = vec_type(direction.x != T(0) ? T(1) / direction.x : T(0), direction.y != T(0) ? T(1) / direction.y : T(0));
+
+			T entry = 0;
+
+			const auto slab = [](T minimum, T maximum, T start, T step, T scale, T& near, T& far) {
+				if (step == T(0)) return minimum <= start && start <= maximum;
+
+				const auto t0 = (minimum - start) * scale;
+				const auto t1 = (maximum - start) * scale;
+
+				near = std::max(near, std::min(t0, t1));
+				far = std::min(far, std::max(t0, t1));
+
+				return true;
+			};
+
+			const auto hit = [&](const bounds_type& box) {
+				T near = 0;
+				T far = distance;
+
+				if (!slab(box.min.x, box.max.x, origin.x, direction.x, inverse.x, near, far)) return false;
+				if (!slab(box.min.y, box.max.y, origin.y, direction.y, inverse.y, near, far)) return false;
+
+				entry = near;
+
+				return near <= far;
+			};
+
+			traverse(hit, [&](size_type index) { distance = std::min(distance, visitor(static_cast<size_type>(mIndices[index]), entry)); });
+		}
+
+		auto nodes() const -> const node* { return mNodes.data(); }
+
+		size_type node_count() const { return mNodes.size(); }
+
+		size_type size() const { return mIndices.size(); }
+
+		bool empty() const { return mIndices.empty(); }
+
+		//the bounds of all boxes
+		auto bounds() const -> bounds_type { return mNodes.empty() ? bounds_type() : mNodes[0].bounds; }
+	private:
+		struct code_entry {
+			uint32_t code;
+			uint32_t index;
+		};
+
+		//the child of radix tree, leaf (one box) if the highest bit is set
+		static constexpr uint32_t leaf_flag = static_cast<uint32_t>(1) << 31;
+
+		struct radix_node {
+			uint32_t left;
+			uint32_t right;
+			uint32_t first;
+			uint32_t last;
+		};
+
+		void build(const bounds_type* boxes, size_type size) {
+			if (size == 0) return;
+
+			const auto pool = mOptions.pool;
+
+			//the Morton code of center in the bounds of centers
+			bounds_type centers;
+
+			for (size_type index = 0; index < size; index++) centers.expand(boxes[index].center());
+
+			const auto extent = centers.size();
+			const auto scale = vec_type(
+				extent.x > T(0) ? T(65535) / extent.x : T(0),
+				extent.y > T(0) ? T(65535) / extent.y : T(0));
+
+			std::vector<code_entry> codes(size);
+
+			detail::bvh_parallel_for(pool, size, [&](size_t first, size_t last) {
+				for (auto index = first; index < last; index++) {
+					const auto cell = (boxes[index].center() - centers.min) * scale;
+
+					codes[index].code = morton_code2(static_cast<uint32_t>(cell.x), static_cast<uint32_t>(cell.y));
+					codes[index].index = static_cast<uint32_t>(index);
+				}
+			});
+
+			radix_sort<uint32_t, code_entry>(codes.data(), codes.data() + size,
+				[](const code_entry& entry) { return entry.code; }, radix_sort_options{ pool });
+
+			mIndices.resize(size);
+			mBounds.resize(size);
+
+			for (size_type index = 0; index < size; index++) {
+				mIndices[index] = codes[index].index;
+				mBounds[index] = boxes[codes[index].index];
+			}
+
+			//the tree has at most 2 * size - 1 nodes
+			mNodes.clear();
+			mNodes.reserve((size << 1) - 1);
+
+			if (size == 1) {
+				mNodes.push_back({ bounds_type(), 0, 0, 1 });
+				mNodes[0].escape = 1;
+			}
+			else {
+				std::vector<radix_node> tree(size - 1);
+
+				detail::bvh_parallel_for(pool, size - 1, [&](size_t first, size_t last) {
+					for (auto index = first; index < last; index++) tree[index] = build_radix_node(codes, index);
+				});
+
+				flatten(tree, 0);
+			}
+
+			refit();
+		}
+
+		//the length of common prefix of codes[i] and codes[j], the index is used if the codes are same
+		static auto delta(const std::vector<code_entry>& codes, int64_t i, int64_t j) -> int {
+			if (j < 0 || j >= static_cast<int64_t>(codes.size())) return -1;
+
+			const auto c0 = codes[static_cast<size_t>(i)].code;
+			const auto c1 = codes[static_cast<size_t>(j)].code;
+
+			if (c0 == c1) return 32 + detail::bvh_leading_zeros(static_cast<uint32_t>(i ^ j));
+
+			return detail::bvh_leading_zeros(c0 ^ c1);
+		}
+
+		//find the range and split of internal node i, see "Maximizing Parallelism in the Construction of BVHs, Octrees, and k-d Trees"
+		static auto build_radix_node(const std::vector<code_entry>& codes, size_type node_index) -> radix_node {
+			const auto i = static_cast<int64_t>(node_index);
+			const auto direction = delta(codes, i, i + 1) - delta(codes, i, i - 1) >= 0 ? 1 : -1;
+			const auto min_delta = delta(codes, i, i - direction);
+
+			//the upper bound of length of range
+			int64_t max_length = 2;
+
+			while (delta(codes, i, i + max_length * direction) > min_delta) max_length = max_length << 1;
+
+			//the length of range by binary search
+			int64_t length = 0;
+
+			for (auto step = max_length >> 1; step >= 1; step = step >> 1)
+				if (delta(codes, i, i + (length + step) * direction) > min_delta) length = length + step;
+
+			const auto j = i + length * direction;
+			const auto node_delta = delta(codes, i, j);
+
+			//the split position by binary search
+			int64_t split = 0;
+			int64_t divisor = 2;
+
+			for (auto step = (length + divisor - 1) / divisor; ; step = (length + divisor - 1) / divisor) {
+				if (delta(codes, i, i + (split + step) * direction) > node_delta) split = split + step;
+
+				if (step == 1) break;
+
+				divisor = divisor << 1;
+			}
+
+			const auto gamma = i + split * direction + std::min(direction, 0);
+			const auto first = static_cast<uint32_t>(std::min(i, j));
+			const auto last = static_cast<uint32_t>(std::max(i, j));
+
+			radix_node result;
+
+			result.left = static_cast<uint32_t>(gamma) | (first == static_cast<uint32_t>(gamma) ? leaf_flag : 0);
+			result.right = static_cast<uint32_t>(gamma + 1) | (last == static_cast<uint32_t>(gamma + 1) ? leaf_flag : 0);
+			result.first = first;
+			result.last = last;
+
+			return result;
+		}
+
+		//emit the subtree in depth-first order, the depth of radix tree is at most 64 so recursion is fine
+		void flatten(const std::vector<radix_node>& tree, uint32_t child) {
+			const auto position = mNodes.size();
+
+			const auto first = child & leaf_flag ? child & ~leaf_flag : tree[child].first;
+			const auto last = child & leaf_flag ? child & ~leaf_flag : tree[child].last;
+			const auto count = last - first + 1;
+
+			mNodes.push_back({ bounds_type(), 0, first, 0 });
+
+			if (count <= mOptions.leaf_size) mNodes[position].count = count;
+			else {
+				flatten(tree, tree[child].left);
+				flatten(tree, tree[child].right);
+			}
+
+			mNodes[position].escape = static_cast<uint32_t>(mNodes.size());
+		}
+
+		//the children are after the parent, so we compute the bounds in reverse order
+		void refit() {
+			for (auto index = mNodes.size(); index-- > 0; ) {
+				auto& current = mNodes[index];
+
+				bounds_type bounds;
+
+				if (current.leaf()) {
+					for (auto box = current.first; box < current.first + current.count; box++) bounds.expand(mBounds[box]);
+				}
+				else {
+					const auto& left = mNodes[index + 1];
+
+					bounds = bounds_type::merge(left.bounds, mNodes[left.escape].bounds);
+				}
+
+				current.bounds = bounds;
+			}
+		}
+
+		//the stackless traversal, visit(index) is called for the sorted boxes pass the test
+		template<typename Test, typename Visit>
+		void traverse(Test&& test, Visit&& visit) const {
+			size_type index = 0;
+
+			while (index < mNodes.size()) {
+				const auto& current = mNodes[index];
+
+				if (!test(current.bounds)) { index = current.escape; continue; }
+
+				if (current.leaf()) {
+					for (auto box = current.first; box < current.first + current.count; box++)
+						if (test(mBounds[box])) visit(box);
+				}
+
+				index++;
+			}
+		}
+	private:
+		bvh_options mOptions;
+
+		std::vector<node> mNodes;
+
+		//the boxes sorted by Morton code and their original indices
+		aligned_buffer<uint32_t> mIndices;
+		aligned_buffer<bounds_type> mBounds;
+	};
+}
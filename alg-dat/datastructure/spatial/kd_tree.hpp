@@ -0,0 +1,300 @@
+#pragma once
+
+/*
+ * kd_tree.hpp
+ * Static 2D k-d tree of points for k nearest neighbors and radius queries.
+ *
+ * The tree is implicit, there is no pointer or node :
+ * the points of subtree are [first, last) of the array and the root of subtree is the median mid = (first + last) / 2,
+ * so the left subtree is [first, mid) and the right subtree is [mid + 1, last).
+ * The split axis is x at even depth and y at odd depth.
+ * It is built by std::nth_element level by level, the large subtrees are built in parallel by the join of pool.
+ *
+ * The kNN keeps the k nearest points in a bounded max-heap, the far subtree is skipped if the split plane
+ * is farther than the top of heap. The batched query sorts the queries by Morton code first,
+ * so the nearby queries are processed one after another and they visit the same nodes (which are in cache),
+ * then the sorted queries are divided by the parallel_for of pool.
+ *
+ * kd_tree_options::pool : the thread pool of parallel build and batched query, nullptr means sequential.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "../../dependent/thread_pool.hpp"
+#include "../../algorithm/radix_sort.hpp"
+#include "../../dependent/memory/aligned_buffer.hpp"
+#include "../../dependent/bounds2.hpp"
+#include "../../dependent/morton.hpp"
+
+namespace alg_dat {
+
+	struct kd_tree_options {
+		thread_pool* pool = nullptr;
+	};
+
+	namespace detail {
+
+		//the subtrees smaller than it are built sequentially
+		constexpr size_t kd_tree_min_work = static_cast<size_t>(1) << 14;
+	}
+
+	template<typename T = real>
+	class kd_tree2 {
+	public:
+		using size_type = size_t;
+		using vec_type = vec2_t<T>;
+
+		struct entry {
+			vec_type point;
+			uint32_t index;
+		};
+	public:
+		kd_tree2() = default;
+
+		/**
+		 * \brief build the tree
+		 * \param begin the first point
+		 * \param end the end of points, the index of point is the offset from begin
+		 * \param options the options
+		 */
+		kd_tree2(const vec_type* begin, const vec_type* end, const kd_tree_options& options = kd_tree_options()) :
+			mOptions(options), mEntries(static_cast<size_type>(end - begin))
+		{
+			assert(end - begin < static_cast<ptrdiff_t>(std::numeric_limits<uint32_t>::max()));
+
+			for (size_type index = 0; index < size(); index++) mEntries[index] = { begin[index], static_cast<uint32_t>(index) };
+
+			build(0, size(), 0);
+		}
+
+		/**
+		 * \brief find the k nearest points
+		 * \param point the query point
+		 * \param k the number of points
+		 * \param indices the indices of points, sorted by distance. It should have k elements
+		 * \param distances the squared distances, it can be nullptr
+		 * \return the number of points found, min(k, size())
+		 */
+		size_type nearest(const vec_type& point, size_type k, uint32_t* indices, T* distances = nullptr) const {
+			std::vector<neighbor> heap;
+
+			return nearest(point, k, heap, indices, distances);
+		}
+
+		/**
+		 * \brief find the k nearest points of every query
+		 * \param points the query points
+		 * \param count the number of queries
+		 * \param k the number of points of every query
+		 * \param indices the result of query i is [indices + i * k, indices + (i + 1) * k), see nearest
+		 * \param distances the squared distances with same layout of indices, it can be nullptr
+		 * \param counts the number of points found of every query, it can be nullptr
+		 */
+		void nearest(const vec_type* points, size_type count, size_type k,
+			uint32_t* indices, T* distances = nullptr, uint32_t* counts = nullptr) const
+		{
+			const auto order = morton_order(points, count, mOptions.pool);
+
+			const auto worker = [&](size_type first, size_type last) {
+				std::vector<neighbor> heap;
+
+				for (auto position = first; position < last; position++) {
+					const auto query = order[position];
+
+					const auto found = nearest(points[query], k, heap, indices + query * k,
+						distances == nullptr ? nullptr : distances + query * k);
+
+					if (counts != nullptr) counts[query] = static_cast<uint32_t>(found);
+				}
+			};
+
+			if (mOptions.pool != nullptr) mOptions.pool->parallel_for(0, count, worker);
+			else worker(0, count);
+		}
+
+		/**
+		 * \brief visit the points in the circle
+		 * \param point the center of circle
+		 * \param radius the radius, the points on the circle are included
+		 * \param visitor visitor(index, squared distance)
+		 */
+		template<typename Visitor>
+		void radius(const vec_type& point, T radius, Visitor&& visitor) const {
+			search_radius(point, radius * radius, 0, size(), 0, visitor);
+		}
+
+		auto entries() const -> const entry* { return mEntries.data(); }
+
+		size_type size() const { return mEntries.size(); }
+
+		bool empty() const { return mEntries.empty(); }
+	private:
+		struct neighbor {
+			T distance;
+			uint32_t index;
+
+			bool operator<(const neighbor& other) const { return distance < other.distance; }
+		};
+
+		//the subtree is small enough, we scan it instead of splitting
+		static constexpr size_type scan_size = 8;
+
+		static T squared_distance(const vec_type& v0, const vec_type& v1) {
+			const auto difference = v0 - v1;
+
+			return vec_type::dot(difference, difference);
+		}
+
+		void build(size_type first, size_type last, size_type depth) {
+			if (last - first <= 1) return;
+
+			const auto mid = (first + last) >> 1;
+			const auto axis = depth & 1;
+
+			std::nth_element(mEntries.begin() + first, mEntries.begin() + mid, mEntries.begin() + last,
+				[axis](const entry& e0, const entry& e1) { return e0.point[axis] < e1.point[axis]; });
+
+			if (mOptions.pool != nullptr && last - first >= detail::kd_tree_min_work) {
+				mOptions.pool->join(
+					[&]() { build(first, mid, depth + 1); },
+					[&]() { build(mid + 1, last, depth + 1); });
+
+				return;
+			}
+
+			build(first, mid, depth + 1);
+			build(mid + 1, last, depth + 1);
+		}
+
+		size_type nearest(const vec_type& point, size_type k, std::vector<neighbor>& heap, uint32_t* indices, T* distances) const {
+			heap.clear();
+
+			if (k == 0) return 0;
+
+			search_nearest(point, k, 0, size(), 0, heap);
+
+			//the heap is max-heap, sort_heap makes it ascending
+			std::sort_heap(heap.begin(), heap.end());
+
+			for (size_type index = 0; index < heap.size(); index++) {
+				indices[index] = heap[index].index;
+
+				if (distances != nullptr) distances[index] = heap[index].distance;
+			}
+
+			return heap.size();
+		}
+
+		static void push_neighbor(std::vector<neighbor>& heap, size_type k, const neighbor& current) {
+			if (heap.size() < k) {
+				heap.push_back(current);
+				std::push_heap(heap.begin(), heap.end());
+
+				return;
+			}
+
+			if (!(current < heap.front())) return;
+
+			std::pop_heap(heap.begin(), heap.end());
+			heap.back() = current;
+			std::push_heap(heap.begin(), heap.end());
+		}
+
+		void search_nearest(const vec_type& point, size_type k, size_type first, size_type last, size_type depth,
+			std::vector<neighbor>& heap) const
+		{
+			if (last - first <= scan_size) {
+				for (auto index = first; index < last; index++)
+					push_neighbor(heap, k, { squared_distance(point, mEntries[index].point), mEntries[index].index });
+
+				return;
+			}
+
+			const auto mid = (first + last) >> 1;
+			const auto& current = mEntries[mid];
+			const auto difference = point[depth & 1] - current.point[depth & 1];
+
+			push_neighbor(heap, k, { squared_distance(point, current.point), current.index });
+
+			//visit the side of point first, the other side is visited if the split plane is in the k-th circle
+			if (difference < 0) search_nearest(point, k, first, mid, depth + 1, heap);
+			else search_nearest(point, k, mid + 1, last, depth + 1, heap);
+
+			if (heap.size() == k && !(difference * difference < heap.front().distance)) return;
+
+			if (difference < 0) search_nearest(point, k, mid + 1, last, depth + 1, heap);
+			else search_nearest(point, k, first, mid, depth + 1, heap);
+		}
+
+		template<typename Visitor>
+		void search_radius(const vec_type& point, T squared_radius, size_type first, size_type last, size_type depth,
+			Visitor& visitor) const
+		{
+			if (last - first <= scan_size) {
+				for (auto index = first; index < last; index++) {
+					const auto distance = squared_distance(point, mEntries[index].point);
+
+					if (distance <= squared_radius) visitor(static_cast<size_type>(mEntries[index].index), distance);
+				}
+
+				return;
+			}
+
+			const auto mid = (first + last) >> 1;
+			const auto& current = mEntries[mid];
+			const auto difference = point[depth & 1] - current.point[depth & 1];
+			const auto distance = squared_distance(point, current.point);
+
+			if (distance <= squared_radius) visitor(static_cast<size_type>(current.index), distance);
+
+			if (difference <= 0 || difference * difference <= squared_radius)
+				search_radius(point, squared_radius, first, mid, depth + 1, visitor);
+
+			if (difference >= 0 || difference * difference <= squared_radius)
+				search_radius(point, squared_radius, mid + 1, last, depth + 1, visitor);
+		}
+
+		//the order of queries sorted by the Morton code of point
+		static auto morton_order(const vec_type* points, size_type count, thread_pool* pool) -> std::vector<uint32_t> {
+			struct code_entry {
+				uint32_t code;
+				uint32_t index;
+			};
+
+			bounds2_t<T> bounds;
+
+			for (size_type index = 0; index < count; index++) bounds.expand(points[index]);
+
+			const auto extent = bounds.size();
+			const auto scale = vec_type(
+				extent.x > T(0) ? T(65535) / extent.x : T(0),
+				extent.y > T(0) ? T(65535) / extent.y : T(0));
+
+			std::vector<code_entry> codes(count);
+
+			for (size_type index = 0; index < count; index++) {
+				const auto cell = (points[index] - bounds.min) * scale;
+
+				codes[index].code = morton_code2(static_cast<uint32_t>(cell.x), static_cast<uint32_t>(cell.y));
+				codes[index].index = static_cast<uint32_t>(index);
+			}
+
+			radix_sort<uint32_t, code_entry>(codes.data(), codes.data() + count,
+				[](const code_entry& element) { return element.code; }, radix_sort_options{ pool });
+
+			std::vector<uint32_t> order(count);
+
+			for (size_type index = 0; index < count; index++) order[index] = codes[index].index;
+
+			return order;
+		}
+	private:
+		kd_tree_options mOptions;
+
+		aligned_buffer<entry> mEntries;
+	};
+}
@@ -0,0 +1,328 @@
+#pragma once
+
+/*
+ * rtree.hpp
+ * Static R-tree of 2D boxes, it is bulk loaded by STR (Sort-Tile-Recursive, Leutenegger 1997) :
+ * 1. sort the boxes by the x of center, cut them into sqrt(leaf count) slices.
+ * 2. sort every slice by the y of center, pack every "fanout" boxes into a leaf.
+ * 3. pack the nodes into the upper level in same way until there is one node (root).
+ * The sort is radix_sort on the quantized centers (32 bits).
+ *
+ * The children of node are stored in structure of arrays, fanout = cache_line_size / sizeof(T),
+ * so every array of node is one cache line and the children are tested by the batch operations of bounds2_soa
+ * (float : one AVX-512 compare, two AVX2 compares or four SSE2 compares per array).
+ * The nodes are stored level by level, the leaves are first and the root is last.
+ *
+ * The window query is a input iterator, the boxes are visited lazily, so we can stop at any time :
+ * for (auto index : tree.window(bounds)) { ... }
+ */
+
+#include <iterator>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "../../algorithm/radix_sort.hpp"
+#include "../../dependent/memory/aligned_buffer.hpp"
+#include "../../dependent/bounds2_soa.hpp"
+
+namespace alg_dat {
+
+	template<typename T = real>
+	class rtree2 {
+	public:
+		using size_type = size_t;
+		using bounds_type = bounds2_t<T>;
+		using vec_type = vec2_t<T>;
+		using batch = typename detail::bounds2_soa_batch<T>::type;
+
+		static constexpr size_type fanout = cache_line_size / sizeof(T);
+
+		static_assert(fanout % batch::width == 0 && fanout <= 32, "the children of node should be full batches.");
+
+		//the children of leaf are the indices of boxes, the children of internal node are the indices of nodes
+		struct alignas(cache_line_size) node {
+			T min_x[fanout];
+			T min_y[fanout];
+			T max_x[fanout];
+			T max_y[fanout];
+
+			uint32_t children[fanout];
+			uint32_t count;
+		};
+
+		class window_iterator {
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using value_type = size_type;
+			using difference_type = ptrdiff_t;
+			using pointer = const size_type*;
+			using reference = const size_type&;
+		public:
+			//the end iterator
+			window_iterator() = default;
+
+			window_iterator(const rtree2* tree, const bounds_type& bounds) : mTree(tree), mBounds(bounds) {
+				if (tree->empty()) { mTree = nullptr; return; }
+
+				push(static_cast<uint32_t>(tree->node_count() - 1));
+				advance();
+			}
+
+			auto operator*() const -> reference { return mCurrent; }
+
+			auto operator++() -> window_iterator& {
+				advance();
+
+				return *this;
+			}
+
+			//only the comparison with end is meaningful
+			bool operator==(const window_iterator& other) const { return mTree == other.mTree; }
+
+			bool operator!=(const window_iterator& other) const { return !(*this == other); }
+		private:
+			struct frame {
+				uint32_t node;
+				uint32_t mask;
+			};
+
+			//the tree has at most 32 levels, fanout^32 is larger than the uint32_t indices
+			static constexpr size_type max_depth = 32;
+
+			void push(uint32_t node) {
+				assert(mDepth < max_depth);
+
+				mStack[mDepth++] = { node, mTree->overlap_mask(mTree->mNodes[node], mBounds) };
+			}
+
+			//find the next box, the iterator becomes end if there is no more box
+			void advance() {
+				while (mDepth != 0) {
+					auto& top = mStack[mDepth - 1];
+
+					if (top.mask == 0) { mDepth--; continue; }
+
+					const auto slot = detail::bounds2_lowest_bit(top.mask);
+					const auto child = mTree->mNodes[top.node].children[slot];
+
+					top.mask = top.mask & (top.mask - 1);
+
+					if (top.node < mTree->mLeafCount) { mCurrent = child; return; }
+
+					push(child);
+				}
+
+				mTree = nullptr;
+			}
+		private:
+			const rtree2* mTree = nullptr;
+
+			bounds_type mBounds;
+
+			frame mStack[max_depth] = {};
+			size_type mDepth = 0;
+			size_type mCurrent = 0;
+		};
+
+		struct window_range {
+			window_iterator first;
+
+			auto begin() const -> window_iterator { return first; }
+
+			auto end() const -> window_iterator { return window_iterator(); }
+		};
+	public:
+		rtree2() = default;
+
+		/**
+		 * \brief bulk load the tree
+		 * \param begin the first box
+		 * \param end the end of boxes, the index of box is the offset from begin
+		 */
+		rtree2(const bounds_type* begin, const bounds_type* end) : mSize(static_cast<size_type>(end - begin)) {
+			assert(mSize < static_cast<size_type>(std::numeric_limits<uint32_t>::max()));
+
+			if (mSize == 0) return;
+
+			//the number of nodes of every level
+			std::vector<size_type> levels = { (mSize + fanout - 1) / fanout };
+
+			while (levels.back() != 1) levels.push_back((levels.back() + fanout - 1) / fanout);
+
+			size_type node_count = 0;
+
+			for (const auto count : levels) node_count = node_count + count;
+
+			mNodes.resize(node_count);
+			mLeafCount = levels.front();
+
+			std::vector<uint32_t> ids(mSize);
+
+			for (size_type index = 0; index < mSize; index++) ids[index] = static_cast<uint32_t>(index);
+
+			pack(begin, ids, 0);
+
+			//the boxes of upper level are the bounds of nodes of lower level
+			std::vector<bounds_type> boxes;
+
+			for (size_type level = 1, first = 0; level < levels.size(); level++) {
+				const auto count = levels[level - 1];
+
+				boxes.resize(first + count);
+				ids.resize(count);
+
+				for (size_type index = 0; index < count; index++) {
+					boxes[first + index] = node_bounds(mNodes[first + index]);
+					ids[index] = static_cast<uint32_t>(first + index);
+				}
+
+				pack(boxes.data(), ids, first + count);
+
+				first = first + count;
+			}
+		}
+
+		/**
+		 * \brief the window query, visit the boxes overlap with bounds lazily
+		 * \param bounds the query box, the boxes touched by boundary overlap
+		 * \return the range of indices of boxes
+		 */
+		auto window(const bounds_type& bounds) const -> window_range {
+			return { window_iterator(this, bounds) };
+		}
+
+		/**
+		 * \brief visit the boxes overlap with bounds
+		 * \param bounds the query box
+		 * \param visitor visitor(index), the index of box
+		 */
+		template<typename Visitor>
+		void query(const bounds_type& bounds, Visitor&& visitor) const {
+			for (auto index : window(bounds)) visitor(index);
+		}
+
+		auto nodes() const -> const node* { return mNodes.data(); }
+
+		//the root is the last node
+		size_type node_count() const { return mNodes.size(); }
+
+		//the leaves are the first leaf_count() nodes
+		size_type leaf_count() const { return mLeafCount; }
+
+		bounds_type bounds() const { return empty() ? bounds_type() : node_bounds(mNodes[node_count() - 1]); }
+
+		size_type size() const { return mSize; }
+
+		bool empty() const { return mSize == 0; }
+	private:
+		struct key_entry {
+			uint32_t key;
+			uint32_t id;
+		};
+
+		static bounds_type node_bounds(const node& current) {
+			bounds_type bounds;
+
+			for (size_type slot = 0; slot < current.count; slot++) {
+				bounds.expand(bounds_type(
+					vec_type(current.min_x[slot], current.min_y[slot]),
+					vec_type(current.max_x[slot], current.max_y[slot])));
+			}
+
+			return bounds;
+		}
+
+		//bit i is 1 if child i overlaps with bounds
+		uint32_t overlap_mask(const node& current, const bounds_type& bounds) const {
+			uint32_t bits = 0;
+
+			for (size_type slot = 0; slot < fanout; slot += batch::width) {
+				using ops = batch;
+
+				const auto mask = ops::both(
+					ops::both(
+						ops::less_equal(ops::set(bounds.min.x), ops::load(current.max_x + slot)),
+						ops::less_equal(ops::load(current.min_x + slot), ops::set(bounds.max.x))),
+					ops::both(
+						ops::less_equal(ops::set(bounds.min.y), ops::load(current.max_y + slot)),
+						ops::less_equal(ops::load(current.min_y + slot), ops::set(bounds.max.y))));
+
+				bits = bits | (ops::bits(mask) << slot);
+			}
+
+			//the empty slots are empty boxes, but they overlap with the infinite query box
+			return current.count == 32 ? bits : bits & ((static_cast<uint32_t>(1) << current.count) - 1);
+		}
+
+		//quantize the centers of boxes to the keys of radix_sort, the center of axis is min[axis] + max[axis]
+		static void quantize(const bounds_type* boxes, key_entry* first, key_entry* last, size_type axis) {
+			auto low = std::numeric_limits<double>::max();
+			auto high = std::numeric_limits<double>::lowest();
+
+			for (auto entry = first; entry != last; ++entry) {
+				const auto& box = boxes[entry->id];
+				const auto center = static_cast<double>(box.min[axis]) + static_cast<double>(box.max[axis]);
+
+				low = std::min(low, center);
+				high = std::max(high, center);
+			}
+
+			const auto scale = high > low ? static_cast<double>(std::numeric_limits<uint32_t>::max()) / (high - low) : 0.0;
+
+			for (auto entry = first; entry != last; ++entry) {
+				const auto& box = boxes[entry->id];
+				const auto center = static_cast<double>(box.min[axis]) + static_cast<double>(box.max[axis]);
+
+				entry->key = static_cast<uint32_t>((center - low) * scale);
+			}
+
+			radix_sort<uint32_t, key_entry>(first, last, [](const key_entry& entry) { return entry.key; });
+		}
+
+		//pack the boxes into the nodes [first_node, first_node + ceil(ids.size() / fanout)) by STR
+		void pack(const bounds_type* boxes, const std::vector<uint32_t>& ids, size_type first_node) {
+			const auto count = ids.size();
+			const auto node_count = (count + fanout - 1) / fanout;
+			const auto slice_count = static_cast<size_type>(std::ceil(std::sqrt(static_cast<double>(node_count))));
+			const auto slice_size = ((node_count + slice_count - 1) / slice_count) * fanout;
+
+			std::vector<key_entry> entries(count);
+
+			for (size_type index = 0; index < count; index++) entries[index].id = ids[index];
+
+			quantize(boxes, entries.data(), entries.data() + count, 0);
+
+			for (size_type first = 0; first < count; first += slice_size)
+				quantize(boxes, entries.data() + first, entries.data() + std::min(first + slice_size, count), 1);
+
+			//every slice has multiple of fanout boxes, so the nodes do not cross the slices
+			for (size_type index = 0; index < node_count; index++) {
+				auto& current = mNodes[first_node + index];
+
+				const auto first = index * fanout;
+				const auto last = std::min(first + fanout, count);
+
+				current.count = static_cast<uint32_t>(last - first);
+
+				for (size_type slot = 0; slot < fanout; slot++) {
+					const auto box = first + slot < last ? boxes[entries[first + slot].id] : bounds_type();
+
+					current.min_x[slot] = box.min.x;
+					current.min_y[slot] = box.min.y;
+					current.max_x[slot] = box.max.x;
+					current.max_y[slot] = box.max.y;
+					current.children[slot] = first + slot < last ? entries[first + slot].id : 0;
+				}
+			}
+		}
+	private:
+		aligned_buffer<node> mNodes;
+
+		size_type mSize = 0;
+		size_type mLeafCount = 0;
+	};
+}
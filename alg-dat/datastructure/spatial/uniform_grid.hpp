@@ -0,0 +1,295 @@
+#pragma once
+
+/*
+ * uniform_grid.hpp
+ * Uniform grid of 2D points for the neighbors in radius, it is designed to be rebuilt every frame (e.g. particles).
+ *
+ * The grid covers the bounds of points, the cells are indexed in row-major order (cell = y * width + x).
+ * The build is a counting sort of points by cell, with the count and scatter steps of radix_sort :
+ * 1. compute the bounds of points and the cell of every point, in parallel.
+ * 2. every chunk counts its points in every cell.
+ * 3. prefix sum the counters by (cell, chunk), the cells are divided to chunks.
+ * 4. every chunk scatters its points, the points in same cell keep the input order.
+ *
+ * The points in same row are stored continuously, so the radius query scans one range of points per row
+ * instead of one range per cell.
+ * The number of cells is limited to about the number of points, if the cell size is too small,
+ * the cell size is enlarged, the result of query is not changed.
+ *
+ * uniform_grid_options::pool : the thread pool of parallel build and batched query, nullptr means sequential.
+ * The chunks are run by the parallel_for of pool.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "../../dependent/thread_pool.hpp"
+#include "../../algorithm/radix_sort.hpp"
+#include "../../dependent/memory/aligned_buffer.hpp"
+#include "../../dependent/bounds2.hpp"
+
+namespace alg_dat {
+
+	struct uniform_grid_options {
+		thread_pool* pool = nullptr;
+	};
+
+	namespace detail {
+
+		//the minimum number of points per chunk, the small grid is built by one chunk
+		constexpr size_t uniform_grid_min_work = static_cast<size_t>(1) << 14;
+
+		inline auto uniform_grid_chunk_count(thread_pool* pool, size_t count) -> size_t {
+			if (pool == nullptr) return 1;
+
+			return std::max(std::min(pool->thread_count(), count / uniform_grid_min_work), static_cast<size_t>(1));
+		}
+
+		//function(chunk, first, last) is called for every chunk of [0, count), the chunks are run in the pool
+		template<typename Function>
+		void uniform_grid_parallel_for(thread_pool* pool, size_t count, size_t chunk_count, Function&& function) {
+			if (chunk_count == 1) { function(static_cast<size_t>(0), static_cast<size_t>(0), count); return; }
+
+			pool->parallel_for(0, chunk_count, [&](size_t first_chunk, size_t last_chunk) {
+				for (auto chunk = first_chunk; chunk < last_chunk; chunk++)
+					function(chunk, count * chunk / chunk_count, count * (chunk + 1) / chunk_count);
+			}, 1);
+		}
+	}
+
+	template<typename T = real>
+	class uniform_grid2 {
+		static_assert(std::is_floating_point<T>::value, "the component of uniform_grid2 should be floating point.");
+	public:
+		using size_type = size_t;
+		using vec_type = vec2_t<T>;
+	public:
+		/**
+		 * \param cell_size the size of cell, it is usually the radius of query
+		 * \param options the options
+		 */
+		explicit uniform_grid2(T cell_size, const uniform_grid_options& options = uniform_grid_options()) :
+			mOptions(options), mCellSize(cell_size)
+		{
+			assert(cell_size > T(0));
+		}
+
+		/**
+		 * \brief rebuild the grid, the buffers are reused
+		 * \param begin the first point
+		 * \param end the end of points, the index of point is the offset from begin
+		 */
+		void build(const vec_type* begin, const vec_type* end) {
+			const auto size = static_cast<size_type>(end - begin);
+			const auto pool = mOptions.pool;
+			const auto chunk_count = detail::uniform_grid_chunk_count(pool, size);
+
+			assert(size < static_cast<size_type>(std::numeric_limits<uint32_t>::max()));
+
+			std::vector<bounds2_t<T>> chunk_bounds(chunk_count);
+
+			detail::uniform_grid_parallel_for(pool, size, chunk_count, [&](size_t chunk, size_t first, size_t last) {
+				for (auto index = first; index < last; index++) chunk_bounds[chunk].expand(begin[index]);
+			});
+
+			mBounds = bounds2_t<T>();
+
+			for (const auto& bounds : chunk_bounds) mBounds.expand(bounds);
+
+			resize_cells(size);
+
+			mCells.resize(size);
+			mPoints.resize(size);
+			mIndices.resize(size);
+
+			const auto cell_count = mWidth * mHeight;
+
+			//counters[chunk * cell_count + cell], the number of points of chunk in cell, then the position of next point
+			mCounters.resize(chunk_count * cell_count);
+			mCounters.fill(0);
+
+			detail::uniform_grid_parallel_for(pool, size, chunk_count, [&](size_t chunk, size_t first, size_t last) {
+				for (auto index = first; index < last; index++)
+					mCells[index] = static_cast<uint32_t>(cell_of(begin[index]));
+
+				detail::radix_sort_count(mCells.data() + first, last - first, mCounters.data() + chunk * cell_count);
+			});
+
+			//the prefix sum in (cell, chunk) order, the cells are divided to chunks and every chunk sums its cells first
+			std::vector<uint32_t> range_sums(chunk_count + 1, 0);
+
+			const auto sum_cells = [&](size_t range, size_t first, size_t last, bool write) {
+				auto sum = write ? range_sums[range] : 0;
+
+				for (auto cell = first; cell < last; cell++) {
+					if (write) mOffsets[cell] = sum;
+
+					for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+						auto& counter = mCounters[chunk * cell_count + cell];
+						const auto count = counter;
+
+						if (write) counter = sum;
+
+						sum = sum + count;
+					}
+				}
+
+				if (!write) range_sums[range + 1] = sum;
+			};
+
+			mOffsets.resize(cell_count + 1);
+
+			detail::uniform_grid_parallel_for(pool, cell_count, chunk_count, [&](size_t range, size_t first, size_t last) {
+				sum_cells(range, first, last, false);
+			});
+
+			for (size_t range = 1; range <= chunk_count; range++) range_sums[range] = range_sums[range] + range_sums[range - 1];
+
+			detail::uniform_grid_parallel_for(pool, cell_count, chunk_count, [&](size_t range, size_t first, size_t last) {
+				sum_cells(range, first, last, true);
+			});
+
+			mOffsets[cell_count] = static_cast<uint32_t>(size);
+
+			detail::uniform_grid_parallel_for(pool, size, chunk_count, [&](size_t chunk, size_t first, size_t last) {
+				detail::radix_sort_scatter(mCells.data() + first, last - first, mCounters.data() + chunk * cell_count,
+					[&](size_t element, size_t position) {
+						mPoints[position] = begin[first + element];
+						mIndices[position] = static_cast<uint32_t>(first + element);
+					});
+			});
+		}
+
+		/**
+		 * \brief visit the points in the circle
+		 * \param point the center of circle
+		 * \param radius the radius, the points on the circle are included
+		 * \param visitor visitor(index, squared distance)
+		 */
+		template<typename Visitor>
+		void radius(const vec_type& point, T radius, Visitor&& visitor) const {
+			if (empty()) return;
+
+			const auto squared_radius = radius * radius;
+
+			const auto x0 = clamp_cell(point.x - radius - mBounds.min.x, mWidth);
+			const auto x1 = clamp_cell(point.x + radius - mBounds.min.x, mWidth);
+			const auto y0 = clamp_cell(point.y - radius - mBounds.min.y, mHeight);
+			const auto y1 = clamp_cell(point.y + radius - mBounds.min.y, mHeight);
+
+			//the cells [x0, x1] of row y are continuous
+			for (auto y = y0; y <= y1; y++) {
+				const auto last = mOffsets[y * mWidth + x1 + 1];
+
+				for (auto index = static_cast<size_type>(mOffsets[y * mWidth + x0]); index < last; index++) {
+					const auto difference = mPoints[index] - point;
+					const auto distance = vec_type::dot(difference, difference);
+
+					if (distance <= squared_radius) visitor(static_cast<size_type>(mIndices[index]), distance);
+				}
+			}
+		}
+
+		/**
+		 * \brief visit the points in the circle of every query, the queries are divided to the chunks of pool
+		 * \param points the centers of circles
+		 * \param count the number of queries
+		 * \param radius the radius
+		 * \param visitor visitor(query, index, squared distance), it is called by several threads at the same time,
+		 * but the calls of one query are in one thread
+		 */
+		template<typename Visitor>
+		void radius(const vec_type* points, size_type count, T radius, Visitor&& visitor) const {
+			detail::uniform_grid_parallel_for(mOptions.pool, count, detail::uniform_grid_chunk_count(mOptions.pool, count),
+				[&](size_t, size_t first, size_t last) {
+					for (auto query = first; query < last; query++) {
+						this->radius(points[query], radius, [&](size_type index, T distance) {
+							visitor(query, index, distance);
+						});
+					}
+				});
+		}
+
+		//the points sorted by cell
+		auto points() const -> const vec_type* { return mPoints.data(); }
+
+		//the index of sorted points
+		auto indices() const -> const uint32_t* { return mIndices.data(); }
+
+		//the sorted points of cell are [offsets()[cell], offsets()[cell + 1]), cell = y * width() + x
+		auto offsets() const -> const uint32_t* { return mOffsets.data(); }
+
+		auto bounds() const -> const bounds2_t<T>& { return mBounds; }
+
+		//the size of cell, it may be larger than the size in constructor
+		T cell_size() const { return mCellSize * mScale; }
+
+		size_type width() const { return mWidth; }
+
+		size_type height() const { return mHeight; }
+
+		size_type size() const { return mPoints.size(); }
+
+		bool empty() const { return mPoints.empty(); }
+	private:
+		void resize_cells(size_type size) {
+			const auto extent = mBounds.empty() ? vec_type(T(0)) : mBounds.size();
+
+			//the cells are at most max(size, 1) * 2, so the counters and offsets are not larger than the points
+			const auto limit = static_cast<double>(std::max(size, static_cast<size_type>(1)) * 2);
+
+			mScale = T(1);
+
+			for (;;) {
+				const auto width = std::floor(static_cast<double>(extent.x) / static_cast<double>(cell_size())) + 1;
+				const auto height = std::floor(static_cast<double>(extent.y) / static_cast<double>(cell_size())) + 1;
+
+				if (width * height <= limit) {
+					mWidth = static_cast<size_type>(width);
+					mHeight = static_cast<size_type>(height);
+					mInverse = T(1) / cell_size();
+
+					return;
+				}
+
+				mScale = static_cast<T>(mScale * std::sqrt(width * height / limit) * 1.0625);
+			}
+		}
+
+		size_type cell_of(const vec_type& point) const {
+			const auto cell = (point - mBounds.min) * mInverse;
+
+			return
+				std::min(static_cast<size_type>(cell.y), mHeight - 1) * mWidth +
+				std::min(static_cast<size_type>(cell.x), mWidth - 1);
+		}
+
+		size_type clamp_cell(T offset, size_type count) const {
+			if (!(offset > T(0))) return 0;
+
+			return std::min(static_cast<size_type>(offset * mInverse), count - 1);
+		}
+	private:
+		uniform_grid_options mOptions;
+
+		T mCellSize;
+		T mScale = T(1);
+		T mInverse = T(1);
+
+		size_type mWidth = 0;
+		size_type mHeight = 0;
+
+		bounds2_t<T> mBounds;
+
+		aligned_buffer<uint32_t> mCells;
+		aligned_buffer<uint32_t> mCounters;
+		aligned_buffer<uint32_t> mOffsets;
+		aligned_buffer<uint32_t> mIndices;
+		aligned_buffer<vec_type> mPoints;
+	};
+}
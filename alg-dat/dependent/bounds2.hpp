@@ -0,0 +1,96 @@
+#pragma once
+
+/*
+ * bounds2.hpp
+ * bounds2_t<T> is the 2D axis-aligned bounding box [min, max], the boundary is inside the box.
+ * The default box is empty (min = +max, max = lowest), so it is the identity of merge.
+ * All operations are constexpr, see more in "vec.hpp".
+ *
+ * For the test of one box against many boxes, see "bounds2_soa.hpp".
+ */
+
+#include <limits>
+
+#include "vec.hpp"
+
+namespace alg_dat {
+
+	template<typename T>
+	struct bounds2_t {
+		vec2_t<T> min;
+		vec2_t<T> max;
+
+		constexpr bounds2_t() noexcept :
+			min(std::numeric_limits<T>::max()), max(std::numeric_limits<T>::lowest()) {}
+
+		constexpr bounds2_t(const vec2_t<T>& min, const vec2_t<T>& max) noexcept : min(min), max(max) {}
+
+		constexpr explicit bounds2_t(const vec2_t<T>& point) noexcept : min(point), max(point) {}
+
+		constexpr bool empty() const noexcept {
+			return min.x > max.x || min.y > max.y;
+		}
+
+		constexpr vec2_t<T> size() const noexcept { return max - min; }
+
+		constexpr vec2_t<T> center() const noexcept { return (min + max) / T(2); }
+
+		constexpr T area() const noexcept {
+			return empty() ? T(0) : (max.x - min.x) * (max.y - min.y);
+		}
+
+		constexpr bool contains(const vec2_t<T>& point) const noexcept {
+			return
+				min.x <= point.x && point.x <= max.x &&
+				min.y <= point.y && point.y <= max.y;
+		}
+
+		constexpr bool contains(const bounds2_t& bounds) const noexcept {
+			return
+				min.x <= bounds.min.x && bounds.max.x <= max.x &&
+				min.y <= bounds.min.y && bounds.max.y <= max.y;
+		}
+
+		//the boxes overlap if they share at least one point, so the boxes touched by boundary overlap
+		constexpr bool overlap(const bounds2_t& bounds) const noexcept {
+			return
+				min.x <= bounds.max.x && bounds.min.x <= max.x &&
+				min.y <= bounds.max.y && bounds.min.y <= max.y;
+		}
+
+		constexpr bounds2_t& expand(const vec2_t<T>& point) noexcept {
+			min = vec2_t<T>::min(min, point);
+			max = vec2_t<T>::max(max, point);
+
+			return *this;
+		}
+
+		constexpr bounds2_t& expand(const bounds2_t& bounds) noexcept {
+			min = vec2_t<T>::min(min, bounds.min);
+			max = vec2_t<T>::max(max, bounds.max);
+
+			return *this;
+		}
+
+		constexpr bool operator==(const bounds2_t& bounds) const noexcept {
+			return min == bounds.min && max == bounds.max;
+		}
+
+		constexpr bool operator!=(const bounds2_t& bounds) const noexcept {
+			return !(*this == bounds);
+		}
+
+		//the union of boxes, "union" is keyword so we call it merge
+		static constexpr bounds2_t merge(const bounds2_t& b0, const bounds2_t& b1) noexcept {
+			return bounds2_t(vec2_t<T>::min(b0.min, b1.min), vec2_t<T>::max(b0.max, b1.max));
+		}
+
+		//the intersection of boxes, it is empty if the boxes do not overlap
+		static constexpr bounds2_t intersect(const bounds2_t& b0, const bounds2_t& b1) noexcept {
+			return bounds2_t(vec2_t<T>::max(b0.min, b1.min), vec2_t<T>::min(b0.max, b1.max));
+		}
+	};
+
+	using bounds2 = bounds2_t<real>;
+
+}
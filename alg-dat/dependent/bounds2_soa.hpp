@@ -0,0 +1,296 @@
+#pragma once
+
+/*
+ * bounds2_soa.hpp
+ * Structure of arrays of bounds2_t, the min x, min y, max x and max y are stored in four cache line aligned arrays.
+ * It is the inner loop of broad-phase collision and culling : test one box (or point) against many boxes.
+ *
+ * The result of batch test is a bitmask, bit i of mask[i / 64] is the result of box i.
+ * A batch of boxes is tested with 4 compares and the lanes are packed into bits with movemask (or the mask of AVX-512) :
+ * AVX-512 : 16 floats per instruction.
+ * AVX2 : 8 floats per instruction.
+ * SSE2 : 4 floats per instruction.
+ * others : the scalar loop.
+ */
+
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "memory/aligned_buffer.hpp"
+#include "bounds2.hpp"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace alg_dat {
+
+	namespace detail {
+
+		inline auto bounds2_lowest_bit(uint64_t bits) -> size_t {
+#ifdef _MSC_VER
+			unsigned long index = 0;
+
+			_BitScanForward64(&index, bits);
+
+			return index;
+#else
+			return static_cast<size_t>(__builtin_ctzll(bits));
+#endif
+		}
+
+		template<typename T>
+		struct bounds2_soa_scalar {
+			using type = T;
+			using mask = bool;
+
+			static constexpr size_t width = 1;
+
+			static type load(const T* value) { return *value; }
+
+			static type set(T value) { return value; }
+
+			static mask less_equal(type b0, type b1) { return b0 <= b1; }
+
+			static mask both(mask m0, mask m1) { return m0 && m1; }
+
+			static uint32_t bits(mask value) { return value ? 1 : 0; }
+		};
+
+#if defined(ALG_DAT_AVX512)
+		struct bounds2_soa_avx512 {
+			using type = __m512;
+			using mask = __mmask16;
+
+			static constexpr size_t width = 16;
+
+			static type load(const float* value) { return _mm512_load_ps(value); }
+
+			static type set(float value) { return _mm512_set1_ps(value); }
+
+			static mask less_equal(type b0, type b1) { return _mm512_cmp_ps_mask(b0, b1, _CMP_LE_OQ); }
+
+			static mask both(mask m0, mask m1) { return static_cast<mask>(m0 & m1); }
+
+			static uint32_t bits(mask value) { return static_cast<uint32_t>(value); }
+		};
+#endif
+
+#if defined(ALG_DAT_AVX2)
+		struct bounds2_soa_avx2 {
+			using type = __m256;
+			using mask = __m256;
+
+			static constexpr size_t width = 8;
+
+			static type load(const float* value) { return _mm256_load_ps(value); }
+
+			static type set(float value) { return _mm256_set1_ps(value); }
+
+			static mask less_equal(type b0, type b1) { return _mm256_cmp_ps(b0, b1, _CMP_LE_OQ); }
+
+			static mask both(mask m0, mask m1) { return _mm256_and_ps(m0, m1); }
+
+			static uint32_t bits(mask value) { return static_cast<uint32_t>(_mm256_movemask_ps(value)); }
+		};
+#endif
+
+#if defined(ALG_DAT_SSE2)
+		struct bounds2_soa_sse2 {
+			using type = __m128;
+			using mask = __m128;
+
+			static constexpr size_t width = 4;
+
+			static type load(const float* value) { return _mm_load_ps(value); }
+
+			static type set(float value) { return _mm_set1_ps(value); }
+
+			static mask less_equal(type b0, type b1) { return _mm_cmple_ps(b0, b1); }
+
+			static mask both(mask m0, mask m1) { return _mm_and_ps(m0, m1); }
+
+			static uint32_t bits(mask value) { return static_cast<uint32_t>(_mm_movemask_ps(value)); }
+		};
+#endif
+
+		//the widest batch operations of T
+		template<typename T>
+		struct bounds2_soa_batch {
+			using type = bounds2_soa_scalar<T>;
+		};
+
+#if defined(ALG_DAT_AVX512)
+		template<>
+		struct bounds2_soa_batch<float> {
+			using type = bounds2_soa_avx512;
+		};
+#elif defined(ALG_DAT_AVX2)
+		template<>
+		struct bounds2_soa_batch<float> {
+			using type = bounds2_soa_avx2;
+		};
+#elif defined(ALG_DAT_SSE2)
+		template<>
+		struct bounds2_soa_batch<float> {
+			using type = bounds2_soa_sse2;
+		};
+#endif
+	}
+
+	template<typename T>
+	class bounds2_soa {
+		static_assert(std::is_arithmetic<T>::value, "the component of bounds2_soa should be arithmetic.");
+	public:
+		using size_type = size_t;
+		using value_type = bounds2_t<T>;
+		using batch = typename detail::bounds2_soa_batch<T>::type;
+
+		static constexpr size_type mask_bits = 64;
+
+		static_assert(mask_bits % batch::width == 0, "the batch should not cross the word of mask.");
+	public:
+		bounds2_soa() = default;
+
+		//the boxes are empty
+		explicit bounds2_soa(size_type size) :
+			mMinX(size, std::numeric_limits<T>::max()), mMinY(size, std::numeric_limits<T>::max()),
+			mMaxX(size, std::numeric_limits<T>::lowest()), mMaxY(size, std::numeric_limits<T>::lowest()) {}
+
+		bounds2_soa(const value_type* begin, const value_type* end) : bounds2_soa(static_cast<size_type>(end - begin)) {
+			for (size_type index = 0; index < size(); index++) set(index, begin[index]);
+		}
+
+		//the new boxes are empty
+		void resize(size_type size) {
+			const auto old = this->size();
+
+			mMinX.resize(size);
+			mMinY.resize(size);
+			mMaxX.resize(size);
+			mMaxY.resize(size);
+
+			for (auto index = old; index < size; index++) set(index, value_type());
+		}
+
+		value_type at(size_type index) const {
+			return value_type(
+				vec2_t<T>(mMinX[index], mMinY[index]),
+				vec2_t<T>(mMaxX[index], mMaxY[index]));
+		}
+
+		void set(size_type index, const value_type& bounds) {
+			mMinX[index] = bounds.min.x;
+			mMinY[index] = bounds.min.y;
+			mMaxX[index] = bounds.max.x;
+			mMaxY[index] = bounds.max.y;
+		}
+
+		size_type size() const { return mMinX.size(); }
+
+		bool empty() const { return mMinX.empty(); }
+
+		//the number of words of mask, the mask of batch test should have mask_size() words
+		size_type mask_size() const { return (size() + mask_bits - 1) / mask_bits; }
+
+		/**
+		 * \brief test the overlap of bounds and every box
+		 * \param bounds the box
+		 * \param mask the result, bit i of mask[i / 64] is 1 if bounds overlaps box i. The bits out of size() are 0
+		 */
+		void overlap_mask(const value_type& bounds, uint64_t* mask) const {
+			//overlap : bounds.min <= box.max && box.min <= bounds.max
+			test(mask, [&](auto kernel, size_type index) {
+				using ops = decltype(kernel);
+
+				return ops::bits(ops::both(
+					ops::both(
+						ops::less_equal(ops::set(bounds.min.x), ops::load(mMaxX.data() + index)),
+						ops::less_equal(ops::load(mMinX.data() + index), ops::set(bounds.max.x))),
+					ops::both(
+						ops::less_equal(ops::set(bounds.min.y), ops::load(mMaxY.data() + index)),
+						ops::less_equal(ops::load(mMinY.data() + index), ops::set(bounds.max.y)))));
+			});
+		}
+
+		//test whether every box contains the point, the mask is same as overlap_mask
+		void contains_mask(const vec2_t<T>& point, uint64_t* mask) const {
+			test(mask, [&](auto kernel, size_type index) {
+				using ops = decltype(kernel);
+
+				return ops::bits(ops::both(
+					ops::both(
+						ops::less_equal(ops::load(mMinX.data() + index), ops::set(point.x)),
+						ops::less_equal(ops::set(point.x), ops::load(mMaxX.data() + index))),
+					ops::both(
+						ops::less_equal(ops::load(mMinY.data() + index), ops::set(point.y)),
+						ops::less_equal(ops::set(point.y), ops::load(mMaxY.data() + index)))));
+			});
+		}
+
+		/**
+		 * \brief find the boxes overlap with bounds
+		 * \param bounds the box
+		 * \param output the indices of boxes in ascending order, it should have enough space (at most size())
+		 * \return the number of boxes
+		 */
+		template<typename Index>
+		size_type overlap(const value_type& bounds, Index* output) const {
+			aligned_buffer<uint64_t> mask(mask_size());
+
+			overlap_mask(bounds, mask.data());
+
+			return extract(mask, output);
+		}
+
+		//find the boxes contain the point, see overlap
+		template<typename Index>
+		size_type contains(const vec2_t<T>& point, Index* output) const {
+			aligned_buffer<uint64_t> mask(mask_size());
+
+			contains_mask(point, mask.data());
+
+			return extract(mask, output);
+		}
+	private:
+		//the batches start at the multiple of width, so the loads are aligned. The last partial batch uses the scalar loop
+		template<typename Kernel>
+		void test(uint64_t* mask, Kernel&& kernel) const {
+			for (size_type word = 0; word < mask_size(); word++) {
+				const auto first = word * mask_bits;
+				const auto last = std::min(first + mask_bits, size());
+
+				uint64_t bits = 0;
+
+				auto index = first;
+
+				for (; index + batch::width <= last; index += batch::width)
+					bits = bits | (static_cast<uint64_t>(kernel(batch(), index)) << (index - first));
+
+				for (; index < last; index++)
+					bits = bits | (static_cast<uint64_t>(kernel(detail::bounds2_soa_scalar<T>(), index)) << (index - first));
+
+				mask[word] = bits;
+			}
+		}
+
+		template<typename Index>
+		static size_type extract(const aligned_buffer<uint64_t>& mask, Index* output) {
+			size_type count = 0;
+
+			for (size_type word = 0; word < mask.size(); word++) {
+				for (auto bits = mask[word]; bits != 0; bits = bits & (bits - 1))
+					output[count++] = static_cast<Index>(word * mask_bits + detail::bounds2_lowest_bit(bits));
+			}
+
+			return count;
+		}
+	private:
+		aligned_buffer<T> mMinX;
+		aligned_buffer<T> mMinY;
+		aligned_buffer<T> mMaxX;
+		aligned_buffer<T> mMaxY;
+	};
+}
@@ -0,0 +1,359 @@
+#pragma once
+
+/*
+ * fixed.hpp
+ * fixed_t<Integer, FractionBits> is the signed fixed-point number, the value is raw / 2^FractionBits.
+ * fixed16_16 (Q16.16) uses int32_t and fixed32_32 (Q32.32) uses int64_t.
+ *
+ * All operations are integer operations, so the results are same on every machine and compiler
+ * (e.g. the deterministic lockstep simulation) :
+ * add and sub : wrap around on overflow, as the two's complement integer.
+ * mul : the double width product shifted right by FractionBits (round toward negative infinity).
+ * div : (a << FractionBits) / b in double width, round toward zero.
+ * sqrt : the exact floor of square root, bit by bit.
+ * The double width of int64_t is __int128 if the compiler has it, otherwise it is emulated by two uint64_t.
+ *
+ * fixed_t works with vec_t (e.g. vec2_t<fixed16_16>) and bounds2_t, std::numeric_limits is specialized.
+ * fixed_multiply multiplies arrays of Q16.16 with SSE4.1/AVX2/AVX-512, the result is same as operator*.
+ */
+
+#include <type_traits>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "simd.hpp"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace alg_dat {
+
+	namespace detail {
+
+#if defined(__SIZEOF_INT128__)
+		//__extension__ keeps -Wpedantic quiet, __int128 is not ISO C++
+		__extension__ typedef __int128 fixed_int128;
+#endif
+
+		//the signed product of 64 bits integers, [low, high] of 128 bits
+		constexpr void fixed_multiply_wide(int64_t a, int64_t b, uint64_t& low, int64_t& high) {
+#if defined(__SIZEOF_INT128__)
+			const auto product = static_cast<fixed_int128>(a) * static_cast<fixed_int128>(b);
+
+			low = static_cast<uint64_t>(product);
+			high = static_cast<int64_t>(product >> 64);
+#else
+			const auto ua = static_cast<uint64_t>(a);
+			const auto ub = static_cast<uint64_t>(b);
+
+			const auto a0 = ua & 0xFFFFFFFFu, a1 = ua >> 32;
+			const auto b0 = ub & 0xFFFFFFFFu, b1 = ub >> 32;
+
+			const auto p00 = a0 * b0;
+			const auto p01 = a0 * b1;
+			const auto p10 = a1 * b0;
+			const auto p11 = a1 * b1;
+
+			const auto middle = (p00 >> 32) + (p01 & 0xFFFFFFFFu) + (p10 & 0xFFFFFFFFu);
+
+			low = (middle << 32) | (p00 & 0xFFFFFFFFu);
+
+			//the unsigned high part, then the correction of signed operands
+			auto unsigned_high = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+
+			if (a < 0) unsigned_high = unsigned_high - ub;
+			if (b < 0) unsigned_high = unsigned_high - ua;
+
+			high = static_cast<int64_t>(unsigned_high);
+#endif
+		}
+
+		//(numerator << shift) / denominator, round toward zero, the quotient is truncated to 64 bits
+		constexpr int64_t fixed_divide_wide(int64_t numerator, int64_t denominator, size_t shift) {
+#if defined(__SIZEOF_INT128__)
+			return static_cast<int64_t>((static_cast<fixed_int128>(numerator) * (static_cast<fixed_int128>(1) << shift)) / denominator);
+#else
+			const bool negative = (numerator < 0) != (denominator < 0);
+
+			const auto magnitude = [](int64_t value) {
+				return value < 0 ? static_cast<uint64_t>(0) - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+			};
+
+			const auto divisor = magnitude(denominator);
+
+			//the dividend is [high, low] = magnitude(numerator) << shift, it is divided bit by bit
+			const auto dividend = magnitude(numerator);
+
+			uint64_t high = shift == 0 ? 0 : dividend >> (64 - shift);
+			uint64_t low = dividend << shift;
+			uint64_t quotient = 0;
+			uint64_t remainder = 0;
+
+			for (size_t bit = 0; bit < 128; bit++) {
+				const bool carry = (remainder >> 63) != 0;
+
+				remainder = (remainder << 1) | (high >> 63);
+				high = (high << 1) | (low >> 63);
+				low = low << 1;
+				quotient = quotient << 1;
+
+				if (carry || remainder >= divisor) {
+					remainder = remainder - divisor;
+					quotient = quotient | 1;
+				}
+			}
+
+			return negative ? static_cast<int64_t>(static_cast<uint64_t>(0) - quotient) : static_cast<int64_t>(quotient);
+#endif
+		}
+	}
+
+	template<typename Integer, size_t FractionBits>
+	class fixed_t {
+		static_assert(std::is_same<Integer, int32_t>::value || std::is_same<Integer, int64_t>::value,
+			"the raw type of fixed_t should be int32_t or int64_t.");
+		static_assert(FractionBits > 0 && FractionBits < sizeof(Integer) * 8 - 1, "the fraction bits are out of range.");
+	public:
+		using raw_type = Integer;
+		using unsigned_type = std::make_unsigned_t<Integer>;
+
+		static constexpr size_t fraction_bits = FractionBits;
+	public:
+		constexpr fixed_t() noexcept = default;
+
+		//the integer is converted implicitly, so T(0) and T(2) work as the other arithmetic types
+		template<typename U, std::enable_if_t<std::is_integral<U>::value, int> = 0>
+		constexpr fixed_t(U value) noexcept :
+			mRaw(static_cast<raw_type>(static_cast<unsigned_type>(value) << FractionBits)) {}
+
+		//round to nearest, the floating point number should be in range
+		template<typename U, std::enable_if_t<std::is_floating_point<U>::value, int> = 0>
+		constexpr explicit fixed_t(U value) noexcept :
+			mRaw(static_cast<raw_type>(value * static_cast<U>(static_cast<raw_type>(1) << FractionBits) + (value < 0 ? U(-0.5) : U(0.5)))) {}
+
+		static constexpr fixed_t from_raw(raw_type raw) noexcept {
+			fixed_t value;
+
+			value.mRaw = raw;
+
+			return value;
+		}
+
+		constexpr raw_type raw() const noexcept { return mRaw; }
+
+		template<typename U, std::enable_if_t<std::is_floating_point<U>::value, int> = 0>
+		constexpr explicit operator U() const noexcept {
+			return static_cast<U>(mRaw) / static_cast<U>(static_cast<raw_type>(1) << FractionBits);
+		}
+
+		//round toward negative infinity
+		template<typename U, std::enable_if_t<std::is_integral<U>::value, int> = 0>
+		constexpr explicit operator U() const noexcept {
+			return static_cast<U>(mRaw >> FractionBits);
+		}
+
+		constexpr fixed_t operator+(const fixed_t& value) const noexcept {
+			return from_raw(static_cast<raw_type>(static_cast<unsigned_type>(mRaw) + static_cast<unsigned_type>(value.mRaw)));
+		}
+
+		constexpr fixed_t operator-(const fixed_t& value) const noexcept {
+			return from_raw(static_cast<raw_type>(static_cast<unsigned_type>(mRaw) - static_cast<unsigned_type>(value.mRaw)));
+		}
+
+		constexpr fixed_t operator-() const noexcept {
+			return from_raw(static_cast<raw_type>(static_cast<unsigned_type>(0) - static_cast<unsigned_type>(mRaw)));
+		}
+
+		constexpr fixed_t operator*(const fixed_t& value) const noexcept {
+			return from_raw(multiply(mRaw, value.mRaw));
+		}
+
+		constexpr fixed_t operator/(const fixed_t& value) const noexcept {
+			assert(value.mRaw != 0);
+
+			return from_raw(divide(mRaw, value.mRaw));
+		}
+
+		constexpr fixed_t& operator+=(const fixed_t& value) noexcept { return *this = *this + value; }
+
+		constexpr fixed_t& operator-=(const fixed_t& value) noexcept { return *this = *this - value; }
+
+		constexpr fixed_t& operator*=(const fixed_t& value) noexcept { return *this = *this * value; }
+
+		constexpr fixed_t& operator/=(const fixed_t& value) noexcept { return *this = *this / value; }
+
+		constexpr bool operator==(const fixed_t& value) const noexcept { return mRaw == value.mRaw; }
+
+		constexpr bool operator!=(const fixed_t& value) const noexcept { return mRaw != value.mRaw; }
+
+		constexpr bool operator<(const fixed_t& value) const noexcept { return mRaw < value.mRaw; }
+
+		constexpr bool operator<=(const fixed_t& value) const noexcept { return mRaw <= value.mRaw; }
+
+		constexpr bool operator>(const fixed_t& value) const noexcept { return mRaw > value.mRaw; }
+
+		constexpr bool operator>=(const fixed_t& value) const noexcept { return mRaw >= value.mRaw; }
+
+		friend constexpr fixed_t abs(const fixed_t& value) noexcept { return value.mRaw < 0 ? -value : value; }
+
+		//the floor of square root, the value should not be negative
+		friend constexpr fixed_t sqrt(const fixed_t& value) noexcept {
+			assert(value.mRaw >= 0);
+
+			if (value.mRaw <= 0) return fixed_t();
+
+			//the square root of raw << FractionBits, 2 bits of it per step from the highest bits
+			constexpr auto bits = (sizeof(raw_type) * 8 + FractionBits + 1) & ~static_cast<size_t>(1);
+
+			const auto raw = static_cast<uint64_t>(value.mRaw);
+
+			uint64_t remainder = 0;
+			uint64_t root = 0;
+
+			for (auto bit = bits; bit != 0; bit -= 2) {
+				const auto shift = static_cast<ptrdiff_t>(bit) - 2 - static_cast<ptrdiff_t>(FractionBits);
+				const auto digits = shift >= 0 ? (raw >> shift) & 3 : (shift == -1 ? (raw << 1) & 3 : 0);
+
+				remainder = (remainder << 2) | digits;
+				root = root << 1;
+
+				if (remainder >= (root << 1) + 1) {
+					remainder = remainder - ((root << 1) + 1);
+					root = root | 1;
+				}
+			}
+
+			return from_raw(static_cast<raw_type>(root));
+		}
+	private:
+		static constexpr raw_type multiply(raw_type a, raw_type b) noexcept {
+			if constexpr (std::is_same<raw_type, int32_t>::value) {
+				return static_cast<raw_type>((static_cast<int64_t>(a) * static_cast<int64_t>(b)) >> FractionBits);
+			}
+			else {
+				uint64_t low = 0;
+				int64_t high = 0;
+
+				detail::fixed_multiply_wide(a, b, low, high);
+
+				return static_cast<raw_type>((low >> FractionBits) | (static_cast<uint64_t>(high) << (64 - FractionBits)));
+			}
+		}
+
+		static constexpr raw_type divide(raw_type a, raw_type b) noexcept {
+			if constexpr (std::is_same<raw_type, int32_t>::value)
+				return static_cast<raw_type>((static_cast<int64_t>(a) * (static_cast<int64_t>(1) << FractionBits)) / b);
+			else
+				return detail::fixed_divide_wide(a, b, FractionBits);
+		}
+	private:
+		raw_type mRaw = 0;
+	};
+
+	using fixed16_16 = fixed_t<int32_t, 16>;
+	using fixed32_32 = fixed_t<int64_t, 32>;
+
+	namespace detail {
+
+		//multiply 4 (8, 16) Q16.16 numbers, the middle 32 bits of the 64 bits products are the results
+#if defined(ALG_DAT_AVX512)
+		inline __m512i fixed_multiply_avx512(__m512i a, __m512i b) {
+			const auto even = _mm512_srli_epi64(_mm512_mul_epi32(a, b), 16);
+			const auto odd = _mm512_slli_epi64(_mm512_mul_epi32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32)), 16);
+
+			return _mm512_mask_blend_epi32(0xAAAA, even, odd);
+		}
+#endif
+
+#if defined(ALG_DAT_AVX2)
+		inline __m256i fixed_multiply_avx2(__m256i a, __m256i b) {
+			const auto even = _mm256_srli_epi64(_mm256_mul_epi32(a, b), 16);
+			const auto odd = _mm256_slli_epi64(_mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32)), 16);
+
+			return _mm256_blend_epi32(even, odd, 0xAA);
+		}
+#endif
+
+#if defined(ALG_DAT_SSE41)
+		inline __m128i fixed_multiply_sse41(__m128i a, __m128i b) {
+			const auto even = _mm_srli_epi64(_mm_mul_epi32(a, b), 16);
+			const auto odd = _mm_slli_epi64(_mm_mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32)), 16);
+
+			return _mm_blend_epi16(even, odd, 0xCC);
+		}
+#endif
+	}
+
+	/**
+	 * \brief multiply the arrays component-wise, output[i] = a[i] * b[i]
+	 * \param a the first array
+	 * \param b the second array
+	 * \param output the output array, it can be a or b
+	 * \param size the number of elements
+	 */
+	template<typename Integer, size_t FractionBits>
+	void fixed_multiply(const fixed_t<Integer, FractionBits>* a, const fixed_t<Integer, FractionBits>* b,
+		fixed_t<Integer, FractionBits>* output, size_t size)
+	{
+		size_t index = 0;
+
+		if constexpr (std::is_same<Integer, int32_t>::value && FractionBits == 16) {
+#if defined(ALG_DAT_AVX512)
+			for (; index + 16 <= size; index += 16) {
+				_mm512_storeu_si512(output + index, detail::fixed_multiply_avx512(
+					_mm512_loadu_si512(a + index), _mm512_loadu_si512(b + index)));
+			}
+#endif
+
+#if defined(ALG_DAT_AVX2)
+			for (; index + 8 <= size; index += 8) {
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + index), detail::fixed_multiply_avx2(
+					_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + index)),
+					_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + index))));
+			}
+#endif
+
+#if defined(ALG_DAT_SSE41)
+			for (; index + 4 <= size; index += 4) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(output + index), detail::fixed_multiply_sse41(
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + index)),
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + index))));
+			}
+#endif
+		}
+
+		for (; index < size; index++) output[index] = a[index] * b[index];
+	}
+}
+
+namespace std {
+
+	template<typename Integer, size_t FractionBits>
+	class numeric_limits<alg_dat::fixed_t<Integer, FractionBits>> {
+	public:
+		using type = alg_dat::fixed_t<Integer, FractionBits>;
+
+		static constexpr bool is_specialized = true;
+		static constexpr bool is_signed = true;
+		static constexpr bool is_integer = false;
+		static constexpr bool is_exact = true;
+		static constexpr bool has_infinity = false;
+		static constexpr bool has_quiet_NaN = false;
+		static constexpr bool is_bounded = true;
+		static constexpr bool is_modulo = true;
+		static constexpr int radix = 2;
+		static constexpr int digits = numeric_limits<Integer>::digits;
+
+		//the smallest positive value
+		static constexpr type min() noexcept { return type::from_raw(1); }
+
+		static constexpr type max() noexcept { return type::from_raw(numeric_limits<Integer>::max()); }
+
+		static constexpr type lowest() noexcept { return type::from_raw(numeric_limits<Integer>::min()); }
+
+		static constexpr type epsilon() noexcept { return type::from_raw(1); }
+	};
+}
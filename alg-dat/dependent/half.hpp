@@ -0,0 +1,160 @@
+#pragma once
+
+/*
+ * half.hpp
+ * half is the IEEE 754 binary16 number, it is a storage format : the arithmetic converts it to float.
+ * So vec2_t<half> is 4 bytes, the half of vec2_t<float>, and the operations of vec2_t<half> are computed in float.
+ *
+ * The conversion from float rounds to nearest even, the overflow becomes infinity and NaN becomes the quiet NaN.
+ * The bulk conversions use F16C (8 numbers per instruction) or the NEON of AArch64 (4 numbers per instruction),
+ * they give same results as the scalar conversions except the payload of NaN.
+ */
+
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+
+#include "simd.hpp"
+
+//the conversions between half and float are in the NEON of AArch64 only
+#if defined(ALG_DAT_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#define ALG_DAT_HALF_NEON
+#endif
+
+namespace alg_dat {
+
+	namespace detail {
+
+		inline uint32_t half_float_bits(float value) {
+			uint32_t bits = 0;
+
+			std::memcpy(&bits, &value, sizeof(float));
+
+			return bits;
+		}
+
+		inline float half_bits_float(uint32_t bits) {
+			float value = 0;
+
+			std::memcpy(&value, &bits, sizeof(float));
+
+			return value;
+		}
+
+		//float to binary16, round to nearest even (F. Giesen, float_to_half_fast3_rtne)
+		inline uint16_t half_encode(float value) {
+			constexpr uint32_t float_infinity = 255u << 23;
+			constexpr uint32_t half_overflow = (127u + 16u) << 23;
+			constexpr uint32_t denormal_magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+			auto bits = half_float_bits(value);
+
+			const auto sign = bits & 0x80000000u;
+
+			bits = bits ^ sign;
+
+			uint16_t result = 0;
+
+			if (bits >= half_overflow) result = bits > float_infinity ? 0x7E00 : 0x7C00;
+			else if (bits < (113u << 23)) {
+				//the result is denormal, the float addition rounds the mantissa for us
+				result = static_cast<uint16_t>(half_float_bits(half_bits_float(bits) + half_bits_float(denormal_magic)) - denormal_magic);
+			}
+			else {
+				const auto odd = (bits >> 13) & 1;
+
+				bits = bits + (static_cast<uint32_t>(15 - 127) << 23) + 0xFFF + odd;
+
+				result = static_cast<uint16_t>(bits >> 13);
+			}
+
+			return static_cast<uint16_t>(result | (sign >> 16));
+		}
+
+		//binary16 to float, it is exact
+		inline float half_decode(uint16_t value) {
+			constexpr uint32_t exponent_mask = 0x7C00u << 13;
+
+			auto bits = static_cast<uint32_t>(value & 0x7FFF) << 13;
+
+			const auto exponent = bits & exponent_mask;
+
+			bits = bits + ((127u - 15u) << 23);
+
+			if (exponent == exponent_mask) bits = bits + ((128u - 16u) << 23);
+			else if (exponent == 0) {
+				//the denormal number, renormalize it by the float subtraction
+				bits = bits + (1u << 23);
+				bits = half_float_bits(half_bits_float(bits) - half_bits_float(113u << 23));
+			}
+
+			return half_bits_float(bits | (static_cast<uint32_t>(value & 0x8000) << 16));
+		}
+	}
+
+	class half {
+	public:
+		half() = default;
+
+		//the other arithmetic types are converted by float, so half(0) works as the other arithmetic types
+		template<typename U, std::enable_if_t<std::is_arithmetic<U>::value, int> = 0>
+		explicit half(U value) : mBits(detail::half_encode(static_cast<float>(value))) {}
+
+		static half from_bits(uint16_t bits) {
+			half value;
+
+			value.mBits = bits;
+
+			return value;
+		}
+
+		uint16_t bits() const { return mBits; }
+
+		//the arithmetic of half is the arithmetic of float
+		operator float() const { return detail::half_decode(mBits); }
+	private:
+		uint16_t mBits = 0;
+	};
+
+	/**
+	 * \brief convert the half array to float array
+	 * \param input the half array
+	 * \param output the float array
+	 * \param size the number of elements
+	 */
+	inline void half_to_float(const half* input, float* output, size_t size) {
+		size_t index = 0;
+
+#if defined(ALG_DAT_F16C)
+		for (; index + 8 <= size; index += 8)
+			_mm256_storeu_ps(output + index, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + index))));
+#elif defined(ALG_DAT_HALF_NEON)
+		for (; index + 4 <= size; index += 4)
+			vst1q_f32(output + index, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(reinterpret_cast<const uint16_t*>(input + index)))));
+#endif
+
+		for (; index < size; index++) output[index] = static_cast<float>(input[index]);
+	}
+
+	/**
+	 * \brief convert the float array to half array, round to nearest even
+	 * \param input the float array
+	 * \param output the half array
+	 * \param size the number of elements
+	 */
+	inline void float_to_half(const float* input, half* output, size_t size) {
+		size_t index = 0;
+
+#if defined(ALG_DAT_F16C)
+		for (; index + 8 <= size; index += 8) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + index),
+				_mm256_cvtps_ph(_mm256_loadu_ps(input + index), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+		}
+#elif defined(ALG_DAT_HALF_NEON)
+		for (; index + 4 <= size; index += 4)
+			vst1_u16(reinterpret_cast<uint16_t*>(output + index), vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(input + index))));
+#endif
+
+		for (; index < size; index++) output[index] = half(input[index]);
+	}
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+/*
+ * @name aligned_buffer.hpp
+ * aligned_buffer is a fixed size array of elements and the memory is aligned to the cache line.
+ * It is used by the containers that want to load the elements with SIMD instructions.
+ *
+ * The Element should be trivially copyable, because we move the memory with std::memcpy.
+ * The elements are zero initialized when we create or expand the buffer.
+ */
+
+#include <type_traits>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+
+#include "../simd.hpp"
+
+namespace alg_dat {
+
+	/**
+	 * \brief malloc memory with alignment
+	 * \param size the size in bytes
+	 * \param alignment alignment, must be power of 2
+	 * \return the memory, nullptr if failed
+	 */
+	inline void* aligned_malloc(size_t size, size_t alignment = cache_line_size) {
+		//aligned_alloc need the size is multiple of alignment
+		size = (size + alignment - 1) & ~(alignment - 1);
+
+		if (size == 0) size = alignment;
+		
+#ifdef _MSC_VER
+		return _aligned_malloc(size, alignment);
+#else
+		return std::aligned_alloc(alignment, size);
+#endif
+	}
+
+	inline void aligned_free(void* memory) {
+#ifdef _MSC_VER
+		_aligned_free(memory);
+#else
+		std::free(memory);
+#endif
+	}
+	
+	template<typename Element, size_t Alignment = cache_line_size>
+	class aligned_buffer {
+		static_assert(std::is_trivially_copyable<Element>::value, "aligned_buffer need trivially copyable element.");
+		static_assert((Alignment & (Alignment - 1)) == 0, "alignment must be power of 2.");
+	public:
+		using size_type = size_t;
+		using type = Element;
+	public:
+		aligned_buffer() = default;
+
+		explicit aligned_buffer(size_type size) { resize(size); }
+
+		aligned_buffer(size_type size, const Element& value) : aligned_buffer(size) {
+			std::fill(mElements, mElements + mSize, value);
+		}
+
+		aligned_buffer(const aligned_buffer& buffer) : aligned_buffer(buffer.mSize) {
+			if (mSize != 0) std::memcpy(mElements, buffer.mElements, sizeof(Element) * mSize);
+		}
+
+		aligned_buffer(aligned_buffer&& buffer) noexcept {
+			std::swap(mElements, buffer.mElements);
+			std::swap(mSize, buffer.mSize);
+		}
+
+		~aligned_buffer() {
+			if (mElements == nullptr) return;
+
+			aligned_free(mElements);
+
+			mElements = nullptr;
+		}
+
+		aligned_buffer& operator=(const aligned_buffer& buffer) {
+			if (this == &buffer) return *this;
+
+			aligned_buffer temp(buffer);
+
+			return *this = std::move(temp);
+		}
+
+		aligned_buffer& operator=(aligned_buffer&& buffer) noexcept {
+			if (this == &buffer) return *this;
+
+			std::swap(mElements, buffer.mElements);
+			std::swap(mSize, buffer.mSize);
+
+			return *this;
+		}
+
+		/**
+		 * \brief resize the buffer, the old elements will be kept and new elements are zero.
+		 * \param size the number of elements
+		 */
+		void resize(size_type size) {
+			if (size == mSize) return;
+
+			const auto temp = static_cast<Element*>(aligned_malloc(sizeof(Element) * size, Alignment));
+
+			assert(temp != nullptr);
+
+			const auto keep = std::min(size, mSize);
+
+			if (keep != 0) std::memcpy(temp, mElements, sizeof(Element) * keep);
+			if (size > keep) std::memset(static_cast<void*>(temp + keep), 0, sizeof(Element) * (size - keep));
+			if (mElements != nullptr) aligned_free(mElements);
+
+			mElements = temp;
+			mSize = size;
+		}
+
+		void fill(const Element& value) { std::fill(mElements, mElements + mSize, value); }
+		
+		Element& operator[](size_type index) {
+			assert(index < mSize);
+
+			return mElements[index];
+		}
+
+		const Element& operator[](size_type index) const {
+			assert(index < mSize);
+
+			return mElements[index];
+		}
+
+		Element* data() { return mElements; }
+
+		const Element* data() const { return mElements; }
+
+		Element* begin() { return mElements; }
+
+		Element* end() { return mElements + mSize; }
+
+		const Element* begin() const { return mElements; }
+
+		const Element* end() const { return mElements + mSize; }
+
+		size_type size() const { return mSize; }
+
+		bool empty() const { return mSize == 0; }
+	private:
+		Element* mElements = nullptr;
+		size_type mSize = 0;
+	};
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+/*
+ * @name pool_allocator.hpp
+ *
+ * block_pool is a allocator for blocks with same size, the blocks can be freed in any order.
+ * The memory is allocated in chunks and never moved, so the pointer of block is valid until we free it.
+ * The free blocks are linked in a free list, so the allocate and free are O(1).
+ *
+ * pool_allocator is a block_pool for Element, we can construct and destroy the elements.
+ * size_class_pool is some block_pools with size of power of 2, it is used by the nodes with variable size.
+ *
+ * The space is the number of blocks we have and the size is the number of blocks we used.
+ * When there is no free block, we use ExpandClass to compute the number of blocks in next chunk.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "allocator.hpp"
+
+namespace alg_dat {
+
+	template<typename ExpandClass = expand_class_mul>
+	class block_pool : public allocator_interface<ExpandClass> {
+	public:
+		using base = allocator_interface<ExpandClass>;
+		using typename base::expand_class;
+		using typename base::size_type;
+	public:
+		block_pool() : block_pool(sizeof(void*)) {}
+
+		/**
+		 * \brief create block pool
+		 * \param block_size the size in bytes of block
+		 * \param space the number of blocks in first chunk
+		 * \param factor the factor of expand class
+		 */
+		explicit block_pool(size_type block_size, size_type space = 64, size_type factor = 2) :
+			base(0, factor), mFirstChunk(space)
+		{
+			assert(space != 0);
+
+			//the free block store the next free block, so it should be able to store a pointer
+			constexpr auto alignment = alignof(std::max_align_t);
+
+			block_size = std::max(block_size, sizeof(void*));
+
+			mBlockSize = (block_size + alignment - 1) / alignment * alignment;
+		}
+
+		block_pool(const block_pool&) = delete;
+
+		block_pool(block_pool&& pool) noexcept : base(std::move(pool)) {
+			std::swap(mChunks, pool.mChunks);
+			std::swap(mFree, pool.mFree);
+			std::swap(mBlockSize, pool.mBlockSize);
+			std::swap(mFirstChunk, pool.mFirstChunk);
+		}
+
+		block_pool& operator=(const block_pool&) = delete;
+
+		block_pool& operator=(block_pool&& pool) noexcept {
+			if (this == &pool) return *this;
+
+			std::swap(base::mExpandFactor, pool.mExpandFactor);
+			std::swap(base::mMemorySpace, pool.mMemorySpace);
+			std::swap(base::mMemorySize, pool.mMemorySize);
+			std::swap(mChunks, pool.mChunks);
+			std::swap(mFree, pool.mFree);
+			std::swap(mBlockSize, pool.mBlockSize);
+			std::swap(mFirstChunk, pool.mFirstChunk);
+
+			return *this;
+		}
+
+		~block_pool() {
+			for (auto chunk : mChunks) std::free(chunk);
+
+			mChunks.clear();
+		}
+
+		auto allocate() -> void* {
+			if (mFree == nullptr) expand();
+
+			const auto block = mFree;
+
+			mFree = *static_cast<void**>(block);
+
+			base::mMemorySize++;
+
+			return block;
+		}
+
+		void deallocate(void* block) {
+			assert(block != nullptr && base::mMemorySize != 0);
+
+			*static_cast<void**>(block) = mFree;
+
+			mFree = block;
+
+			base::mMemorySize--;
+		}
+
+		size_type block_size() const { return mBlockSize; }
+	private:
+		void expand() {
+			static ExpandClass expandSpace;
+
+			//the first chunk is the space we set, and next chunks are computed by expand class
+			const auto count = base::mMemorySpace == 0 ? mFirstChunk :
+				std::max(expandSpace(this, base::mMemorySpace + 1), static_cast<size_type>(1));
+
+			const auto chunk = static_cast<char*>(std::malloc(count * mBlockSize));
+
+			assert(chunk != nullptr);
+
+			//link the blocks of new chunk into free list
+			for (size_type index = count; index > 0; index--) {
+				const auto block = chunk + (index - 1) * mBlockSize;
+
+				*reinterpret_cast<void**>(block) = mFree;
+
+				mFree = block;
+			}
+
+			mChunks.push_back(chunk);
+
+			base::mMemorySpace = base::mMemorySpace + count;
+		}
+	private:
+		std::vector<void*> mChunks;
+		void* mFree = nullptr;
+
+		size_type mBlockSize = 0;
+		size_type mFirstChunk = 0;
+	};
+
+	template<typename Element, typename ExpandClass = expand_class_mul>
+	class pool_allocator : public block_pool<ExpandClass> {
+	public:
+		using base = block_pool<ExpandClass>;
+		using typename base::expand_class;
+		using typename base::size_type;
+		using type = Element;
+	public:
+		explicit pool_allocator(size_type space = 64, size_type factor = 2) : base(sizeof(Element), space, factor) {
+			static_assert(alignof(Element) <= alignof(std::max_align_t), "pool_allocator do not support over aligned element.");
+		}
+
+		pool_allocator(pool_allocator&& allocator) noexcept : base(std::move(allocator)) {}
+
+		pool_allocator& operator=(pool_allocator&& allocator) noexcept {
+			base::operator=(std::move(allocator));
+
+			return *this;
+		}
+
+		template<typename ...Types>
+		auto construct(Types&& ... args)->Element* {
+			return new (base::allocate())Element(std::forward<Types>(args)...);
+		}
+
+		void destroy(Element* element) {
+			element->~Element();
+
+			base::deallocate(element);
+		}
+	};
+
+	template<typename ExpandClass = expand_class_mul>
+	class size_class_pool {
+	public:
+		using size_type = size_t;
+	public:
+		/**
+		 * \brief create pools with block size min_size, min_size * 2, ..., up to max_size
+		 * \param min_size the min size in bytes
+		 * \param max_size the max size in bytes
+		 */
+		size_class_pool(size_type min_size, size_type max_size) {
+			assert(min_size != 0 && min_size <= max_size);
+
+			for (auto size = min_size; ; size = size << 1) {
+				mPools.emplace_back(size);
+
+				if (size >= max_size) break;
+			}
+		}
+
+		auto allocate(size_type size) -> void* {
+			return mPools[class_of(size)].allocate();
+		}
+
+		//the size should be same as the size we allocate
+		void deallocate(void* block, size_type size) {
+			mPools[class_of(size)].deallocate(block);
+		}
+	private:
+		auto class_of(size_type size) const -> size_type {
+			size_type index = 0;
+
+			while (mPools[index].block_size() < size) {
+				index++;
+
+				assert(index < mPools.size());
+			}
+
+			return index;
+		}
+	private:
+		std::vector<block_pool<ExpandClass>> mPools;
+	};
+}
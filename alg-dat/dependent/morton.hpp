@@ -0,0 +1,36 @@
+#pragma once
+
+/*
+ * morton.hpp
+ * Morton (Z-order) codes of 2D cells, the bits of x and y are interleaved.
+ * The near cells have near codes, so the elements sorted by the codes of their cells are local in space
+ * (bvh2 builds the tree from the sorted codes, kd_tree2 sorts the batched queries by them).
+ */
+
+#include <cstdint>
+
+namespace alg_dat {
+
+	namespace detail {
+
+		//insert one zero bit between the bits of value, 16 bits to 32 bits
+		inline auto morton_expand_bits(uint32_t value) -> uint32_t {
+			value = (value | (value << 8)) & 0x00FF00FFu;
+			value = (value | (value << 4)) & 0x0F0F0F0Fu;
+			value = (value | (value << 2)) & 0x33333333u;
+			value = (value | (value << 1)) & 0x55555555u;
+
+			return value;
+		}
+	}
+
+	/**
+	 * \brief the Morton code of cell
+	 * \param x the x of cell, it is less than 65536
+	 * \param y the y of cell, it is less than 65536
+	 * \return the code, the bit 2i is the bit i of x and the bit 2i + 1 is the bit i of y
+	 */
+	inline auto morton_code2(uint32_t x, uint32_t y) -> uint32_t {
+		return detail::morton_expand_bits(x) | (detail::morton_expand_bits(y) << 1);
+	}
+}
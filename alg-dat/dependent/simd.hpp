@@ -0,0 +1,85 @@
+#pragma once
+
+/*
+ * simd.hpp
+ * Detect the instruction sets we can use and include the intrinsic headers.
+ * Every SIMD path in alg-dat is guarded by these macros and has a scalar fallback,
+ * so the library still works on the compilers and platforms without them.
+ *
+ * ALG_DAT_SSE2   : SSE2 (always on x86-64).
+ * ALG_DAT_SSE41  : SSE4.1.
+ * ALG_DAT_AVX2   : AVX2.
+ * ALG_DAT_FMA    : FMA3.
+ * ALG_DAT_F16C   : F16C, the conversions between half and float.
+ * ALG_DAT_AVX512 : AVX-512 F + VL + BW + DQ.
+ * ALG_DAT_NEON   : ARM NEON.
+ *
+ * Define ALG_DAT_NO_SIMD before including any header to force the scalar paths.
+ */
+
+#include <cstddef>
+
+#ifndef ALG_DAT_NO_SIMD
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ALG_DAT_SSE2
+#endif
+
+#if defined(__SSE4_1__) || defined(__AVX__)
+#define ALG_DAT_SSE41
+#endif
+
+#if defined(__AVX2__)
+#define ALG_DAT_AVX2
+#endif
+
+#if defined(__AVX512F__) && defined(__AVX512VL__) && defined(__AVX512BW__) && defined(__AVX512DQ__)
+#define ALG_DAT_AVX512
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define ALG_DAT_NEON
+#endif
+
+//MSVC has no __FMA__, but /arch:AVX2 implies FMA3
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define ALG_DAT_FMA
+#endif
+
+//MSVC has no __F16C__, but /arch:AVX2 implies F16C
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define ALG_DAT_F16C
+#endif
+
+#endif
+
+#if defined(ALG_DAT_SSE2)
+#include <immintrin.h>
+#endif
+
+#if defined(ALG_DAT_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace alg_dat {
+
+	//the size of cache line, we use it to align the memory of containers.
+	constexpr size_t cache_line_size = 64;
+
+	namespace detail {
+
+		/*
+		 * whether the constexpr function is evaluated at compile time, it is std::is_constant_evaluated of C++20.
+		 * The intrinsics are not constexpr, so the constexpr functions use the scalar path when it is true.
+		 * If the compiler has no builtin, it is always true and we never use the SIMD path in constexpr functions.
+		 */
+		constexpr bool constant_evaluated() noexcept {
+#if (defined(__GNUC__) && __GNUC__ >= 9) || (defined(__clang__) && __clang_major__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+			return __builtin_is_constant_evaluated();
+#else
+			return true;
+#endif
+		}
+	}
+	
+}
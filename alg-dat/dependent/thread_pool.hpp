@@ -0,0 +1,533 @@
+#pragma once
+
+/*
+ * thread_pool.hpp
+ * A work-stealing thread pool, the shared runtime of parallel algorithms.
+ *
+ * Every worker has a Chase-Lev deque (Chase and Lev 2005, the C11 version of Le et al. 2013) :
+ * the worker pushes and takes the tasks at the bottom, the other workers steal the tasks at the top.
+ * The tasks are on the stack of join(), so the pool never allocates a task.
+ *
+ * join(f0, f1) : fork f1 to the deque, run f0, then run f1 if it is not stolen, or run the other tasks until it is done.
+ * parallel_for(first, last, function, grain) : call function(begin, end) for the sub ranges of [first, last).
+ * It splits the range lazily (lazy binary splitting, Tzannes et al. 2010) : a worker splits its range only if its deque is empty,
+ * so the range is cut to grain only when the other workers are idle, the grain adapts to the load.
+ * run(function) : run function in the pool and wait for it. The thread out of the pool sleeps during the run,
+ * so the pool never uses more threads than thread_count(), the algorithms can run on a pool provided by the caller.
+ *
+ * The idle workers sleep on a condition variable, the new tasks wake them up.
+ * thread_pool(thread_count, pin) : 0 means std::thread::hardware_concurrency(), pin binds the worker i to the processor i.
+ * default_thread_pool() : the pool shared by the algorithms if the caller provides no pool.
+ *
+ * The exception of task is thrown again by join() (and run(), parallel_for()).
+ */
+
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <deque>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#define ALG_DAT_UNDEF_NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#define ALG_DAT_UNDEF_WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#ifdef ALG_DAT_UNDEF_NOMINMAX
+#undef NOMINMAX
+#undef ALG_DAT_UNDEF_NOMINMAX
+#endif
+#ifdef ALG_DAT_UNDEF_WIN32_LEAN_AND_MEAN
+#undef WIN32_LEAN_AND_MEAN
+#undef ALG_DAT_UNDEF_WIN32_LEAN_AND_MEAN
+#endif
+#endif
+
+namespace alg_dat {
+
+	class thread_pool;
+
+	namespace detail {
+
+		//the task on the stack of its owner, invoke sets done at last, then the owner may destroy the task
+		struct thread_pool_task {
+			void (*invoke)(thread_pool_task*) = nullptr;
+
+			std::exception_ptr error;
+			std::atomic<bool> done = { false };
+		};
+
+		template<typename Function>
+		struct thread_pool_closure : thread_pool_task {
+			explicit thread_pool_closure(Function& function) : function(function) {
+				invoke = [](thread_pool_task* task) {
+					const auto closure = static_cast<thread_pool_closure*>(task);
+
+					try {
+						closure->function();
+					}
+					catch (...) {
+						closure->error = std::current_exception();
+					}
+
+					closure->done.store(true, std::memory_order_release);
+				};
+			}
+
+			Function& function;
+		};
+
+		//the task of the thread out of pool, the thread sleeps until it is done
+		template<typename Function>
+		struct thread_pool_injected : thread_pool_task {
+			explicit thread_pool_injected(Function& function) : function(function) {
+				invoke = [](thread_pool_task* task) {
+					const auto injected = static_cast<thread_pool_injected*>(task);
+
+					try {
+						injected->function();
+					}
+					catch (...) {
+						injected->error = std::current_exception();
+					}
+
+					std::lock_guard<std::mutex> lock(injected->mutex);
+
+					injected->done.store(true, std::memory_order_release);
+					injected->condition.notify_one();
+				};
+			}
+
+			Function& function;
+
+			std::mutex mutex;
+			std::condition_variable condition;
+		};
+
+		//the Chase-Lev deque, the owner pushes and takes at bottom, the thieves steal at top
+		class thread_pool_deque {
+		public:
+			thread_pool_deque() { mArray.store(allocate(64), std::memory_order_relaxed); }
+
+			thread_pool_deque(const thread_pool_deque&) = delete;
+
+			thread_pool_deque& operator=(const thread_pool_deque&) = delete;
+
+			//only the owner
+			void push(thread_pool_task* task) {
+				const auto bottom = mBottom.load(std::memory_order_relaxed);
+				const auto top = mTop.load(std::memory_order_acquire);
+
+				auto array = mArray.load(std::memory_order_relaxed);
+
+				if (bottom - top > static_cast<int64_t>(array->mask)) array = grow(array, top, bottom);
+
+				array->slot(bottom).store(task, std::memory_order_relaxed);
+
+				//the thieves read bottom by acquire, so they see the task
+				mBottom.store(bottom + 1, std::memory_order_release);
+			}
+
+			//only the owner, nullptr if the deque is empty
+			thread_pool_task* take() {
+				const auto bottom = mBottom.load(std::memory_order_relaxed) - 1;
+				const auto array = mArray.load(std::memory_order_relaxed);
+
+				mBottom.store(bottom, std::memory_order_relaxed);
+
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				auto top = mTop.load(std::memory_order_relaxed);
+
+				if (top > bottom) {
+					mBottom.store(bottom + 1, std::memory_order_relaxed);
+
+					return nullptr;
+				}
+
+				auto task = array->slot(bottom).load(std::memory_order_relaxed);
+
+				//the last task, race with the thieves
+				if (top == bottom) {
+					if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) task = nullptr;
+
+					mBottom.store(bottom + 1, std::memory_order_relaxed);
+				}
+
+				return task;
+			}
+
+			//any thread, nullptr if the deque is empty or another thread wins
+			thread_pool_task* steal() {
+				auto top = mTop.load(std::memory_order_acquire);
+
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				const auto bottom = mBottom.load(std::memory_order_acquire);
+
+				if (top >= bottom) return nullptr;
+
+				const auto array = mArray.load(std::memory_order_acquire);
+				const auto task = array->slot(top).load(std::memory_order_relaxed);
+
+				if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return nullptr;
+
+				return task;
+			}
+
+			//only the owner
+			bool empty() const {
+				return mBottom.load(std::memory_order_relaxed) <= mTop.load(std::memory_order_relaxed);
+			}
+		private:
+			struct array_type {
+				size_t mask;
+				std::unique_ptr<std::atomic<thread_pool_task*>[]> slots;
+
+				std::atomic<thread_pool_task*>& slot(int64_t index) { return slots[static_cast<size_t>(index) & mask]; }
+			};
+
+			array_type* allocate(size_t capacity) {
+				mArrays.push_back(std::unique_ptr<array_type>(new array_type{ capacity - 1, std::unique_ptr<std::atomic<thread_pool_task*>[]>(new std::atomic<thread_pool_task*>[capacity]) }));
+
+				return mArrays.back().get();
+			}
+
+			//the thieves may read the old array, so it is kept until the deque is destroyed
+			array_type* grow(array_type* array, int64_t top, int64_t bottom) {
+				const auto larger = allocate((array->mask + 1) << 1);
+
+				for (auto index = top; index < bottom; index++)
+					larger->slot(index).store(array->slot(index).load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+				mArray.store(larger, std::memory_order_release);
+
+				return larger;
+			}
+		private:
+			alignas(64) std::atomic<int64_t> mTop = { 0 };
+			alignas(64) std::atomic<int64_t> mBottom = { 0 };
+
+			std::atomic<array_type*> mArray = { nullptr };
+			std::vector<std::unique_ptr<array_type>> mArrays;
+		};
+
+		struct thread_pool_worker {
+			thread_pool* pool = nullptr;
+			size_t index = 0;
+			uint32_t random = 0;
+
+			thread_pool_deque deque;
+		};
+
+		//the worker of current thread, nullptr if the thread is not a worker
+		inline thread_pool_worker*& thread_pool_current() {
+			static thread_local thread_pool_worker* worker = nullptr;
+
+			return worker;
+		}
+
+		//bind the thread to the processor
+		inline void thread_pool_pin(std::thread& thread, size_t processor) {
+#if defined(__linux__)
+			cpu_set_t set;
+
+			CPU_ZERO(&set);
+			CPU_SET(static_cast<int>(processor % CPU_SETSIZE), &set);
+
+			pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &set);
+#elif defined(_WIN32)
+			SetThreadAffinityMask(static_cast<HANDLE>(thread.native_handle()), static_cast<DWORD_PTR>(1) << (processor % (sizeof(DWORD_PTR) * 8)));
+#else
+			(void)thread;
+			(void)processor;
+#endif
+		}
+	}
+
+	class thread_pool {
+	public:
+		using size_type = size_t;
+	public:
+		/**
+		 * \brief start the workers
+		 * \param thread_count the number of workers, 0 means std::thread::hardware_concurrency()
+		 * \param pin bind the worker i to the processor i % std::thread::hardware_concurrency()
+		 */
+		explicit thread_pool(size_type thread_count = 0, bool pin = false) {
+			const auto processor_count = std::max(static_cast<size_type>(std::thread::hardware_concurrency()), static_cast<size_type>(1));
+
+			if (thread_count == 0) thread_count = processor_count;
+
+			for (size_type index = 0; index < thread_count; index++) {
+				mWorkers.emplace_back(new detail::thread_pool_worker());
+
+				mWorkers.back()->pool = this;
+				mWorkers.back()->index = index;
+				mWorkers.back()->random = static_cast<uint32_t>(index * 0x9E3779B9u + 1);
+			}
+
+			for (size_type index = 0; index < thread_count; index++) {
+				mThreads.emplace_back([this, index]() { work(*mWorkers[index]); });
+
+				if (pin) detail::thread_pool_pin(mThreads.back(), index % processor_count);
+			}
+		}
+
+		thread_pool(const thread_pool&) = delete;
+
+		thread_pool& operator=(const thread_pool&) = delete;
+
+		~thread_pool() {
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+
+				mStop.store(true);
+			}
+
+			mCondition.notify_all();
+
+			for (auto& thread : mThreads) thread.join();
+		}
+
+		size_type thread_count() const { return mWorkers.size(); }
+
+		//whether current thread is a worker of this pool
+		bool contains_current() const {
+			const auto worker = detail::thread_pool_current();
+
+			return worker != nullptr && worker->pool == this;
+		}
+
+		/**
+		 * \brief run the function in the pool and wait for it, the function is called directly in the worker of this pool
+		 * \param function function()
+		 */
+		template<typename Function>
+		void run(Function&& function) {
+			if (contains_current()) {
+				function();
+
+				return;
+			}
+
+			//the caller sleeps until a worker finishes the task
+			detail::thread_pool_injected<std::remove_reference_t<Function>> task(function);
+
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+
+				mInjected.push_back(&task);
+				mInjectedCount.fetch_add(1);
+			}
+
+			wake();
+
+			{
+				std::unique_lock<std::mutex> lock(task.mutex);
+
+				task.condition.wait(lock, [&]() { return task.done.load(std::memory_order_acquire); });
+			}
+
+			if (task.error) std::rethrow_exception(task.error);
+		}
+
+		/**
+		 * \brief run f0 and f1 in parallel and wait for them
+		 * \param f0 f0()
+		 * \param f1 f1(), it may be stolen by other workers
+		 */
+		template<typename Function0, typename Function1>
+		void join(Function0&& f0, Function1&& f1) {
+			if (!contains_current()) {
+				run([&]() { join(f0, f1); });
+
+				return;
+			}
+
+			auto& worker = *detail::thread_pool_current();
+
+			detail::thread_pool_closure<std::remove_reference_t<Function1>> task(f1);
+
+			worker.deque.push(&task);
+
+			wake();
+
+			std::exception_ptr error;
+
+			try {
+				f0();
+			}
+			catch (...) {
+				error = std::current_exception();
+			}
+
+			//the tasks pushed by f0 are taken by their join, so the bottom is our task if it is not stolen
+			if (worker.deque.take() == &task) task.invoke(&task);
+			else wait(worker, task);
+
+			if (error) std::rethrow_exception(error);
+			if (task.error) std::rethrow_exception(task.error);
+		}
+
+		/**
+		 * \brief call function(begin, end) for the sub ranges of [first, last) in parallel
+		 * \param first the first index
+		 * \param last the end of indices
+		 * \param function function(begin, end)
+		 * \param grain the minimum size of sub ranges, 0 means (last - first) / (32 * thread_count())
+		 */
+		template<typename Function>
+		void parallel_for(size_type first, size_type last, Function&& function, size_type grain = 0) {
+			if (first >= last) return;
+
+			if (grain == 0) grain = (last - first) / (thread_count() * 32);
+
+			grain = std::max(grain, static_cast<size_type>(1));
+
+			run([&]() { split(first, last, function, grain); });
+		}
+	private:
+		template<typename Function>
+		void split(size_type first, size_type last, Function& function, size_type grain) {
+			const auto& worker = *detail::thread_pool_current();
+
+			while (last - first > grain) {
+				//the last half we forked is not stolen, nobody is idle, so do not split
+				if (!worker.deque.empty()) {
+					function(first, first + grain);
+
+					first = first + grain;
+
+					continue;
+				}
+
+				const auto middle = first + (last - first) / 2;
+
+				join([&]() { split(first, middle, function, grain); }, [&]() { split(middle, last, function, grain); });
+
+				return;
+			}
+
+			function(first, last);
+		}
+
+		//the task is stolen, run the other tasks until it is done
+		void wait(detail::thread_pool_worker& worker, const detail::thread_pool_task& task) {
+			while (!task.done.load(std::memory_order_acquire)) {
+				if (const auto other = find(worker)) other->invoke(other);
+				else std::this_thread::yield();
+			}
+		}
+
+		//the task of own deque, or the task stolen from a random worker, or the task of caller out of pool
+		detail::thread_pool_task* find(detail::thread_pool_worker& worker) {
+			if (const auto task = worker.deque.take()) return task;
+
+			worker.random = worker.random * 1664525u + 1013904223u;
+
+			const auto count = mWorkers.size();
+			const auto start = static_cast<size_type>(worker.random >> 8) % count;
+
+			for (size_type offset = 0; offset < count; offset++) {
+				const auto victim = (start + offset) % count;
+
+				if (victim == worker.index) continue;
+
+				if (const auto task = mWorkers[victim]->deque.steal()) return task;
+			}
+
+			if (mInjectedCount.load() != 0) {
+				std::lock_guard<std::mutex> lock(mMutex);
+
+				if (!mInjected.empty()) {
+					const auto task = mInjected.front();
+
+					mInjected.pop_front();
+					mInjectedCount.fetch_sub(1);
+
+					return task;
+				}
+			}
+
+			return nullptr;
+		}
+
+		//wake a sleeping worker for the new task
+		void wake() {
+			mEpoch.fetch_add(1);
+
+			if (mSleeping.load() != 0) {
+				std::lock_guard<std::mutex> lock(mMutex);
+
+				mCondition.notify_one();
+			}
+		}
+
+		void work(detail::thread_pool_worker& worker) {
+			constexpr size_type spin_count = 64;
+
+			detail::thread_pool_current() = &worker;
+
+			while (!mStop.load()) {
+				//read the epoch before the last search, so a task pushed after the search changes it
+				const auto epoch = mEpoch.load();
+
+				detail::thread_pool_task* task = nullptr;
+
+				for (size_type spin = 0; spin < spin_count && task == nullptr; spin++) {
+					task = find(worker);
+
+					if (task == nullptr) std::this_thread::yield();
+				}
+
+				if (task != nullptr) {
+					task->invoke(task);
+
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(mMutex);
+
+				mSleeping.fetch_add(1);
+				mCondition.wait(lock, [&]() { return mStop.load() || mEpoch.load() != epoch || mInjectedCount.load() != 0; });
+				mSleeping.fetch_sub(1);
+			}
+
+			detail::thread_pool_current() = nullptr;
+		}
+	private:
+		std::vector<std::unique_ptr<detail::thread_pool_worker>> mWorkers;
+		std::vector<std::thread> mThreads;
+
+		std::mutex mMutex;
+		std::condition_variable mCondition;
+		std::deque<detail::thread_pool_task*> mInjected;
+
+		std::atomic<size_type> mInjectedCount = { 0 };
+		std::atomic<size_type> mSleeping = { 0 };
+		std::atomic<uint64_t> mEpoch = { 0 };
+		std::atomic<bool> mStop = { false };
+	};
+
+	//the pool shared by the algorithms, it has std::thread::hardware_concurrency() workers
+	inline thread_pool& default_thread_pool() {
+		static thread_pool pool;
+
+		return pool;
+	}
+}
@@ -0,0 +1,994 @@
+#pragma once
+
+/*
+ * vec.hpp
+ * vec_t<T, N> is the N-dimensional vector, vec2_t/vec3_t/vec4_t are the aliases of N = 2, 3, 4.
+ * The vectors of 2, 3, 4 dimensions have named components (x, y, z, w), others store an array.
+ *
+ * The operations are expanded from std::index_sequence with fold expressions,
+ * so they are unrolled at compile time and there is no loop over the components.
+ * vec_t is a literal type, all operations except length and normalize (sqrt) are constexpr,
+ * so it can be used in constant expressions, e.g. the geometry tables computed at compile time.
+ *
+ * There are SIMD specializations for vec_t<float, 2>, vec_t<int32_t, 2> and vec_t<float, 4>, see below.
+ */
+
+#include <type_traits>
+#include <algorithm>
+#include <utility>
+#include <cassert>
+#include <cstdint>
+#include <cmath>
+
+#include "../utility.hpp"
+#include "simd.hpp"
+
+namespace alg_dat {
+
+	namespace detail {
+
+		using std::sqrt;
+
+		//std::sqrt of arithmetic types, the other types (e.g. fixed_t) provide their sqrt found by ADL
+		template<typename T>
+		auto vec_sqrt(T value) -> decltype(sqrt(value)) { return sqrt(value); }
+
+		//the components of vec_t with N > 4, they are stored in an array
+		template<typename T, size_t N>
+		struct vec_components {
+			T values[N];
+
+			template<typename... Args>
+			constexpr vec_components(Args... args) noexcept : values{ args... } {}
+
+			constexpr T& component(size_t index) noexcept { return values[index]; }
+
+			constexpr const T& component(size_t index) const noexcept { return values[index]; }
+		};
+
+		template<typename T>
+		struct vec_components<T, 2> {
+			T x;
+			T y;
+
+			constexpr vec_components(T x, T y) noexcept : x(x), y(y) {}
+
+			constexpr T& component(size_t index) noexcept { return this->*members[index]; }
+
+			constexpr const T& component(size_t index) const noexcept { return this->*members[index]; }
+		private:
+			//index the component without branch
+			static constexpr T vec_components::* members[2] = { &vec_components::x, &vec_components::y };
+		};
+
+		template<typename T>
+		struct vec_components<T, 3> {
+			T x;
+			T y;
+			T z;
+
+			constexpr vec_components(T x, T y, T z) noexcept : x(x), y(y), z(z) {}
+
+			constexpr T& component(size_t index) noexcept { return this->*members[index]; }
+
+			constexpr const T& component(size_t index) const noexcept { return this->*members[index]; }
+		private:
+			static constexpr T vec_components::* members[3] = {
+				&vec_components::x, &vec_components::y, &vec_components::z };
+		};
+
+		template<typename T>
+		struct vec_components<T, 4> {
+			T x;
+			T y;
+			T z;
+			T w;
+
+			constexpr vec_components(T x, T y, T z, T w) noexcept : x(x), y(y), z(z), w(w) {}
+
+			constexpr T& component(size_t index) noexcept { return this->*members[index]; }
+
+			constexpr const T& component(size_t index) const noexcept { return this->*members[index]; }
+		private:
+			static constexpr T vec_components::* members[4] = {
+				&vec_components::x, &vec_components::y, &vec_components::z, &vec_components::w };
+		};
+	}
+
+	template<typename T, size_t N>
+	struct vec_t : detail::vec_components<T, N> {
+		static_assert(N >= 2, "the dimension of vec_t should be at least 2.");
+
+		using value_type = T;
+		using components = detail::vec_components<T, N>;
+
+		static constexpr size_t dimension = N;
+
+		constexpr vec_t() noexcept : vec_t(T(0)) {}
+
+		constexpr vec_t(T value) noexcept : vec_t(value, indices()) {}
+
+		template<typename... Args, typename = typename std::enable_if<sizeof...(Args) == N>::type>
+		constexpr vec_t(Args... args) noexcept : components(static_cast<T>(args)...) {}
+
+		constexpr T& operator [](size_t index) noexcept {
+			assert(index < N);
+
+			return this->component(index);
+		}
+
+		constexpr const T& operator [](size_t index) const noexcept {
+			assert(index < N);
+
+			return this->component(index);
+		}
+
+		constexpr vec_t operator+(const vec_t &vec) const noexcept {
+			return map(*this, vec, [](T v0, T v1) { return v0 + v1; }, indices());
+		}
+
+		constexpr vec_t operator-(const vec_t &vec) const noexcept {
+			return map(*this, vec, [](T v0, T v1) { return v0 - v1; }, indices());
+		}
+
+		constexpr vec_t operator-() const noexcept {
+			return map(*this, *this, [](T v0, T) { return -v0; }, indices());
+		}
+
+		constexpr vec_t operator*(const T &value) const noexcept {
+			return map(*this, vec_t(value), [](T v0, T v1) { return v0 * v1; }, indices());
+		}
+
+		//component-wise multiply
+		constexpr vec_t operator*(const vec_t &vec) const noexcept {
+			return map(*this, vec, [](T v0, T v1) { return v0 * v1; }, indices());
+		}
+
+		constexpr vec_t operator/(const T &value) const noexcept {
+			return map(*this, vec_t(value), [](T v0, T v1) { return v0 / v1; }, indices());
+		}
+
+		constexpr vec_t& operator+=(const vec_t &vec) noexcept {
+			return update(vec, [](T& v0, T v1) { v0 += v1; }, indices());
+		}
+
+		constexpr vec_t& operator-=(const vec_t &vec) noexcept {
+			return update(vec, [](T& v0, T v1) { v0 -= v1; }, indices());
+		}
+
+		constexpr vec_t& operator*=(const T &value) noexcept {
+			return update(vec_t(value), [](T& v0, T v1) { v0 *= v1; }, indices());
+		}
+
+		constexpr vec_t& operator*=(const vec_t &vec) noexcept {
+			return update(vec, [](T& v0, T v1) { v0 *= v1; }, indices());
+		}
+
+		constexpr vec_t& operator/=(const T &value) noexcept {
+			return update(vec_t(value), [](T& v0, T v1) { v0 /= v1; }, indices());
+		}
+
+		constexpr bool operator==(const vec_t &vec) const noexcept {
+			return equal(*this, vec, indices());
+		}
+
+		constexpr bool operator!=(const vec_t &vec) const noexcept {
+			return !(*this == vec);
+		}
+
+		//the length of integer vector is double, as std::sqrt does
+		auto length() const noexcept -> decltype(detail::vec_sqrt(T(0))) {
+			return detail::vec_sqrt(dot(*this, *this));
+		}
+
+		static constexpr vec_t min(const vec_t &v0, const vec_t &v1) noexcept {
+			return map(v0, v1, [](T c0, T c1) { return std::min(c0, c1); }, indices());
+		}
+
+		static constexpr vec_t max(const vec_t &v0, const vec_t &v1) noexcept {
+			return map(v0, v1, [](T c0, T c1) { return std::max(c0, c1); }, indices());
+		}
+
+		static constexpr T dot(const vec_t &v0, const vec_t &v1) noexcept {
+			return dot(v0, v1, indices());
+		}
+
+		static vec_t normalize(const vec_t &vec) noexcept {
+			const auto length = vec.length();
+
+			assert(length != T(0));
+
+			return map(vec, vec, [length](T v0, T) { return static_cast<T>(v0 / length); }, indices());
+		}
+
+		//v0 * v1 + v2 component-wise
+		static constexpr vec_t fma(const vec_t &v0, const vec_t &v1, const vec_t &v2) noexcept {
+			return fma(v0, v1, v2, indices());
+		}
+	private:
+		using indices = std::make_index_sequence<N>;
+
+		template<size_t... I>
+		constexpr vec_t(T value, std::index_sequence<I...>) noexcept : components(((void)I, value)...) {}
+
+		template<typename Operation, size_t... I>
+		static constexpr vec_t map(const vec_t &v0, const vec_t &v1, Operation operation, std::index_sequence<I...>) noexcept {
+			return vec_t(operation(v0[I], v1[I])...);
+		}
+
+		template<typename Operation, size_t... I>
+		constexpr vec_t& update(const vec_t &vec, Operation operation, std::index_sequence<I...>) noexcept {
+			(operation((*this)[I], vec[I]), ...);
+
+			return *this;
+		}
+
+		template<size_t... I>
+		static constexpr bool equal(const vec_t &v0, const vec_t &v1, std::index_sequence<I...>) noexcept {
+			return (... && (v0[I] == v1[I]));
+		}
+
+		template<size_t... I>
+		static constexpr T dot(const vec_t &v0, const vec_t &v1, std::index_sequence<I...>) noexcept {
+			return (... + (v0[I] * v1[I]));
+		}
+
+		template<size_t... I>
+		static constexpr vec_t fma(const vec_t &v0, const vec_t &v1, const vec_t &v2, std::index_sequence<I...>) noexcept {
+			return vec_t((v0[I] * v1[I] + v2[I])...);
+		}
+	};
+
+	/*
+	 * The specializations of vec_t<float, 2> and vec_t<int32_t, 2> with SSE or NEON.
+	 * The two components are packed into one 64-bit lane, we load them with movq (SSE) or vld1 (NEON),
+	 * so every operation is one instruction instead of two. They have same API as the vec_t<T, 2>.
+	 * The intrinsics are not constexpr, so the operations use the scalar path in constant evaluation.
+	 */
+#if defined(ALG_DAT_SSE2) || defined(ALG_DAT_NEON)
+	namespace detail {
+
+#if defined(ALG_DAT_SSE2)
+		using vec2f_register = __m128;
+		using vec2i_register = __m128i;
+
+		inline vec2f_register vec2f_load(const float* value) {
+			return _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(value)));
+		}
+
+		inline void vec2f_store(float* value, vec2f_register vec) {
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(value), _mm_castps_si128(vec));
+		}
+
+		inline vec2f_register vec2f_add(vec2f_register v0, vec2f_register v1) { return _mm_add_ps(v0, v1); }
+
+		inline vec2f_register vec2f_sub(vec2f_register v0, vec2f_register v1) { return _mm_sub_ps(v0, v1); }
+
+		inline vec2f_register vec2f_mul(vec2f_register v0, vec2f_register v1) { return _mm_mul_ps(v0, v1); }
+
+		inline vec2f_register vec2f_scale(vec2f_register v0, float value) { return _mm_mul_ps(v0, _mm_set1_ps(value)); }
+
+		inline vec2f_register vec2f_min(vec2f_register v0, vec2f_register v1) { return _mm_min_ps(v0, v1); }
+
+		inline vec2f_register vec2f_max(vec2f_register v0, vec2f_register v1) { return _mm_max_ps(v0, v1); }
+
+		inline vec2f_register vec2f_fma(vec2f_register v0, vec2f_register v1, vec2f_register v2) {
+#if defined(ALG_DAT_FMA)
+			return _mm_fmadd_ps(v0, v1, v2);
+#else
+			return _mm_add_ps(_mm_mul_ps(v0, v1), v2);
+#endif
+		}
+
+		//the sum of two lanes in lane 0
+		inline float vec2f_dot(vec2f_register v0, vec2f_register v1) {
+			const auto product = _mm_mul_ps(v0, v1);
+
+			return _mm_cvtss_f32(_mm_add_ss(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(1, 1, 1, 1))));
+		}
+
+		inline bool vec2f_equal(vec2f_register v0, vec2f_register v1) {
+			return (_mm_movemask_ps(_mm_cmpeq_ps(v0, v1)) & 3) == 3;
+		}
+
+		inline vec2i_register vec2i_load(const int32_t* value) {
+			return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(value));
+		}
+
+		inline void vec2i_store(int32_t* value, vec2i_register vec) {
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(value), vec);
+		}
+
+		inline vec2i_register vec2i_add(vec2i_register v0, vec2i_register v1) { return _mm_add_epi32(v0, v1); }
+
+		inline vec2i_register vec2i_sub(vec2i_register v0, vec2i_register v1) { return _mm_sub_epi32(v0, v1); }
+
+		inline vec2i_register vec2i_mul(vec2i_register v0, vec2i_register v1) {
+#if defined(ALG_DAT_SSE41)
+			return _mm_mullo_epi32(v0, v1);
+#else
+			//SSE2 only has the multiply of even lanes, so we multiply lane 0 and lane 1 with two instructions
+			const auto even = _mm_mul_epu32(v0, v1);
+			const auto odd = _mm_mul_epu32(_mm_srli_epi64(v0, 32), _mm_srli_epi64(v1, 32));
+
+			return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+		}
+
+		inline vec2i_register vec2i_scale(vec2i_register v0, int32_t value) { return vec2i_mul(v0, _mm_set1_epi32(value)); }
+
+		inline vec2i_register vec2i_min(vec2i_register v0, vec2i_register v1) {
+#if defined(ALG_DAT_SSE41)
+			return _mm_min_epi32(v0, v1);
+#else
+			const auto mask = _mm_cmpgt_epi32(v0, v1);
+
+			return _mm_or_si128(_mm_and_si128(mask, v1), _mm_andnot_si128(mask, v0));
+#endif
+		}
+
+		inline vec2i_register vec2i_max(vec2i_register v0, vec2i_register v1) {
+#if defined(ALG_DAT_SSE41)
+			return _mm_max_epi32(v0, v1);
+#else
+			const auto mask = _mm_cmpgt_epi32(v0, v1);
+
+			return _mm_or_si128(_mm_and_si128(mask, v0), _mm_andnot_si128(mask, v1));
+#endif
+		}
+
+		inline bool vec2i_equal(vec2i_register v0, vec2i_register v1) {
+			return (_mm_movemask_epi8(_mm_cmpeq_epi32(v0, v1)) & 0xFF) == 0xFF;
+		}
+#else
+		using vec2f_register = float32x2_t;
+		using vec2i_register = int32x2_t;
+
+		inline vec2f_register vec2f_load(const float* value) { return vld1_f32(value); }
+
+		inline void vec2f_store(float* value, vec2f_register vec) { vst1_f32(value, vec); }
+
+		inline vec2f_register vec2f_add(vec2f_register v0, vec2f_register v1) { return vadd_f32(v0, v1); }
+
+		inline vec2f_register vec2f_sub(vec2f_register v0, vec2f_register v1) { return vsub_f32(v0, v1); }
+
+		inline vec2f_register vec2f_mul(vec2f_register v0, vec2f_register v1) { return vmul_f32(v0, v1); }
+
+		inline vec2f_register vec2f_scale(vec2f_register v0, float value) { return vmul_n_f32(v0, value); }
+
+		inline vec2f_register vec2f_min(vec2f_register v0, vec2f_register v1) { return vmin_f32(v0, v1); }
+
+		inline vec2f_register vec2f_max(vec2f_register v0, vec2f_register v1) { return vmax_f32(v0, v1); }
+
+		inline vec2f_register vec2f_fma(vec2f_register v0, vec2f_register v1, vec2f_register v2) {
+#if defined(__aarch64__) || defined(_M_ARM64)
+			return vfma_f32(v2, v0, v1);
+#else
+			return vmla_f32(v2, v0, v1);
+#endif
+		}
+
+		inline float vec2f_dot(vec2f_register v0, vec2f_register v1) {
+			const auto product = vmul_f32(v0, v1);
+
+			return vget_lane_f32(vpadd_f32(product, product), 0);
+		}
+
+		inline bool vec2f_equal(vec2f_register v0, vec2f_register v1) {
+			const auto mask = vceq_f32(v0, v1);
+
+			return (vget_lane_u32(mask, 0) & vget_lane_u32(mask, 1)) != 0;
+		}
+
+		inline vec2i_register vec2i_load(const int32_t* value) { return vld1_s32(value); }
+
+		inline void vec2i_store(int32_t* value, vec2i_register vec) { vst1_s32(value, vec); }
+
+		inline vec2i_register vec2i_add(vec2i_register v0, vec2i_register v1) { return vadd_s32(v0, v1); }
+
+		inline vec2i_register vec2i_sub(vec2i_register v0, vec2i_register v1) { return vsub_s32(v0, v1); }
+
+		inline vec2i_register vec2i_mul(vec2i_register v0, vec2i_register v1) { return vmul_s32(v0, v1); }
+
+		inline vec2i_register vec2i_scale(vec2i_register v0, int32_t value) { return vmul_n_s32(v0, value); }
+
+		inline vec2i_register vec2i_min(vec2i_register v0, vec2i_register v1) { return vmin_s32(v0, v1); }
+
+		inline vec2i_register vec2i_max(vec2i_register v0, vec2i_register v1) { return vmax_s32(v0, v1); }
+
+		inline bool vec2i_equal(vec2i_register v0, vec2i_register v1) {
+			const auto mask = vceq_s32(v0, v1);
+
+			return (vget_lane_u32(mask, 0) & vget_lane_u32(mask, 1)) != 0;
+		}
+#endif
+	}
+
+	template<>
+	struct alignas(8) vec_t<float, 2> {
+		using value_type = float;
+
+		static constexpr size_t dimension = 2;
+
+		float x;
+		float y;
+
+		constexpr vec_t() noexcept : x(0), y(0) {}
+
+		constexpr vec_t(float x, float y) noexcept : x(x), y(y) {}
+
+		constexpr vec_t(float value) noexcept : x(value), y(value) {}
+
+		constexpr float& operator [](size_t index) noexcept {
+			assert(index < 2);
+
+			return this->*components[index];
+		}
+
+		constexpr const float& operator [](size_t index) const noexcept {
+			assert(index < 2);
+
+			return this->*components[index];
+		}
+
+		constexpr vec_t operator+(const vec_t &vec) const noexcept {
+			if (detail::constant_evaluated()) return vec_t(x + vec.x, y + vec.y);
+
+			return from(detail::vec2f_add(load(), vec.load()));
+		}
+
+		constexpr vec_t operator-(const vec_t &vec) const noexcept {
+			if (detail::constant_evaluated()) return vec_t(x - vec.x, y - vec.y);
+
+			return from(detail::vec2f_sub(load(), vec.load()));
+		}
+
+		constexpr vec_t operator-() const noexcept {
+			return vec_t(-x, -y);
+		}
+
+		constexpr vec_t operator*(const float &value) const noexcept {
+			if (detail::constant_evaluated()) return vec_t(x * value, y * value);
+
+			return from(detail::vec2f_scale(load(), value));
+		}
+
+		constexpr vec_t operator*(const vec_t &vec) const noexcept {
+			if (detail::constant_evaluated()) return vec_t(x * vec.x, y * vec.y);
+
+			return from(detail::vec2f_mul(load(), vec.load()));
+		}
+
+		//the scalar divisions of two components avoid the load and store of register, and ARMv7 NEON has no division
+		constexpr vec_t operator/(const float &value) const noexcept {
+			return vec_t(x / value, y / value);
+		}
+
+		constexpr vec_t& operator+=(const vec_t &vec) noexcept {
+			if (detail::constant_evaluated()) return *this = vec_t(x + vec.x, y + vec.y);
+
+			detail::vec2f_store(&x, detail::vec2f_add(load(), vec.load()));
+
+			return *this;
+		}
+
+		constexpr vec_t& operator-=(const vec_t &vec) noexcept {
+			if (detail::constant_evaluated()) return *this = vec_t(x - vec.x, y - vec.y);
+
+			detail::vec2f_store(&x, detail::vec2f_sub(load(), vec.load()));
+
+			return *this;
+		}
+
+		constexpr vec_t& operator*=(const float &value) noexcept {
+			if (detail::constant_evaluated()) return *this = vec_t(x * value, y * value);
+
+			detail::vec2f_store(&x, detail::vec2f_scale(load(), value));
+
+			return *this;
+		}
+
+		constexpr vec_t& operator*=(const vec_t &vec) noexcept {
+			if (detail::constant_evaluated()) return *this = vec_t(x * vec.x, y * vec.y);
+
+			detail::vec2f_store(&x, detail::vec2f_mul(load(), vec.load()));
+
+			return *this;
+		}
+
+		constexpr vec_t& operator/=(const float &value) noexcept {
+			x /= value;
+			y /= value;
+
+			return *this;
+		}
+
+		constexpr bool operator==(const vec_t &vec) const noexcept {
+			if (detail::constant_evaluated()) return x == vec.x && y == vec.y;
+
+			return detail::vec2f_equal(load(), vec.load());
+		}
+
+		constexpr bool operator!=(const vec_t &vec) const noexcept {
+			return !(*this == vec);
+		}
+
+		float length() const noexcept {
+			return std::sqrt(dot(*this, *this));
+		}
+
+		static constexpr vec_t min(const vec_t &v0, const vec_t &v1) noexcept {
+			if (detail::constant_evaluated()) return vec_t(std::min(v0.x, v1.x), std::min(v0.y, v1.y));
+
+			return from(detail::vec2f_min(v0.load(), v1.load()));
+		}
+
+		static constexpr vec_t max(const vec_t &v0, const vec_t &v1) noexcept {
+			if (detail::constant_evaluated()) return vec_t(std::max(v0.x, v1.x), std::max(v0.y, v1.y));
+
+			return from(detail::vec2f_max(v0.load(), v1.load()));
+		}
+
+		static constexpr float dot(const vec_t &v0, const vec_t &v1) noexcept {
+			if (detail::constant_evaluated()) return v0.x * v1.x + v0.y * v1.y;
+
+			return detail::vec2f_dot(v0.load(), v1.load());
+		}
+
+		static vec_t normalize(const vec_t &vec) noexcept {
+			const auto length = vec.length();
+
+			assert(length != 0.0f);
+
+			return from(detail::vec2f_scale(vec.load(), 1.0f / length));
+		}
+
+		static constexpr vec_t fma(const vec_t &v0, const vec_t &v1, const vec_t &v2) noexcept {
+			if (detail::constant_evaluated()) return vec_t(v0.x * v1.x + v2.x, v0.y * v1.y + v2.y);
+
+			return from(detail::vec2f_fma(v0.load(), v1.load(), v2.load()));
+		}
+	private:
+		static constexpr float vec_t::* components[2] = { &vec_t::x, &vec_t::y };
+
+		detail::vec2f_register load() const noexcept { return detail::vec2f_load(&x); }
+
+		static vec_t from(detail::vec2f_register vec) noexcept {
+			vec_t result;
+
+			detail::vec2f_store(&result.x, vec);
+
+			return result;
+		}
+	};
+
+	template<>
+	struct alignas(8) vec_t<int32_t, 2> {
+		using value_type = int32_t;
+
+		static constexpr size_t dimension = 2;
+
+		int32_t x;
+		int32_t y;
+
+		constexpr vec_t() noexcept : x(0), y(0) {}
+
+		constexpr vec_t(int32_t x, int32_t y) noexcept : x(x), y(y) {}
+
+		constexpr vec_t(int32_t value) noexcept : x(value), y(value) {}
+
+		constexpr int32_t& operator [](size_t index) noexcept {
+			assert(index < 2);
+
+			return this->*components[index];
+		}
+
+		constexpr const int32_t& operator [](size_t index) const noexcept {
+			assert(index < 2);
+
+			return this->*components[index];
+		}
+
+		constexpr vec_t operator+(const vec_t &vec) const noexcept {
+			if (detail::constant_evaluated()) return vec_t(x + vec.x, y + vec.y);
+
+			return from(detail::vec2i_add(load(), vec.load()));
+		}
+
+		constexpr vec_t operator-(const vec_t &vec) const noexcept {
+			if (detail::constant_evaluated()) return vec_t(x - vec.x, y - vec.y);
+
+			return from(detail::vec2i_sub(load(), vec.load()));
+		}
+
+		constexpr vec_t operator-() const noexcept {
+			return vec_t(-x, -y);
+		}
+
+		constexpr vec_t operator*(const int32_t &value) const noexcept {
+			if (detail::constant_evaluated()) return vec_t(x * value, y * value);
+
+			return from(detail::vec2i_scale(load(), value));
+		}
+
+		constexpr vec_t operator*(const vec_t &vec) const noexcept {
+			if (detail::constant_evaluated()) return vec_t(x * vec.x, y * vec.y);
+
+			return from(detail::vec2i_mul(load(), vec.load()));
+		}
+
+		//there is no integer division in SSE/NEON
+		constexpr vec_t operator/(const int32_t &value) const noexcept {
+			return vec_t(x / value, y / value);
+		}
+
+		constexpr vec_t& operator+=(const vec_t &vec) noexcept {
+			if (detail::constant_evaluated()) return *this = vec_t(x + vec.x, y + vec.y);
+
+			detail::vec2i_store(&x, detail::vec2i_add(load(), vec.load()));
+
+			return *this;
+		}
+
+		constexpr vec_t& operator-=(const vec_t &vec) noexcept {
+			if (detail::constant_evaluated()) return *this = vec_t(x - vec.x, y - vec.y);
+
+			detail::vec2i_store(&x, detail::vec2i_sub(load(), vec.load()));
+
+			return *this;
+		}
+
+		constexpr vec_t& operator*=(const int32_t &value) noexcept {
+			if (detail::constant_evaluated()) return *this = vec_t(x * value, y * value);
+
+			detail::vec2i_store(&x, detail::vec2i_scale(load(), value));
+
+			return *this;
+		}
+
+		constexpr vec_t& operator*=(const vec_t &vec) noexcept {
+			if (detail::constant_evaluated()) return *this = vec_t(x * vec.x, y * vec.y);
+
+			detail::vec2i_store(&x, detail::vec2i_mul(load(), vec.load()));
+
+			return *this;
+		}
+
+		constexpr vec_t& operator/=(const int32_t &value) noexcept {
+			x /= value;
+			y /= value;
+
+			return *this;
+		}
+
+		constexpr bool operator==(const vec_t &vec) const noexcept {
+			if (detail::constant_evaluated()) return x == vec.x && y == vec.y;
+
+			return detail::vec2i_equal(load(), vec.load());
+		}
+
+		constexpr bool operator!=(const vec_t &vec) const noexcept {
+			return !(*this == vec);
+		}
+
+		double length() const noexcept {
+			return std::sqrt(static_cast<double>(dot(*this, *this)));
+		}
+
+		static constexpr vec_t min(const vec_t &v0, const vec_t &v1) noexcept {
+			if (detail::constant_evaluated()) return vec_t(std::min(v0.x, v1.x), std::min(v0.y, v1.y));
+
+			return from(detail::vec2i_min(v0.load(), v1.load()));
+		}
+
+		static constexpr vec_t max(const vec_t &v0, const vec_t &v1) noexcept {
+			if (detail::constant_evaluated()) return vec_t(std::max(v0.x, v1.x), std::max(v0.y, v1.y));
+
+			return from(detail::vec2i_max(v0.load(), v1.load()));
+		}
+
+		static constexpr int32_t dot(const vec_t &v0, const vec_t &v1) noexcept {
+			return v0.x * v1.x + v0.y * v1.y;
+		}
+
+		static constexpr vec_t fma(const vec_t &v0, const vec_t &v1, const vec_t &v2) noexcept {
+			if (detail::constant_evaluated()) return vec_t(v0.x * v1.x + v2.x, v0.y * v1.y + v2.y);
+
+			return from(detail::vec2i_add(detail::vec2i_mul(v0.load(), v1.load()), v2.load()));
+		}
+	private:
+		static constexpr int32_t vec_t::* components[2] = { &vec_t::x, &vec_t::y };
+
+		detail::vec2i_register load() const noexcept { return detail::vec2i_load(&x); }
+
+		static vec_t from(detail::vec2i_register vec) noexcept {
+			vec_t result;
+
+			detail::vec2i_store(&result.x, vec);
+
+			return result;
+		}
+	};
+#endif
+
+	/*
+	 * The specialization of vec_t<float, 4> with SSE or NEON, the four components are one 128-bit register.
+	 * It is aligned to 16 bytes, so we load it with one aligned load.
+	 */
+#if defined(ALG_DAT_SSE2) || defined(ALG_DAT_NEON)
+	namespace detail {
+
+#if defined(ALG_DAT_SSE2)
+		using vec4f_register = __m128;
+
+		inline vec4f_register vec4f_load(const float* value) { return _mm_load_ps(value); }
+
+		inline void vec4f_store(float* value, vec4f_register vec) { _mm_store_ps(value, vec); }
+
+		inline vec4f_register vec4f_add(vec4f_register v0, vec4f_register v1) { return _mm_add_ps(v0, v1); }
+
+		inline vec4f_register vec4f_sub(vec4f_register v0, vec4f_register v1) { return _mm_sub_ps(v0, v1); }
+
+		inline vec4f_register vec4f_mul(vec4f_register v0, vec4f_register v1) { return _mm_mul_ps(v0, v1); }
+
+		inline vec4f_register vec4f_scale(vec4f_register v0, float value) { return _mm_mul_ps(v0, _mm_set1_ps(value)); }
+
+		inline vec4f_register vec4f_min(vec4f_register v0, vec4f_register v1) { return _mm_min_ps(v0, v1); }
+
+		inline vec4f_register vec4f_max(vec4f_register v0, vec4f_register v1) { return _mm_max_ps(v0, v1); }
+
+		inline vec4f_register vec4f_fma(vec4f_register v0, vec4f_register v1, vec4f_register v2) {
+#if defined(ALG_DAT_FMA)
+			return _mm_fmadd_ps(v0, v1, v2);
+#else
+			return _mm_add_ps(_mm_mul_ps(v0, v1), v2);
+#endif
+		}
+
+		inline float vec4f_dot(vec4f_register v0, vec4f_register v1) {
+#if defined(ALG_DAT_SSE41)
+			return _mm_cvtss_f32(_mm_dp_ps(v0, v1, 0xF1));
+#else
+			auto product = _mm_mul_ps(v0, v1);
+
+			product = _mm_add_ps(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(1, 0, 3, 2)));
+			product = _mm_add_ps(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 3, 0, 1)));
+
+			return _mm_cvtss_f32(product);
+#endif
+		}
+
+		inline bool vec4f_equal(vec4f_register v0, vec4f_register v1) {
+			return _mm_movemask_ps(_mm_cmpeq_ps(v0, v1)) == 0xF;
+		}
+#else
+		using vec4f_register = float32x4_t;
+
+		inline vec4f_register vec4f_load(const float* value) { return vld1q_f32(value); }
+
+		inline void vec4f_store(float* value, vec4f_register vec) { vst1q_f32(value, vec); }
+
+		inline vec4f_register vec4f_add(vec4f_register v0, vec4f_register v1) { return vaddq_f32(v0, v1); }
+
+		inline vec4f_register vec4f_sub(vec4f_register v0, vec4f_register v1) { return vsubq_f32(v0, v1); }
+
+		inline vec4f_register vec4f_mul(vec4f_register v0, vec4f_register v1) { return vmulq_f32(v0, v1); }
+
+		inline vec4f_register vec4f_scale(vec4f_register v0, float value) { return vmulq_n_f32(v0, value); }
+
+		inline vec4f_register vec4f_min(vec4f_register v0, vec4f_register v1) { return vminq_f32(v0, v1); }
+
+		inline vec4f_register vec4f_max(vec4f_register v0, vec4f_register v1) { return vmaxq_f32(v0, v1); }
+
+		inline vec4f_register vec4f_fma(vec4f_register v0, vec4f_register v1, vec4f_register v2) {
+#if defined(__aarch64__) || defined(_M_ARM64)
+			return vfmaq_f32(v2, v0, v1);
+#else
+			return vmlaq_f32(v2, v0, v1);
+#endif
+		}
+
+		inline float vec4f_dot(vec4f_register v0, vec4f_register v1) {
+			const auto product = vmulq_f32(v0, v1);
+			const auto sum = vadd_f32(vget_low_f32(product), vget_high_f32(product));
+
+			return vget_lane_f32(vpadd_f32(sum, sum), 0);
+		}
+
+		inline bool vec4f_equal(vec4f_register v0, vec4f_register v1) {
+			const auto mask = vceqq_f32(v0, v1);
+			const auto half = vand_u32(vget_low_u32(mask), vget_high_u32(mask));
+
+			return (vget_lane_u32(half, 0) & vget_lane_u32(half, 1)) != 0;
+		}
+#endif
+	}
+
+	template<>
+	struct alignas(16) vec_t<float, 4> {
+		using value_type = float;
+
+		static constexpr size_t dimension = 4;
+
+		float x;
+		float y;
+		float z;
+		float w;
+
+		constexpr vec_t() noexcept : x(0), y(0), z(0), w(0) {}
+
+		constexpr vec_t(float x, float y, float z, float w) noexcept : x(x), y(y), z(z), w(w) {}
+
+		constexpr vec_t(float value) noexcept : x(value), y(value), z(value), w(value) {}
+
+		constexpr float& operator [](size_t index) noexcept {
+			assert(index < 4);
+
+			return this->*components[index];
+		}
+
+		constexpr const float& operator [](size_t index) const noexcept {
+			assert(index < 4);
+
+			return this->*components[index];
+		}
+
+		constexpr vec_t operator+(const vec_t &vec) const noexcept {
+			if (detail::constant_evaluated()) return vec_t(x + vec.x, y + vec.y, z + vec.z, w + vec.w);
+
+			return from(detail::vec4f_add(load(), vec.load()));
+		}
+
+		constexpr vec_t operator-(const vec_t &vec) const noexcept {
+			if (detail::constant_evaluated()) return vec_t(x - vec.x, y - vec.y, z - vec.z, w - vec.w);
+
+			return from(detail::vec4f_sub(load(), vec.load()));
+		}
+
+		constexpr vec_t operator-() const noexcept {
+			return vec_t(-x, -y, -z, -w);
+		}
+
+		constexpr vec_t operator*(const float &value) const noexcept {
+			if (detail::constant_evaluated()) return vec_t(x * value, y * value, z * value, w * value);
+
+			return from(detail::vec4f_scale(load(), value));
+		}
+
+		constexpr vec_t operator*(const vec_t &vec) const noexcept {
+			if (detail::constant_evaluated()) return vec_t(x * vec.x, y * vec.y, z * vec.z, w * vec.w);
+
+			return from(detail::vec4f_mul(load(), vec.load()));
+		}
+
+		constexpr vec_t operator/(const float &value) const noexcept {
+			return vec_t(x / value, y / value, z / value, w / value);
+		}
+
+		constexpr vec_t& operator+=(const vec_t &vec) noexcept {
+			if (detail::constant_evaluated()) return *this = vec_t(x + vec.x, y + vec.y, z + vec.z, w + vec.w);
+
+			detail::vec4f_store(&x, detail::vec4f_add(load(), vec.load()));
+
+			return *this;
+		}
+
+		constexpr vec_t& operator-=(const vec_t &vec) noexcept {
+			if (detail::constant_evaluated()) return *this = vec_t(x - vec.x, y - vec.y, z - vec.z, w - vec.w);
+
+			detail::vec4f_store(&x, detail::vec4f_sub(load(), vec.load()));
+
+			return *this;
+		}
+
+		constexpr vec_t& operator*=(const float &value) noexcept {
+			if (detail::constant_evaluated()) return *this = vec_t(x * value, y * value, z * value, w * value);
+
+			detail::vec4f_store(&x, detail::vec4f_scale(load(), value));
+
+			return *this;
+		}
+
+		constexpr vec_t& operator*=(const vec_t &vec) noexcept {
+			if (detail::constant_evaluated()) return *this = vec_t(x * vec.x, y * vec.y, z * vec.z, w * vec.w);
+
+			detail::vec4f_store(&x, detail::vec4f_mul(load(), vec.load()));
+
+			return *this;
+		}
+
+		constexpr vec_t& operator/=(const float &value) noexcept {
+			x /= value;
+			y /= value;
+			z /= value;
+			w /= value;
+
+			return *this;
+		}
+
+		constexpr bool operator==(const vec_t &vec) const noexcept {
+			if (detail::constant_evaluated()) return x == vec.x && y == vec.y && z == vec.z && w == vec.w;
+
+			return detail::vec4f_equal(load(), vec.load());
+		}
+
+		constexpr bool operator!=(const vec_t &vec) const noexcept {
+			return !(*this == vec);
+		}
+
+		float length() const noexcept {
+			return std::sqrt(dot(*this, *this));
+		}
+
+		static constexpr vec_t min(const vec_t &v0, const vec_t &v1) noexcept {
+			if (detail::constant_evaluated()) {
+				return vec_t(
+					std::min(v0.x, v1.x), std::min(v0.y, v1.y),
+					std::min(v0.z, v1.z), std::min(v0.w, v1.w));
+			}
+
+			return from(detail::vec4f_min(v0.load(), v1.load()));
+		}
+
+		static constexpr vec_t max(const vec_t &v0, const vec_t &v1) noexcept {
+			if (detail::constant_evaluated()) {
+				return vec_t(
+					std::max(v0.x, v1.x), std::max(v0.y, v1.y),
+					std::max(v0.z, v1.z), std::max(v0.w, v1.w));
+			}
+
+			return from(detail::vec4f_max(v0.load(), v1.load()));
+		}
+
+		static constexpr float dot(const vec_t &v0, const vec_t &v1) noexcept {
+			if (detail::constant_evaluated()) return v0.x * v1.x + v0.y * v1.y + v0.z * v1.z + v0.w * v1.w;
+
+			return detail::vec4f_dot(v0.load(), v1.load());
+		}
+
+		static vec_t normalize(const vec_t &vec) noexcept {
+			const auto length = vec.length();
+
+			assert(length != 0.0f);
+
+			return from(detail::vec4f_scale(vec.load(), 1.0f / length));
+		}
+
+		static constexpr vec_t fma(const vec_t &v0, const vec_t &v1, const vec_t &v2) noexcept {
+			if (detail::constant_evaluated()) {
+				return vec_t(
+					v0.x * v1.x + v2.x, v0.y * v1.y + v2.y,
+					v0.z * v1.z + v2.z, v0.w * v1.w + v2.w);
+			}
+
+			return from(detail::vec4f_fma(v0.load(), v1.load(), v2.load()));
+		}
+	private:
+		static constexpr float vec_t::* components[4] = { &vec_t::x, &vec_t::y, &vec_t::z, &vec_t::w };
+
+		detail::vec4f_register load() const noexcept { return detail::vec4f_load(&x); }
+
+		static vec_t from(detail::vec4f_register vec) noexcept {
+			vec_t result;
+
+			detail::vec4f_store(&result.x, vec);
+
+			return result;
+		}
+	};
+#endif
+
+	template<typename T>
+	using vec2_t = vec_t<T, 2>;
+
+	template<typename T>
+	using vec3_t = vec_t<T, 3>;
+
+	template<typename T>
+	using vec4_t = vec_t<T, 4>;
+
+	using vec2 = vec2_t<real>;
+	using vec3 = vec3_t<real>;
+	using vec4 = vec4_t<real>;
+
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+/*
+ * vec2_compressed.hpp
+ * The compressed storage of vec2 (float), the bandwidth-bound passes read the compressed points and decode them :
+ * vec2_t<half> : 4 bytes per point, the relative error is 2^-11, see more in "half.hpp".
+ * vec2_quantizer::code_type : 4 bytes per point, the components are 16 bits integers in the bounds,
+ * the absolute error is about half of step() = size of bounds / 65535 (plus the rounding of float).
+ *
+ * The bulk decoders write vec2 array (AoS) or vec2_soa :
+ * half : F16C converts 8 halves per instruction, the SoA decoder separates x and y with one byte shuffle.
+ * quantized : AVX2 (or SSE4.1) widens the integers and converts them to float, the SoA decoder
+ * separates x and y with a mask and a shift, because x is the low 16 bits of every 32 bits.
+ * The results of SIMD and scalar decoders are same, all decoders compute code * step + origin with FMA if ALG_DAT_FMA,
+ * otherwise with a multiplication and an addition.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+#include "half.hpp"
+#include "bounds2.hpp"
+#include "vec2_soa.hpp"
+
+namespace alg_dat {
+
+	namespace detail {
+
+		//code * step + origin, the same operation as the SIMD decoders, so the compiler can not contract it differently
+		inline float vec2_compressed_decode(float code, float step, float origin) {
+#if defined(ALG_DAT_FMA)
+			return std::fma(code, step, origin);
+#else
+			return code * step + origin;
+#endif
+		}
+
+#if defined(ALG_DAT_AVX2)
+		inline __m256 vec2_compressed_decode(__m256 code, __m256 step, __m256 origin) {
+#if defined(ALG_DAT_FMA)
+			return _mm256_fmadd_ps(code, step, origin);
+#else
+			return _mm256_add_ps(_mm256_mul_ps(code, step), origin);
+#endif
+		}
+#endif
+
+#if defined(ALG_DAT_SSE41)
+		inline __m128 vec2_compressed_decode(__m128 code, __m128 step, __m128 origin) {
+#if defined(ALG_DAT_FMA)
+			return _mm_fmadd_ps(code, step, origin);
+#else
+			return _mm_add_ps(_mm_mul_ps(code, step), origin);
+#endif
+		}
+#endif
+	}
+
+	/**
+	 * \brief compress the points to half
+	 * \param input the points
+	 * \param output the compressed points
+	 * \param size the number of points
+	 */
+	inline void vec2_encode_half(const vec2_t<float>* input, vec2_t<half>* output, size_t size) {
+		float_to_half(reinterpret_cast<const float*>(input), reinterpret_cast<half*>(output), size << 1);
+	}
+
+	/**
+	 * \brief decompress the points from half
+	 * \param input the compressed points
+	 * \param output the points
+	 * \param size the number of points
+	 */
+	inline void vec2_decode_half(const vec2_t<half>* input, vec2_t<float>* output, size_t size) {
+		half_to_float(reinterpret_cast<const half*>(input), reinterpret_cast<float*>(output), size << 1);
+	}
+
+	/**
+	 * \brief decompress the points from half to structure of arrays
+	 * \param input the compressed points
+	 * \param size the number of points
+	 * \param output the points, it is resized to size
+	 */
+	inline void vec2_decode_half(const vec2_t<half>* input, size_t size, vec2_soa<float>& output) {
+		output.resize(size);
+
+		size_t index = 0;
+
+#if defined(ALG_DAT_F16C) && defined(ALG_DAT_AVX2)
+		//the x of every point is the low 2 bytes, gather them into the low 8 bytes of every 128-bit lane
+		const auto shuffle = _mm256_setr_epi8(
+			0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15,
+			0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+
+		for (; index + 8 <= size; index += 8) {
+			const auto xy = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + index)), shuffle);
+
+			//[x0-3, y0-3, x4-7, y4-7] to [x0-3, x4-7, y0-3, y4-7]
+			const auto separated = _mm256_permute4x64_epi64(xy, _MM_SHUFFLE(3, 1, 2, 0));
+
+			_mm256_storeu_ps(output.x() + index, _mm256_cvtph_ps(_mm256_castsi256_si128(separated)));
+			_mm256_storeu_ps(output.y() + index, _mm256_cvtph_ps(_mm256_extracti128_si256(separated, 1)));
+		}
+#endif
+
+		for (; index < size; index++) {
+			output.x()[index] = static_cast<float>(input[index].x);
+			output.y()[index] = static_cast<float>(input[index].y);
+		}
+	}
+
+	//quantize the points in bounds to 16 bits integers, the point is origin + code * step
+	class vec2_quantizer {
+	public:
+		using size_type = size_t;
+		using code_type = vec2_t<uint16_t>;
+
+		static constexpr float max_code = 65535.0f;
+	public:
+		explicit vec2_quantizer(const bounds2_t<float>& bounds) : mOrigin(bounds.min) {
+			const auto size = bounds.size();
+
+			mStep = vec2_t<float>(size.x > 0 ? size.x / max_code : 0.0f, size.y > 0 ? size.y / max_code : 0.0f);
+			mInverse = vec2_t<float>(size.x > 0 ? max_code / size.x : 0.0f, size.y > 0 ? max_code / size.y : 0.0f);
+		}
+
+		//the point out of bounds is clamped to bounds
+		code_type encode(const vec2_t<float>& point) const {
+			const auto code = (point - mOrigin) * mInverse;
+
+			return code_type(quantize(code.x), quantize(code.y));
+		}
+
+		vec2_t<float> decode(const code_type& code) const {
+			return vec2_t<float>(
+				detail::vec2_compressed_decode(static_cast<float>(code.x), mStep.x, mOrigin.x),
+				detail::vec2_compressed_decode(static_cast<float>(code.y), mStep.y, mOrigin.y));
+		}
+
+		void encode(const vec2_t<float>* input, code_type* output, size_type size) const {
+			for (size_type index = 0; index < size; index++) output[index] = encode(input[index]);
+		}
+
+		/**
+		 * \brief decode the points
+		 * \param input the codes
+		 * \param output the points
+		 * \param size the number of points
+		 */
+		void decode(const code_type* input, vec2_t<float>* output, size_type size) const {
+			size_type index = 0;
+
+#if defined(ALG_DAT_AVX2) || defined(ALG_DAT_SSE41)
+			//the codes and points are interleaved (x, y), so the step and origin are interleaved too
+			const auto values = reinterpret_cast<const uint16_t*>(input);
+			const auto points = reinterpret_cast<float*>(output);
+#endif
+
+#if defined(ALG_DAT_AVX2)
+			const auto step = _mm256_setr_ps(mStep.x, mStep.y, mStep.x, mStep.y, mStep.x, mStep.y, mStep.x, mStep.y);
+			const auto origin = _mm256_setr_ps(mOrigin.x, mOrigin.y, mOrigin.x, mOrigin.y, mOrigin.x, mOrigin.y, mOrigin.x, mOrigin.y);
+
+			for (; index + 4 <= size; index += 4) {
+				const auto code = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + (index << 1)))));
+
+				_mm256_storeu_ps(points + (index << 1), detail::vec2_compressed_decode(code, step, origin));
+			}
+#elif defined(ALG_DAT_SSE41)
+			const auto step = _mm_setr_ps(mStep.x, mStep.y, mStep.x, mStep.y);
+			const auto origin = _mm_setr_ps(mOrigin.x, mOrigin.y, mOrigin.x, mOrigin.y);
+
+			for (; index + 2 <= size; index += 2) {
+				const auto code = _mm_cvtepi32_ps(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(values + (index << 1)))));
+
+				_mm_storeu_ps(points + (index << 1), detail::vec2_compressed_decode(code, step, origin));
+			}
+#endif
+
+			for (; index < size; index++) output[index] = decode(input[index]);
+		}
+
+		/**
+		 * \brief decode the points to structure of arrays
+		 * \param input the codes
+		 * \param size the number of points
+		 * \param output the points, it is resized to size
+		 */
+		void decode(const code_type* input, size_type size, vec2_soa<float>& output) const {
+			output.resize(size);
+
+			size_type index = 0;
+
+#if defined(ALG_DAT_AVX2)
+			const auto mask = _mm256_set1_epi32(0xFFFF);
+			const auto step_x = _mm256_set1_ps(mStep.x), step_y = _mm256_set1_ps(mStep.y);
+			const auto origin_x = _mm256_set1_ps(mOrigin.x), origin_y = _mm256_set1_ps(mOrigin.y);
+
+			for (; index + 8 <= size; index += 8) {
+				const auto code = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + index));
+
+				const auto x = _mm256_cvtepi32_ps(_mm256_and_si256(code, mask));
+				const auto y = _mm256_cvtepi32_ps(_mm256_srli_epi32(code, 16));
+
+				_mm256_storeu_ps(output.x() + index, detail::vec2_compressed_decode(x, step_x, origin_x));
+				_mm256_storeu_ps(output.y() + index, detail::vec2_compressed_decode(y, step_y, origin_y));
+			}
+#endif
+
+			for (; index < size; index++) {
+				const auto point = decode(input[index]);
+
+				output.x()[index] = point.x;
+				output.y()[index] = point.y;
+			}
+		}
+
+		auto origin() const -> const vec2_t<float>& { return mOrigin; }
+
+		auto step() const -> const vec2_t<float>& { return mStep; }
+	private:
+		//NaN is 0, the cast of NaN to integer is undefined
+		static uint16_t quantize(float value) {
+			if (!(value > 0.0f)) return 0;
+
+			return static_cast<uint16_t>(std::min(std::round(value), max_code));
+		}
+	private:
+		vec2_t<float> mOrigin;
+		vec2_t<float> mStep;
+		vec2_t<float> mInverse;
+	};
+}
@@ -0,0 +1,416 @@
+#pragma once
+
+/*
+ * vec2_soa.hpp
+ * Structure of arrays of vec2_t, the x and y components are stored in two cache line aligned arrays.
+ * So a batch of points is loaded into registers with two loads, instead of the shuffles of AoS (vec2_t array).
+ *
+ * The kernels process the points by batches :
+ * AVX-512 : 16 floats per instruction.
+ * AVX2 : 8 floats per instruction.
+ * others : the scalar loop, it is simple enough for compiler to vectorize it.
+ * The rest points (less than a batch) are processed by the scalar loop.
+ * The fma of all kernels is fused if the batch is AVX-512 or ALG_DAT_FMA, otherwise it is a multiplication and an addition,
+ * so the rest points and the batches have same results.
+ */
+
+#include <type_traits>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "memory/aligned_buffer.hpp"
+#include "vec.hpp"
+
+namespace alg_dat {
+
+	namespace detail {
+
+		//the batch operations of scalar, it is used for the rest points and the types without SIMD version
+		template<typename T>
+		struct vec2_soa_scalar {
+			using type = T;
+
+			static constexpr size_t width = 1;
+
+			static type load(const T* value) { return *value; }
+
+			static void store(T* value, type batch) { *value = batch; }
+
+			static type set(T value) { return value; }
+
+			static type add(type b0, type b1) { return b0 + b1; }
+
+			static type sub(type b0, type b1) { return b0 - b1; }
+
+			static type mul(type b0, type b1) { return b0 * b1; }
+
+			static type min(type b0, type b1) { return std::min(b0, b1); }
+
+			static type max(type b0, type b1) { return std::max(b0, b1); }
+
+			//the floating point fma has one rounding as the fused SIMD kernels, so the rest points are same as the batches
+			static type fma(type b0, type b1, type b2) {
+#if defined(ALG_DAT_FMA) || defined(ALG_DAT_AVX512)
+				if (std::is_floating_point<T>::value) return static_cast<type>(std::fma(b0, b1, b2));
+#endif
+				return b0 * b1 + b2;
+			}
+
+			static type sqrt(type batch) { return static_cast<T>(std::sqrt(batch)); }
+
+			static T reduce_min(type batch) { return batch; }
+
+			static T reduce_max(type batch) { return batch; }
+
+			//xy is [x0, y0]
+			static void deinterleave(const T* xy, T* x, T* y) { *x = xy[0]; *y = xy[1]; }
+
+			static void interleave(T* xy, const T* x, const T* y) { xy[0] = *x; xy[1] = *y; }
+		};
+
+#if defined(ALG_DAT_AVX512)
+		struct vec2_soa_avx512 {
+			using type = __m512;
+
+			static constexpr size_t width = 16;
+
+			static type load(const float* value) { return _mm512_loadu_ps(value); }
+
+			static void store(float* value, type batch) { _mm512_storeu_ps(value, batch); }
+
+			static type set(float value) { return _mm512_set1_ps(value); }
+
+			static type add(type b0, type b1) { return _mm512_add_ps(b0, b1); }
+
+			static type sub(type b0, type b1) { return _mm512_sub_ps(b0, b1); }
+
+			static type mul(type b0, type b1) { return _mm512_mul_ps(b0, b1); }
+
+			static type min(type b0, type b1) { return _mm512_min_ps(b0, b1); }
+
+			static type max(type b0, type b1) { return _mm512_max_ps(b0, b1); }
+
+			static type fma(type b0, type b1, type b2) { return _mm512_fmadd_ps(b0, b1, b2); }
+
+			static type sqrt(type batch) { return _mm512_sqrt_ps(batch); }
+
+			static float reduce_min(type batch) { return _mm512_reduce_min_ps(batch); }
+
+			static float reduce_max(type batch) { return _mm512_reduce_max_ps(batch); }
+
+			//the even floats of [xy, xy + 32) are x and the odd floats are y
+			static void deinterleave(const float* xy, float* x, float* y) {
+				const auto even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+				const auto odd = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+
+				const auto b0 = _mm512_loadu_ps(xy + 0);
+				const auto b1 = _mm512_loadu_ps(xy + 16);
+
+				_mm512_storeu_ps(x, _mm512_permutex2var_ps(b0, even, b1));
+				_mm512_storeu_ps(y, _mm512_permutex2var_ps(b0, odd, b1));
+			}
+
+			static void interleave(float* xy, const float* x, const float* y) {
+				const auto low = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+				const auto high = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+
+				const auto bx = _mm512_loadu_ps(x);
+				const auto by = _mm512_loadu_ps(y);
+
+				_mm512_storeu_ps(xy + 0, _mm512_permutex2var_ps(bx, low, by));
+				_mm512_storeu_ps(xy + 16, _mm512_permutex2var_ps(bx, high, by));
+			}
+		};
+#endif
+
+#if defined(ALG_DAT_AVX2)
+		struct vec2_soa_avx2 {
+			using type = __m256;
+
+			static constexpr size_t width = 8;
+
+			static type load(const float* value) { return _mm256_loadu_ps(value); }
+
+			static void store(float* value, type batch) { _mm256_storeu_ps(value, batch); }
+
+			static type set(float value) { return _mm256_set1_ps(value); }
+
+			static type add(type b0, type b1) { return _mm256_add_ps(b0, b1); }
+
+			static type sub(type b0, type b1) { return _mm256_sub_ps(b0, b1); }
+
+			static type mul(type b0, type b1) { return _mm256_mul_ps(b0, b1); }
+
+			static type min(type b0, type b1) { return _mm256_min_ps(b0, b1); }
+
+			static type max(type b0, type b1) { return _mm256_max_ps(b0, b1); }
+
+			static type fma(type b0, type b1, type b2) {
+#if defined(ALG_DAT_FMA)
+				return _mm256_fmadd_ps(b0, b1, b2);
+#else
+				return _mm256_add_ps(_mm256_mul_ps(b0, b1), b2);
+#endif
+			}
+
+			static type sqrt(type batch) { return _mm256_sqrt_ps(batch); }
+
+			static float reduce_min(type batch) {
+				auto result = _mm_min_ps(_mm256_castps256_ps128(batch), _mm256_extractf128_ps(batch, 1));
+
+				result = _mm_min_ps(result, _mm_shuffle_ps(result, result, _MM_SHUFFLE(1, 0, 3, 2)));
+				result = _mm_min_ps(result, _mm_shuffle_ps(result, result, _MM_SHUFFLE(2, 3, 0, 1)));
+
+				return _mm_cvtss_f32(result);
+			}
+
+			static float reduce_max(type batch) {
+				auto result = _mm_max_ps(_mm256_castps256_ps128(batch), _mm256_extractf128_ps(batch, 1));
+
+				result = _mm_max_ps(result, _mm_shuffle_ps(result, result, _MM_SHUFFLE(1, 0, 3, 2)));
+				result = _mm_max_ps(result, _mm_shuffle_ps(result, result, _MM_SHUFFLE(2, 3, 0, 1)));
+
+				return _mm_cvtss_f32(result);
+			}
+
+			//shuffle_ps works in 128-bit lanes, so the results are [0, 1, 4, 5, 2, 3, 6, 7] and we permute them back
+			static void deinterleave(const float* xy, float* x, float* y) {
+				const auto b0 = _mm256_loadu_ps(xy + 0);
+				const auto b1 = _mm256_loadu_ps(xy + 8);
+
+				const auto bx = _mm256_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0));
+				const auto by = _mm256_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1));
+
+				_mm256_storeu_ps(x, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(bx), _MM_SHUFFLE(3, 1, 2, 0))));
+				_mm256_storeu_ps(y, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(by), _MM_SHUFFLE(3, 1, 2, 0))));
+			}
+
+			static void interleave(float* xy, const float* x, const float* y) {
+				const auto bx = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_loadu_ps(x)), _MM_SHUFFLE(3, 1, 2, 0)));
+				const auto by = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_loadu_ps(y)), _MM_SHUFFLE(3, 1, 2, 0)));
+
+				_mm256_storeu_ps(xy + 0, _mm256_unpacklo_ps(bx, by));
+				_mm256_storeu_ps(xy + 8, _mm256_unpackhi_ps(bx, by));
+			}
+		};
+#endif
+
+		//the widest batch operations of T
+		template<typename T>
+		struct vec2_soa_batch {
+			using type = vec2_soa_scalar<T>;
+		};
+
+#if defined(ALG_DAT_AVX512)
+		template<>
+		struct vec2_soa_batch<float> {
+			using type = vec2_soa_avx512;
+		};
+#elif defined(ALG_DAT_AVX2)
+		template<>
+		struct vec2_soa_batch<float> {
+			using type = vec2_soa_avx2;
+		};
+#endif
+	}
+
+	template<typename T>
+	class vec2_soa {
+		static_assert(std::is_arithmetic<T>::value, "the component of vec2_soa should be arithmetic.");
+		static_assert(sizeof(vec2_t<T>) == sizeof(T) * 2, "vec2_t should be two packed components.");
+	public:
+		using size_type = size_t;
+		using value_type = vec2_t<T>;
+		using batch = typename detail::vec2_soa_batch<T>::type;
+		using scalar = detail::vec2_soa_scalar<T>;
+	public:
+		vec2_soa() = default;
+
+		explicit vec2_soa(size_type size) : mX(size), mY(size) {}
+
+		//convert from vec2_t array (AoS)
+		vec2_soa(const value_type* begin, const value_type* end) : vec2_soa(static_cast<size_type>(end - begin)) {
+			const auto xy = reinterpret_cast<const T*>(begin);
+
+			for_each_batch([&](auto kernel, size_type index) {
+				decltype(kernel)::deinterleave(xy + (index << 1), mX.data() + index, mY.data() + index);
+			});
+		}
+
+		//convert to vec2_t array (AoS), the array should have size() elements
+		void to_aos(value_type* output) const {
+			const auto xy = reinterpret_cast<T*>(output);
+
+			for_each_batch([&](auto kernel, size_type index) {
+				decltype(kernel)::interleave(xy + (index << 1), mX.data() + index, mY.data() + index);
+			});
+		}
+
+		void resize(size_type size) {
+			mX.resize(size);
+			mY.resize(size);
+		}
+
+		value_type at(size_type index) const { return value_type(mX[index], mY[index]); }
+
+		void set(size_type index, const value_type& value) {
+			mX[index] = value.x;
+			mY[index] = value.y;
+		}
+
+		T* x() { return mX.data(); }
+
+		T* y() { return mY.data(); }
+
+		const T* x() const { return mX.data(); }
+
+		const T* y() const { return mY.data(); }
+
+		size_type size() const { return mX.size(); }
+
+		bool empty() const { return mX.empty(); }
+
+		//points[i] = points[i] + offset
+		void add(const value_type& offset) {
+			for_each_batch([&](auto kernel, size_type index) {
+				using ops = decltype(kernel);
+
+				ops::store(mX.data() + index, ops::add(ops::load(mX.data() + index), ops::set(offset.x)));
+				ops::store(mY.data() + index, ops::add(ops::load(mY.data() + index), ops::set(offset.y)));
+			});
+		}
+
+		//points[i] = points[i] + other[i]
+		void add(const vec2_soa& other) {
+			assert(other.size() == size());
+
+			for_each_batch([&](auto kernel, size_type index) {
+				using ops = decltype(kernel);
+
+				ops::store(mX.data() + index, ops::add(ops::load(mX.data() + index), ops::load(other.mX.data() + index)));
+				ops::store(mY.data() + index, ops::add(ops::load(mY.data() + index), ops::load(other.mY.data() + index)));
+			});
+		}
+
+		//points[i] = points[i] - offset
+		void sub(const value_type& offset) {
+			for_each_batch([&](auto kernel, size_type index) {
+				using ops = decltype(kernel);
+
+				ops::store(mX.data() + index, ops::sub(ops::load(mX.data() + index), ops::set(offset.x)));
+				ops::store(mY.data() + index, ops::sub(ops::load(mY.data() + index), ops::set(offset.y)));
+			});
+		}
+
+		//points[i] = points[i] - other[i]
+		void sub(const vec2_soa& other) {
+			assert(other.size() == size());
+
+			for_each_batch([&](auto kernel, size_type index) {
+				using ops = decltype(kernel);
+
+				ops::store(mX.data() + index, ops::sub(ops::load(mX.data() + index), ops::load(other.mX.data() + index)));
+				ops::store(mY.data() + index, ops::sub(ops::load(mY.data() + index), ops::load(other.mY.data() + index)));
+			});
+		}
+
+		//points[i] = points[i] * value
+		void scale(const T& value) {
+			for_each_batch([&](auto kernel, size_type index) {
+				using ops = decltype(kernel);
+
+				ops::store(mX.data() + index, ops::mul(ops::load(mX.data() + index), ops::set(value)));
+				ops::store(mY.data() + index, ops::mul(ops::load(mY.data() + index), ops::set(value)));
+			});
+		}
+
+		/**
+		 * \brief affine transform, points[i] = axis_x * points[i].x + axis_y * points[i].y + offset
+		 * \param axis_x the first column of matrix
+		 * \param axis_y the second column of matrix
+		 * \param offset the translation
+		 */
+		void transform(const value_type& axis_x, const value_type& axis_y, const value_type& offset) {
+			for_each_batch([&](auto kernel, size_type index) {
+				using ops = decltype(kernel);
+
+				const auto x = ops::load(mX.data() + index);
+				const auto y = ops::load(mY.data() + index);
+
+				ops::store(mX.data() + index, ops::fma(x, ops::set(axis_x.x), ops::fma(y, ops::set(axis_y.x), ops::set(offset.x))));
+				ops::store(mY.data() + index, ops::fma(x, ops::set(axis_x.y), ops::fma(y, ops::set(axis_y.y), ops::set(offset.y))));
+			});
+		}
+
+		//output[i] = dot(points[i] - point, points[i] - point), the output should have size() elements
+		void distance_squared(const value_type& point, T* output) const {
+			for_each_batch([&](auto kernel, size_type index) {
+				using ops = decltype(kernel);
+
+				const auto dx = ops::sub(ops::load(mX.data() + index), ops::set(point.x));
+				const auto dy = ops::sub(ops::load(mY.data() + index), ops::set(point.y));
+
+				ops::store(output + index, ops::fma(dx, dx, ops::mul(dy, dy)));
+			});
+		}
+
+		//output[i] = length(points[i] - point), the output should have size() elements
+		void distance(const value_type& point, T* output) const {
+			for_each_batch([&](auto kernel, size_type index) {
+				using ops = decltype(kernel);
+
+				const auto dx = ops::sub(ops::load(mX.data() + index), ops::set(point.x));
+				const auto dy = ops::sub(ops::load(mY.data() + index), ops::set(point.y));
+
+				ops::store(output + index, ops::sqrt(ops::fma(dx, dx, ops::mul(dy, dy))));
+			});
+		}
+
+		/**
+		 * \brief the bounding box of points, the points should not be empty
+		 * \param min the min corner
+		 * \param max the max corner
+		 */
+		void bounds(value_type& min, value_type& max) const {
+			assert(!empty());
+
+			auto min_x = batch::set(mX[0]);
+			auto min_y = batch::set(mY[0]);
+			auto max_x = min_x;
+			auto max_y = min_y;
+
+			size_type index = 0;
+
+			for (; index + batch::width <= size(); index += batch::width) {
+				const auto x = batch::load(mX.data() + index);
+				const auto y = batch::load(mY.data() + index);
+
+				min_x = batch::min(min_x, x);
+				min_y = batch::min(min_y, y);
+				max_x = batch::max(max_x, x);
+				max_y = batch::max(max_y, y);
+			}
+
+			min = value_type(batch::reduce_min(min_x), batch::reduce_min(min_y));
+			max = value_type(batch::reduce_max(max_x), batch::reduce_max(max_y));
+
+			for (; index < size(); index++) {
+				min = value_type::min(min, at(index));
+				max = value_type::max(max, at(index));
+			}
+		}
+	private:
+		//call kernel(batch(), index) for every full batch and kernel(scalar(), index) for the rest points
+		template<typename Kernel>
+		void for_each_batch(Kernel&& kernel) const {
+			size_type index = 0;
+
+			for (; index + batch::width <= size(); index += batch::width) kernel(batch(), index);
+			for (; index < size(); index++) kernel(scalar(), index);
+		}
+	private:
+		aligned_buffer<T> mX;
+		aligned_buffer<T> mY;
+	};
+}
@@ -0,0 +1,97 @@
+/*
+ * bounds2.cpp
+ * Test the batch overlap and contains of bounds2_soa against bounds2_t::overlap and bounds2_t::contains of every box.
+ * The boxes touch at the integer coordinates, so the SIMD compares and the scalar compares must agree on the edges.
+ */
+
+#include <random>
+#include <vector>
+
+#include "../dependent/bounds2_soa.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	template<typename T>
+	bounds2_t<T> random_bounds(std::mt19937& random, int extent) {
+		const vec2_t<T> min(T(random() % 101), T(random() % 101));
+
+		return bounds2_t<T>(min, min + vec2_t<T>(T(random() % extent), T(random() % extent)));
+	}
+
+	template<typename T>
+	void test_queries(std::mt19937& random) {
+		for (size_t size : { 0, 1, 5, 16, 63, 64, 65, 200, 3000 }) {
+			std::vector<bounds2_t<T>> boxes;
+
+			for (size_t index = 0; index < size; index++) boxes.push_back(random_bounds<T>(random, 20));
+
+			bounds2_soa<T> soa(boxes.data(), boxes.data() + size);
+
+			ALG_DAT_CHECK(soa.size() == size && soa.mask_size() == (size + 63) / 64);
+
+			for (size_t index = 0; index < size; index++) ALG_DAT_CHECK(soa.at(index) == boxes[index]);
+
+			std::vector<uint32_t> output(size + 1);
+			std::vector<uint64_t> mask(soa.mask_size());
+
+			for (int query = 0; query < 50; query++) {
+				const auto bounds = random_bounds<T>(random, 30);
+				const auto point = bounds.min;
+
+				std::vector<uint32_t> expected_overlap;
+				std::vector<uint32_t> expected_contains;
+
+				for (uint32_t index = 0; index < size; index++) {
+					if (boxes[index].overlap(bounds)) expected_overlap.push_back(index);
+					if (boxes[index].contains(point)) expected_contains.push_back(index);
+				}
+
+				auto count = soa.overlap(bounds, output.data());
+
+				ALG_DAT_CHECK(std::vector<uint32_t>(output.begin(), output.begin() + count) == expected_overlap);
+
+				count = soa.contains(point, output.data());
+
+				ALG_DAT_CHECK(std::vector<uint32_t>(output.begin(), output.begin() + count) == expected_contains);
+
+				//all boxes overlap the big box, and the bits out of size() are 0
+				soa.overlap_mask(bounds2_t<T>(vec2_t<T>(T(-1)), vec2_t<T>(T(1000))), mask.data());
+
+				for (size_t index = 0; index < size; index++) ALG_DAT_CHECK(((mask[index / 64] >> (index % 64)) & 1) != 0);
+				if (size % 64 != 0) ALG_DAT_CHECK((mask.back() >> (size % 64)) == 0);
+			}
+
+			//the new boxes are empty, they overlap nothing
+			soa.resize(size + 3);
+
+			ALG_DAT_CHECK(soa.at(size).empty() && soa.at(size + 2).empty());
+			ALG_DAT_CHECK(soa.overlap(bounds2_t<T>(vec2_t<T>(T(0)), vec2_t<T>(T(200))), output.data()) == size);
+		}
+	}
+
+	void test_constexpr() {
+		constexpr bounds2_t<float> a(vec2_t<float>(0, 0), vec2_t<float>(2, 2));
+		constexpr bounds2_t<float> b(vec2_t<float>(1, 1), vec2_t<float>(3, 3));
+		constexpr bounds2_t<float> c(vec2_t<float>(3), vec2_t<float>(4));
+
+		static_assert(a.overlap(b) && bounds2_t<float>::merge(a, b).area() == 9 && bounds2_t<float>::intersect(a, b).area() == 1, "the overlapped boxes.");
+		static_assert(bounds2_t<float>().empty() && bounds2_t<float>::merge(bounds2_t<float>(), a) == a, "the empty box.");
+		static_assert(!a.overlap(c) && bounds2_t<float>::intersect(a, c).empty() && b.overlap(c), "the disjoint and touching boxes.");
+		static_assert(a.contains(vec2_t<float>(2, 0)) && !a.contains(vec2_t<float>(2.5f, 0)) && a.center() == vec2_t<float>(1), "the points on edges.");
+	}
+}
+
+int main() {
+	std::mt19937 random(85);
+
+	test_queries<float>(random);
+	test_queries<double>(random);
+	test_queries<int32_t>(random);
+	test_constexpr();
+
+	return test::result("bounds2");
+}
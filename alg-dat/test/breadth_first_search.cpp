@@ -0,0 +1,132 @@
+/*
+ * breadth_first_search.cpp
+ * Test breadth_first_search against the std::queue search : the depths are same and every parent is a valid parent,
+ * for top-down only, bottom-up heavy and default switching, sequential and on a thread_pool.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <queue>
+
+#include "../algorithm/breadth_first_search.hpp"
+#include "../datastructure/container/compressed_graph.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	using graph_type = compressed_graph<uint32_t, float>;
+
+	constexpr auto invalid = bfs_invalid_vertex<uint32_t>();
+
+	std::vector<uint32_t> reference_depths(const graph_type& graph, uint32_t source) {
+		std::vector<uint32_t> depths(graph.vertex_count(), invalid);
+		std::queue<uint32_t> queue;
+
+		depths[source] = 0;
+		queue.push(source);
+
+		while (!queue.empty()) {
+			const auto vertex = queue.front();
+
+			queue.pop();
+
+			for (auto neighbor = graph.neighbors_begin(vertex); neighbor != graph.neighbors_end(vertex); ++neighbor) {
+				if (depths[*neighbor] != invalid) continue;
+
+				depths[*neighbor] = depths[vertex] + 1;
+				queue.push(*neighbor);
+			}
+		}
+
+		return depths;
+	}
+
+	bool has_edge(const graph_type& graph, uint32_t source, uint32_t target) {
+		return std::find(graph.neighbors_begin(source), graph.neighbors_end(source), target) != graph.neighbors_end(source);
+	}
+
+	void test_graph(const compressed_graph_builder<uint32_t, float>& builder, size_t vertex_count, uint32_t source, thread_pool& pool) {
+		const auto out_edges = builder.build(vertex_count);
+		const auto in_edges = builder.build(vertex_count, compressed_layout::column);
+
+		const adjacency_view<uint32_t> out_view = { vertex_count, out_edges.offsets(), out_edges.targets() };
+		const adjacency_view<uint32_t> in_view = { vertex_count, in_edges.offsets(), in_edges.targets() };
+
+		const auto expected = reference_depths(out_edges, source);
+		const auto reached = static_cast<size_t>(vertex_count - std::count(expected.begin(), expected.end(), invalid));
+
+		//top-down only, bottom-up as soon as possible and the default switching
+		const std::pair<size_t, size_t> directions[] = { { 1u << 30, 1 }, { 1, 1u << 30 }, { 14, 24 } };
+
+		for (auto direction : directions) {
+			for (auto current : { static_cast<thread_pool*>(nullptr), &pool }) {
+				bfs_options options;
+
+				options.pool = current;
+				options.alpha = direction.first;
+				options.beta = direction.second;
+
+				std::vector<uint32_t> parents(vertex_count);
+				std::vector<uint32_t> depths(vertex_count, invalid);
+
+				ALG_DAT_CHECK(breadth_first_search(out_view, in_view, source, parents.data(), depths.data(), options) == reached);
+				ALG_DAT_CHECK(depths == expected);
+
+				size_t failures = 0;
+
+				for (uint32_t vertex = 0; vertex < vertex_count; vertex++) {
+					if (expected[vertex] == invalid) failures += parents[vertex] != invalid;
+					else if (vertex == source) failures += parents[vertex] != source;
+					else failures += expected[parents[vertex]] + 1 != expected[vertex] || !has_edge(out_edges, parents[vertex], vertex);
+				}
+
+				ALG_DAT_CHECK(failures == 0);
+			}
+		}
+	}
+
+	void test_random_graphs(std::mt19937& random, thread_pool& pool) {
+		for (size_t vertex_count : { 1, 50, 1000, 20000, 100000 }) {
+			for (size_t degree : { 1, 8 }) {
+				compressed_graph_builder<uint32_t, float> builder(false, false);
+
+				for (size_t index = 0; index < vertex_count * degree + vertex_count / 2; index++)
+					builder.add_edge(static_cast<uint32_t>(random() % vertex_count), static_cast<uint32_t>(random() % vertex_count));
+
+				test_graph(builder, vertex_count, static_cast<uint32_t>(random() % vertex_count), pool);
+			}
+		}
+	}
+
+	//a cycle has one vertex in every level, and a star has all vertices in one level
+	void test_shapes(thread_pool& pool) {
+		const uint32_t vertex_count = 5000;
+
+		compressed_graph_builder<uint32_t, float> cycle(false, false);
+		compressed_graph_builder<uint32_t, float> star(false, false);
+
+		for (uint32_t vertex = 0; vertex < vertex_count; vertex++) {
+			cycle.add_edge(vertex, (vertex + 1) % vertex_count);
+			star.add_edge(0, vertex);
+			star.add_edge(vertex, 0);
+		}
+
+		test_graph(cycle, vertex_count, 17, pool);
+		test_graph(star, vertex_count, 0, pool);
+		test_graph(star, vertex_count, 9, pool);
+	}
+}
+
+int main() {
+	std::mt19937 random(80);
+	thread_pool pool(4);
+
+	test_random_graphs(random, pool);
+	test_shapes(pool);
+
+	return test::result("breadth_first_search");
+}
@@ -0,0 +1,172 @@
+/*
+ * bvh.cpp
+ * Test the box, point and ray queries of bvh2 against the brute force tests of every box, before and after refit,
+ * and the build and refit on a thread_pool against the sequential build and refit : the nodes are same.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../datastructure/spatial/bvh.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	using bounds_type = bounds2_t<float>;
+	using vec_type = vec2_t<float>;
+
+	//the entry t of ray in box, or -1 if missed. It is same computation as bvh2::raycast, so the t is same in bits
+	float ray_entry(const bounds_type& box, const vec_type& origin, const vec_type& direction, float distance) {
+		float near = 0;
+		float far = distance;
+
+		for (size_t axis = 0; axis < 2; axis++) {
+			if (direction[axis] == 0.0f) {
+				if (box.min[axis] > origin[axis] || origin[axis] > box.max[axis]) return -1.0f;
+
+				continue;
+			}
+
+			const auto scale = 1.0f / direction[axis];
+			const auto t0 = (box.min[axis] - origin[axis]) * scale;
+			const auto t1 = (box.max[axis] - origin[axis]) * scale;
+
+			near = std::max(near, std::min(t0, t1));
+			far = std::min(far, std::max(t0, t1));
+		}
+
+		return near <= far ? near : -1.0f;
+	}
+
+	bool same(const bvh2<float>& left, const bvh2<float>& right) {
+		if (left.node_count() != right.node_count() || left.size() != right.size()) return false;
+
+		for (size_t index = 0; index < left.node_count(); index++) {
+			const auto& l = left.nodes()[index];
+			const auto& r = right.nodes()[index];
+
+			if (l.bounds != r.bounds || l.escape != r.escape || l.first != r.first || l.count != r.count) return false;
+		}
+
+		return true;
+	}
+
+	void test_queries(std::mt19937& random, const std::vector<bounds_type>& boxes, const bvh2<float>& tree) {
+		std::uniform_real_distribution<float> position(0, 1000), extent(0, 60);
+
+		for (int query = 0; query < 100; query++) {
+			const vec_type point(position(random), position(random));
+			const bounds_type bounds(point, point + vec_type(extent(random), extent(random)));
+
+			std::vector<size_t> found;
+			std::vector<size_t> expected;
+
+			tree.query(bounds, [&](size_t index) { found.push_back(index); });
+
+			for (size_t index = 0; index < boxes.size(); index++) if (boxes[index].overlap(bounds)) expected.push_back(index);
+
+			std::sort(found.begin(), found.end());
+			ALG_DAT_CHECK(found == expected);
+
+			found.clear();
+			expected.clear();
+
+			tree.query(point, [&](size_t index) { found.push_back(index); });
+
+			for (size_t index = 0; index < boxes.size(); index++) if (boxes[index].contains(point)) expected.push_back(index);
+
+			std::sort(found.begin(), found.end());
+			ALG_DAT_CHECK(found == expected);
+
+			found.clear();
+			expected.clear();
+
+			//the rays parallel to the axes have zero components
+			vec_type direction(position(random) - 500, position(random) - 500);
+
+			if (query % 10 == 1) direction.x = 0;
+			if (query % 10 == 2) direction.y = 0;
+
+			tree.raycast(point, direction, 1.0f, [&](size_t index, float) { found.push_back(index); return 1.0f; });
+
+			for (size_t index = 0; index < boxes.size(); index++) if (ray_entry(boxes[index], point, direction, 1.0f) >= 0) expected.push_back(index);
+
+			std::sort(found.begin(), found.end());
+			ALG_DAT_CHECK(found == expected);
+
+			//the visitor shrinks the distance to the hit, so the nearest box is found
+			float nearest = 1.0f;
+			float expected_nearest = 1.0f;
+
+			tree.raycast(point, direction, 1.0f, [&](size_t, float t) { nearest = std::min(nearest, t); return nearest; });
+
+			for (const auto& box : boxes) {
+				const auto t = ray_entry(box, point, direction, 1.0f);
+
+				if (t >= 0) expected_nearest = std::min(expected_nearest, t);
+			}
+
+			ALG_DAT_CHECK(nearest == expected_nearest);
+		}
+	}
+
+	void test_tree(std::mt19937& random, size_t size, size_t leaf_size, bool duplicate, thread_pool& pool) {
+		std::uniform_real_distribution<float> position(0, 1000), extent(0, 20);
+
+		std::vector<bounds_type> boxes(size);
+
+		//the duplicated boxes have same Morton code
+		for (auto& box : boxes) {
+			const auto min = duplicate ? vec_type(5.0f) : vec_type(position(random), position(random));
+
+			box = bounds_type(min, min + vec_type(extent(random), extent(random)));
+		}
+
+		bvh_options options;
+
+		options.leaf_size = leaf_size;
+
+		bvh2<float> tree(boxes.data(), boxes.data() + size, options);
+
+		options.pool = &pool;
+
+		bvh2<float> parallel(boxes.data(), boxes.data() + size, options);
+
+		ALG_DAT_CHECK(tree.size() == size && tree.empty() == (size == 0) && same(tree, parallel));
+
+		for (int round = 0; round < 2; round++) {
+			test_queries(random, boxes, tree);
+
+			for (auto& box : boxes) {
+				const vec_type offset(extent(random) - 10, extent(random) - 10);
+
+				box = bounds_type(box.min + offset, box.max + offset);
+			}
+
+			tree.refit(boxes.data());
+			parallel.refit(boxes.data());
+
+			ALG_DAT_CHECK(same(tree, parallel));
+		}
+
+		for (const auto& box : boxes) ALG_DAT_CHECK(tree.bounds().contains(box));
+	}
+}
+
+int main() {
+	std::mt19937 random(86);
+	thread_pool pool(4);
+
+	//the parallel steps need at least 2 * bvh_min_work boxes
+	for (size_t size : { 0, 1, 2, 3, 17, 1000, 50000 }) {
+		for (size_t leaf_size : { 1, 4 }) test_tree(random, size, leaf_size, false, pool);
+	}
+
+	test_tree(random, 500, 2, true, pool);
+
+	return test::result("bvh");
+}
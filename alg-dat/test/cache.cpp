@@ -0,0 +1,274 @@
+/*
+ * cache.cpp
+ * Test lru_cache against a std::list model of LRU, the budget and second chance of clock_cache,
+ * and sharded_cache from many threads against the same operations from one thread.
+ */
+
+#include <algorithm>
+#include <string>
+#include <random>
+#include <thread>
+#include <vector>
+#include <list>
+#include <map>
+
+#include "../datastructure/container/cache.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	//the model of lru cache, the front of list is the most recently used entry
+	class lru_model {
+	public:
+		lru_model(size_t budget, size_t entries) : mBudget(budget), mEntries(entries) {}
+
+		const std::string* find(int key) {
+			const auto entry = locate(key);
+
+			if (entry == mList.end()) return nullptr;
+
+			mList.splice(mList.begin(), mList, entry);
+
+			return &mList.front().value;
+		}
+
+		bool insert(int key, const std::string& value, size_t charge) {
+			if (charge > mBudget) return false;
+
+			erase(key);
+
+			mList.push_front({ key, value, charge });
+			mCharge += charge;
+
+			while (mCharge > mBudget || mList.size() > mEntries) {
+				mCharge -= mList.back().charge;
+				mList.pop_back();
+			}
+
+			return true;
+		}
+
+		bool erase(int key) {
+			const auto entry = locate(key);
+
+			if (entry == mList.end()) return false;
+
+			mCharge -= entry->charge;
+			mList.erase(entry);
+
+			return true;
+		}
+
+		size_t size() const { return mList.size(); }
+
+		size_t charge() const { return mCharge; }
+	private:
+		struct entry {
+			int key;
+			std::string value;
+			size_t charge;
+		};
+
+		std::list<entry>::iterator locate(int key) {
+			return std::find_if(mList.begin(), mList.end(), [&](const entry& current) { return current.key == key; });
+		}
+	private:
+		std::list<entry> mList;
+
+		size_t mBudget;
+		size_t mEntries;
+		size_t mCharge = 0;
+	};
+
+	void test_lru_cache(std::mt19937& random) {
+		lru_cache<int, std::string> cache(100, 20);
+		lru_model model(100, 20);
+
+		for (int round = 0; round < 100000; round++) {
+			const auto key = static_cast<int>(random() % 60);
+
+			switch (random() % 4) {
+			case 0: {
+				const auto result = cache.find(key);
+				const auto expected = model.find(key);
+
+				ALG_DAT_CHECK((result == nullptr) == (expected == nullptr));
+
+				if (result != nullptr && expected != nullptr) ALG_DAT_CHECK(*result == *expected);
+
+				break;
+			}
+			case 1:
+				ALG_DAT_CHECK(cache.erase(key) == model.erase(key));
+				break;
+			default: {
+				const auto value = std::to_string(random());
+				const auto charge = static_cast<size_t>(random() % 120);
+
+				ALG_DAT_CHECK(cache.insert(key, value, charge) == model.insert(key, value, charge));
+
+				break;
+			}
+			}
+
+			ALG_DAT_CHECK(cache.size() == model.size());
+			ALG_DAT_CHECK(cache.charge() == model.charge());
+		}
+
+		cache.clear();
+
+		ALG_DAT_CHECK(cache.empty() && cache.charge() == 0);
+	}
+
+	void test_clock_cache(std::mt19937& random) {
+		clock_cache<int, int> cache(50, 16);
+		std::map<int, int> values;
+
+		for (int round = 0; round < 100000; round++) {
+			const auto key = static_cast<int>(random() % 100);
+
+			switch (random() % 4) {
+			case 0: {
+				const auto result = cache.find(key);
+
+				if (result != nullptr) ALG_DAT_CHECK(*result == values[key]);
+
+				break;
+			}
+			case 1:
+				cache.erase(key);
+
+				ALG_DAT_CHECK(cache.find(key) == nullptr);
+
+				break;
+			default: {
+				const auto value = static_cast<int>(random());
+
+				values[key] = value;
+
+				//the new entry is never evicted by its own insert
+				ALG_DAT_CHECK(cache.insert(key, value, random() % 10));
+				ALG_DAT_CHECK(cache.find(key) != nullptr && *cache.find(key) == value);
+
+				break;
+			}
+			}
+
+			ALG_DAT_CHECK(cache.charge() <= cache.budget() && cache.size() <= 16);
+		}
+
+		ALG_DAT_CHECK(!cache.insert(0, 0, 51));
+
+		//the referenced entry gets second chance, the first entry not referenced is evicted
+		clock_cache<int, int> small(100, 4);
+
+		for (int key = 0; key < 4; key++) small.insert(key, key);
+
+		small.find(0);
+		small.insert(4, 4);
+
+		ALG_DAT_CHECK(small.find(0) != nullptr && small.find(1) == nullptr && small.find(4) != nullptr);
+	}
+
+	template<typename Cache>
+	void test_sharded_cache_budget() {
+		for (size_t budget : { 0, 1, 4, 10, 15, 16, 17, 100 }) {
+			for (size_t entries : { 1, 3, 16, 100 }) {
+				sharded_cache<Cache, 16> cache(budget, entries);
+
+				for (int key = 0; key < 1000; key++) cache.insert(key, key);
+
+				ALG_DAT_CHECK(cache.charge() <= budget && cache.size() <= entries);
+
+				//the budget is not lost by the division into shards
+				if (budget <= entries) ALG_DAT_CHECK(cache.size() == budget);
+			}
+		}
+	}
+
+	//the keys of threads are disjoint and every shard is large enough for all keys, so every thread sees its own inserts
+	template<typename Cache>
+	void test_sharded_cache_threads() {
+		const int thread_count = 4;
+		const int key_count = 2000;
+		const int capacity = thread_count * key_count * 8;
+
+		sharded_cache<Cache, 8> cache(capacity, capacity);
+		sharded_cache<Cache, 8> sequential(capacity, capacity);
+
+		std::vector<std::thread> threads;
+		std::vector<int> failures(thread_count, 0);
+
+		for (int thread = 0; thread < thread_count; thread++) {
+			threads.emplace_back([&, thread]() {
+				for (int key = thread; key < thread_count * key_count; key += thread_count) {
+					int value = 0;
+
+					if (cache.find(key, value)) failures[thread]++;
+
+					cache.insert(key, key * 3);
+
+					if (!cache.find(key, value) || value != key * 3) failures[thread]++;
+				}
+			});
+		}
+
+		for (auto& thread : threads) thread.join();
+
+		for (int key = 0; key < thread_count * key_count; key++) sequential.insert(key, key * 3);
+
+		ALG_DAT_CHECK(std::count(failures.begin(), failures.end(), 0) == thread_count);
+		ALG_DAT_CHECK(cache.size() == sequential.size() && cache.charge() == sequential.charge());
+
+		for (int key = 0; key < thread_count * key_count; key++) {
+			int value = 0;
+
+			ALG_DAT_CHECK(cache.find(key, value) && value == key * 3);
+		}
+
+		//the threads fight for a small cache, it never breaks the budget or returns a wrong value
+		sharded_cache<Cache, 4> small(64, 32);
+
+		threads.clear();
+
+		for (int thread = 0; thread < thread_count; thread++) {
+			threads.emplace_back([&, thread]() {
+				std::mt19937 random(thread);
+
+				for (int round = 0; round < 20000; round++) {
+					const auto key = static_cast<int>(random() % 500);
+
+					int value = 0;
+
+					if (small.find(key, value) && value != key + 1) failures[thread]++;
+
+					if (random() % 3 == 0) small.insert(key, key + 1, random() % 8);
+					else if (random() % 7 == 0) small.erase(key);
+				}
+			});
+		}
+
+		for (auto& thread : threads) thread.join();
+
+		ALG_DAT_CHECK(std::count(failures.begin(), failures.end(), 0) == thread_count);
+		ALG_DAT_CHECK(small.charge() <= 64 && small.size() <= 32);
+	}
+}
+
+int main() {
+	std::mt19937 random(77);
+
+	test_lru_cache(random);
+	test_clock_cache(random);
+
+	test_sharded_cache_budget<lru_cache<int, int>>();
+	test_sharded_cache_budget<clock_cache<int, int>>();
+
+	test_sharded_cache_threads<lru_cache<int, int>>();
+	test_sharded_cache_threads<clock_cache<int, int>>();
+
+	return test::result("cache");
+}
@@ -0,0 +1,171 @@
+/*
+ * compressed_graph.cpp
+ * Test compressed_graph_builder against the adjacency lists built by std::stable_sort of edges,
+ * in row and column layouts, with compacted ids, and the build on a thread_pool against the sequential build.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../datastructure/container/compressed_graph.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	using builder_type = compressed_graph_builder<uint32_t, float>;
+	using graph_type = builder_type::graph_type;
+
+	struct edge {
+		uint32_t source;
+		uint32_t target;
+		float weight;
+	};
+
+	//the rows of graph in the order of builder : grouped by row, sorted by the other endpoint if need, else in input order
+	std::vector<edge> expected_rows(std::vector<edge> edges, compressed_layout layout, bool sorted) {
+		const auto row = [&](const edge& value) { return layout == compressed_layout::row ? value.source : value.target; };
+		const auto column = [&](const edge& value) { return layout == compressed_layout::row ? value.target : value.source; };
+
+		std::stable_sort(edges.begin(), edges.end(), [&](const edge& left, const edge& right) {
+			if (row(left) != row(right)) return row(left) < row(right);
+
+			return sorted && column(left) < column(right);
+		});
+
+		return edges;
+	}
+
+	bool same(const graph_type& graph, const std::vector<edge>& rows, compressed_layout layout, size_t vertex_count) {
+		if (graph.vertex_count() != vertex_count || graph.edge_count() != rows.size() || graph.layout() != layout) return false;
+
+		size_t index = 0;
+
+		for (uint32_t vertex = 0; vertex < vertex_count; vertex++) {
+			auto weight = graph.weights_begin(vertex);
+
+			for (auto neighbor = graph.neighbors_begin(vertex); neighbor != graph.neighbors_end(vertex); ++neighbor, ++weight, ++index) {
+				const auto& expected = rows[index];
+
+				if (layout == compressed_layout::row && (expected.source != vertex || expected.target != *neighbor)) return false;
+				if (layout == compressed_layout::column && (expected.target != vertex || expected.source != *neighbor)) return false;
+				if (expected.weight != *weight) return false;
+			}
+		}
+
+		return index == rows.size();
+	}
+
+	bool same(const graph_type& left, const graph_type& right) {
+		if (left.vertex_count() != right.vertex_count() || left.edge_count() != right.edge_count()) return false;
+
+		return std::equal(left.offsets(), left.offsets() + left.vertex_count() + 1, right.offsets()) &&
+			std::equal(left.targets(), left.targets() + left.edge_count(), right.targets()) &&
+			std::equal(left.weights(), left.weights() + left.edge_count(), right.weights());
+	}
+
+	void test_build(std::mt19937& random, thread_pool& pool) {
+		for (size_t vertex_count : { 1, 7, 1000, 50000 }) {
+			for (bool sorted : { false, true }) {
+				std::vector<edge> edges;
+
+				builder_type sequential(true, sorted);
+				builder_type parallel(true, sorted, compressed_graph_options{ &pool });
+
+				//the weights are the input order, so the stability is checked too
+				for (size_t index = 0; index < 100000; index++) {
+					const edge value = { static_cast<uint32_t>(random() % vertex_count), static_cast<uint32_t>(random() % vertex_count), static_cast<float>(index) };
+
+					edges.push_back(value);
+					sequential.add_edge(value.source, value.target, value.weight);
+					parallel.add_edge(value.source, value.target, value.weight);
+				}
+
+				for (auto layout : { compressed_layout::row, compressed_layout::column }) {
+					const auto graph = sequential.build(vertex_count, layout);
+
+					ALG_DAT_CHECK(same(graph, expected_rows(edges, layout, sorted), layout, vertex_count));
+					ALG_DAT_CHECK(same(graph, parallel.build(vertex_count, layout)));
+				}
+
+				//the rvalue build moves the edges of builder
+				const auto graph = sequential.build(vertex_count);
+				const auto moved = std::move(parallel).build(vertex_count);
+
+				ALG_DAT_CHECK(same(graph, moved) && parallel.edge_count() == 0);
+			}
+		}
+	}
+
+	void test_build_compact(std::mt19937& random, thread_pool& pool) {
+		builder_type sequential(true);
+		builder_type parallel(true, true, compressed_graph_options{ &pool });
+
+		std::vector<edge> edges;
+		std::vector<uint32_t> expected_ids;
+
+		//the sparse ids are multiple of 977
+		for (size_t index = 0; index < 60000; index++) {
+			const edge value = { static_cast<uint32_t>(random() % 5000 * 977), static_cast<uint32_t>(random() % 5000 * 977), static_cast<float>(random() % 100) };
+
+			edges.push_back(value);
+			expected_ids.push_back(value.source);
+			expected_ids.push_back(value.target);
+			sequential.add_edge(value.source, value.target, value.weight);
+			parallel.add_edge(value.source, value.target, value.weight);
+		}
+
+		std::sort(expected_ids.begin(), expected_ids.end());
+		expected_ids.erase(std::unique(expected_ids.begin(), expected_ids.end()), expected_ids.end());
+
+		for (auto& value : edges) {
+			value.source = static_cast<uint32_t>(std::lower_bound(expected_ids.begin(), expected_ids.end(), value.source) - expected_ids.begin());
+			value.target = static_cast<uint32_t>(std::lower_bound(expected_ids.begin(), expected_ids.end(), value.target) - expected_ids.begin());
+		}
+
+		for (auto layout : { compressed_layout::row, compressed_layout::column }) {
+			std::vector<uint32_t> ids;
+			std::vector<uint32_t> parallel_ids;
+
+			const auto graph = sequential.build_compact(ids, layout);
+
+			ALG_DAT_CHECK(ids == expected_ids);
+			ALG_DAT_CHECK(same(graph, expected_rows(edges, layout, true), layout, expected_ids.size()));
+			ALG_DAT_CHECK(same(graph, parallel.build_compact(parallel_ids, layout)) && parallel_ids == ids);
+		}
+	}
+
+	void test_small() {
+		compressed_graph_builder<uint64_t> builder;
+
+		builder.add_edge(0, 3);
+		builder.add_edge(3, 1);
+		builder.add_edge(0, 1);
+
+		const auto graph = builder.build(5);
+
+		ALG_DAT_CHECK(graph.vertex_count() == 5 && graph.edge_count() == 3 && !graph.has_weights());
+		ALG_DAT_CHECK(graph.degree(0) == 2 && graph.degree(1) == 0 && graph.degree(3) == 1 && graph.degree(4) == 0);
+		ALG_DAT_CHECK(graph.neighbors_begin(0)[0] == 1 && graph.neighbors_begin(0)[1] == 3);
+		ALG_DAT_CHECK(graph.weights_begin(0) == nullptr);
+
+		//no edges
+		const auto empty = compressed_graph_builder<uint32_t, float>(true).build(3);
+
+		ALG_DAT_CHECK(empty.vertex_count() == 3 && empty.edge_count() == 0);
+	}
+}
+
+int main() {
+	std::mt19937 random(79);
+	thread_pool pool(4);
+
+	test_build(random, pool);
+	test_build_compact(random, pool);
+	test_small();
+
+	return test::result("compressed_graph");
+}
@@ -0,0 +1,226 @@
+/*
+ * delaunay.cpp
+ * Test incircle against the exact 128-bit determinant on the nearly cocircular points,
+ * delaunay2 against the brute force empty circumcircle test on small random, grid and collinear points,
+ * and the parallel triangulation on a thread_pool against the sequential triangulation (it is unique)
+ * with the local Delaunay test of every edge.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <array>
+#include <set>
+
+#include "../algorithm/geometry/delaunay.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+#if defined(__SIZEOF_INT128__)
+	__extension__ typedef __int128 int128;
+
+	//the corners of rectangle are cocircular, the fourth corner is moved by one unit
+	void test_incircle(std::mt19937& random) {
+		const auto value = [&]() { return static_cast<int64_t>(random() % (1u << 20)); };
+
+		size_t failures = 0;
+
+		for (int round = 0; round < 100000; round++) {
+			int64_t x0 = value(), x1 = value(), y0 = value(), y1 = value();
+
+			if (x0 == x1 || y0 == y1) continue;
+			if (x0 > x1) std::swap(x0, x1);
+			if (y0 > y1) std::swap(y0, y1);
+
+			const int64_t a[2] = { x0, y0 }, b[2] = { x1, y0 }, c[2] = { x1, y1 };
+			const int64_t d[2] = { x0 + static_cast<int64_t>(random() % 3) - 1, y1 + static_cast<int64_t>(random() % 3) - 1 };
+
+			const auto lift = [&](const int64_t* p) { return static_cast<int128>(p[0] - d[0]) * (p[0] - d[0]) + static_cast<int128>(p[1] - d[1]) * (p[1] - d[1]); };
+			const auto cross = [&](const int64_t* p, const int64_t* q) { return static_cast<int128>(p[0] - d[0]) * (q[1] - d[1]) - static_cast<int128>(p[1] - d[1]) * (q[0] - d[0]); };
+
+			const auto determinant = lift(a) * cross(b, c) + lift(b) * cross(c, a) + lift(c) * cross(a, b);
+			const auto expected = determinant > 0 ? 1 : determinant < 0 ? -1 : 0;
+
+			const auto point = [](const int64_t* p) { return vec2_t<double>(static_cast<double>(p[0]), static_cast<double>(p[1])); };
+
+			failures += incircle(point(a), point(b), point(c), point(d)) != expected;
+			failures += incircle(point(b), point(c), point(a), point(d)) != expected;
+		}
+
+		ALG_DAT_CHECK(failures == 0);
+	}
+#else
+	void test_incircle(std::mt19937&) {}
+#endif
+
+	//the mesh is consistent, the triangles are counterclockwise, every distinct point is used and the count is 2n - 2 - h
+	template<typename T>
+	bool valid_mesh(const std::vector<vec2_t<T>>& points, const delaunay2<T>& mesh) {
+		const auto vertices = mesh.vertices();
+		const auto twins = mesh.twins();
+		const auto edge_count = static_cast<uint32_t>(mesh.triangle_count() * 3);
+
+		size_t hull = 0;
+
+		std::vector<bool> used(points.size());
+
+		for (uint32_t edge = 0; edge < edge_count; edge++) {
+			used[vertices[edge]] = true;
+
+			if (twins[edge] == delaunay2<T>::none) {
+				hull++;
+
+				continue;
+			}
+
+			if (twins[twins[edge]] != edge || vertices[twins[edge]] != vertices[mesh.next(edge)]) return false;
+		}
+
+		for (size_t triangle = 0; triangle < mesh.triangle_count(); triangle++)
+			if (orientation(points[vertices[3 * triangle]], points[vertices[3 * triangle + 1]], points[vertices[3 * triangle + 2]]) <= 0) return false;
+
+		std::set<std::pair<T, T>> distinct;
+
+		for (const auto& point : points) distinct.insert({ point.x, point.y });
+
+		if (static_cast<size_t>(std::count(used.begin(), used.end(), true)) != distinct.size()) return false;
+
+		return mesh.triangle_count() == 2 * distinct.size() - 2 - hull;
+	}
+
+	//no point is strictly in the circumcircle of any triangle
+	template<typename T>
+	bool empty_circles(const std::vector<vec2_t<T>>& points, const delaunay2<T>& mesh) {
+		const auto vertices = mesh.vertices();
+
+		for (size_t triangle = 0; triangle < mesh.triangle_count(); triangle++) {
+			for (const auto& point : points)
+				if (incircle(points[vertices[3 * triangle]], points[vertices[3 * triangle + 1]], points[vertices[3 * triangle + 2]], point) > 0) return false;
+		}
+
+		return true;
+	}
+
+	//the opposite vertex of every edge is not strictly in the circumcircle, it is same as empty_circles
+	template<typename T>
+	bool locally_delaunay(const std::vector<vec2_t<T>>& points, const delaunay2<T>& mesh) {
+		const auto vertices = mesh.vertices();
+		const auto twins = mesh.twins();
+
+		for (uint32_t edge = 0; edge < mesh.triangle_count() * 3; edge++) {
+			if (twins[edge] == delaunay2<T>::none) continue;
+
+			const auto triangle = edge / 3 * 3;
+			const auto opposite = vertices[mesh.previous(twins[edge])];
+
+			if (incircle(points[vertices[triangle]], points[vertices[triangle + 1]], points[vertices[triangle + 2]], points[opposite]) > 0) return false;
+		}
+
+		return true;
+	}
+
+	//the triangles by the coordinates of corners, the duplicated points may be inserted from different indices
+	template<typename T>
+	std::set<std::array<std::pair<T, T>, 3>> triangles(const std::vector<vec2_t<T>>& points, const delaunay2<T>& mesh) {
+		std::set<std::array<std::pair<T, T>, 3>> result;
+
+		for (size_t triangle = 0; triangle < mesh.triangle_count(); triangle++) {
+			std::array<std::pair<T, T>, 3> corners;
+
+			for (size_t corner = 0; corner < 3; corner++) {
+				const auto& point = points[mesh.vertices()[3 * triangle + corner]];
+
+				corners[corner] = { point.x, point.y };
+			}
+
+			std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+			result.insert(corners);
+		}
+
+		return result;
+	}
+
+	void test_small(std::mt19937& random) {
+		size_t failures = 0;
+
+		for (int round = 0; round < 150; round++) {
+			const auto size = 3 + random() % 400;
+			const auto grid = static_cast<int>(2 + random() % 20);
+
+			std::uniform_real_distribution<double> distribution(-1, 1);
+
+			std::vector<vec2_t<double>> real_points(size);
+			std::vector<vec2_t<int32_t>> grid_points(size);
+			std::vector<vec2_t<float>> line_points(size);
+
+			//the float points are often on the line y = 0
+			for (size_t index = 0; index < size; index++) {
+				real_points[index] = vec2_t<double>(distribution(random), distribution(random));
+				grid_points[index] = vec2_t<int32_t>(static_cast<int32_t>(random() % grid), static_cast<int32_t>(random() % grid));
+				line_points[index] = vec2_t<float>(static_cast<float>(random() % grid) * 0.1f, random() % 3 == 0 ? 0.0f : static_cast<float>(random() % grid) * 0.1f);
+			}
+
+			const delaunay2<double> real_mesh(real_points.data(), real_points.data() + size);
+			const delaunay2<int32_t> grid_mesh(grid_points.data(), grid_points.data() + size);
+			const delaunay2<float> line_mesh(line_points.data(), line_points.data() + size);
+
+			failures += !valid_mesh(real_points, real_mesh) || !empty_circles(real_points, real_mesh);
+
+			if (grid_mesh.triangle_count() != 0) failures += !valid_mesh(grid_points, grid_mesh) || !empty_circles(grid_points, grid_mesh);
+			if (line_mesh.triangle_count() != 0) failures += !valid_mesh(line_points, line_mesh) || !empty_circles(line_points, line_mesh);
+		}
+
+		ALG_DAT_CHECK(failures == 0);
+
+		//all points are collinear, there is no triangle
+		const std::vector<vec2_t<double>> line = { vec2_t<double>(0, 0), vec2_t<double>(1, 1), vec2_t<double>(3, 3), vec2_t<double>(1, 1) };
+
+		ALG_DAT_CHECK(delaunay2<double>(line.data(), line.data() + line.size()).triangle_count() == 0);
+	}
+
+	//the parallel mode needs at least 2 * delaunay_min_work points
+	void test_parallel(std::mt19937& random, thread_pool& pool) {
+		const size_t size = 140000;
+
+		std::uniform_real_distribution<double> distribution(0, 1);
+
+		std::vector<vec2_t<double>> points(size);
+
+		for (auto& point : points) point = vec2_t<double>(distribution(random), distribution(random));
+
+		const delaunay2<double> sequential(points.data(), points.data() + size);
+		const delaunay2<double> parallel(points.data(), points.data() + size, delaunay_options{ &pool });
+
+		ALG_DAT_CHECK(valid_mesh(points, sequential) && locally_delaunay(points, sequential));
+		ALG_DAT_CHECK(valid_mesh(points, parallel) && locally_delaunay(points, parallel));
+		ALG_DAT_CHECK(triangles(points, sequential) == triangles(points, parallel));
+
+		//the grid points are cocircular, the symbolic perturbation makes the triangulation unique, the two columns are on the seams
+		std::vector<vec2_t<int32_t>> grid(size);
+
+		for (auto& point : grid) point = vec2_t<int32_t>(static_cast<int32_t>(random() % 700), static_cast<int32_t>(random() % 700));
+		for (size_t index = 0; index < 1000; index++) grid[index] = vec2_t<int32_t>(index % 2 != 0 ? 0 : 699, static_cast<int32_t>(index % 700));
+
+		const delaunay2<int32_t> grid_sequential(grid.data(), grid.data() + size);
+		const delaunay2<int32_t> grid_parallel(grid.data(), grid.data() + size, delaunay_options{ &pool });
+
+		ALG_DAT_CHECK(valid_mesh(grid, grid_sequential) && locally_delaunay(grid, grid_sequential));
+		ALG_DAT_CHECK(valid_mesh(grid, grid_parallel) && locally_delaunay(grid, grid_parallel));
+		ALG_DAT_CHECK(triangles(grid, grid_sequential) == triangles(grid, grid_parallel));
+	}
+}
+
+int main() {
+	std::mt19937 random(94);
+	thread_pool pool(4);
+
+	test_incircle(random);
+	test_small(random);
+	test_parallel(random, pool);
+
+	return test::result("delaunay");
+}
@@ -0,0 +1,167 @@
+/*
+ * fixed.cpp
+ * Test fixed16_16 against the int64_t references and fixed32_32 against the 128-bit integer references,
+ * the floor of sqrt, the bulk fixed_multiply (SIMD) against operator* (scalar), and fixed_t in vec2_t and bounds2_t.
+ */
+
+#include <random>
+#include <vector>
+
+#include "../dependent/fixed.hpp"
+#include "../dependent/bounds2.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	static_assert(fixed16_16(3) * fixed16_16(2) == fixed16_16(6), "the constant multiplication of fixed16_16.");
+	static_assert(fixed16_16(1.5) + fixed16_16(2) == fixed16_16(3.5), "the constant addition of fixed16_16.");
+	static_assert(fixed32_32(7) / fixed32_32(2) == fixed32_32(3.5), "the constant division of fixed32_32.");
+	static_assert((vec2_t<fixed16_16>(1, 2) * fixed16_16(3)).y == fixed16_16(6), "the constant vec2_t of fixed16_16.");
+
+#if defined(__SIZEOF_INT128__)
+	__extension__ typedef __int128 int128;
+	__extension__ typedef unsigned __int128 uint128;
+#endif
+
+	void test_fixed16_16(std::mt19937_64& random) {
+		size_t failures = 0;
+
+		for (int round = 0; round < 1000000; round++) {
+			auto a = static_cast<int32_t>(random());
+			auto b = static_cast<int32_t>(random());
+
+			//the small values do not overflow in the division
+			if (round % 3 == 0) {
+				a = a >> 12;
+				b = b >> 12;
+			}
+
+			const auto fa = fixed16_16::from_raw(a), fb = fixed16_16::from_raw(b);
+
+			failures += (fa * fb).raw() != static_cast<int32_t>((static_cast<int64_t>(a) * b) >> 16);
+			failures += (fa + fb).raw() != static_cast<int32_t>(static_cast<uint32_t>(a) + static_cast<uint32_t>(b));
+
+			if (b != 0) {
+				const auto quotient = static_cast<int64_t>(a) * 65536 / b;
+
+				if (quotient <= INT32_MAX && quotient >= INT32_MIN) failures += (fa / fb).raw() != static_cast<int32_t>(quotient);
+			}
+
+			if (a > 0) {
+				const auto root = static_cast<uint64_t>(sqrt(fa).raw());
+				const auto square = static_cast<uint64_t>(a) << 16;
+
+				failures += !(root * root <= square && (root + 1) * (root + 1) > square);
+			}
+		}
+
+		ALG_DAT_CHECK(failures == 0);
+	}
+
+	void test_fixed32_32(std::mt19937_64& random) {
+#if defined(__SIZEOF_INT128__)
+		size_t failures = 0;
+
+		for (int round = 0; round < 1000000; round++) {
+			auto c = static_cast<int64_t>(random());
+			auto d = static_cast<int64_t>(random());
+
+			if (round % 2 == 1) {
+				c = c >> 20;
+				d = d >> 20;
+			}
+
+			const auto fc = fixed32_32::from_raw(c), fd = fixed32_32::from_raw(d);
+			const auto product = static_cast<int128>(c) * d;
+
+			failures += (fc * fd).raw() != static_cast<int64_t>(product >> 32);
+
+			uint64_t low = 0;
+			int64_t high = 0;
+
+			detail::fixed_multiply_wide(c, d, low, high);
+			failures += low != static_cast<uint64_t>(product) || high != static_cast<int64_t>(product >> 64);
+
+			if (d != 0) {
+				const auto quotient = static_cast<int128>(c) * (static_cast<int128>(1) << 32) / d;
+
+				if (quotient <= INT64_MAX && quotient >= INT64_MIN) failures += (fc / fd).raw() != static_cast<int64_t>(quotient);
+			}
+
+			if (c > 0) {
+				const auto root = static_cast<uint128>(sqrt(fc).raw());
+				const auto square = static_cast<uint128>(c) << 32;
+
+				failures += !(root * root <= square && (root + 1) * (root + 1) > square);
+			}
+		}
+
+		ALG_DAT_CHECK(failures == 0);
+#else
+		(void)random;
+#endif
+	}
+
+	//the sizes cover the AVX-512, AVX2 and SSE4.1 batches and the scalar tail
+	void test_bulk_multiply(std::mt19937_64& random) {
+		for (size_t size : { 0, 1, 3, 4, 7, 8, 15, 16, 17, 100, 1001 }) {
+			std::vector<fixed16_16> a(size), b(size), output(size);
+			std::vector<fixed32_32> c(size), d(size), wide_output(size);
+
+			for (size_t index = 0; index < size; index++) {
+				a[index] = fixed16_16::from_raw(static_cast<int32_t>(random()));
+				b[index] = fixed16_16::from_raw(static_cast<int32_t>(random()) >> (index % 24));
+				c[index] = fixed32_32::from_raw(static_cast<int64_t>(random()));
+				d[index] = fixed32_32::from_raw(static_cast<int64_t>(random()) >> 20);
+			}
+
+			fixed_multiply(a.data(), b.data(), output.data(), size);
+			fixed_multiply(c.data(), d.data(), wide_output.data(), size);
+
+			size_t failures = 0;
+
+			for (size_t index = 0; index < size; index++) {
+				failures += output[index] != a[index] * b[index];
+				failures += wide_output[index] != c[index] * d[index];
+			}
+
+			//the output can be the input
+			fixed_multiply(a.data(), b.data(), a.data(), size);
+
+			failures += a != output;
+
+			ALG_DAT_CHECK(failures == 0);
+		}
+	}
+
+	void test_vectors() {
+		const vec2_t<fixed16_16> v(fixed16_16(3.0), fixed16_16(4.0));
+
+		ALG_DAT_CHECK(v.length() == fixed16_16(5));
+
+		bounds2_t<fixed32_32> bounds;
+
+		bounds.expand(vec2_t<fixed32_32>(1, 2));
+		bounds.expand(vec2_t<fixed32_32>(-3, 5));
+
+		ALG_DAT_CHECK(bounds.area() == fixed32_32(12) && bounds.center() == vec2_t<fixed32_32>(-1, fixed32_32(3.5)));
+
+		//the integer conversion rounds toward negative infinity
+		ALG_DAT_CHECK(static_cast<double>(fixed16_16(-1.25)) == -1.25 && static_cast<int>(fixed16_16(-1.25)) == -2);
+		ALG_DAT_CHECK(std::numeric_limits<fixed16_16>::max().raw() == INT32_MAX);
+	}
+}
+
+int main() {
+	std::mt19937_64 random(91);
+
+	test_fixed16_16(random);
+	test_fixed32_32(random);
+	test_bulk_multiply(random);
+	test_vectors();
+
+	return test::result("fixed");
+}
@@ -0,0 +1,218 @@
+/*
+ * geometry.cpp
+ * Test orientation against the exact determinant of int64_t on the nearly collinear points,
+ * the convex hull against the orientation of all points and the parallel hull against the sequential hull,
+ * and the batch point_in_polygon against the single point test and the scalar loop of one point.
+ */
+
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <vector>
+
+#include "../algorithm/geometry/convex_hull.hpp"
+#include "../algorithm/geometry/point_in_polygon.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	//the coordinates are integers less than 2^29, the determinant is exact in int64_t and the products are not exact in double
+	void test_orientation(std::mt19937& random) {
+		const int64_t range = static_cast<int64_t>(1) << 29;
+
+		const auto value = [&]() { return static_cast<int64_t>(random() % static_cast<uint64_t>(range)); };
+
+		size_t failures = 0;
+
+		for (int round = 0; round < 100000; round++) {
+			const int64_t ax = value(), ay = value();
+			const int64_t dx = static_cast<int64_t>(random() % 4096), dy = static_cast<int64_t>(random() % 4096);
+			const int64_t k = static_cast<int64_t>(random() % 1000);
+
+			//c is on the line of a and b or one unit off
+			const int64_t bx = ax + dx, by = ay + dy;
+			const int64_t cx = ax + dx * k + static_cast<int64_t>(random() % 3) - 1, cy = ay + dy * k;
+
+			const auto determinant = (ax - cx) * (by - cy) - (ay - cy) * (bx - cx);
+			const auto expected = determinant > 0 ? 1 : determinant < 0 ? -1 : 0;
+
+			const auto a = vec2_t<double>(static_cast<double>(ax), static_cast<double>(ay));
+			const auto b = vec2_t<double>(static_cast<double>(bx), static_cast<double>(by));
+			const auto c = vec2_t<double>(static_cast<double>(cx), static_cast<double>(cy));
+
+			failures += orientation(a, b, c) != expected;
+			failures += orientation(b, c, a) != expected;
+			failures += orientation(b, a, c) != -expected;
+		}
+
+		ALG_DAT_CHECK(failures == 0);
+
+		//the next double of 0.5 makes a clockwise turn
+		const vec2_t<double> b(12, 12), c(24, 24);
+
+		ALG_DAT_CHECK(orientation(vec2_t<double>(0.5, 0.5), b, c) == 0);
+		ALG_DAT_CHECK(orientation(vec2_t<double>(std::nextafter(0.5, 1.0), 0.5), b, c) == -1);
+		ALG_DAT_CHECK(orientation(vec2_t<double>(std::nextafter(0.5, 0.0), 0.5), b, c) == 1);
+		ALG_DAT_CHECK(orientation(vec2_t<float>(0, 0), vec2_t<float>(1, 1), vec2_t<float>(2, 2)) == 0);
+		ALG_DAT_CHECK(orientation(vec2_t<int32_t>(0, 0), vec2_t<int32_t>(2000000000, 1), vec2_t<int32_t>(1, 0)) == -1);
+	}
+
+	//the hull is strictly convex and counterclockwise, and no point is on the right of any edge
+	template<typename T>
+	bool valid_hull(const std::vector<vec2_t<T>>& points, const std::vector<vec2_t<T>>& hull) {
+		const auto size = hull.size();
+
+		if (size < 3) return true;
+
+		for (size_t index = 0; index < size; index++) {
+			const auto& p0 = hull[index];
+			const auto& p1 = hull[(index + 1) % size];
+
+			if (orientation(p0, p1, hull[(index + 2) % size]) <= 0) return false;
+
+			for (const auto& point : points)
+				if (orientation(p0, p1, point) < 0) return false;
+		}
+
+		return true;
+	}
+
+	template<typename T>
+	void test_convex_hull(std::mt19937& random, thread_pool& pool) {
+		std::uniform_real_distribution<double> distribution(-1000, 1000);
+
+		//the parallel hull needs at least 2 * convex_hull_min_work points
+		for (size_t size : { 0, 1, 2, 3, 10, 1000, 140000 }) {
+			//random, collinear and the points of 5 x 5 grid
+			for (int mode = 0; mode < 3; mode++) {
+				std::vector<vec2_t<T>> points(size);
+
+				for (auto& point : points) {
+					if (mode == 0) point = vec2_t<T>(T(distribution(random)), T(distribution(random)));
+					else if (mode == 1) {
+						const auto k = static_cast<int>(distribution(random));
+
+						point = vec2_t<T>(T(k), T(2 * k + 1));
+					}
+					else point = vec2_t<T>(T(static_cast<int>(random() % 5)), T(static_cast<int>(random() % 5)));
+				}
+
+				std::vector<vec2_t<T>> hull(size), parallel(size);
+
+				hull.resize(convex_hull(points.data(), points.data() + size, hull.data()));
+				parallel.resize(convex_hull(points.data(), points.data() + size, parallel.data(), convex_hull_options{ &pool }));
+
+				ALG_DAT_CHECK(hull == parallel);
+				ALG_DAT_CHECK(valid_hull(points, hull));
+
+				if (size != 0) ALG_DAT_CHECK(hull.front() == *std::min_element(points.begin(), points.end(), [](const vec2_t<T>& l, const vec2_t<T>& r) {
+					return l.x < r.x || (l.x == r.x && l.y < r.y);
+				}));
+
+				if (mode == 1 && size >= 2) ALG_DAT_CHECK(hull.size() <= 2);
+				if (mode == 2 && size >= 1000) ALG_DAT_CHECK(hull.size() == 4);
+			}
+		}
+	}
+
+	void test_point_in_polygon(std::mt19937& random) {
+		std::uniform_real_distribution<float> distribution(-10, 10);
+
+		//the star polygon with 50 vertices
+		std::vector<vec2_t<float>> polygon;
+
+		for (int index = 0; index < 50; index++) {
+			const auto angle = static_cast<float>(index) * 6.2831853f / 50;
+			const auto radius = 5 + 3 * std::sin(angle * 5);
+
+			polygon.push_back(vec2_t<float>(radius * std::cos(angle), radius * std::sin(angle)));
+		}
+
+		for (size_t size : { 0, 1, 63, 64, 65, 1000 }) {
+			std::vector<vec2_t<float>> points(size);
+
+			for (auto& point : points) point = vec2_t<float>(distribution(random), distribution(random));
+
+			const vec2_soa<float> soa(points.data(), points.data() + size);
+
+			std::vector<uint64_t> mask((size + 63) / 64 + 1, ~static_cast<uint64_t>(0));
+
+			point_in_polygon(polygon.data(), polygon.size(), soa, mask.data());
+
+			size_t failures = 0;
+
+			for (size_t index = 0; index < size; index++) {
+				const bool inside = ((mask[index / 64] >> (index % 64)) & 1) != 0;
+
+				//one point is tested by the scalar loop, it is same as the batches in bits
+				const vec2_soa<float> single(&points[index], &points[index] + 1);
+
+				uint64_t single_mask = 0;
+
+				point_in_polygon(polygon.data(), polygon.size(), single, &single_mask);
+
+				failures += inside != point_in_polygon(polygon.data(), polygon.size(), points[index]);
+				failures += inside != (single_mask == 1);
+			}
+
+			ALG_DAT_CHECK(failures == 0);
+
+			//the bits out of size are 0
+			if (size % 64 != 0) ALG_DAT_CHECK((mask[size / 64] >> (size % 64)) == 0);
+		}
+
+		//the points on the edges are inside or outside, but the batches and the scalar loop round the intersections same
+		std::uniform_real_distribution<float> unit(0, 1);
+
+		std::vector<vec2_t<float>> points;
+
+		for (size_t index = 0, previous = polygon.size() - 1; index < polygon.size(); previous = index++) {
+			const auto& p0 = polygon[previous];
+			const auto& p1 = polygon[index];
+
+			for (int sample = 0; sample < 64; sample++) {
+				const auto y = p0.y + (p1.y - p0.y) * unit(random);
+				const auto x = p0.x + (y - p0.y) * ((p1.x - p0.x) / (p1.y - p0.y));
+
+				points.push_back(vec2_t<float>(std::nextafter(x, sample % 3 == 0 ? -100.0f : 100.0f), y));
+				points.push_back(vec2_t<float>(x, y));
+			}
+		}
+
+		const vec2_soa<float> soa(points.data(), points.data() + points.size());
+
+		std::vector<uint64_t> mask(soa.size() / 64 + 1);
+
+		point_in_polygon(polygon.data(), polygon.size(), soa, mask.data());
+
+		size_t failures = 0;
+
+		for (size_t index = 0; index < points.size(); index++) {
+			const vec2_soa<float> single(&points[index], &points[index] + 1);
+
+			uint64_t single_mask = 0;
+
+			point_in_polygon(polygon.data(), polygon.size(), single, &single_mask);
+
+			failures += ((mask[index / 64] >> (index % 64)) & 1) != single_mask;
+		}
+
+		ALG_DAT_CHECK(failures == 0);
+	}
+}
+
+int main() {
+	std::mt19937 random(90);
+	thread_pool pool(4);
+
+	test_orientation(random);
+	test_convex_hull<float>(random, pool);
+	test_convex_hull<double>(random, pool);
+	test_convex_hull<int32_t>(random, pool);
+	test_point_in_polygon(random);
+
+	return test::result("geometry");
+}
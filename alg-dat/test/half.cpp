@@ -0,0 +1,213 @@
+/*
+ * half.cpp
+ * Test half against the nearest binary16 found in the table of all halves (round to nearest even),
+ * the bulk conversions (F16C) against the scalar conversions, and the half and quantized decoders of vec2
+ * (AoS, SoA and single point) against each other and the error bounds.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <cstring>
+
+#include "../dependent/vec2_compressed.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	static_assert(sizeof(half) == 2 && sizeof(vec2_t<half>) == 4, "half is 2 bytes.");
+
+	bool is_nan_bits(uint16_t bits) {
+		return (bits & 0x7C00) == 0x7C00 && (bits & 0x3FF) != 0;
+	}
+
+	//the finite positive halves in order, and 65536 for the infinity (the next step after the max half 65504)
+	std::vector<float> half_table() {
+		std::vector<float> table;
+
+		for (uint32_t bits = 0; bits < 0x7C00; bits++) table.push_back(static_cast<float>(half::from_bits(static_cast<uint16_t>(bits))));
+
+		table.push_back(65536.0f);
+
+		return table;
+	}
+
+	//the nearest half of value, the ties go to the even bits
+	uint16_t reference_half(const std::vector<float>& table, float value) {
+		const uint16_t sign = std::signbit(value) ? 0x8000 : 0;
+		const auto magnitude = std::fabs(value);
+
+		if (magnitude >= 65536.0f) return static_cast<uint16_t>(sign | 0x7C00);
+
+		const auto upper = static_cast<uint16_t>(std::lower_bound(table.begin(), table.end(), magnitude) - table.begin());
+
+		if (table[upper] == magnitude || upper == 0) return static_cast<uint16_t>(sign | upper);
+
+		const auto lower = static_cast<uint16_t>(upper - 1);
+
+		//the difference of neighbor floats is exact
+		const auto below = magnitude - table[lower];
+		const auto above = table[upper] - magnitude;
+
+		if (below < above) return static_cast<uint16_t>(sign | lower);
+		if (above < below) return static_cast<uint16_t>(sign | upper);
+
+		return static_cast<uint16_t>(sign | ((lower & 1) == 0 ? lower : upper));
+	}
+
+	void test_roundtrip() {
+		size_t failures = 0;
+
+		for (uint32_t bits = 0; bits < 65536; bits++) {
+			const auto value = static_cast<float>(half::from_bits(static_cast<uint16_t>(bits)));
+
+			if (is_nan_bits(static_cast<uint16_t>(bits))) failures += !std::isnan(value);
+			else failures += half(value).bits() != bits;
+		}
+
+		ALG_DAT_CHECK(failures == 0);
+	}
+
+	void test_conversions(std::mt19937& random) {
+		const auto table = half_table();
+
+		//the random bits (all exponents and NaN) and the values near the range of half
+		std::vector<float> values(100003);
+
+		for (auto& value : values) {
+			const auto bits = static_cast<uint32_t>(random());
+
+			std::memcpy(&value, &bits, sizeof(float));
+
+			if (random() % 2 == 0) value = std::ldexp(static_cast<float>(random() % 100000) / 1000.0f, static_cast<int>(random() % 40) - 30);
+		}
+
+		//the ties of normal and denormal halves, the max half and the overflow
+		for (float value : { 1.0f + 1.0f / 2048, 1.0f + 3.0f / 2048, 65504.0f, 65519.0f, 65520.0f, -65520.0f, 1e-8f, 2.98023224e-8f, 0.0f, -0.0f })
+			values.push_back(value);
+
+		std::vector<half> halves(values.size());
+
+		float_to_half(values.data(), halves.data(), values.size());
+
+		size_t failures = 0;
+
+		for (size_t index = 0; index < values.size(); index++) {
+			if (std::isnan(values[index])) {
+				failures += !is_nan_bits(halves[index].bits()) || !is_nan_bits(half(values[index]).bits());
+
+				continue;
+			}
+
+			failures += half(values[index]).bits() != reference_half(table, values[index]);
+			failures += halves[index].bits() != half(values[index]).bits();
+		}
+
+		std::vector<float> back(values.size());
+
+		half_to_float(halves.data(), back.data(), halves.size());
+
+		for (size_t index = 0; index < values.size(); index++) {
+			if (std::isnan(values[index])) failures += !std::isnan(back[index]);
+			else failures += back[index] != static_cast<float>(halves[index]);
+		}
+
+		ALG_DAT_CHECK(failures == 0);
+	}
+
+	void test_vec2_half(std::mt19937& random) {
+		for (size_t size : { 0, 1, 7, 8, 9, 33, 1000 }) {
+			std::vector<vec2_t<float>> points(size), decoded(size);
+
+			for (auto& point : points) point = vec2_t<float>(static_cast<float>(random() % 20000) / 7.0f - 1000, static_cast<float>(random() % 20000) / 3.0f);
+
+			std::vector<vec2_t<half>> codes(size);
+
+			vec2_encode_half(points.data(), codes.data(), size);
+			vec2_decode_half(codes.data(), decoded.data(), size);
+
+			vec2_soa<float> soa;
+
+			vec2_decode_half(codes.data(), size, soa);
+
+			ALG_DAT_CHECK(soa.size() == size);
+
+			size_t failures = 0;
+
+			for (size_t index = 0; index < size; index++) {
+				const auto& point = points[index];
+
+				failures += decoded[index].x != static_cast<float>(half(point.x)) || decoded[index].y != static_cast<float>(half(point.y));
+				failures += soa.x()[index] != decoded[index].x || soa.y()[index] != decoded[index].y;
+				failures += std::fabs(decoded[index].x - point.x) > std::fabs(point.x) / 2048;
+			}
+
+			ALG_DAT_CHECK(failures == 0);
+		}
+	}
+
+	void test_quantizer(std::mt19937& random) {
+		const bounds2_t<float> bounds(vec2_t<float>(-100, 5), vec2_t<float>(300, 5000));
+		const vec2_quantizer quantizer(bounds);
+
+		for (size_t size : { 0, 1, 3, 4, 5, 8, 9, 17, 1001 }) {
+			std::vector<vec2_t<float>> points(size), decoded(size);
+
+			for (auto& point : points) point = vec2_t<float>(-100 + static_cast<float>(random() % 400000) / 1000.0f, 5 + static_cast<float>(random() % 4995000) / 1000.0f);
+
+			//the points out of bounds are clamped
+			if (size > 2) {
+				points[0] = vec2_t<float>(-1000, 99999);
+				points[1] = bounds.max;
+			}
+
+			std::vector<vec2_quantizer::code_type> codes(size);
+
+			quantizer.encode(points.data(), codes.data(), size);
+			quantizer.decode(codes.data(), decoded.data(), size);
+
+			vec2_soa<float> soa;
+
+			quantizer.decode(codes.data(), size, soa);
+
+			size_t failures = 0;
+
+			for (size_t index = 0; index < size; index++) {
+				const auto single = quantizer.decode(codes[index]);
+
+				failures += single != decoded[index] || quantizer.encode(points[index]) != codes[index];
+				failures += soa.x()[index] != decoded[index].x || soa.y()[index] != decoded[index].y;
+
+				if (index > 1 || size <= 2) {
+					failures += std::fabs(decoded[index].x - points[index].x) > quantizer.step().x * 0.51f + 1e-4f;
+					failures += std::fabs(decoded[index].y - points[index].y) > quantizer.step().y * 0.51f + 1e-3f;
+				}
+			}
+
+			ALG_DAT_CHECK(failures == 0);
+
+			if (size > 2) ALG_DAT_CHECK(codes[0] == vec2_quantizer::code_type(0, 65535) && codes[1] == vec2_quantizer::code_type(65535, 65535));
+		}
+
+		//the empty bounds and NaN
+		const vec2_quantizer flat(bounds2_t<float>(vec2_t<float>(1, 2), vec2_t<float>(1, 2)));
+
+		ALG_DAT_CHECK(flat.decode(flat.encode(vec2_t<float>(1, 2))) == vec2_t<float>(1, 2));
+		ALG_DAT_CHECK(quantizer.encode(vec2_t<float>(std::nanf(""), -std::nanf(""))) == vec2_quantizer::code_type(0, 0));
+	}
+}
+
+int main() {
+	std::mt19937 random(92);
+
+	test_roundtrip();
+	test_conversions(random);
+	test_vec2_half(random);
+	test_quantizer(random);
+
+	return test::result("half");
+}
@@ -0,0 +1,116 @@
+/*
+ * kd_tree.cpp
+ * Test the kNN and radius queries of kd_tree2 against the sorted squared distances of all points,
+ * the batched kNN against the single kNN, and the build and batched kNN on a thread_pool against the sequential ones.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../datastructure/spatial/kd_tree.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	using vec_type = vec2_t<float>;
+
+	float squared_distance(const vec_type& v0, const vec_type& v1) {
+		const auto offset = v0 - v1;
+
+		return vec_type::dot(offset, offset);
+	}
+
+	void test_tree(std::mt19937& random, size_t size, thread_pool& pool) {
+		std::uniform_real_distribution<float> position(0, 100);
+
+		std::vector<vec_type> points(size);
+
+		for (auto& point : points) point = vec_type(position(random), position(random));
+
+		//the duplicated points have same distance
+		for (size_t index = 0; index < std::min<size_t>(size / 4, 20); index++) points[index] = points[0];
+
+		const kd_tree2<float> tree(points.data(), points.data() + size);
+		const kd_tree2<float> parallel(points.data(), points.data() + size, kd_tree_options{ &pool });
+
+		ALG_DAT_CHECK(tree.size() == size && parallel.size() == size);
+
+		size_t failures = 0;
+
+		for (size_t index = 0; index < size; index++) {
+			const auto& l = tree.entries()[index];
+			const auto& r = parallel.entries()[index];
+
+			failures += l.point != r.point || l.index != r.index || points[l.index] != l.point;
+		}
+
+		ALG_DAT_CHECK(failures == 0);
+
+		const size_t k = 7;
+		const size_t count = 200;
+
+		std::vector<vec_type> queries(count);
+
+		for (auto& query : queries) query = vec_type(position(random), position(random));
+
+		std::vector<uint32_t> indices(count * k), parallel_indices(count * k), counts(count), parallel_counts(count);
+		std::vector<float> distances(count * k), parallel_distances(count * k);
+
+		tree.nearest(queries.data(), count, k, indices.data(), distances.data(), counts.data());
+		parallel.nearest(queries.data(), count, k, parallel_indices.data(), parallel_distances.data(), parallel_counts.data());
+
+		ALG_DAT_CHECK(indices == parallel_indices && distances == parallel_distances && counts == parallel_counts);
+
+		for (size_t query = 0; query < count; query++) {
+			std::vector<float> expected;
+
+			for (const auto& point : points) expected.push_back(squared_distance(point, queries[query]));
+
+			std::sort(expected.begin(), expected.end());
+
+			const auto found = std::min(k, size);
+
+			ALG_DAT_CHECK(counts[query] == found);
+
+			for (size_t index = 0; index < found; index++) {
+				ALG_DAT_CHECK(distances[query * k + index] == expected[index]);
+				ALG_DAT_CHECK(squared_distance(points[indices[query * k + index]], queries[query]) == expected[index]);
+			}
+
+			uint32_t single_indices[k];
+			float single_distances[k];
+
+			ALG_DAT_CHECK(tree.nearest(queries[query], k, single_indices, single_distances) == found);
+			ALG_DAT_CHECK(std::equal(single_distances, single_distances + found, distances.begin() + query * k));
+
+			//every point in the circle is visited once
+			const float radius = 9;
+
+			std::vector<int> visits(size, 0);
+			size_t wrong = 0;
+
+			tree.radius(queries[query], radius, [&](size_t index, float distance) {
+				visits[index]++;
+				wrong += squared_distance(points[index], queries[query]) != distance;
+			});
+
+			for (size_t index = 0; index < size; index++) wrong += visits[index] != (squared_distance(points[index], queries[query]) <= radius * radius ? 1 : 0);
+
+			ALG_DAT_CHECK(wrong == 0);
+		}
+	}
+}
+
+int main() {
+	std::mt19937 random(87);
+	thread_pool pool(4);
+
+	//the parallel build needs the subtrees larger than kd_tree_min_work
+	for (size_t size : { 0, 1, 5, 9, 100, 1000, 40000 }) test_tree(random, size, pool);
+
+	return test::result("kd_tree");
+}
@@ -0,0 +1,125 @@
+/*
+ * partition.cpp
+ * Test copy_if, partition_copy and stable_partition against std::copy_if, std::partition_copy and std::stable_partition,
+ * and partition by std::is_partitioned and the same elements, for the elements of 2, 3, 4 and 8 bytes (AVX-512, AVX2 and scalar blocks),
+ * sequential and on a thread_pool (the count-scan-scatter).
+ */
+
+#include <type_traits>
+#include <algorithm>
+#include <iterator>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../algorithm/partition.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	struct rgb {
+		uint8_t r, g, b;
+
+		bool operator==(const rgb& other) const { return r == other.r && g == other.g && b == other.b; }
+		bool operator<(const rgb& other) const { return r != other.r ? r < other.r : g != other.g ? g < other.g : b < other.b; }
+	};
+
+	//the floating point values are divided to have the random low bits
+	template<typename T>
+	T random_value(std::mt19937& random) {
+		return std::is_floating_point<T>::value ? static_cast<T>(static_cast<T>(random()) / 7) : static_cast<T>(random());
+	}
+
+	template<>
+	rgb random_value<rgb>(std::mt19937& random) {
+		return { static_cast<uint8_t>(random()), static_cast<uint8_t>(random()), static_cast<uint8_t>(random()) };
+	}
+
+	template<typename T>
+	uint8_t first_byte(const T& value) {
+		uint8_t byte;
+
+		std::memcpy(&byte, &value, 1);
+
+		return byte;
+	}
+
+	template<typename T>
+	void test_partitions(std::mt19937& random, size_t size, uint8_t threshold, thread_pool* pool) {
+		std::vector<T> input(size);
+
+		for (auto& value : input) value = random_value<T>(random);
+
+		//the first byte is random, the threshold makes all, none or a part of elements satisfy predicate
+		const auto predicate = [threshold](const T& value) { return first_byte(value) < threshold; };
+		const partition_options options = { pool };
+
+		std::vector<T> expected_true, expected_false;
+
+		std::partition_copy(input.begin(), input.end(), std::back_inserter(expected_true), std::back_inserter(expected_false), predicate);
+
+		const auto count = expected_true.size();
+
+		std::vector<T> output(size), output_false(size);
+
+		ALG_DAT_CHECK(copy_if(input.data(), size, output.data(), predicate, options) == count);
+		ALG_DAT_CHECK(std::equal(expected_true.begin(), expected_true.end(), output.begin()));
+
+		ALG_DAT_CHECK(partition_copy(input.data(), size, output.data(), output_false.data(), predicate, options) == count);
+		ALG_DAT_CHECK(std::equal(expected_true.begin(), expected_true.end(), output.begin()));
+		ALG_DAT_CHECK(std::equal(expected_false.begin(), expected_false.end(), output_false.begin()));
+
+		auto data = input;
+		auto expected = input;
+
+		std::stable_partition(expected.begin(), expected.end(), predicate);
+
+		ALG_DAT_CHECK(stable_partition(data.data(), size, predicate, options) == count);
+		ALG_DAT_CHECK(data == expected);
+
+		data = input;
+
+		ALG_DAT_CHECK(partition(data.data(), size, predicate, options) == count);
+		ALG_DAT_CHECK(std::is_partitioned(data.begin(), data.end(), predicate));
+
+		std::sort(data.begin(), data.end());
+		std::sort(expected.begin(), expected.end());
+
+		ALG_DAT_CHECK(data == expected);
+
+		//the sequential copy_if can compact in place
+		if (pool == nullptr) {
+			data = input;
+
+			ALG_DAT_CHECK(copy_if(data.data(), size, data.data(), predicate) == count);
+			ALG_DAT_CHECK(std::equal(expected_true.begin(), expected_true.end(), data.begin()));
+		}
+	}
+
+	template<typename T>
+	void test_type(std::mt19937& random, size_t size, thread_pool* pool) {
+		for (uint8_t threshold : { 0, 1, 85, 128, 255 }) test_partitions<T>(random, size, threshold, pool);
+	}
+}
+
+int main() {
+	std::mt19937 random(97);
+	thread_pool pool(4);
+
+	//the parallel partition needs at least 2 * partition_min_work elements
+	for (auto current : { static_cast<thread_pool*>(nullptr), &pool }) {
+		for (size_t size : { 0, 1, 3, 17, 63, 64, 65, 127, 128, 129, 1000, 65535, 65536, 200001 }) {
+			test_type<uint16_t>(random, size, current);
+			test_type<rgb>(random, size, current);
+			test_type<uint32_t>(random, size, current);
+			test_type<float>(random, size, current);
+			test_type<uint64_t>(random, size, current);
+			test_type<double>(random, size, current);
+		}
+	}
+
+	return test::result("partition");
+}
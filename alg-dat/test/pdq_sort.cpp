@@ -0,0 +1,125 @@
+/*
+ * pdq_sort.cpp
+ * Test pdq_sort against std::sort on the random, sorted, reversed, organ pipe, almost sorted and few distinct keys,
+ * for the branchless partition (arithmetic keys, std::greater and nan_last_less) and the branchy partition (strings and structures),
+ * sequential and on a thread_pool (sample_sort), and the linear comparisons of the sorted and equal keys.
+ */
+
+#include <functional>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <cmath>
+
+#include "../algorithm/pdq_sort.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	struct record {
+		int key;
+		std::string name;
+	};
+
+	//the sort is not stable, the equivalent elements are compared by the order only
+	template<typename T, typename Compare>
+	bool sorted_same(std::vector<T> values, Compare compare, thread_pool* pool) {
+		auto expected = values;
+
+		std::sort(expected.begin(), expected.end(), compare);
+		pdq_sort(values.data(), values.data() + values.size(), compare, pdq_sort_options{ pool });
+
+		for (size_t index = 0; index < values.size(); index++) {
+			if (compare(values[index], expected[index]) || compare(expected[index], values[index])) return false;
+		}
+
+		return true;
+	}
+
+	void test_patterns(std::mt19937& random, size_t size, thread_pool* pool) {
+		std::vector<std::vector<int>> patterns(7, std::vector<int>(size));
+
+		for (size_t index = 0; index < size; index++) {
+			const auto value = static_cast<int>(index);
+
+			patterns[0][index] = static_cast<int>(random());
+			patterns[1][index] = value;
+			patterns[2][index] = static_cast<int>(size) - value;
+			patterns[3][index] = index < size / 2 ? value : static_cast<int>(size) - value;
+			patterns[4][index] = index % 16 != 0 ? value : static_cast<int>(random());
+			patterns[5][index] = static_cast<int>(random() % 4);
+			patterns[6][index] = 7;
+		}
+
+		size_t failures = 0;
+
+		for (const auto& pattern : patterns) {
+			failures += !sorted_same(pattern, std::less<int>(), pool);
+			failures += !sorted_same(pattern, std::greater<>(), pool);
+		}
+
+		std::vector<double> reals(size);
+		std::vector<std::string> strings(size);
+		std::vector<record> records(size);
+
+		for (size_t index = 0; index < size; index++) {
+			reals[index] = random() % 10 == 0 ? std::nan("") : static_cast<double>(random()) / 3 - 1e9;
+			strings[index] = std::to_string(random() % 1000) + "abcdefghijklmnopqrstuvwxyz";
+			records[index] = { static_cast<int>(random() % 100), std::to_string(random()) };
+		}
+
+		failures += !sorted_same(reals, nan_last_less<>(), pool);
+		failures += !sorted_same(strings, std::less<>(), pool);
+		failures += !sorted_same(records, [](const record& l, const record& r) { return l.key < r.key || (l.key == r.key && l.name < r.name); }, pool);
+
+		ALG_DAT_CHECK(failures == 0);
+	}
+
+	void test_nan() {
+		std::vector<double> values = { std::nan(""), 1, std::nan(""), -3, 2, -0.5 };
+
+		pdq_sort(values.data(), values.data() + values.size(), nan_last_less<double>());
+
+		ALG_DAT_CHECK(values[0] == -3 && values[1] == -0.5 && values[2] == 1 && values[3] == 2 && std::isnan(values[4]) && std::isnan(values[5]));
+	}
+
+	//the sorted, reversed and equal keys are O(n), the comparator with state takes the branchy partition
+	void test_linear() {
+		const size_t size = 100000;
+
+		std::vector<std::vector<int>> patterns = { std::vector<int>(size), std::vector<int>(size), std::vector<int>(size, 5) };
+
+		for (size_t index = 0; index < size; index++) {
+			patterns[0][index] = static_cast<int>(index);
+			patterns[1][index] = static_cast<int>(size - index);
+		}
+
+		for (auto& pattern : patterns) {
+			size_t comparisons = 0;
+
+			pdq_sort(pattern.data(), pattern.data() + size, [&](int l, int r) { comparisons++; return l < r; });
+
+			ALG_DAT_CHECK(std::is_sorted(pattern.begin(), pattern.end()));
+			ALG_DAT_CHECK(comparisons < size * 4);
+		}
+	}
+}
+
+int main() {
+	std::mt19937 random(98);
+	thread_pool pool(4);
+
+	//the parallel sort needs at least pdq_sort_min_work elements
+	for (auto current : { static_cast<thread_pool*>(nullptr), &pool }) {
+		for (size_t size : { 0, 1, 2, 5, 23, 24, 25, 100, 128, 129, 1000, 65535, 70000, 300000 }) test_patterns(random, size, current);
+	}
+
+	test_nan();
+	test_linear();
+
+	return test::result("pdq_sort");
+}
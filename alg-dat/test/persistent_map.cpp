@@ -0,0 +1,136 @@
+/*
+ * persistent_map.cpp
+ * Test persistent_map against copies of std::map : every version keeps its entries after the edits of others,
+ * with a good hash and a bad hash (the collision nodes), and the transient batch edit.
+ */
+
+#include <string>
+#include <random>
+#include <vector>
+#include <map>
+
+#include "../datastructure/container/persistent_map.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	//only 7 different hashes, so most keys are in collision nodes
+	struct bad_hash {
+		size_t operator()(int key) const { return static_cast<size_t>(key % 7) * static_cast<size_t>(0x9E3779B97F4A7C15ull); }
+	};
+
+	template<typename Hash>
+	bool same(const persistent_map<int, std::string, Hash>& map, const std::map<int, std::string>& expected, int range) {
+		if (map.size() != expected.size()) return false;
+
+		size_t count = 0;
+		bool result = true;
+
+		map.for_each([&](const std::pair<int, std::string>& entry) {
+			const auto position = expected.find(entry.first);
+
+			count++;
+
+			if (position == expected.end() || position->second != entry.second) result = false;
+		});
+
+		for (int key = 0; key < range; key += range / 50 + 1) {
+			const auto value = map.find(key);
+			const auto position = expected.find(key);
+
+			if ((value != nullptr) != (position != expected.end())) result = false;
+			if (value != nullptr && position != expected.end() && *value != position->second) result = false;
+		}
+
+		return result && count == expected.size();
+	}
+
+	template<typename Hash>
+	void test_versions(std::mt19937& random, int range) {
+		using map_type = persistent_map<int, std::string, Hash>;
+
+		std::vector<std::pair<map_type, std::map<int, std::string>>> versions(1);
+
+		for (int round = 0; round < 800; round++) {
+			const auto& [map, expected] = versions[random() % versions.size()];
+
+			auto next = expected;
+			map_type result;
+
+			const auto operation = random() % 8;
+			const auto key = static_cast<int>(random() % range);
+
+			if (operation < 4) {
+				const auto value = std::to_string(round);
+
+				result = map.insert(key, value);
+				next[key] = value;
+			}
+			else if (operation < 6) {
+				result = map.erase(key);
+				next.erase(key);
+			}
+			else {
+				auto transient = map.transient();
+
+				for (auto count = random() % 500; count != 0; count--) {
+					const auto current = static_cast<int>(random() % range);
+
+					if (random() % 3 != 0) {
+						transient.insert(current, "transient " + std::to_string(count));
+						next[current] = "transient " + std::to_string(count);
+					}
+					else ALG_DAT_CHECK(transient.erase(current) == (next.erase(current) == 1));
+				}
+
+				result = transient.persistent();
+			}
+
+			versions.emplace_back(result, next);
+
+			if (versions.size() > 16) versions.erase(versions.begin() + random() % versions.size());
+
+			for (const auto& [current, entries] : versions) ALG_DAT_CHECK(same(current, entries, range));
+		}
+	}
+
+	void test_large() {
+		persistent_map<long long, long long> map;
+
+		{
+			auto transient = map.transient();
+
+			for (long long index = 0; index < 100000; index++) transient.insert(index * 2654435761LL, index);
+
+			map = transient.persistent();
+		}
+
+		ALG_DAT_CHECK(map.size() == 100000);
+
+		auto half = map;
+
+		for (long long index = 0; index < 100000; index += 2) half = half.erase(index * 2654435761LL);
+
+		for (long long index = 0; index < 100000; index++) {
+			const auto value = map.find(index * 2654435761LL);
+
+			ALG_DAT_CHECK(value != nullptr && *value == index);
+			ALG_DAT_CHECK(half.contains(index * 2654435761LL) == (index % 2 == 1));
+		}
+
+		ALG_DAT_CHECK(half.size() == 50000 && !map.contains(1));
+	}
+}
+
+int main() {
+	std::mt19937 random(78);
+
+	test_versions<std::hash<int>>(random, 3000);
+	test_versions<bad_hash>(random, 200);
+	test_large();
+
+	return test::result("persistent_map");
+}
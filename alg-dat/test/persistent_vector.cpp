@@ -0,0 +1,154 @@
+/*
+ * persistent_vector.cpp
+ * Test persistent_vector against copies of std::vector : every version keeps its elements after the edits of others,
+ * the transient batch edit is the same as the single edits, and the snapshots are read from many threads.
+ */
+
+#include <string>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../datastructure/container/persistent_vector.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	using version = std::pair<persistent_vector<std::string>, std::vector<std::string>>;
+
+	bool same(const persistent_vector<std::string>& vector, const std::vector<std::string>& expected) {
+		if (vector.size() != expected.size()) return false;
+
+		for (size_t index = 0; index < expected.size(); index++)
+			if (vector[index] != expected[index]) return false;
+
+		return true;
+	}
+
+	void test_versions(std::mt19937& random) {
+		std::vector<version> versions(1);
+
+		for (int round = 0; round < 3000; round++) {
+			const auto& [vector, expected] = versions[random() % versions.size()];
+
+			auto next = expected;
+			persistent_vector<std::string> result;
+
+			const auto operation = random() % 10;
+
+			if (operation < 6 || expected.empty()) {
+				const auto value = std::to_string(round);
+
+				result = vector.push_back(value);
+				next.push_back(value);
+			}
+			else if (operation < 8) {
+				const auto index = random() % expected.size();
+				const auto value = "set " + std::to_string(round);
+
+				result = vector.set(index, value);
+				next[index] = value;
+			}
+			else if (operation == 8) {
+				result = vector.pop_back();
+				next.pop_back();
+			}
+			else {
+				auto transient = vector.transient();
+
+				//a batch crosses the boundaries of leaves and levels
+				for (auto count = random() % 1500; count != 0; count--) {
+					if (random() % 4 != 0 || next.empty()) {
+						transient.push_back(std::to_string(count));
+						next.push_back(std::to_string(count));
+					}
+					else if (random() % 2 == 0) {
+						transient.pop_back();
+						next.pop_back();
+					}
+					else {
+						const auto index = random() % next.size();
+
+						transient.set(index, "transient");
+						next[index] = "transient";
+					}
+				}
+
+				ALG_DAT_CHECK(transient.size() == next.size());
+
+				result = transient.persistent();
+			}
+
+			versions.emplace_back(result, next);
+
+			if (versions.size() > 32) versions.erase(versions.begin() + random() % versions.size());
+
+			//no version is changed by the edits of others
+			for (const auto& [current, values] : versions) ALG_DAT_CHECK(same(current, values));
+		}
+	}
+
+	void test_large() {
+		const size_t size = 200000;
+
+		persistent_vector<size_t> vector;
+
+		{
+			auto transient = vector.transient();
+
+			for (size_t index = 0; index < size; index++) transient.push_back(index);
+
+			vector = transient.persistent();
+		}
+
+		ALG_DAT_CHECK(vector.size() == size && vector.front() == 0 && vector.back() == size - 1);
+
+		//the threads read and edit their copies of same snapshot
+		std::vector<std::thread> threads;
+		std::vector<int> failures(4, 0);
+
+		for (size_t thread = 0; thread < failures.size(); thread++) {
+			threads.emplace_back([&, thread, vector]() {
+				auto copy = vector.set(thread, 0);
+
+				for (size_t index = 0; index < size; index++) {
+					if (vector[index] != index) failures[thread]++;
+					if (copy[index] != (index == thread ? 0 : index)) failures[thread]++;
+				}
+
+				for (size_t count = 0; count < size / 2; count++) copy = copy.pop_back();
+
+				if (copy.size() != size - size / 2 || copy.back() != size - size / 2 - 1) failures[thread]++;
+			});
+		}
+
+		for (auto& thread : threads) thread.join();
+
+		for (auto failure : failures) ALG_DAT_CHECK(failure == 0);
+
+		for (size_t index = 0; index < size; index++) ALG_DAT_CHECK(vector[index] == index);
+
+		//pop to empty and push again
+		auto small = vector;
+
+		for (size_t count = 0; count < size; count++) small = small.pop_back();
+
+		ALG_DAT_CHECK(small.empty());
+
+		small = small.push_back(7);
+
+		ALG_DAT_CHECK(small.size() == 1 && small.back() == 7 && vector.size() == size);
+	}
+}
+
+int main() {
+	std::mt19937 random(78);
+
+	test_versions(random);
+	test_large();
+
+	return test::result("persistent_vector");
+}
@@ -0,0 +1,102 @@
+/*
+ * rtree.cpp
+ * Test the window query of rtree2 against the brute force overlap of every box, for float (the batch compares),
+ * double and int32_t, the early stop of window iterator and the structure of STR bulk load.
+ */
+
+#include <algorithm>
+#include <random>
+#include <limits>
+#include <vector>
+
+#include "../datastructure/spatial/rtree.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	template<typename T>
+	void test_tree(std::mt19937& random, size_t size) {
+		std::uniform_real_distribution<double> position(0, 1000), extent(0, 20);
+
+		std::vector<bounds2_t<T>> boxes(size);
+
+		for (auto& box : boxes) {
+			const vec2_t<T> min(T(position(random)), T(position(random)));
+
+			box = bounds2_t<T>(min, min + vec2_t<T>(T(extent(random)), T(extent(random))));
+		}
+
+		const rtree2<T> tree(boxes.data(), boxes.data() + size);
+
+		ALG_DAT_CHECK(tree.size() == size && tree.empty() == (size == 0));
+
+		bounds2_t<T> bounds;
+
+		for (const auto& box : boxes) bounds.expand(box);
+
+		ALG_DAT_CHECK(tree.bounds() == bounds);
+
+		//every box is in one leaf
+		std::vector<int> leaves(size, 0);
+
+		for (size_t node = 0; node < tree.leaf_count(); node++) {
+			for (size_t slot = 0; slot < tree.nodes()[node].count; slot++) leaves[tree.nodes()[node].children[slot]]++;
+		}
+
+		ALG_DAT_CHECK(std::count(leaves.begin(), leaves.end(), 1) == static_cast<ptrdiff_t>(size));
+
+		for (int query = 0; query < 200; query++) {
+			const vec2_t<T> min(T(position(random)), T(position(random)));
+
+			auto window = bounds2_t<T>(min, min + vec2_t<T>(T(extent(random) * 5), T(extent(random) * 5)));
+
+			if (query == 0) window = bounds2_t<T>(vec2_t<T>(std::numeric_limits<T>::lowest()), vec2_t<T>(std::numeric_limits<T>::max()));
+
+			//the boxes touched by the boundary of window overlap
+			if (query == 1 && size != 0) window = bounds2_t<T>(boxes[0].max, boxes[0].max + vec2_t<T>(T(1)));
+
+			std::vector<size_t> found;
+			std::vector<size_t> expected;
+
+			for (auto index : tree.window(window)) found.push_back(index);
+
+			for (size_t index = 0; index < size; index++) if (boxes[index].overlap(window)) expected.push_back(index);
+
+			std::sort(found.begin(), found.end());
+			ALG_DAT_CHECK(found == expected);
+
+			size_t count = 0;
+
+			tree.query(window, [&](size_t) { count++; });
+			ALG_DAT_CHECK(count == expected.size());
+
+			//stop after 3 boxes
+			std::vector<size_t> first;
+
+			for (auto index : tree.window(window)) {
+				first.push_back(index);
+
+				if (first.size() == 3) break;
+			}
+
+			ALG_DAT_CHECK(first.size() == std::min<size_t>(3, expected.size()));
+
+			for (auto index : first) ALG_DAT_CHECK(std::binary_search(expected.begin(), expected.end(), index));
+		}
+	}
+}
+
+int main() {
+	std::mt19937 random(89);
+
+	for (size_t size : { 0, 1, 7, 16, 17, 300, 5000, 50000 }) {
+		test_tree<float>(random, size);
+		test_tree<double>(random, size);
+		test_tree<int32_t>(random, size);
+	}
+
+	return test::result("rtree");
+}
@@ -0,0 +1,130 @@
+/*
+ * sample_sort.cpp
+ * Test sample_sort against std::sort on the random, sorted, few distinct, half equal and equal keys (the equality buckets),
+ * NaN with nan_last_less, strings and structures, sequential and on a thread_pool (the parallel classification and scatter),
+ * and the elements moved through the raw scratch memory are constructed and destroyed once.
+ */
+
+#include <functional>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cmath>
+
+#include "../algorithm/sample_sort.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	struct record {
+		int key;
+		std::string name;
+	};
+
+	//the number of live objects (they are constructed in the workers), the moved from objects are marked
+	struct tracked {
+		static std::atomic<long> live;
+
+		int key;
+		bool valid;
+
+		explicit tracked(int key) : key(key), valid(true) { live++; }
+		tracked(const tracked& other) : key(other.key), valid(other.valid) { live++; }
+		tracked(tracked&& other) noexcept : key(other.key), valid(other.valid) { other.valid = false; live++; }
+		tracked& operator=(const tracked& other) = default;
+		tracked& operator=(tracked&& other) noexcept { key = other.key; valid = other.valid; other.valid = false; return *this; }
+		~tracked() { live--; }
+	};
+
+	std::atomic<long> tracked::live(0);
+
+	//the sort is not stable, the equivalent elements are compared by the order only
+	template<typename T, typename Compare>
+	bool sorted_same(std::vector<T> values, Compare compare, thread_pool* pool) {
+		auto expected = values;
+
+		std::sort(expected.begin(), expected.end(), compare);
+		sample_sort(values.data(), values.data() + values.size(), compare, sample_sort_options{ pool });
+
+		for (size_t index = 0; index < values.size(); index++) {
+			if (compare(values[index], expected[index]) || compare(expected[index], values[index])) return false;
+		}
+
+		return true;
+	}
+
+	void test_patterns(std::mt19937& random, size_t size, thread_pool* pool) {
+		std::vector<std::vector<int>> patterns(6, std::vector<int>(size));
+
+		for (size_t index = 0; index < size; index++) {
+			patterns[0][index] = static_cast<int>(random());
+			patterns[1][index] = static_cast<int>(index);
+			patterns[2][index] = static_cast<int>(random() % 4);
+			patterns[3][index] = static_cast<int>(random() % 1000);
+			patterns[4][index] = index % 2 != 0 ? 5 : static_cast<int>(random());
+			patterns[5][index] = 7;
+		}
+
+		size_t failures = 0;
+
+		for (const auto& pattern : patterns) {
+			failures += !sorted_same(pattern, std::less<int>(), pool);
+			failures += !sorted_same(pattern, std::greater<>(), pool);
+		}
+
+		std::vector<double> reals(size);
+		std::vector<std::string> strings(size);
+		std::vector<record> records(size);
+
+		for (size_t index = 0; index < size; index++) {
+			reals[index] = random() % 10 == 0 ? std::nan("") : static_cast<double>(random()) / 3;
+			strings[index] = std::to_string(random() % 100000) + "abcdefghijklmnopqrstuvwxyz";
+			records[index] = { static_cast<int>(random() % 100), std::to_string(random()) };
+		}
+
+		failures += !sorted_same(reals, nan_last_less<>(), pool);
+		failures += !sorted_same(strings, std::less<>(), pool);
+		failures += !sorted_same(records, [](const record& l, const record& r) { return l.key < r.key || (l.key == r.key && l.name < r.name); }, pool);
+
+		ALG_DAT_CHECK(failures == 0);
+	}
+
+	void test_lifetime(std::mt19937& random, thread_pool* pool) {
+		{
+			std::vector<tracked> values;
+
+			values.reserve(200000);
+
+			for (size_t index = 0; index < 200000; index++) values.emplace_back(static_cast<int>(random() % 5000));
+
+			const long live = tracked::live;
+
+			sample_sort(values.data(), values.data() + values.size(), [](const tracked& l, const tracked& r) { return l.key < r.key; }, sample_sort_options{ pool });
+
+			ALG_DAT_CHECK(tracked::live == live);
+			ALG_DAT_CHECK(std::all_of(values.begin(), values.end(), [](const tracked& value) { return value.valid; }));
+			ALG_DAT_CHECK(std::is_sorted(values.begin(), values.end(), [](const tracked& l, const tracked& r) { return l.key < r.key; }));
+		}
+
+		ALG_DAT_CHECK(tracked::live == 0);
+	}
+}
+
+int main() {
+	std::mt19937 random(100);
+	thread_pool pool(4);
+
+	//the sequential sort is sample_sort above sample_sort_base, the parallel steps need at least 2 * sample_sort_min_work elements
+	for (auto current : { static_cast<thread_pool*>(nullptr), &pool }) {
+		for (size_t size : { 0, 1, 100, 4095, 4096, 5000, 20000, 70000, 300000 }) test_patterns(random, size, current);
+
+		test_lifetime(random, current);
+	}
+
+	return test::result("sample_sort");
+}
@@ -0,0 +1,118 @@
+/*
+ * scan.cpp
+ * Test the inclusive, exclusive and segmented scans against the loops of std::plus and other operations,
+ * out of place and in place, sequential (the AVX2 scan) and on a thread_pool (the look-back scan).
+ * The values are small integers, so the floating point sums are exact in any order.
+ */
+
+#include <functional>
+#include <random>
+#include <vector>
+#include <cmath>
+
+#include "../algorithm/scan.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	struct maximum {
+		template<typename T>
+		T operator()(T v0, T v1) const { return v0 > v1 ? v0 : v1; }
+	};
+
+	template<typename T, typename Operation>
+	void test_scans(std::mt19937& random, size_t size, Operation operation, thread_pool* pool) {
+		std::vector<T> input(size);
+		std::vector<uint8_t> heads(size);
+
+		for (size_t index = 0; index < size; index++) {
+			input[index] = T(random() % 100 < 30 ? 0 : random() % 100);
+			heads[index] = random() % 50 == 0;
+		}
+
+		const scan_options options = { pool };
+		const T initial = T(7);
+
+		std::vector<T> expected(size);
+
+		//the scan runs out of place and in place
+		const auto same = [&](auto scan) {
+			std::vector<T> output(size);
+
+			scan(input.data(), output.data());
+
+			std::vector<T> in_place = input;
+
+			scan(in_place.data(), in_place.data());
+
+			return output == expected && in_place == expected;
+		};
+
+		for (size_t index = 0; index < size; index++) expected[index] = index == 0 ? input[index] : operation(expected[index - 1], input[index]);
+
+		ALG_DAT_CHECK(same([&](const T* in, T* out) { inclusive_scan(in, out, size, operation, options); }));
+
+		for (size_t index = 0; index < size; index++) expected[index] = index == 0 ? initial : operation(expected[index - 1], input[index - 1]);
+
+		ALG_DAT_CHECK(same([&](const T* in, T* out) { exclusive_scan(in, out, size, initial, operation, options); }));
+
+		for (size_t index = 0; index < size; index++) expected[index] = index == 0 || heads[index] ? input[index] : operation(expected[index - 1], input[index]);
+
+		ALG_DAT_CHECK(same([&](const T* in, T* out) { segmented_inclusive_scan(in, heads.data(), out, size, operation, options); }));
+
+		for (size_t index = 0; index < size; index++) expected[index] = index == 0 || heads[index] ? initial : operation(expected[index - 1], input[index - 1]);
+
+		ALG_DAT_CHECK(same([&](const T* in, T* out) { segmented_exclusive_scan(in, heads.data(), out, size, initial, operation, options); }));
+	}
+
+	//the floating point sums of AVX2 are in another order, they are close to the scalar sums
+	void test_rounding(std::mt19937& random) {
+		std::uniform_real_distribution<float> distribution(0, 1);
+
+		const size_t size = 100003;
+
+		std::vector<float> input(size), output(size);
+
+		for (auto& value : input) value = distribution(random);
+
+		inclusive_scan(input.data(), output.data(), size);
+
+		double sum = 0;
+		size_t failures = 0;
+
+		for (size_t index = 0; index < size; index++) {
+			sum += input[index];
+			failures += std::abs(output[index] - sum) > sum * 1e-4;
+		}
+
+		ALG_DAT_CHECK(failures == 0);
+	}
+}
+
+int main() {
+	std::mt19937 random(96);
+	thread_pool pool(4);
+
+	//the parallel scan needs at least scan_min_work elements
+	for (auto current : { static_cast<thread_pool*>(nullptr), &pool }) {
+		for (size_t size : { 0, 1, 2, 7, 8, 9, 100, 65535, 65536, 200001 }) {
+			test_scans<int32_t>(random, size, std::plus<int32_t>(), current);
+			test_scans<uint32_t>(random, size, std::plus<>(), current);
+			test_scans<int64_t>(random, size, std::plus<int64_t>(), current);
+			test_scans<uint64_t>(random, size, std::plus<uint64_t>(), current);
+			test_scans<double>(random, size, std::plus<double>(), current);
+			test_scans<float>(random, size % 100000, std::plus<float>(), current);
+			test_scans<int32_t>(random, size, maximum(), current);
+
+			//the last nonzero value is associative but not commutative
+			test_scans<int32_t>(random, size, [](int32_t v0, int32_t v1) { return v1 == 0 ? v0 : v1; }, current);
+		}
+	}
+
+	test_rounding(random);
+
+	return test::result("scan");
+}
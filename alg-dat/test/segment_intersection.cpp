@@ -0,0 +1,162 @@
+/*
+ * segment_intersection.cpp
+ * Test segment_intersections against the brute force test of all pairs (pruned by the x ranges of segments),
+ * on small grids (touching, collinear, vertical and degenerate segments) and random segments,
+ * and the parallel sweep on a thread_pool against the brute force and the sequential sweep.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../algorithm/geometry/segment_intersection.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	using pairs_type = std::vector<std::pair<uint32_t, uint32_t>>;
+
+	//p is in the bounds of segment (a, b), it is on the segment if it is collinear
+	template<typename T>
+	bool in_bounds(const vec2_t<T>& a, const vec2_t<T>& b, const vec2_t<T>& p) {
+		return std::min(a.x, b.x) <= p.x && p.x <= std::max(a.x, b.x) && std::min(a.y, b.y) <= p.y && p.y <= std::max(a.y, b.y);
+	}
+
+	template<typename T>
+	bool intersect(const vec2_t<T>& a, const vec2_t<T>& b, const vec2_t<T>& c, const vec2_t<T>& d) {
+		const auto o1 = orientation(a, b, c), o2 = orientation(a, b, d);
+		const auto o3 = orientation(c, d, a), o4 = orientation(c, d, b);
+
+		if (o1 * o2 < 0 && o3 * o4 < 0) return true;
+
+		return
+			(o1 == 0 && in_bounds(a, b, c)) || (o2 == 0 && in_bounds(a, b, d)) ||
+			(o3 == 0 && in_bounds(c, d, a)) || (o4 == 0 && in_bounds(c, d, b));
+	}
+
+	template<typename T>
+	pairs_type reference_pairs(const std::vector<vec2_t<T>>& endpoints) {
+		const auto count = static_cast<uint32_t>(endpoints.size() / 2);
+
+		const auto min_x = [&](uint32_t index) { return std::min(endpoints[2 * index].x, endpoints[2 * index + 1].x); };
+		const auto max_x = [&](uint32_t index) { return std::max(endpoints[2 * index].x, endpoints[2 * index + 1].x); };
+
+		std::vector<uint32_t> order(count);
+
+		for (uint32_t index = 0; index < count; index++) order[index] = index;
+
+		std::sort(order.begin(), order.end(), [&](uint32_t l, uint32_t r) { return min_x(l) < min_x(r); });
+
+		pairs_type pairs;
+
+		for (size_t first = 0; first < count; first++) {
+			const auto i = order[first];
+
+			for (auto second = first + 1; second < count && min_x(order[second]) <= max_x(i); second++) {
+				const auto j = order[second];
+
+				if (intersect(endpoints[2 * i], endpoints[2 * i + 1], endpoints[2 * j], endpoints[2 * j + 1]))
+					pairs.push_back({ std::min(i, j), std::max(i, j) });
+			}
+		}
+
+		std::sort(pairs.begin(), pairs.end());
+
+		return pairs;
+	}
+
+	//the segments on the integer grid are often touching, collinear, vertical, horizontal or one point
+	template<typename T>
+	std::vector<vec2_t<T>> grid_segments(std::mt19937& random, size_t count, int grid, int span) {
+		std::vector<vec2_t<T>> endpoints(count * 2);
+
+		const auto value = [&]() { return T(static_cast<int>(random() % static_cast<unsigned>(grid))); };
+
+		for (size_t index = 0; index < count; index++) {
+			auto& a = endpoints[2 * index];
+			auto& b = endpoints[2 * index + 1];
+
+			a = vec2_t<T>(value(), value());
+
+			const auto shape = random() % 4;
+
+			if (span != 0) {
+				const auto offset = [&]() { return T(static_cast<int>(random() % static_cast<unsigned>(2 * span + 1)) - span); };
+
+				b = a + vec2_t<T>(offset(), offset());
+			}
+			else if (shape == 0) b = vec2_t<T>(a.x, value());
+			else if (shape == 1) b = vec2_t<T>(value(), a.y);
+			else b = vec2_t<T>(value(), value());
+		}
+
+		return endpoints;
+	}
+
+	template<typename T>
+	std::vector<vec2_t<T>> random_segments(std::mt19937& random, size_t count) {
+		std::uniform_real_distribution<double> distribution(0, 1000);
+
+		std::vector<vec2_t<T>> endpoints(count * 2);
+
+		for (size_t index = 0; index < count; index++) {
+			endpoints[2 * index] = vec2_t<T>(T(distribution(random)), T(distribution(random)));
+			endpoints[2 * index + 1] = endpoints[2 * index] + vec2_t<T>(T(distribution(random) / 50 - 10), T(distribution(random) / 50 - 10));
+		}
+
+		return endpoints;
+	}
+
+	template<typename T>
+	void test_small(std::mt19937& random) {
+		size_t failures = 0;
+
+		for (unsigned round = 0; round < 300; round++) {
+			const auto endpoints = grid_segments<T>(random, 2 + round % 40, 4 + round % 9, 0);
+
+			failures += segment_intersections(endpoints.data(), endpoints.size() / 2) != reference_pairs(endpoints);
+		}
+
+		for (unsigned round = 0; round < 10; round++) {
+			const auto grid = grid_segments<T>(random, 300, 50, 0);
+			const auto segments = random_segments<T>(random, 500);
+
+			failures += segment_intersections(grid.data(), grid.size() / 2) != reference_pairs(grid);
+			failures += segment_intersections(segments.data(), segments.size() / 2) != reference_pairs(segments);
+		}
+
+		ALG_DAT_CHECK(failures == 0);
+		ALG_DAT_CHECK(segment_intersections(static_cast<const vec2_t<T>*>(nullptr), 0).empty());
+	}
+
+	//the parallel sweep needs at least 2 * segment_intersection_min_work segments
+	void test_parallel(std::mt19937& random, thread_pool& pool) {
+		const auto segments = random_segments<float>(random, 40000);
+		const auto grid = grid_segments<float>(random, 40000, 3000, 20);
+		const auto wide = random_segments<double>(random, 40000);
+
+		const segment_intersection_options options = { &pool };
+
+		const auto expected = reference_pairs(segments);
+
+		ALG_DAT_CHECK(segment_intersections(segments.data(), segments.size() / 2, options) == expected);
+		ALG_DAT_CHECK(segment_intersections(segments.data(), segments.size() / 2) == expected);
+		ALG_DAT_CHECK(segment_intersections(grid.data(), grid.size() / 2, options) == reference_pairs(grid));
+		ALG_DAT_CHECK(segment_intersections(wide.data(), wide.size() / 2, options) == segment_intersections(wide.data(), wide.size() / 2));
+	}
+}
+
+int main() {
+	std::mt19937 random(93);
+	thread_pool pool(4);
+
+	test_small<float>(random);
+	test_small<double>(random);
+	test_small<int32_t>(random);
+	test_parallel(random, pool);
+
+	return test::result("segment_intersection");
+}
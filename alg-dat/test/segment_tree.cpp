@@ -0,0 +1,239 @@
+/*
+ * segment_tree.cpp
+ * Test fenwick_tree, segment_tree, lazy_segment_tree and wide_segment_tree against the brute force of array,
+ * and the SIMD reduction of wide node against the scalar loop.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../datastructure/container/fenwick_tree.hpp"
+#include "../datastructure/container/segment_tree.hpp"
+#include "../datastructure/container/wide_segment_tree.hpp"
+#include "../dependent/vec.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	const size_t sizes[] = { 0, 1, 2, 3, 5, 16, 17, 100, 257, 1000, 5000 };
+
+	template<typename T, typename Operation>
+	T reduce(const std::vector<T>& array, size_t first, size_t last) {
+		T result = Operation::identity();
+
+		for (auto index = first; index < last; index++) result = Operation()(result, array[index]);
+
+		return result;
+	}
+
+	template<typename T>
+	std::vector<T> random_array(std::mt19937& random, size_t size) {
+		std::vector<T> array(size);
+
+		//small integers, so the float sums are exact in any order
+		for (auto& value : array) value = static_cast<T>(static_cast<int>(random() % 100) - 50);
+
+		return array;
+	}
+
+	void test_fenwick_tree(std::mt19937& random) {
+		for (auto size : sizes) {
+			auto array = random_array<long long>(random, size);
+
+			fenwick_tree<long long> tree(array.data(), array.data() + size);
+
+			for (size_t round = 0; round < 1000 && size != 0; round++) {
+				const auto index = random() % size;
+				const auto value = static_cast<long long>(random() % 100) - 50;
+
+				tree.add(index, value);
+				array[index] += value;
+
+				auto first = random() % (size + 1);
+				auto last = random() % (size + 1);
+
+				if (first > last) std::swap(first, last);
+
+				ALG_DAT_CHECK(tree.range_sum(first, last) == (reduce<long long, segment_tree_sum<long long>>(array, first, last)));
+				ALG_DAT_CHECK(tree.at(index) == array[index]);
+			}
+		}
+
+		//lower_bound of the non-negative array
+		for (auto size : sizes) {
+			std::vector<unsigned> array(size);
+
+			for (auto& value : array) value = random() % 4;
+
+			fenwick_tree<unsigned> tree(array.data(), array.data() + size);
+
+			for (unsigned value = 0; value < 2 * size + 2; value++) {
+				size_t expected = 0;
+				unsigned sum = 0;
+
+				while (expected <= size && sum < value) sum += expected < size ? array[expected] : 0, expected++;
+
+				if (sum < value) expected = size + 1;
+
+				ALG_DAT_CHECK(tree.lower_bound(value) == expected);
+			}
+		}
+	}
+
+	template<typename T, typename Operation>
+	void test_segment_tree(std::mt19937& random) {
+		for (auto size : sizes) {
+			auto array = random_array<T>(random, size);
+
+			segment_tree<T, Operation> tree(array.data(), array.data() + size);
+
+			ALG_DAT_CHECK(tree.size() == size);
+
+			for (size_t round = 0; round < 1000 && size != 0; round++) {
+				const auto index = random() % size;
+
+				array[index] = static_cast<T>(static_cast<int>(random() % 100) - 50);
+				tree.set(index, array[index]);
+
+				auto first = random() % (size + 1);
+				auto last = random() % (size + 1);
+
+				if (first > last) std::swap(first, last);
+
+				ALG_DAT_CHECK(tree.query(first, last) == (reduce<T, Operation>(array, first, last)));
+				ALG_DAT_CHECK(tree.at(index) == array[index]);
+			}
+		}
+	}
+
+	template<typename T, typename Operation>
+	void test_lazy_segment_tree(std::mt19937& random) {
+		for (auto size : sizes) {
+			auto array = random_array<T>(random, size);
+
+			lazy_segment_tree<T, Operation> tree(array.data(), array.data() + size);
+			lazy_segment_tree<T, Operation> zero(size);
+
+			ALG_DAT_CHECK(tree.size() == size && zero.size() == size);
+
+			if (size != 0) ALG_DAT_CHECK(zero.all() == T(0) && tree.all() == (reduce<T, Operation>(array, 0, size)));
+
+			for (size_t round = 0; round < 1000 && size != 0; round++) {
+				auto first = random() % (size + 1);
+				auto last = random() % (size + 1);
+
+				if (first > last) std::swap(first, last);
+
+				if (random() % 2 == 0) {
+					const auto value = static_cast<T>(static_cast<int>(random() % 10) - 5);
+
+					tree.add(first, last, value);
+
+					for (auto index = first; index < last; index++) array[index] += value;
+				}
+				else {
+					const auto index = random() % size;
+
+					array[index] = static_cast<T>(static_cast<int>(random() % 100) - 50);
+					tree.set(index, array[index]);
+				}
+
+				ALG_DAT_CHECK(tree.query(first, last) == (reduce<T, Operation>(array, first, last)));
+				ALG_DAT_CHECK(tree.all() == (reduce<T, Operation>(array, 0, size)));
+			}
+		}
+	}
+
+	template<typename T, typename Operation>
+	void test_wide_segment_tree(std::mt19937& random) {
+		for (auto size : sizes) {
+			auto array = random_array<T>(random, size);
+
+			wide_segment_tree<T, Operation> tree(array.data(), array.data() + size);
+			wide_segment_tree<T, Operation> zero(size);
+
+			ALG_DAT_CHECK(tree.size() == size && zero.size() == size);
+
+			if (size != 0) ALG_DAT_CHECK(zero.all() == T(0));
+
+			for (size_t round = 0; round < 1000 && size != 0; round++) {
+				const auto index = random() % size;
+
+				array[index] = static_cast<T>(static_cast<int>(random() % 100) - 50);
+				tree.set(index, array[index]);
+
+				auto first = random() % (size + 1);
+				auto last = random() % (size + 1);
+
+				if (first > last) std::swap(first, last);
+
+				ALG_DAT_CHECK(tree.query(first, last) == (reduce<T, Operation>(array, first, last)));
+				ALG_DAT_CHECK(tree.at(index) == array[index]);
+			}
+		}
+	}
+
+	//the reduction of every [first, last) of a node is the same as the scalar loop
+	template<typename T, typename Operation, size_t Width>
+	void test_wide_node_reduce(std::mt19937& random) {
+		aligned_buffer<T> node(Width);
+
+		for (size_t index = 0; index < Width; index++) node[index] = static_cast<T>(static_cast<int>(random() % 100) - 50);
+
+		const std::vector<T> array(node.data(), node.data() + Width);
+
+		for (size_t first = 0; first <= Width; first++) {
+			for (auto last = first; last <= Width; last++) {
+				ALG_DAT_CHECK((wide_node_reduce<T, Operation, Width>::reduce(node.data(), first, last, Operation())) ==
+					(reduce<T, Operation>(array, first, last)));
+			}
+		}
+	}
+
+	//the default width is a power of 2 and at least 4, for the elements larger than a cache line too
+	struct large_element {
+		double values[9];
+	};
+
+	static_assert(wide_segment_tree<float>::width == 16, "the node of float is a cache line.");
+	static_assert(wide_segment_tree<double>::width == 8, "the node of double is a cache line.");
+	static_assert(wide_segment_tree<vec3>::width == 4, "the width of 12 bytes element is rounded down to power of 2.");
+	static_assert(detail::wide_segment_tree_width(sizeof(large_element)) == 4, "the width is at least 4.");
+}
+
+int main() {
+	std::mt19937 random(76);
+
+	test_fenwick_tree(random);
+
+	test_segment_tree<int, segment_tree_sum<int>>(random);
+	test_segment_tree<int, segment_tree_min<int>>(random);
+	test_segment_tree<double, segment_tree_max<double>>(random);
+
+	test_lazy_segment_tree<long long, segment_tree_sum<long long>>(random);
+	test_lazy_segment_tree<int, segment_tree_min<int>>(random);
+	test_lazy_segment_tree<int, segment_tree_max<int>>(random);
+	test_lazy_segment_tree<float, segment_tree_max<float>>(random);
+
+	test_wide_segment_tree<float, segment_tree_sum<float>>(random);
+	test_wide_segment_tree<float, segment_tree_min<float>>(random);
+	test_wide_segment_tree<float, segment_tree_max<float>>(random);
+	test_wide_segment_tree<int32_t, segment_tree_sum<int32_t>>(random);
+	test_wide_segment_tree<int32_t, segment_tree_min<int32_t>>(random);
+	test_wide_segment_tree<int32_t, segment_tree_max<int32_t>>(random);
+	test_wide_segment_tree<double, segment_tree_sum<double>>(random);
+	test_wide_segment_tree<vec3, segment_tree_sum<vec3>>(random);
+
+	test_wide_node_reduce<float, segment_tree_sum<float>, 16>(random);
+	test_wide_node_reduce<float, segment_tree_min<float>, 16>(random);
+	test_wide_node_reduce<float, segment_tree_max<float>, 8>(random);
+	test_wide_node_reduce<int32_t, segment_tree_sum<int32_t>, 16>(random);
+	test_wide_node_reduce<int32_t, segment_tree_min<int32_t>, 4>(random);
+	test_wide_node_reduce<int32_t, segment_tree_max<int32_t>, 32>(random);
+
+	return test::result("segment_tree");
+}
@@ -0,0 +1,146 @@
+/*
+ * small_sort.cpp
+ * Test small_sort of keys and pairs against std::sort for every size up to small_sort_max_size (and the larger fallback),
+ * with the duplicated keys and the extreme keys equal to the padding, for all key types of the sorting networks and a scalar key,
+ * and small_sort_batch sequential and on a thread_pool against the arrays sorted one by one.
+ */
+
+#include <type_traits>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <limits>
+#include <set>
+
+#include "../algorithm/small_sort.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	//the random, few distinct, maximum (infinity) and minimum keys, the floating point keys are not NaN or -0
+	template<typename Key>
+	Key random_key(std::mt19937_64& random, unsigned mode) {
+		auto bits = random();
+
+		if (mode == 1) bits %= 4;
+
+		if (std::is_floating_point<Key>::value) {
+			if (mode == 2) return std::numeric_limits<Key>::infinity();
+			if (mode == 3) return -std::numeric_limits<Key>::infinity();
+
+			return static_cast<Key>(static_cast<int64_t>(bits % 2000000) - 1000000) / 7;
+		}
+
+		if (mode == 2) return std::numeric_limits<Key>::max();
+		if (mode == 3) return std::numeric_limits<Key>::lowest();
+
+		return static_cast<Key>(bits);
+	}
+
+	template<typename Key, typename Value>
+	void test_sizes(std::mt19937_64& random) {
+		size_t failures = 0;
+
+		for (size_t size = 0; size <= small_sort_max_size + 50; size++) {
+			for (unsigned round = 0; round < 4; round++) {
+				std::vector<Key> keys(size);
+				std::vector<Value> values(size);
+
+				for (size_t index = 0; index < size; index++) {
+					keys[index] = random_key<Key>(random, round == 0 ? 0 : static_cast<unsigned>(random() % 4));
+					values[index] = static_cast<Value>(random() % 3 == 0 ? 0 : random() % 100000);
+				}
+
+				auto expected = keys;
+				auto sorted = keys;
+
+				std::sort(expected.begin(), expected.end());
+				small_sort(sorted.data(), size);
+
+				failures += sorted != expected;
+
+				//the values are moved with their keys
+				std::multiset<std::pair<Key, Value>> before, after;
+
+				for (size_t index = 0; index < size; index++) before.insert({ keys[index], values[index] });
+
+				small_sort(keys.data(), values.data(), size);
+
+				for (size_t index = 0; index < size; index++) after.insert({ keys[index], values[index] });
+
+				failures += keys != expected || before != after;
+			}
+		}
+
+		ALG_DAT_CHECK(failures == 0);
+	}
+
+	template<typename Key, typename Value>
+	void test_batch(std::mt19937_64& random, thread_pool& pool) {
+		std::vector<size_t> offsets = { 0 };
+
+		while (offsets.back() < 100000) offsets.push_back(offsets.back() + random() % (small_sort_max_size + 1));
+
+		const auto count = offsets.size() - 1;
+
+		std::vector<Key> keys(offsets.back());
+		std::vector<Value> values(offsets.back());
+
+		for (size_t index = 0; index < keys.size(); index++) {
+			keys[index] = random_key<Key>(random, random() % 8 == 0 ? 1 : 0);
+			values[index] = static_cast<Value>(index);
+		}
+
+		auto expected = keys;
+
+		for (size_t array = 0; array < count; array++) std::sort(expected.begin() + offsets[array], expected.begin() + offsets[array + 1]);
+
+		for (auto current : { static_cast<thread_pool*>(nullptr), &pool }) {
+			auto sorted = keys;
+			auto pair_keys = keys;
+			auto pair_values = values;
+
+			small_sort_batch(sorted.data(), offsets.data(), count, small_sort_options{ current });
+			small_sort_batch(pair_keys.data(), pair_values.data(), offsets.data(), count, small_sort_options{ current });
+
+			ALG_DAT_CHECK(sorted == expected && pair_keys == expected);
+
+			size_t failures = 0;
+
+			//the value is the original index, it stays in its array
+			for (size_t array = 0; array < count; array++) {
+				for (auto index = offsets[array]; index < offsets[array + 1]; index++) {
+					const auto original = static_cast<size_t>(pair_values[index]);
+
+					failures += original < offsets[array] || original >= offsets[array + 1] || keys[original] != pair_keys[index];
+				}
+			}
+
+			ALG_DAT_CHECK(failures == 0);
+		}
+	}
+
+	template<typename Key, typename Value>
+	void test_type(std::mt19937_64& random, thread_pool& pool) {
+		test_sizes<Key, Value>(random);
+		test_batch<Key, Value>(random, pool);
+	}
+}
+
+int main() {
+	std::mt19937_64 random(99);
+	thread_pool pool(4);
+
+	test_type<int32_t, uint32_t>(random, pool);
+	test_type<uint32_t, float>(random, pool);
+	test_type<float, uint32_t>(random, pool);
+	test_type<int64_t, double>(random, pool);
+	test_type<uint64_t, uint64_t>(random, pool);
+	test_type<double, uint64_t>(random, pool);
+	test_type<uint16_t, uint32_t>(random, pool);
+
+	return test::result("small_sort");
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+ * test.hpp
+ * The tiny harness of tests, every test is an executable returns non-zero if any check fails.
+ *
+ * ALG_DAT_CHECK(condition) : count and report the failed check, the test continues.
+ * test::result(name) : print the summary and return the exit code of test.
+ *
+ * Every test is built twice by CMake : with the SIMD instructions of host and with ALG_DAT_NO_SIMD,
+ * so the same checks compare the SIMD and scalar paths with the std or brute force results.
+ * The tests of parallel algorithms run with nullptr and a thread_pool and compare them.
+ */
+
+#include <cstdio>
+#include <cstddef>
+
+#include "../dependent/simd.hpp"
+
+namespace alg_dat {
+
+	namespace test {
+
+		inline size_t& failure_count() {
+			static size_t count = 0;
+
+			return count;
+		}
+
+		inline void fail(const char* condition, const char* file, int line) {
+			//only the first failures are reported, the others are usually caused by them
+			if (failure_count()++ < 20) std::printf("%s(%d): check failed: %s\n", file, line, condition);
+		}
+
+		/**
+		 * \brief print the summary of test
+		 * \param name the name of test
+		 * \return the exit code, 0 if all checks pass
+		 */
+		inline int result(const char* name) {
+#ifdef ALG_DAT_NO_SIMD
+			const char* path = "scalar";
+#else
+			const char* path = "simd";
+#endif
+
+			if (failure_count() == 0) std::printf("%s (%s): ok\n", name, path);
+			else std::printf("%s (%s): %zu checks failed\n", name, path, failure_count());
+
+			return failure_count() == 0 ? 0 : 1;
+		}
+	}
+}
+
+#define ALG_DAT_CHECK(condition) \
+	do { if (!(condition)) alg_dat::test::fail(#condition, __FILE__, __LINE__); } while (false)
@@ -0,0 +1,185 @@
+/*
+ * thread_pool.cpp
+ * Test thread_pool : parallel_for visits every index once, the nested join and parallel_for, the exceptions of tasks,
+ * the concurrent callers out of the pool, and the parallel radix_sort against std::stable_sort and the sequential radix_sort.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <random>
+#include <vector>
+#include <atomic>
+#include <thread>
+
+#include "../dependent/thread_pool.hpp"
+#include "../algorithm/radix_sort.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	struct item {
+		uint32_t key;
+		uint32_t index;
+	};
+
+	//the small numbers are computed in the loop, the others fork both halves by join
+	long fibonacci(thread_pool& pool, int n) {
+		if (n < 12) {
+			long a = 0, b = 1;
+
+			for (int index = 0; index < n; index++) {
+				const auto c = a + b;
+
+				a = b;
+				b = c;
+			}
+
+			return a;
+		}
+
+		long x = 0, y = 0;
+
+		pool.join([&]() { x = fibonacci(pool, n - 1); }, [&]() { y = fibonacci(pool, n - 2); });
+
+		return x + y;
+	}
+
+	void test_parallel_for(thread_pool& pool) {
+		ALG_DAT_CHECK(fibonacci(pool, 25) == 75025);
+
+		for (size_t size : { 0, 1, 5, 1000, 100000, 1000003 }) {
+			for (size_t grain : { 0, 1, 1000 }) {
+				std::vector<std::atomic<int>> visits(size);
+
+				for (auto& visit : visits) visit = 0;
+
+				pool.parallel_for(0, size, [&](size_t first, size_t last) {
+					for (auto index = first; index < last; index++) visits[index]++;
+				}, grain);
+
+				ALG_DAT_CHECK(std::all_of(visits.begin(), visits.end(), [](const std::atomic<int>& visit) { return visit == 1; }));
+			}
+		}
+
+		//the nested parallel_for runs in the workers
+		std::atomic<long> total(0);
+
+		pool.parallel_for(0, 64, [&](size_t first, size_t last) {
+			for (auto index = first; index < last; index++) {
+				pool.parallel_for(0, 1000, [&](size_t begin, size_t end) { total += static_cast<long>(end - begin); });
+			}
+		}, 1);
+
+		ALG_DAT_CHECK(total == 64000);
+	}
+
+	void test_exceptions(thread_pool& pool) {
+		bool thrown = false;
+
+		try {
+			pool.parallel_for(0, 1000, [](size_t first, size_t) { if (first <= 500) throw std::runtime_error("parallel_for"); }, 10);
+		}
+		catch (const std::runtime_error&) {
+			thrown = true;
+		}
+
+		ALG_DAT_CHECK(thrown);
+
+		//both tasks of join throw, one exception is thrown
+		thrown = false;
+
+		try {
+			pool.join([]() { throw std::logic_error("f0"); }, []() { throw std::logic_error("f1"); });
+		}
+		catch (const std::logic_error&) {
+			thrown = true;
+		}
+
+		ALG_DAT_CHECK(thrown);
+
+		//the pool still works
+		std::atomic<int> count(0);
+
+		pool.parallel_for(0, 100, [&](size_t first, size_t last) { count += static_cast<int>(last - first); });
+
+		ALG_DAT_CHECK(count == 100);
+	}
+
+	void test_callers(thread_pool& pool) {
+		std::vector<std::thread> callers;
+		std::atomic<int> correct(0);
+
+		for (int caller = 0; caller < 4; caller++) {
+			callers.emplace_back([&]() {
+				for (int round = 0; round < 20; round++) {
+					std::atomic<long> sum(0);
+
+					pool.parallel_for(0, 10000, [&](size_t first, size_t last) {
+						long local = 0;
+
+						for (auto index = first; index < last; index++) local += static_cast<long>(index);
+
+						sum += local;
+					});
+
+					if (sum == 49995000) correct++;
+				}
+			});
+		}
+
+		for (auto& caller : callers) caller.join();
+
+		ALG_DAT_CHECK(correct == 80);
+	}
+
+	void test_radix_sort(std::mt19937& random, thread_pool& pool) {
+		for (size_t size : { 0, 1, 1000, 70000, 300001 }) {
+			std::vector<item> items(size);
+
+			for (size_t index = 0; index < size; index++) items[index] = { static_cast<uint32_t>(random() % 5000), static_cast<uint32_t>(index) };
+
+			auto expected = items;
+			auto sequential = items;
+
+			const auto key = [](const item& value) { return value.key; };
+
+			radix_sort<uint32_t, item>(items.data(), items.data() + size, key, radix_sort_options{ &pool });
+			radix_sort<uint32_t, item>(sequential.data(), sequential.data() + size, key);
+			std::stable_sort(expected.begin(), expected.end(), [](const item& l, const item& r) { return l.key < r.key; });
+
+			const auto same = [](const item& l, const item& r) { return l.key == r.key && l.index == r.index; };
+
+			ALG_DAT_CHECK(std::equal(items.begin(), items.end(), expected.begin(), same));
+			ALG_DAT_CHECK(std::equal(sequential.begin(), sequential.end(), expected.begin(), same));
+
+			std::vector<uint64_t> keys(size);
+
+			for (auto& value : keys) value = (static_cast<uint64_t>(random()) << 32) | random();
+
+			auto sorted = keys;
+
+			radix_sort<uint64_t, uint64_t>(keys.data(), keys.data() + size, default_radix_sort_function<uint64_t, uint64_t>, radix_sort_options{ &pool });
+			std::sort(sorted.begin(), sorted.end());
+
+			ALG_DAT_CHECK(keys == sorted);
+		}
+	}
+}
+
+int main() {
+	std::mt19937 random(95);
+
+	for (size_t thread_count : { 1, 2, 4, 7 }) {
+		thread_pool pool(thread_count, thread_count == 4);
+
+		test_parallel_for(pool);
+		test_exceptions(pool);
+		test_callers(pool);
+		test_radix_sort(random, pool);
+	}
+
+	return test::result("thread_pool");
+}
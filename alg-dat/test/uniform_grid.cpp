@@ -0,0 +1,139 @@
+/*
+ * uniform_grid.cpp
+ * Test the radius queries of uniform_grid2 against the brute force distances of all points, for the cell sizes
+ * smaller and larger than the points, the stable order of points in cells, and the build and batched query
+ * on a thread_pool against the sequential build and single queries.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../datastructure/spatial/uniform_grid.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	using vec_type = vec2_t<float>;
+
+	float squared_distance(const vec_type& v0, const vec_type& v1) {
+		const auto offset = v0 - v1;
+
+		return vec_type::dot(offset, offset);
+	}
+
+	void test_radius(std::mt19937& random, size_t size, float cell_size) {
+		std::uniform_real_distribution<float> position(-50, 50);
+
+		std::vector<vec_type> points(size);
+
+		for (auto& point : points) point = vec_type(position(random), position(random));
+
+		if (size > 10) points[3] = points[4];
+
+		//the second build reuses the buffers
+		uniform_grid2<float> grid(cell_size);
+
+		grid.build(points.data(), points.data() + size);
+		grid.build(points.data(), points.data() + size);
+
+		ALG_DAT_CHECK(grid.size() == size && grid.width() * grid.height() <= std::max<size_t>(size, 1) * 2);
+		ALG_DAT_CHECK(grid.cell_size() >= cell_size);
+
+		//the points of cell keep the input order
+		size_t failures = 0;
+
+		for (size_t cell = 0; cell < grid.width() * grid.height(); cell++) {
+			for (auto index = grid.offsets()[cell]; index < grid.offsets()[cell + 1]; index++) {
+				failures += grid.points()[index] != points[grid.indices()[index]];
+				failures += index > grid.offsets()[cell] && grid.indices()[index] <= grid.indices()[index - 1];
+			}
+		}
+
+		ALG_DAT_CHECK(failures == 0 && grid.offsets()[grid.width() * grid.height()] == size);
+
+		std::vector<vec_type> queries(100);
+
+		for (auto& query : queries) query = vec_type(position(random) * 1.2f, position(random) * 1.2f);
+
+		if (size != 0) queries[0] = points[0];
+
+		for (float radius : { 0.0f, 0.5f, 7.0f, 300.0f }) {
+			for (const auto& query : queries) {
+				std::vector<uint32_t> found;
+				std::vector<uint32_t> expected;
+
+				size_t wrong = 0;
+
+				grid.radius(query, radius, [&](size_t index, float distance) {
+					found.push_back(static_cast<uint32_t>(index));
+					wrong += squared_distance(points[index], query) != distance;
+				});
+
+				for (uint32_t index = 0; index < size; index++)
+					if (squared_distance(points[index], query) <= radius * radius) expected.push_back(index);
+
+				std::sort(found.begin(), found.end());
+
+				ALG_DAT_CHECK(wrong == 0 && found == expected);
+			}
+		}
+	}
+
+	//the parallel build and batched query need at least 2 * uniform_grid_min_work points and queries
+	void test_parallel(std::mt19937& random, thread_pool& pool) {
+		std::uniform_real_distribution<float> position(0, 1000);
+
+		const size_t size = 70000;
+
+		std::vector<vec_type> points(size);
+
+		for (auto& point : points) point = vec_type(position(random), position(random));
+
+		uniform_grid2<float> grid(3.0f);
+		uniform_grid2<float> parallel(3.0f, uniform_grid_options{ &pool });
+
+		grid.build(points.data(), points.data() + size);
+		parallel.build(points.data(), points.data() + size);
+
+		const auto cell_count = grid.width() * grid.height();
+
+		ALG_DAT_CHECK(parallel.width() == grid.width() && parallel.height() == grid.height());
+		ALG_DAT_CHECK(std::equal(grid.offsets(), grid.offsets() + cell_count + 1, parallel.offsets()));
+		ALG_DAT_CHECK(std::equal(grid.indices(), grid.indices() + size, parallel.indices()));
+
+		const auto count = size / 2;
+
+		std::vector<std::vector<uint32_t>> found(count);
+
+		parallel.radius(points.data(), count, 3.0f, [&](size_t query, size_t index, float) { found[query].push_back(static_cast<uint32_t>(index)); });
+
+		size_t failures = 0;
+
+		for (size_t query = 0; query < count; query++) {
+			std::vector<uint32_t> expected;
+
+			grid.radius(points[query], 3.0f, [&](size_t index, float) { expected.push_back(static_cast<uint32_t>(index)); });
+
+			failures += found[query] != expected;
+		}
+
+		ALG_DAT_CHECK(failures == 0);
+	}
+}
+
+int main() {
+	std::mt19937 random(88);
+	thread_pool pool(4);
+
+	for (size_t size : { 0, 1, 2, 50, 1000, 5000 }) {
+		for (float cell_size : { 0.001f, 1.0f, 5.0f, 1000.0f }) test_radius(random, size, cell_size);
+	}
+
+	test_parallel(random, pool);
+
+	return test::result("uniform_grid");
+}
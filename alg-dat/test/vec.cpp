@@ -0,0 +1,187 @@
+/*
+ * vec.cpp
+ * Test vec_t<T, N> against the loops over std::array, the SIMD vec4_t<float> against the scalar vec_t<double, 4>,
+ * and the operations in constant expressions against them at run time.
+ */
+
+#include <random>
+#include <array>
+#include <cmath>
+
+#include "../dependent/vec.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	template<typename T, size_t N>
+	bool same(const vec_t<T, N>& vec, const std::array<T, N>& expected) {
+		for (size_t index = 0; index < N; index++)
+			if (vec[index] != expected[index]) return false;
+
+		return true;
+	}
+
+	template<typename T, size_t N, typename Operation>
+	std::array<T, N> map(const std::array<T, N>& v0, const std::array<T, N>& v1, Operation operation) {
+		std::array<T, N> result = {};
+
+		for (size_t index = 0; index < N; index++) result[index] = operation(v0[index], v1[index]);
+
+		return result;
+	}
+
+	//the components are small integers, so the results are exact for all types
+	template<typename T, size_t N>
+	void test_operations(std::mt19937& random) {
+		const auto value = [&](int range) { return static_cast<T>(static_cast<int>(random() % (2 * range + 1)) - range); };
+
+		for (int round = 0; round < 20000; round++) {
+			std::array<T, N> a = {}, b = {};
+			vec_t<T, N> u, v;
+
+			for (size_t index = 0; index < N; index++) {
+				a[index] = value(1000);
+				b[index] = value(100);
+				u[index] = a[index];
+				v[index] = b[index];
+			}
+
+			const auto s = value(10);
+
+			ALG_DAT_CHECK(same(u + v, map(a, b, [](T x, T y) { return T(x + y); })));
+			ALG_DAT_CHECK(same(u - v, map(a, b, [](T x, T y) { return T(x - y); })));
+			ALG_DAT_CHECK(same(-u, map(a, b, [](T x, T) { return T(-x); })));
+			ALG_DAT_CHECK(same(u * v, map(a, b, [](T x, T y) { return T(x * y); })));
+			ALG_DAT_CHECK(same(u * s, map(a, b, [&](T x, T) { return T(x * s); })));
+			ALG_DAT_CHECK(same(vec_t<T, N>::min(u, v), map(a, b, [](T x, T y) { return std::min(x, y); })));
+			ALG_DAT_CHECK(same(vec_t<T, N>::max(u, v), map(a, b, [](T x, T y) { return std::max(x, y); })));
+			ALG_DAT_CHECK(same(vec_t<T, N>::fma(u, v, u), map(a, b, [](T x, T y) { return T(x * y + x); })));
+
+			if (s != T(0)) ALG_DAT_CHECK(same(u / s, map(a, b, [&](T x, T) { return T(x / s); })));
+
+			T dot = T(0);
+
+			for (size_t index = 0; index < N; index++) dot = dot + a[index] * b[index];
+
+			ALG_DAT_CHECK((vec_t<T, N>::dot(u, v) == dot));
+
+			auto w = u;
+
+			w += v;
+			w *= s;
+			w -= v;
+			w *= v;
+			ALG_DAT_CHECK(same(w, map(a, b, [&](T x, T y) { return T((T(x + y) * s - y) * y); })));
+
+			ALG_DAT_CHECK((u == v) == (a == b) && (u != v) == (a != b) && u == u);
+		}
+	}
+
+	//the SIMD vec4_t<float> is compared with the generic vec_t<double, 4>
+	void test_vec4(std::mt19937& random) {
+		const auto value = [&](int range) { return static_cast<int>(random() % (2 * range + 1)) - range; };
+		const auto same4 = [](const vec4_t<float>& vec, const vec4_t<double>& expected) {
+			return vec.x == float(expected.x) && vec.y == float(expected.y) && vec.z == float(expected.z) && vec.w == float(expected.w);
+		};
+
+		for (int round = 0; round < 50000; round++) {
+			const int a[4] = { value(1000), value(1000), value(1000), value(1000) };
+			const int b[4] = { value(100), value(100), value(100), value(100) };
+			const int s = value(10);
+
+			const vec4_t<float> u(a[0], a[1], a[2], a[3]), v(b[0], b[1], b[2], b[3]);
+			const vec4_t<double> ru(a[0], a[1], a[2], a[3]), rv(b[0], b[1], b[2], b[3]);
+
+			ALG_DAT_CHECK(same4(u + v, ru + rv) && same4(u - v, ru - rv) && same4(-u, -ru));
+			ALG_DAT_CHECK(same4(u * v, ru * rv) && same4(u * float(s), ru * double(s)));
+			ALG_DAT_CHECK(same4(vec4_t<float>::min(u, v), vec4_t<double>::min(ru, rv)));
+			ALG_DAT_CHECK(same4(vec4_t<float>::max(u, v), vec4_t<double>::max(ru, rv)));
+			ALG_DAT_CHECK(same4(vec4_t<float>::fma(u, v, u), vec4_t<double>::fma(ru, rv, ru)));
+			ALG_DAT_CHECK(vec4_t<float>::dot(u, v) == float(vec4_t<double>::dot(ru, rv)));
+			ALG_DAT_CHECK((u == v) == (ru == rv) && (u != v) == (ru != rv));
+
+			if (s != 0) {
+				const auto quotient = u / float(s);
+
+				for (size_t index = 0; index < 4; index++) ALG_DAT_CHECK(quotient[index] == float(a[index]) / float(s));
+			}
+		}
+
+		const vec4_t<float> q(3, 4, 0, 0);
+		const auto n = vec4_t<float>::normalize(q);
+
+		ALG_DAT_CHECK(q.length() == 5.0f && std::abs(n.x - 0.6f) < 1e-6f && std::abs(n.y - 0.8f) < 1e-6f && n.z == 0.0f);
+	}
+
+	//all operations except length and normalize, it is evaluated at compile time and at run time
+	template<typename T, size_t N>
+	constexpr vec_t<T, N> expression(T one) {
+		vec_t<T, N> a(one);
+
+		a[1] = 2;
+		a += vec_t<T, N>(3);
+		a -= vec_t<T, N>(one);
+		a *= T(2);
+		a *= a;
+		a /= T(2);
+
+		return vec_t<T, N>::fma(a, vec_t<T, N>(2), -vec_t<T, N>::min(a, vec_t<T, N>::max(a, vec_t<T, N>(0)))) * vec_t<T, N>(1) / T(1) + a - a * T(1);
+	}
+
+	template<typename T, size_t N>
+	void test_constexpr() {
+		constexpr auto result = expression<T, N>(T(1));
+
+		static_assert(result[0] == T(18) && result[1] == T(32), "the constant expression of vec_t.");
+		static_assert(vec_t<T, N>::dot(result, vec_t<T, N>(1)) == T(32 + 18 * (N - 1)), "the constant dot of vec_t.");
+
+		volatile T one = T(1);
+
+		ALG_DAT_CHECK((expression<T, N>(one) == result));
+	}
+
+	void test_components() {
+		static_assert(sizeof(vec3_t<float>) == 12 && sizeof(vec4_t<float>) == 16 && sizeof(vec_t<double, 7>) == 56, "vec_t is packed components.");
+
+		constexpr vec3_t<float> v(1, 2, 3);
+		constexpr vec4_t<float> w(1, 2, 3, 4);
+
+		static_assert(v.z == 3 && vec3_t<float>::dot(v, v) == 14, "the named components of vec3_t.");
+		static_assert(w.w == 4 && vec4_t<float>::dot(w, w) == 30, "the named components of vec4_t.");
+
+		vec3_t<double> d(1, 2, 2);
+
+		ALG_DAT_CHECK(d.length() == 3.0);
+
+		d.x += 1;
+
+		ALG_DAT_CHECK(d[0] == 2.0 && d == vec3_t<double>(2, 2, 2));
+	}
+}
+
+int main() {
+	std::mt19937 random(84);
+
+	test_operations<float, 3>(random);
+	test_operations<float, 5>(random);
+	test_operations<int32_t, 3>(random);
+	test_operations<int32_t, 4>(random);
+	test_operations<double, 4>(random);
+	test_operations<int64_t, 9>(random);
+	test_vec4(random);
+
+	test_constexpr<float, 2>();
+	test_constexpr<float, 3>();
+	test_constexpr<float, 4>();
+	test_constexpr<float, 5>();
+	test_constexpr<int32_t, 2>();
+	test_constexpr<int32_t, 4>();
+	test_constexpr<double, 4>();
+	test_constexpr<int64_t, 9>();
+	test_components();
+
+	return test::result("vec");
+}
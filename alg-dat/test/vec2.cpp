@@ -0,0 +1,138 @@
+/*
+ * vec2.cpp
+ * Test the SIMD vec2_t<float> and vec2_t<int32_t> against the scalar vec_t<double, 2> and vec_t<int64_t, 2>.
+ * The components are small integers, so the results of float and int32 are exact and must be same.
+ * The operations in constant expressions (the scalar path of specializations) are same as them at run time.
+ */
+
+#include <random>
+#include <cmath>
+
+#include "../dependent/vec2.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	template<typename T, typename Reference>
+	bool same(const vec2_t<T>& vec, const vec2_t<Reference>& expected) {
+		return vec.x == static_cast<T>(expected.x) && vec.y == static_cast<T>(expected.y) && vec[0] == vec.x && vec[1] == vec.y;
+	}
+
+	//the operations of T and Reference on same values, Reference is the generic (scalar) vec_t
+	template<typename T, typename Reference>
+	void test_operations(std::mt19937& random) {
+		const auto value = [&](int range) { return static_cast<int>(random() % (2 * range + 1)) - range; };
+
+		for (int round = 0; round < 100000; round++) {
+			const int a = value(1000), b = value(1000), c = value(100), d = value(100), s = value(10);
+
+			const vec2_t<T> u(a, b), v(c, d);
+			const vec2_t<Reference> ru(a, b), rv(c, d);
+
+			ALG_DAT_CHECK(same(u + v, ru + rv));
+			ALG_DAT_CHECK(same(u - v, ru - rv));
+			ALG_DAT_CHECK(same(-u, -ru));
+			ALG_DAT_CHECK(same(u * static_cast<T>(s), ru * static_cast<Reference>(s)));
+			ALG_DAT_CHECK(same(u * v, ru * rv));
+			ALG_DAT_CHECK(same(vec2_t<T>::min(u, v), vec2_t<Reference>::min(ru, rv)));
+			ALG_DAT_CHECK(same(vec2_t<T>::max(u, v), vec2_t<Reference>::max(ru, rv)));
+			ALG_DAT_CHECK(same(vec2_t<T>::fma(u, v, u), vec2_t<Reference>::fma(ru, rv, ru)));
+			ALG_DAT_CHECK(vec2_t<T>::dot(u, v) == static_cast<T>(vec2_t<Reference>::dot(ru, rv)));
+
+			//the division is not exact, it is compared with the division of T
+			if (s != 0) {
+				const auto quotient = u / static_cast<T>(s);
+
+				ALG_DAT_CHECK(quotient.x == static_cast<T>(a) / static_cast<T>(s) && quotient.y == static_cast<T>(b) / static_cast<T>(s));
+
+				auto w = u;
+
+				w /= static_cast<T>(s);
+				ALG_DAT_CHECK(w == quotient);
+			}
+
+			auto w = u;
+
+			w += v;
+			ALG_DAT_CHECK(same(w, ru + rv));
+			w -= v;
+			ALG_DAT_CHECK(w == u && !(w != u));
+			w *= static_cast<T>(s);
+			ALG_DAT_CHECK(same(w, ru * static_cast<Reference>(s)));
+			w = u;
+			w *= v;
+			ALG_DAT_CHECK(same(w, ru * rv));
+
+			ALG_DAT_CHECK((u == v) == (a == c && b == d));
+			ALG_DAT_CHECK((u != v) == (a != c || b != d));
+			ALG_DAT_CHECK(vec2_t<T>(a, d) != u || d == b);
+		}
+	}
+
+	//all operations except length and normalize, it is evaluated at compile time and at run time
+	template<typename T>
+	constexpr vec2_t<T> expression(T one) {
+		vec2_t<T> a(one, 2);
+
+		a += vec2_t<T>(3, 4);
+		a -= vec2_t<T>(one);
+		a *= T(2);
+		a *= vec2_t<T>(1, 2);
+		a /= T(2);
+		a[0] = a[0] + 1;
+
+		return vec2_t<T>::fma(a, vec2_t<T>(2), -vec2_t<T>::min(a, vec2_t<T>::max(a, vec2_t<T>(0)))) * vec2_t<T>(1, 1) / T(1);
+	}
+
+	template<typename T>
+	void test_constexpr() {
+		constexpr auto result = expression<T>(T(1));
+
+		static_assert(result == vec2_t<T>(4, 10) && result != vec2_t<T>(4, 11), "the constant expression of vec2_t.");
+		static_assert(vec2_t<T>::dot(result, result) == T(116), "the constant dot of vec2_t.");
+
+		constexpr vec2_t<T> table[] = { vec2_t<T>(1, 0) + vec2_t<T>(0, 1), vec2_t<T>(2) * T(3) };
+
+		static_assert(table[0] == vec2_t<T>(1) && table[1][1] == T(6), "the constant table of vec2_t.");
+		static_assert(noexcept(result + result) && noexcept(result.length()), "the operations of vec2_t are noexcept.");
+
+		//the value is not known at compile time, so the SIMD path is used
+		volatile T one = T(1);
+
+		ALG_DAT_CHECK(expression<T>(one) == result);
+	}
+
+	void test_length() {
+		const vec2_t<float> f(3, 4);
+		const vec2_t<double> d(3, 4);
+		const vec2_t<int32_t> i(-3, 4);
+
+		ALG_DAT_CHECK(f.length() == 5.0f && d.length() == 5.0 && i.length() == 5.0);
+
+		const auto n = vec2_t<float>::normalize(f);
+		const auto m = vec2_t<double>::normalize(d);
+
+		ALG_DAT_CHECK(std::abs(n.x - 0.6f) < 1e-6f && std::abs(n.y - 0.8f) < 1e-6f);
+		ALG_DAT_CHECK(std::abs(m.x - 0.6) < 1e-12 && std::abs(m.y - 0.8) < 1e-12);
+
+		static_assert(sizeof(vec2_t<float>) == 8 && sizeof(vec2_t<int32_t>) == 8, "vec2_t is two components.");
+	}
+}
+
+int main() {
+	std::mt19937 random(81);
+
+	test_operations<float, double>(random);
+	test_operations<int32_t, int64_t>(random);
+	test_length();
+
+	test_constexpr<float>();
+	test_constexpr<int32_t>();
+	test_constexpr<double>();
+	test_constexpr<int64_t>();
+
+	return test::result("vec2");
+}
@@ -0,0 +1,132 @@
+/*
+ * vec2_soa.cpp
+ * Test the batch kernels of vec2_soa against the vec2_t operations of every point,
+ * and the SIMD batches against the scalar loop : a vec2_soa of one point only runs the scalar loop,
+ * so the results of every point alone must be same as the results of batches in bits.
+ */
+
+#include <random>
+#include <vector>
+#include <cmath>
+
+#include "../dependent/vec2_soa.hpp"
+
+#include "test.hpp"
+
+using namespace alg_dat;
+
+namespace {
+
+	const size_t sizes[] = { 1, 7, 8, 15, 16, 17, 33, 1000 };
+
+	//the components are small integers, so the results are exact for all types
+	template<typename T>
+	void test_operations() {
+		for (auto size : sizes) {
+			std::vector<vec2_t<T>> points(size);
+
+			for (size_t index = 0; index < size; index++) points[index] = vec2_t<T>(T(index % 37) - 5, T(index % 11) * 2);
+
+			vec2_soa<T> soa(points.data(), points.data() + size);
+
+			ALG_DAT_CHECK(soa.size() == size);
+
+			for (size_t index = 0; index < size; index++) ALG_DAT_CHECK(soa.at(index) == points[index]);
+
+			soa.add(vec2_t<T>(1, 2));
+			soa.scale(T(2));
+			soa.sub(vec2_t<T>(1, 1));
+
+			vec2_soa<T> other(soa);
+
+			other.add(soa);
+			other.sub(soa);
+
+			soa.transform(vec2_t<T>(0, 1), vec2_t<T>(-1, 0), vec2_t<T>(3, 4));
+
+			std::vector<vec2_t<T>> output(size);
+
+			soa.to_aos(output.data());
+
+			for (size_t index = 0; index < size; index++) {
+				const auto point = (points[index] + vec2_t<T>(1, 2)) * T(2) - vec2_t<T>(1, 1);
+
+				ALG_DAT_CHECK(other.at(index) == point);
+				ALG_DAT_CHECK(output[index] == vec2_t<T>(-point.y + 3, point.x + 4));
+			}
+
+			vec2_t<T> min, max;
+			vec2_t<T> expected_min = output[0], expected_max = output[0];
+
+			for (const auto& point : output) {
+				expected_min = vec2_t<T>::min(expected_min, point);
+				expected_max = vec2_t<T>::max(expected_max, point);
+			}
+
+			soa.bounds(min, max);
+
+			ALG_DAT_CHECK(min == expected_min && max == expected_max);
+
+			std::vector<T> distances(size);
+			std::vector<T> squared(size);
+
+			soa.distance(vec2_t<T>(1, 1), distances.data());
+			soa.distance_squared(vec2_t<T>(1, 1), squared.data());
+
+			for (size_t index = 0; index < size; index++) {
+				const auto offset = output[index] - vec2_t<T>(1, 1);
+				const auto expected = vec2_t<T>::dot(offset, offset);
+
+				ALG_DAT_CHECK(squared[index] == expected);
+				ALG_DAT_CHECK(std::abs(static_cast<double>(distances[index]) - std::sqrt(static_cast<double>(expected))) <= (std::is_integral<T>::value ? 1.0 : 1e-3));
+			}
+		}
+	}
+
+	//the random floats round differently if the fma of batches and scalar loop are not same
+	void test_batches_against_scalar(std::mt19937& random) {
+		std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+
+		const size_t size = 1000;
+
+		std::vector<vec2_t<float>> points(size);
+
+		for (auto& point : points) point = vec2_t<float>(distribution(random), distribution(random));
+
+		const vec2_t<float> query(0.3f, -7.1f), axis_x(0.7f, 0.3f), axis_y(-0.31f, 0.9f), offset(1.1f, 2.3f);
+
+		vec2_soa<float> soa(points.data(), points.data() + size);
+
+		std::vector<float> squared(size), distances(size);
+
+		soa.distance_squared(query, squared.data());
+		soa.distance(query, distances.data());
+		soa.transform(axis_x, axis_y, offset);
+
+		for (size_t index = 0; index < size; index++) {
+			vec2_soa<float> single(&points[index], &points[index] + 1);
+
+			float value = 0;
+
+			single.distance_squared(query, &value);
+			ALG_DAT_CHECK(value == squared[index]);
+
+			single.distance(query, &value);
+			ALG_DAT_CHECK(value == distances[index]);
+
+			single.transform(axis_x, axis_y, offset);
+			ALG_DAT_CHECK(single.x()[0] == soa.x()[index] && single.y()[0] == soa.y()[index]);
+		}
+	}
+}
+
+int main() {
+	std::mt19937 random(82);
+
+	test_operations<float>();
+	test_operations<double>();
+	test_operations<int32_t>();
+	test_batches_against_scalar(random);
+
+	return test::result("vec2_soa");
+}
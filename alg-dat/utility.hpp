@@ -1,8 +1,36 @@
 #pragma once
 
+/*
+ * utility.hpp
+ * real is the default component type, e.g. vec2, bounds2 and the default template argument of spatial structures.
+ * It is float by default, define one of the macros before including any header to change it :
+ * ALG_DAT_REAL_DOUBLE : double.
+ * ALG_DAT_REAL_FIXED16 : fixed16_16 (Q16.16), see more in "dependent/fixed.hpp".
+ * ALG_DAT_REAL_FIXED32 : fixed32_32 (Q32.32).
+ * ALG_DAT_REAL : any type, e.g. #define ALG_DAT_REAL long double.
+ *
+ * The macros work per translation unit, but the translation units in one program should use same real,
+ * otherwise the inline functions with real (e.g. vec2) have different definitions.
+ * To mix them, use the template argument instead, e.g. vec2_t<double> and bvh2<float>.
+ */
+
+#if defined(ALG_DAT_REAL_FIXED16) || defined(ALG_DAT_REAL_FIXED32)
+#include "dependent/fixed.hpp"
+#endif
+
 namespace alg_dat {
 	
+#if defined(ALG_DAT_REAL)
+	using real = ALG_DAT_REAL;
+#elif defined(ALG_DAT_REAL_DOUBLE)
+	using real = double;
+#elif defined(ALG_DAT_REAL_FIXED16)
+	using real = fixed16_16;
+#elif defined(ALG_DAT_REAL_FIXED32)
+	using real = fixed32_32;
+#else
 	using real = float;
+#endif
 
 	
 }